@@ -0,0 +1,231 @@
+// UTF-8 and string function benchmarks, compares the library against a naive
+// decoder that goes through utf8_decode() for every rune.
+//
+//   cc -std=c11 -O2 -DTARGET_OS_LINUX bench.c prelude.c -o bench.bin -lm
+#include "prelude.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CORPUS_SIZE (8ll * 1024 * 1024)
+#define FIELD_SIZE 24
+
+typedef struct {
+	cstring name;
+	byte* data;
+	isize len;
+} Corpus;
+
+static u64 rng_state = 0x9e3779b97f4a7c15ull;
+
+static u32 rng(){
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return (u32)rng_state;
+}
+
+// Fill with log-like fields padded by spaces, `mixed_pct` percent of the
+// characters are non-ASCII (Latin-1, Cyrillic, CJK and emoji).
+static Corpus make_corpus(cstring name, u32 mixed_pct){
+	static const rune non_ascii[] = { 0xe9, 0xfc, 0x0436, 0x044f, 0x4e2d, 0x6587, 0x1f600 };
+	Corpus c = { .name = name, .data = malloc(CORPUS_SIZE), .len = 0 };
+	while(c.len + FIELD_SIZE + 8 < CORPUS_SIZE){
+		isize field_end = c.len + FIELD_SIZE;
+		c.data[c.len++] = ' ';
+		while(c.len < field_end - 2){
+			if(rng() % 100 < mixed_pct){
+				UTF8_Encode_Result e = utf8_encode(non_ascii[rng() % (sizeof(non_ascii) / sizeof(rune))]);
+				mem_copy(&c.data[c.len], e.bytes, e.len);
+				c.len += e.len;
+			}
+			else {
+				c.data[c.len++] = 'a' + rng() % 26;
+			}
+		}
+		c.data[c.len++] = ' ';
+		c.data[c.len++] = '\t';
+	}
+	return c;
+}
+
+static isize naive_next(byte const* data, isize len, isize pos, rune* r){
+	UTF8_Decode_Result res = utf8_decode(&data[pos], len - pos);
+	*r = res.codepoint;
+	return res.len > 0 ? res.len : 1;
+}
+
+static isize naive_count(String s){
+	isize count = 0;
+	rune r;
+	for(isize i = 0; i < s.len; i += naive_next(s.data, s.len, i, &r)){
+		count += 1;
+	}
+	return count;
+}
+
+static isize naive_offset(String s, isize n){
+	isize i = 0;
+	rune r;
+	for(isize k = 0; k < n && i < s.len; k += 1){
+		i += naive_next(s.data, s.len, i, &r);
+	}
+	return i;
+}
+
+static String naive_trim_leading(String s, String cutset){
+	rune set[64] = {0};
+	isize set_len = 0;
+	rune r;
+	for(isize i = 0; i < cutset.len && set_len < 64; set_len += 1){
+		i += naive_next(cutset.data, cutset.len, i, &set[set_len]);
+	}
+	isize i = 0;
+	while(i < s.len){
+		isize n = naive_next(s.data, s.len, i, &r);
+		bool cut = false;
+		for(isize k = 0; k < set_len; k += 1){
+			if(set[k] == r){ cut = true; break; }
+		}
+		if(!cut){ break; }
+		i += n;
+	}
+	return str_sub(s, i, s.len - i);
+}
+
+static isize lib_iterate(String s){
+	UTF8_Iterator it = str_iterator(s);
+	rune r; i8 n;
+	isize sum = 0;
+	while(utf8_iter_next(&it, &r, &n)){
+		sum += r;
+	}
+	return sum;
+}
+
+static isize naive_iterate(String s){
+	isize sum = 0;
+	for(isize i = 0; i < s.len;){
+		rune r;
+		i += naive_next(s.data, s.len, i, &r);
+		sum += r;
+	}
+	return sum;
+}
+
+static isize lib_trim_fields(String s){
+	isize kept = 0;
+	for(isize i = 0; i + FIELD_SIZE <= s.len; i += FIELD_SIZE){
+		kept += str_trim_leading(str_sub(s, i, FIELD_SIZE), str_lit(" \t")).len;
+	}
+	return kept;
+}
+
+static Cutset field_cutset;
+
+static isize lib_trim_set_fields(String s){
+	isize kept = 0;
+	for(isize i = 0; i + FIELD_SIZE <= s.len; i += FIELD_SIZE){
+		kept += str_trim_leading_set(str_sub(s, i, FIELD_SIZE), &field_cutset).len;
+	}
+	return kept;
+}
+
+static isize naive_trim_fields(String s){
+	isize kept = 0;
+	for(isize i = 0; i + FIELD_SIZE <= s.len; i += FIELD_SIZE){
+		kept += naive_trim_leading(str_sub(s, i, FIELD_SIZE), str_lit(" \t")).len;
+	}
+	return kept;
+}
+
+static isize lib_offsets(String s){
+	isize sum = 0;
+	for(isize k = 1; k <= 64; k += 1){
+		sum += str_codepoint_offset(s, k * 1000);
+	}
+	return sum;
+}
+
+static isize naive_offsets(String s){
+	isize sum = 0;
+	for(isize k = 1; k <= 64; k += 1){
+		sum += naive_offset(s, k * 1000);
+	}
+	return sum;
+}
+
+static isize lib_count(String s){ return str_codepoint_count(s); }
+
+static u16* utf16_buffer;
+
+static isize naive_to_utf16(String s){
+	isize n = 0;
+	for(isize i = 0; i < s.len;){
+		rune r;
+		i += naive_next(s.data, s.len, i, &r);
+		if(r < 0x10000){
+			utf16_buffer[n++] = (u16)r;
+		}
+		else {
+			utf16_buffer[n++] = (u16)(0xd800 + ((r - 0x10000) >> 10));
+			utf16_buffer[n++] = (u16)(0xdc00 + ((r - 0x10000) & 0x3ff));
+		}
+	}
+	return n;
+}
+
+static isize lib_to_utf16(String s){
+	return utf8_to_utf16(utf16_buffer, s.len, s.data, s.len, null);
+}
+
+typedef isize (*Bench_Func)(String s);
+
+// Best of a few runs, in nanoseconds
+static Time_Duration measure(Bench_Func f, String s, isize* result){
+	Time_Duration best = -1;
+	for(int run = 0; run < 5; run += 1){
+		Time_Point start = time_now();
+		*result = f(s);
+		Time_Duration d = time_since(start);
+		if(best < 0 || d < best){ best = d; }
+	}
+	return best;
+}
+
+static void compare(cstring name, Corpus c, isize bytes, Bench_Func naive, Bench_Func lib){
+	String s = str_from_bytes(c.data, c.len);
+	isize naive_res = 0, lib_res = 0;
+	Time_Duration t_naive = measure(naive, s, &naive_res);
+	Time_Duration t_lib = measure(lib, s, &lib_res);
+	printf("%-10s %-8s naive %8.3f GB/s   lib %8.3f GB/s   x%6.1f %s\n",
+		name, c.name,
+		(double)bytes / (double)t_naive, (double)bytes / (double)t_lib,
+		(double)t_naive / (double)t_lib,
+		naive_res == lib_res ? "" : "(MISMATCH)");
+}
+
+int main(){
+	Corpus corpora[] = {
+		make_corpus("ascii", 0),
+		make_corpus("mixed", 15),
+		make_corpus("heavy", 60),
+	};
+
+	cutset_init(&field_cutset, str_lit(" \t"), libc_allocator());
+	utf16_buffer = malloc(CORPUS_SIZE * sizeof(u16));
+
+	for(isize i = 0; i < (isize)(sizeof(corpora) / sizeof(Corpus)); i += 1){
+		Corpus c = corpora[i];
+		String s = str_from_bytes(c.data, c.len);
+		compare("iterate", c, c.len, naive_iterate, lib_iterate);
+		compare("count", c, c.len, naive_count, lib_count);
+		compare("trim", c, c.len, naive_trim_fields, lib_trim_fields);
+		compare("trim_set", c, c.len, naive_trim_fields, lib_trim_set_fields);
+		compare("offset", c, naive_offset(s, 64 * 1000) * 64 / 2, naive_offsets, lib_offsets);
+		compare("to_utf16", c, c.len, naive_to_utf16, lib_to_utf16);
+		free(c.data);
+	}
+	cutset_destroy(&field_cutset);
+	free(utf16_buffer);
+}
@@ -36,7 +36,8 @@ void unimplemented(){
 }
 
 //// Spinlock //////////////////////////////////////////////////////////////////
-void spinlock_acquire(Spinlock* l){
+/* Names are parenthesized so the profiling macros don't expand here */
+void (spinlock_acquire)(Spinlock* l){
 	for(;;){
 		if(!atomic_exchange_explicit(&l->_state, SPINLOCK_LOCKED, memory_order_acquire)){
 			break;
@@ -46,12 +47,138 @@ void spinlock_acquire(Spinlock* l){
 	}
 }
 
-bool spinlock_try_acquire(Spinlock* l){
+bool (spinlock_try_acquire)(Spinlock* l){
     return !atomic_exchange_explicit(&l->_state, SPINLOCK_LOCKED, memory_order_acquire);
 }
 
+#ifdef ENABLE_LOCK_PROFILING
+static void lock_profile_release(Spinlock* l);
+#endif
+
 void spinlock_release(Spinlock* l){
+#ifdef ENABLE_LOCK_PROFILING
+	lock_profile_release(l);
+#else
 	atomic_store(&l->_state, SPINLOCK_UNLOCKED);
+#endif
+}
+
+//// Atomic ////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+
+static inline
+long futex_op(atomic_int* addr, int op, int val, struct timespec const* timeout){
+	return syscall(SYS_futex, addr, op, val, timeout, null, 0);
+}
+
+void atomic_wait(atomic_int* ptr, int old, memory_order order){
+	while(atomic_load_explicit(ptr, order) == old){
+		futex_op(ptr, FUTEX_WAIT_PRIVATE, old, null);
+	}
+}
+
+static inline
+i64 monotonic_ns(){
+	struct timespec spec = {0};
+	clock_gettime(CLOCK_MONOTONIC, &spec);
+	return (i64)spec.tv_sec * 1000000000ll + (i64)spec.tv_nsec;
+}
+
+bool atomic_wait_timeout(atomic_int* ptr, int old, memory_order order, i64 timeout_ns){
+	i64 deadline = monotonic_ns() + timeout_ns;
+	/* Signals and spurious wakeups return early, sleep again for what is left */
+	for(;;){
+		if(atomic_load_explicit(ptr, order) != old){ return true; }
+		i64 remaining = deadline - monotonic_ns();
+		if(remaining <= 0){ return false; }
+		struct timespec spec = {
+			.tv_sec  = remaining / 1000000000ll,
+			.tv_nsec = remaining % 1000000000ll,
+		};
+		futex_op(ptr, FUTEX_WAIT_PRIVATE, old, &spec);
+	}
+}
+
+void atomic_notify_one(atomic_int* ptr){
+	futex_op(ptr, FUTEX_WAKE_PRIVATE, 1, null);
+}
+
+void atomic_notify_all(atomic_int* ptr){
+	futex_op(ptr, FUTEX_WAKE_PRIVATE, INT_MAX, null);
+}
+
+#elif defined(TARGET_OS_WINDOWS)
+#pragma comment(lib, "Synchronization.lib")
+
+void atomic_wait(atomic_int* ptr, int old, memory_order order){
+	while(atomic_load_explicit(ptr, order) == old){
+		WaitOnAddress(ptr, &old, sizeof(old), INFINITE);
+	}
+}
+
+bool atomic_wait_timeout(atomic_int* ptr, int old, memory_order order, i64 timeout_ns){
+	LARGE_INTEGER freq, start, now;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+	/* Spurious wakeups return early, sleep again for what is left */
+	for(;;){
+		if(atomic_load_explicit(ptr, order) != old){ return true; }
+		QueryPerformanceCounter(&now);
+		i64 elapsed = (i64)((double)(now.QuadPart - start.QuadPart) * (1e9 / (double)freq.QuadPart));
+		i64 remaining = timeout_ns - elapsed;
+		if(remaining <= 0){ return false; }
+		/* Round up, so a sub-millisecond wait doesn't turn into a busy loop */
+		DWORD ms = (DWORD)((remaining + 999999ll) / 1000000ll);
+		WaitOnAddress(ptr, &old, sizeof(old), ms);
+	}
+}
+
+void atomic_notify_one(atomic_int* ptr){
+	WakeByAddressSingle(ptr);
+}
+
+void atomic_notify_all(atomic_int* ptr){
+	WakeByAddressAll(ptr);
+}
+#endif
+
+//// Sharded Counter ///////////////////////////////////////////////////////////
+static inline
+isize current_cpu_slot(){
+#if defined(TARGET_OS_LINUX)
+	int cpu = sched_getcpu();
+#elif defined(TARGET_OS_WINDOWS)
+	int cpu = (int)GetCurrentProcessorNumber();
+#endif
+	if(cpu < 0){
+		/* No CPU info, spread threads by the address of their thread local storage */
+		static _Thread_local byte marker;
+		cpu = (int)(((uintptr)&marker) >> 12);
+	}
+	return (isize)cpu & (SHARDED_COUNTER_SLOTS - 1);
+}
+
+void sharded_counter_add(Sharded_Counter* c, i64 delta){
+	atomic_fetch_add_explicit(&c->_slots[current_cpu_slot()].value, delta, memory_order_relaxed);
+}
+
+i64 sharded_counter_sum(Sharded_Counter* c){
+	i64 total = 0;
+	for(isize i = 0; i < SHARDED_COUNTER_SLOTS; i += 1){
+		total += atomic_load_explicit(&c->_slots[i].value, memory_order_relaxed);
+	}
+	return total;
+}
+
+void sharded_counter_reset(Sharded_Counter* c){
+	for(isize i = 0; i < SHARDED_COUNTER_SLOTS; i += 1){
+		atomic_store_explicit(&c->_slots[i].value, 0, memory_order_relaxed);
+	}
 }
 
 //// Memory ////////////////////////////////////////////////////////////////////
@@ -146,7 +273,10 @@ void* mem_realloc(Mem_Allocator allocator, void* ptr, isize old_size, isize new_
 
 	void* new_data = mem_alloc(allocator, new_size, align);
 	if(new_data != null){
-		mem_copy_no_overlap(new_data, ptr, min(old_size, new_size));
+		/* Growing from nothing, there is no old block to copy from */
+		if(old_size > 0 && ptr != null){
+			mem_copy_no_overlap(new_data, ptr, min(old_size, new_size));
+		}
 		mem_free_ex(allocator, ptr, old_size, align);
 	}
 	return new_data;
@@ -170,7 +300,80 @@ u8 io_capabilities(IO_Stream s){
 	return (u8)s.func(s.data, IO_Query, null, 0);
 }
 
+//// SIMD //////////////////////////////////////////////////////////////////////
+/* x86 vector paths are compiled with per-function target attributes and picked
+ * at runtime, so the library itself still builds for a baseline CPU. */
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && \
+	!defined(__TINYC__) && !defined(DISABLE_SIMD)
+#define SIMD_X86 1
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_TARGET(Isa)
+#else
+#define SIMD_TARGET(Isa) __attribute__((target(Isa)))
+#endif
+
+enum {
+	SIMD_NONE = 0,
+	SIMD_SSE4 = 1,
+	SIMD_AVX2 = 2,
+};
+
+static inline
+int simd_level(){
+#if defined(_MSC_VER) && !defined(__clang__)
+	static volatile int level = -1;
+	if(level < 0){
+		int info[4];
+		int found = SIMD_NONE;
+		__cpuid(info, 1);
+		bool sse4 = (info[2] & (1 << 19)) != 0;
+		bool avx_os = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+			(_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		if(sse4){ found = SIMD_SSE4; }
+		if(avx_os && avx2){ found = SIMD_AVX2; }
+		level = found;
+	}
+	return level;
+#else
+	if(__builtin_cpu_supports("avx2")){ return SIMD_AVX2; }
+	if(__builtin_cpu_supports("sse4.1")){ return SIMD_SSE4; }
+	return SIMD_NONE;
+#endif
+}
+
+/* Index of the lowest set bit, x must not be 0 */
+static inline
+int simd_ctz(u32 x){
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long idx;
+	_BitScanForward(&idx, x);
+	return (int)idx;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+/* Index of the highest set bit, x must not be 0 */
+static inline
+int simd_msb(u32 x){
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long idx;
+	_BitScanReverse(&idx, x);
+	return (int)idx;
+#else
+	return 31 - __builtin_clz(x);
+#endif
+}
+#endif
+
 //// UTF-8 /////////////////////////////////////////////////////////////////////
+#include <string.h>
+
 #define UTF8_RANGE1 ((i32)0x7f)
 #define UTF8_RANGE2 ((i32)0x7ff)
 #define UTF8_RANGE3 ((i32)0xffff)
@@ -201,7 +404,7 @@ bool is_continuation_byte(rune c){
 UTF8_Encode_Result utf8_encode(rune c){
 	UTF8_Encode_Result res = {0};
 
-	if(is_continuation_byte(c) ||
+	if(c < 0 ||
 	   (c >= UTF16_SURROGATE1 && c <= UTF16_SURROGATE2) ||
 	   (c > UTF8_RANGE4))
 	{
@@ -271,6 +474,16 @@ UTF8_Decode_Result utf8_decode(byte const* buf, isize len){
 	if(res.codepoint >= UTF16_SURROGATE1 && res.codepoint <= UTF16_SURROGATE2){
 		return DECODE_ERROR;
 	}
+	if(res.codepoint > UTF8_RANGE4){
+		return DECODE_ERROR;
+	}
+	/* Overlong encodings: the codepoint fits in a shorter sequence */
+	if((res.len == 2 && res.codepoint <= UTF8_RANGE1) ||
+	   (res.len == 3 && res.codepoint <= UTF8_RANGE2) ||
+	   (res.len == 4 && res.codepoint <= UTF8_RANGE3))
+	{
+		return DECODE_ERROR;
+	}
 	if(res.len > 1 && !is_continuation_byte(buf[1])){
 		return DECODE_ERROR;
 	}
@@ -287,19 +500,64 @@ UTF8_Decode_Result utf8_decode(byte const* buf, isize len){
 // static inline
 // bool is_continuation_byte
 
+/* Decode a well formed multi-byte sequence, the second byte ranges are the
+ * ones that rule out overlong encodings, surrogates and codepoints past
+ * U+10FFFF. Returns 0 for anything else, utf8_decode() sorts that out. */
+static inline
+isize utf8_decode_multi(rune* out, byte const* s, isize len){
+	byte b = s[0];
+	if(b < 0xc2 || b > 0xf4 || len < 2){ return 0; }
+
+	byte lo = 0x80, hi = 0xbf;
+	if(b == 0xe0){ lo = 0xa0; }
+	else if(b == 0xed){ hi = 0x9f; }
+	else if(b == 0xf0){ lo = 0x90; }
+	else if(b == 0xf4){ hi = 0x8f; }
+	if(s[1] < lo || s[1] > hi){ return 0; }
+
+	if(b < UTF8_SIZE3){
+		*out = ((b & UTF8_MASK2) << 6) | (s[1] & UTF8_MASKX);
+		return 2;
+	}
+	if(len < 3 || !is_continuation_byte(s[2])){ return 0; }
+	if(b < UTF8_SIZE4){
+		*out = ((b & UTF8_MASK3) << 12) | ((s[1] & UTF8_MASKX) << 6) | (s[2] & UTF8_MASKX);
+		return 3;
+	}
+	if(len < 4 || !is_continuation_byte(s[3])){ return 0; }
+	*out = ((b & UTF8_MASK4) << 18) | ((s[1] & UTF8_MASKX) << 12) | ((s[2] & UTF8_MASKX) << 6) | (s[3] & UTF8_MASKX);
+	return 4;
+}
+
 // Steps iterator forward and puts rune and Length advanced into pointers,
 // returns false when finished.
 bool utf8_iter_next(UTF8_Iterator* iter, rune* r, i8* len){
 	if(iter->current >= iter->data_length){ return 0; }
 
+	byte first = iter->data[iter->current];
+	if(first < 0x80){
+		/* ASCII fast path */
+		*r = first;
+		*len = 1;
+		iter->current += 1;
+		return 1;
+	}
+
+	isize n = utf8_decode_multi(r, &iter->data[iter->current], iter->data_length - iter->current);
+	if(n > 0){
+		*len = (i8)n;
+		iter->current += n;
+		return 1;
+	}
+
 	UTF8_Decode_Result res = utf8_decode(&iter->data[iter->current], iter->data_length - iter->current);
+	if(res.len == 0){
+		/* Skip the offending byte */
+		res.len = 1;
+	}
 	*r = res.codepoint;
 	*len = res.len;
 
-	if(res.codepoint == DECODE_ERROR.codepoint){
-		*len = res.len + 1;
-	}
-
 	iter->current += res.len;
 
 	return 1;
@@ -310,442 +568,5331 @@ bool utf8_iter_next(UTF8_Iterator* iter, rune* r, i8* len){
 bool utf8_iter_prev(UTF8_Iterator* iter, rune* r, i8* len){
 	if(iter->current <= 0){ return false; }
 
+	isize end = iter->current;
 	iter->current -= 1;
-	while(is_continuation_byte(iter->data[iter->current])){
-		iter->current -= 1;
+	if(iter->data[iter->current] < 0x80){
+		/* ASCII fast path */
+		*r = iter->data[iter->current];
+		*len = 1;
+		return true;
 	}
 
-	UTF8_Decode_Result res = utf8_decode(&iter->data[iter->current], iter->data_length - iter->current);
+	/* Back up to the lead byte, a rune is at most 4 bytes long */
+	isize start = iter->current;
+	while(start > 0 && end - start < 4 && is_continuation_byte(iter->data[start])){
+		start -= 1;
+	}
+
+	UTF8_Decode_Result res = utf8_decode(&iter->data[start], end - start);
+	if(res.len != end - start){
+		/* Not a whole rune, skip the offending byte */
+		*r = UTF8_ERROR;
+		*len = 1;
+		return true;
+	}
+	iter->current = start;
 	*r = res.codepoint;
 	*len = res.len;
 	return true;
 }
 
-#undef CONT
-
-
-//// Strings ///////////////////////////////////////////////////////////////////
-bool str_empty(String s){
-	return s.len == 0 || s.data == null;
-}
-
-String str_from(cstring data){
-	String s = {
-		.data = (byte const *)data,
-		.len = cstring_len(data),
-	};
-	return s;
-}
+/* Bulk validation follows Keiser & Lemire, "Validating UTF-8 In Less Than One
+ * Instruction Per Byte": each byte is classified with 3 nibble lookups on the
+ * previous/current byte pair, then 3rd/4th byte continuations are checked
+ * separately. Every bit below marks one kind of error. */
+#define UTF8_TOO_SHORT   (1 << 0) /* 11______ 0_______ or 11______ 11______ */
+#define UTF8_TOO_LONG    (1 << 1) /* 0_______ 10______ */
+#define UTF8_OVERLONG_3  (1 << 2) /* 11100000 100_____ */
+#define UTF8_TOO_LARGE   (1 << 3) /* 11110100 1001____, 11110100 101_____, 11110101+ 1001____... */
+#define UTF8_SURROGATE   (1 << 4) /* 11101101 101_____ */
+#define UTF8_OVERLONG_2  (1 << 5) /* 1100000_ 10______ */
+#define UTF8_TOO_LARGE_1000 (1 << 6) /* 11110101+ 1000____ */
+#define UTF8_OVERLONG_4  (1 << 6) /* 11110000 1000____ */
+#define UTF8_TWO_CONTS   (1 << 7) /* 10______ 10______ */
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define UTF8_BYTE_1_HIGH \
+	UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, \
+	UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, \
+	UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, \
+	UTF8_TOO_SHORT | UTF8_OVERLONG_2, \
+	UTF8_TOO_SHORT, \
+	UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE, \
+	UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+
+#define UTF8_BYTE_1_LOW \
+	UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4, \
+	UTF8_CARRY | UTF8_OVERLONG_2, \
+	UTF8_CARRY, \
+	UTF8_CARRY, \
+	UTF8_CARRY | UTF8_TOO_LARGE, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+
+#define UTF8_BYTE_2_HIGH \
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, \
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, \
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4, \
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE, \
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+
+/* Largest byte allowed in the last 3 positions of a block without the sequence
+ * it starts running past the block */
+#define UTF8_INCOMPLETE_TAIL 0xf0 - 1, 0xe0 - 1, 0xc0 - 1
 
-String str_from_bytes(byte const* data, isize length){
-	String s = {
-		.data = (byte const *)data,
-		.len = length,
-	};
-	return s;
+static
+bool utf8_validate_scalar(byte const* data, isize len){
+	isize i = 0;
+	while(i < len){
+		if(data[i] < 0x80){
+			i += 1;
+			continue;
+		}
+		UTF8_Decode_Result res = utf8_decode(&data[i], len - i);
+		if(res.len == 0){ return false; }
+		i += res.len;
+	}
+	return true;
 }
 
-String str_concat(String a, String b, Mem_Allocator allocator){
-	byte* data = mem_new(byte, a.len + b.len, allocator);
-	String s = {0};
-	if(data != null){
-		mem_copy(&data[0], a.data, a.len);
-		mem_copy(&data[a.len], b.data, b.len);
-		s.data = data;
-		s.len = a.len + b.len;
+/* Decode known valid UTF-8, results are the same as utf8_decode() */
+static inline
+isize utf8_decode_valid_one(rune* out, byte const* s){
+	byte b = s[0];
+	if(b < 0x80){
+		*out = b;
+		return 1;
 	}
-	return s;
+	if(b < UTF8_SIZE3){
+		*out = ((b & UTF8_MASK2) << 6) | (s[1] & UTF8_MASKX);
+		return 2;
+	}
+	if(b < UTF8_SIZE4){
+		*out = ((b & UTF8_MASK3) << 12) | ((s[1] & UTF8_MASKX) << 6) | (s[2] & UTF8_MASKX);
+		return 3;
+	}
+	*out = ((b & UTF8_MASK4) << 18) | ((s[1] & UTF8_MASKX) << 12) | ((s[2] & UTF8_MASKX) << 6) | (s[3] & UTF8_MASKX);
+	return 4;
 }
 
-String str_from_range(cstring data, isize start, isize length){
-	String s = {
-		.data = (byte const *)&data[start],
-		.len = length,
-	};
-	return s;
+/* Branchless version of utf8_decode_valid_one(), mixed length text makes the
+ * branches above mispredict constantly. Needs 4 readable bytes. Every sequence
+ * is assembled as if it was 4 bytes long, then shifted down to its real size,
+ * bytes past the end of a shorter sequence fall off the bottom. */
+static inline
+isize utf8_decode_valid_wide(rune* out, byte const* s){
+	static const u8 lengths[16] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 3, 4};
+	static const u8 lead_masks[5] = {0, 0x7f, UTF8_MASK2, UTF8_MASK3, UTF8_MASK4};
+	static const u8 shifts[5] = {0, 18, 12, 6, 0};
+
+	isize len = lengths[s[0] >> 4];
+	u32 v = ((u32)(s[0] & lead_masks[len]) << 18) |
+		((u32)(s[1] & UTF8_MASKX) << 12) |
+		((u32)(s[2] & UTF8_MASKX) << 6) |
+		((u32)(s[3] & UTF8_MASKX) << 0);
+	*out = (rune)(v >> shifts[len]);
+	return len;
 }
 
-isize str_codepoint_count(String s){
-	UTF8_Iterator it = str_iterator(s);
-
-	isize count = 0;
-	rune c; i8 len;
-	while(utf8_iter_next(&it, &c, &len)){
-		count += 1;
+static
+isize utf8_decode_valid_scalar(rune* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	for(; i + 4 <= len; n += 1){
+		i += utf8_decode_valid_wide(&out[n], &data[i]);
 	}
-	return count;
+	for(; i < len; n += 1){
+		i += utf8_decode_valid_one(&out[n], &data[i]);
+	}
+	return n;
 }
 
-bool str_starts_with(String s, String prefix){
-	if(prefix.len > s.len){ return false; }
-
-	s = str_sub(s, 0, prefix.len);
-
-	i32 res = mem_compare(prefix.data, s.data, prefix.len);
-	return res == 0;
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static inline
+__m128i utf8_check_sse4(__m128i input, __m128i prev_input){
+	const __m128i lo4 = _mm_set1_epi8(0x0f);
+	__m128i prev1 = _mm_alignr_epi8(input, prev_input, 16 - 1);
+	__m128i prev2 = _mm_alignr_epi8(input, prev_input, 16 - 2);
+	__m128i prev3 = _mm_alignr_epi8(input, prev_input, 16 - 3);
+
+	__m128i byte_1_high = _mm_shuffle_epi8(_mm_setr_epi8(UTF8_BYTE_1_HIGH),
+		_mm_and_si128(_mm_srli_epi16(prev1, 4), lo4));
+	__m128i byte_1_low = _mm_shuffle_epi8(_mm_setr_epi8(UTF8_BYTE_1_LOW), _mm_and_si128(prev1, lo4));
+	__m128i byte_2_high = _mm_shuffle_epi8(_mm_setr_epi8(UTF8_BYTE_2_HIGH),
+		_mm_and_si128(_mm_srli_epi16(input, 4), lo4));
+	__m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+	/* 111_____ two bytes back or 1111____ three bytes back need a continuation */
+	__m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xe0 - 0x80)));
+	__m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xf0 - 0x80)));
+	__m128i must_23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+
+	return _mm_xor_si128(must_23, special);
 }
 
-bool str_ends_with(String s, String suffix){
-	if(suffix.len > s.len){ return false; }
+SIMD_TARGET("sse4.1")
+static
+bool utf8_validate_sse4(byte const* data, isize len){
+	const __m128i incomplete_max = _mm_setr_epi8(
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, UTF8_INCOMPLETE_TAIL);
+	__m128i error = _mm_setzero_si128();
+	__m128i prev_input = _mm_setzero_si128();
+	__m128i prev_incomplete = _mm_setzero_si128();
+
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i input = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(input) == 0){
+			/* All ASCII, only a sequence left open by the previous block can fail */
+			error = _mm_or_si128(error, prev_incomplete);
+			prev_incomplete = _mm_setzero_si128();
+		}
+		else {
+			error = _mm_or_si128(error, utf8_check_sse4(input, prev_input));
+			prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+		}
+		prev_input = input;
+	}
 
-	s = str_sub(s, s.len - suffix.len, suffix.len);
+	/* Zero padding is ASCII, so it also catches sequences cut off at the end */
+	alignas(16) byte tail[16] = {0};
+	mem_copy(tail, &data[i], len - i);
+	error = _mm_or_si128(error, utf8_check_sse4(_mm_load_si128((__m128i const*)tail), prev_input));
 
-	i32 res = mem_compare(suffix.data, s.data, suffix.len);
-	return res == 0;
+	return _mm_testz_si128(error, error);
 }
 
-isize str_codepoint_offset(String s, isize n){
-	UTF8_Iterator it = str_iterator(s);
-
-	isize acc = 0;
-
-	rune c; i8 len;
-	do {
-		if(acc == n){ break; }
-		acc += 1;
-	} while(utf8_iter_next(&it, &c, &len));
-
-	return it.current;
+SIMD_TARGET("avx2")
+static inline
+__m256i utf8_check_avx2(__m256i input, __m256i prev_input){
+	const __m256i lo4 = _mm256_set1_epi8(0x0f);
+	/* Bytes from the high lane of prev_input followed by the low lane of input */
+	__m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+	__m256i prev1 = _mm256_alignr_epi8(input, shifted, 16 - 1);
+	__m256i prev2 = _mm256_alignr_epi8(input, shifted, 16 - 2);
+	__m256i prev3 = _mm256_alignr_epi8(input, shifted, 16 - 3);
+
+	__m256i byte_1_high = _mm256_shuffle_epi8(_mm256_setr_epi8(UTF8_BYTE_1_HIGH, UTF8_BYTE_1_HIGH),
+		_mm256_and_si256(_mm256_srli_epi16(prev1, 4), lo4));
+	__m256i byte_1_low = _mm256_shuffle_epi8(_mm256_setr_epi8(UTF8_BYTE_1_LOW, UTF8_BYTE_1_LOW),
+		_mm256_and_si256(prev1, lo4));
+	__m256i byte_2_high = _mm256_shuffle_epi8(_mm256_setr_epi8(UTF8_BYTE_2_HIGH, UTF8_BYTE_2_HIGH),
+		_mm256_and_si256(_mm256_srli_epi16(input, 4), lo4));
+	__m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+	__m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xe0 - 0x80)));
+	__m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xf0 - 0x80)));
+	__m256i must_23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+
+	return _mm256_xor_si256(must_23, special);
 }
 
-// TODO: Handle length in codepoint count
-String str_sub(String s, isize start, isize byte_count){
-	if(start < 0 || byte_count < 0 || (start + byte_count) > s.len){ return (String){0}; }
-
-	String sub = {
-		.data = &s.data[start],
-		.len = byte_count,
-	};
+SIMD_TARGET("avx2")
+static
+bool utf8_validate_avx2(byte const* data, isize len){
+	const __m256i incomplete_max = _mm256_setr_epi8(
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, UTF8_INCOMPLETE_TAIL);
+	__m256i error = _mm256_setzero_si256();
+	__m256i prev_input = _mm256_setzero_si256();
+	__m256i prev_incomplete = _mm256_setzero_si256();
+
+	isize i = 0;
+	for(; i + 64 <= len; i += 64){
+		__m256i a = _mm256_loadu_si256((__m256i const*)&data[i]);
+		__m256i b = _mm256_loadu_si256((__m256i const*)&data[i + 32]);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0){
+			error = _mm256_or_si256(error, prev_incomplete);
+			prev_incomplete = _mm256_setzero_si256();
+		}
+		else {
+			error = _mm256_or_si256(error, utf8_check_avx2(a, prev_input));
+			error = _mm256_or_si256(error, utf8_check_avx2(b, a));
+			prev_incomplete = _mm256_subs_epu8(b, incomplete_max);
+		}
+		prev_input = b;
+	}
+	for(; i + 32 <= len; i += 32){
+		__m256i input = _mm256_loadu_si256((__m256i const*)&data[i]);
+		error = _mm256_or_si256(error, utf8_check_avx2(input, prev_input));
+		prev_input = input;
+	}
 
-	return sub;
-}
+	alignas(32) byte tail[32] = {0};
+	mem_copy(tail, &data[i], len - i);
+	error = _mm256_or_si256(error, utf8_check_avx2(_mm256_load_si256((__m256i const*)tail), prev_input));
 
-String str_clone(String s, Mem_Allocator allocator){
-	char* mem = mem_new(char, s.len, allocator);
-	if(mem == null){ return (String){0}; }
-	return (String){
-		.data = (byte const *)mem,
-		.len = s.len,
-	};
+	return _mm256_testz_si256(error, error);
 }
 
-bool str_eq(String a, String b){
-	if(a.len != b.len){ return false; }
-
-	for(isize i = 0; i < a.len; i += 1){
-		if(a.data[i] != b.data[i]){ return false; }
+SIMD_TARGET("sse4.1")
+static
+isize utf8_decode_valid_sse4(rune* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	/* Blocks always start on a sequence boundary, the 3 spare bytes keep the
+	 * wide decode of the block's last sequence in bounds. */
+	while(i + 16 + 3 <= len){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) == 0){
+			/* Widen 16 ASCII bytes to runes */
+			_mm_storeu_si128((__m128i*)&out[n + 0],  _mm_cvtepu8_epi32(v));
+			_mm_storeu_si128((__m128i*)&out[n + 4],  _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)));
+			_mm_storeu_si128((__m128i*)&out[n + 8],  _mm_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+			_mm_storeu_si128((__m128i*)&out[n + 12], _mm_cvtepu8_epi32(_mm_srli_si128(v, 12)));
+			i += 16;
+			n += 16;
+			continue;
+		}
+		/* Walk the bitmask of non-continuation bytes, so finding the next
+		 * sequence doesn't wait on decoding the current one */
+		u32 leads = (u32)_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(-65)));
+		isize end = i;
+		while(leads != 0){
+			isize p = i + simd_ctz(leads);
+			leads &= leads - 1;
+			end = p + utf8_decode_valid_wide(&out[n], &data[p]);
+			n += 1;
+		}
+		i = end;
 	}
-
-	return true;
+	return n + utf8_decode_valid_scalar(&out[n], &data[i], len - i);
 }
 
-UTF8_Iterator str_iterator(String s){
-	return (UTF8_Iterator){
-		.current = 0,
-		.data_length = s.len,
-		.data = s.data,
-	};
+SIMD_TARGET("avx2")
+static
+isize utf8_decode_valid_avx2(rune* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	while(i + 32 + 3 <= len){
+		__m256i v = _mm256_loadu_si256((__m256i const*)&data[i]);
+		if(_mm256_movemask_epi8(v) == 0){
+			__m128i lo = _mm256_castsi256_si128(v);
+			__m128i hi = _mm256_extracti128_si256(v, 1);
+			_mm256_storeu_si256((__m256i*)&out[n + 0],  _mm256_cvtepu8_epi32(lo));
+			_mm256_storeu_si256((__m256i*)&out[n + 8],  _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+			_mm256_storeu_si256((__m256i*)&out[n + 16], _mm256_cvtepu8_epi32(hi));
+			_mm256_storeu_si256((__m256i*)&out[n + 24], _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+			i += 32;
+			n += 32;
+			continue;
+		}
+		u32 leads = (u32)_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(-65)));
+		isize end = i;
+		while(leads != 0){
+			isize p = i + simd_ctz(leads);
+			leads &= leads - 1;
+			end = p + utf8_decode_valid_wide(&out[n], &data[p]);
+			n += 1;
+		}
+		i = end;
+	}
+	return n + utf8_decode_valid_scalar(&out[n], &data[i], len - i);
 }
+#endif
 
-UTF8_Iterator str_iterator_reversed(String s){
-	return (UTF8_Iterator){
-		.current = s.len,
-		.data_length = s.len,
-		.data = s.data,
-	};
+bool utf8_validate(byte const* data, isize len){
+	if(len <= 0){ return true; }
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case SIMD_AVX2: return utf8_validate_avx2(data, len);
+		case SIMD_SSE4: return utf8_validate_sse4(data, len);
+		default: break;
+	}
+#endif
+	return utf8_validate_scalar(data, len);
 }
 
-void str_destroy(String s, Mem_Allocator allocator){
-	mem_free(allocator, (void*)s.data);
+static
+isize utf8_decode_valid(rune* out, byte const* data, isize len){
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case SIMD_AVX2: return utf8_decode_valid_avx2(out, data, len);
+		case SIMD_SSE4: return utf8_decode_valid_sse4(out, data, len);
+		default: break;
+	}
+#endif
+	return utf8_decode_valid_scalar(out, data, len);
 }
 
-#define MAX_CUTSET_LEN 64
+/* Input is validated in windows of this size, a window with an error in it is
+ * decoded by the checked scalar decoder instead */
+#define UTF8_DECODE_WINDOW 4096
 
-String str_trim(String s, String cutset){
-	String st = str_trim_leading(str_trim_trailing(s, cutset), cutset);
-	return st;
+/* End of a window of at most `size` bytes starting at `pos`, moved back so it
+ * doesn't split a sequence between windows */
+static inline
+isize utf8_window_end(byte const* data, isize len, isize pos, isize size){
+	isize end = min(len, pos + min(UTF8_DECODE_WINDOW, size));
+	for(isize k = 0; k < 3 && end < len && end > pos && is_continuation_byte(data[end]); k += 1){
+		end -= 1;
+	}
+	return end;
 }
 
-String str_trim_leading(String s, String cutset){
-	debug_assert(cutset.len <= MAX_CUTSET_LEN, "Cutset string exceeds MAX_CUTSET_LEN");
+isize utf8_decode_runes(rune* out, isize out_len, byte const* data, isize len, isize* consumed){
+	isize pos = 0, n = 0;
 
-	rune set[MAX_CUTSET_LEN] = {0};
-	isize set_len = 0;
-	isize cut_after = 0;
+	while(pos < len && n < out_len){
+		isize end = utf8_window_end(data, len, pos, out_len - n);
 
-	decode_cutset: {
-		rune c; i8 n;
-		UTF8_Iterator iter = str_iterator(cutset);
+		if(end > pos && utf8_validate(&data[pos], end - pos)){
+			n += utf8_decode_valid(&out[n], &data[pos], end - pos);
+			pos = end;
+			continue;
+		}
 
-		isize i = 0;
-		while(utf8_iter_next(&iter, &c, &n) && i < MAX_CUTSET_LEN){
-			set[i] = c;
-			i += 1;
+		/* Same behavior as utf8_iter_next(), errors skip a single byte */
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end && n < out_len){
+			UTF8_Decode_Result res = utf8_decode(&data[pos], len - pos);
+			out[n] = res.codepoint;
+			n += 1;
+			pos += res.len > 0 ? res.len : 1;
 		}
-		set_len = i;
 	}
 
-	strip_cutset: {
-		rune c; i8 n;
-		UTF8_Iterator iter = str_iterator(s);
+	if(consumed != null){ *consumed = pos; }
+	return n;
+}
 
-		while(utf8_iter_next(&iter, &c, &n)){
-			bool to_be_cut = false;
-			for(isize i = 0; i < set_len; i += 1){
-				if(set[i] == c){
-					to_be_cut = true;
-					break;
-				}
-			}
+/* High bit of every byte in a word, set only by non-ASCII bytes */
+#define UTF8_ASCII_MASK 0x8080808080808080ull
 
-			if(to_be_cut){
-				cut_after += n;
-			}
-			else {
-				break; // Reached first rune that isn't in cutset
-			}
+/* Rune count under which utf8_rune_offset() steps over ASCII directly */
+#define UTF8_ASCII_RUN 256
 
-		}
-	}
+/* Consecutive ASCII runes needed before it reads 8 bytes at a time, single
+ * spaces between non-ASCII runes are not worth a word load */
+#define UTF8_ASCII_PROBE 4
 
-	return str_sub(s, cut_after, s.len - cut_after);
+/* Number of non-continuation bytes in 8 bytes, one per rune in valid UTF-8 */
+static inline
+isize utf8_count_word(u64 x){
+	const u64 ones = 0x0101010101010101ull;
+	/* 10xx_xxxx: bit 7 set and bit 6 clear */
+	u64 conts = (x >> 7) & ~(x >> 6) & ones;
+	return 8 - (isize)((conts * ones) >> 56);
 }
 
-String str_trim_trailing(String s, String cutset){
-	debug_assert(cutset.len <= MAX_CUTSET_LEN, "Cutset string exceeds MAX_CUTSET_LEN");
+static
+isize utf8_count_valid_scalar(byte const* data, isize len){
+	isize i = 0, count = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		memcpy(&x, &data[i], 8);
+		count += utf8_count_word(x);
+	}
+	for(; i < len; i += 1){
+		count += !is_continuation_byte(data[i]);
+	}
+	return count;
+}
 
-	rune set[MAX_CUTSET_LEN] = {0};
-	isize set_len = 0;
-	isize cut_until = s.len;
+#ifdef SIMD_X86
+/* Lead bytes are counted in 8-bit lanes and flushed with a SAD before a lane
+ * can overflow */
+SIMD_TARGET("sse4.1")
+static
+isize utf8_count_valid_sse4(byte const* data, isize len){
+	const __m128i threshold = _mm_set1_epi8(-65);
+	isize i = 0, count = 0;
+	while(i + 16 <= len){
+		__m128i acc = _mm_setzero_si128();
+		isize blocks = min((len - i) / 16, 255);
+		for(isize k = 0; k < blocks; k += 1, i += 16){
+			__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+			acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, threshold));
+		}
+		__m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+		count += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+	}
+	return count + utf8_count_valid_scalar(&data[i], len - i);
+}
 
-	decode_cutset: {
-		rune c; i8 n;
-		UTF8_Iterator iter = str_iterator(cutset);
+SIMD_TARGET("avx2")
+static
+isize utf8_count_valid_avx2(byte const* data, isize len){
+	const __m256i threshold = _mm256_set1_epi8(-65);
+	isize i = 0, count = 0;
+	while(i + 32 <= len){
+		__m256i acc = _mm256_setzero_si256();
+		isize blocks = min((len - i) / 32, 255);
+		for(isize k = 0; k < blocks; k += 1, i += 32){
+			__m256i v = _mm256_loadu_si256((__m256i const*)&data[i]);
+			acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(v, threshold));
+		}
+		alignas(32) u64 sums[4];
+		_mm256_store_si256((__m256i*)sums, _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+		count += (isize)(sums[0] + sums[1] + sums[2] + sums[3]);
+	}
+	return count + utf8_count_valid_scalar(&data[i], len - i);
+}
+#endif
 
-		isize i = 0;
-		while(utf8_iter_next(&iter, &c, &n) && i < MAX_CUTSET_LEN){
-			set[i] = c;
-			i += 1;
+static
+isize utf8_count_valid(byte const* data, isize len){
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case SIMD_AVX2: return utf8_count_valid_avx2(data, len);
+		case SIMD_SSE4: return utf8_count_valid_sse4(data, len);
+		default: break;
+	}
+#endif
+	return utf8_count_valid_scalar(data, len);
+}
+
+/* Byte offset of rune `n` in valid UTF-8 holding more than `n` runes */
+static
+isize utf8_offset_valid(byte const* data, isize len, isize n){
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		memcpy(&x, &data[i], 8);
+		isize c = utf8_count_word(x);
+		if(c > n){ break; }
+		n -= c;
+	}
+	for(; i < len; i += 1){
+		if(is_continuation_byte(data[i])){ continue; }
+		if(n == 0){ break; }
+		n -= 1;
+	}
+	return i;
+}
+
+/* Store the byte offset of every `stride`-th rune into `offsets`, returns the
+ * total number of runes. Same rune boundaries as utf8_iter_next(). */
+static
+isize utf8_rune_checkpoints(byte const* data, isize len, isize stride, isize* offsets, isize* offsets_len){
+	isize pos = 0, runes = 0, count = 0;
+
+	while(pos < len){
+		isize end = utf8_window_end(data, len, pos, len);
+
+		if(end > pos && utf8_validate(&data[pos], end - pos)){
+			isize c = utf8_count_valid(&data[pos], end - pos);
+			/* Find every checkpoint that lands inside this window */
+			isize at = pos, at_runes = runes;
+			while(count * stride < runes + c){
+				isize target = count * stride;
+				at += utf8_offset_valid(&data[at], end - at, target - at_runes);
+				at_runes = target;
+				offsets[count] = at;
+				count += 1;
+			}
+			runes += c;
+			pos = end;
+			continue;
+		}
+
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end){
+			if(runes == count * stride){
+				offsets[count] = pos;
+				count += 1;
+			}
+			UTF8_Decode_Result res = utf8_decode(&data[pos], len - pos);
+			pos += res.len > 0 ? res.len : 1;
+			runes += 1;
 		}
-		set_len = i;
 	}
 
-	strip_cutset: {
-		rune c; i8 n;
-		UTF8_Iterator iter = str_iterator_reversed(s);
+	*offsets_len = count;
+	return runes;
+}
 
-		while(utf8_iter_prev(&iter, &c, &n)){
-			bool to_be_cut = false;
-			for(isize i = 0; i < set_len; i += 1){
-				if(set[i] == c){
-					to_be_cut = true;
-					break;
+isize utf8_rune_offset(byte const* data, isize len, isize n, isize* skipped){
+	isize pos = 0, done = 0;
+
+	while(pos < len && done < n){
+		isize want = n - done;
+
+		/* Short ASCII runs are cheaper to step over 8 bytes at a time than to
+		 * validate, longer ones go through the vector path below */
+		if(want < UTF8_ASCII_RUN && data[pos] < 0x80){
+			isize run = 0;
+			for(; pos < len && want > 0 && run < UTF8_ASCII_PROBE && data[pos] < 0x80; pos += 1, run += 1){
+				want -= 1;
+			}
+			if(run == UTF8_ASCII_PROBE){
+				for(; pos + 8 <= len && want >= 8; pos += 8, want -= 8){
+					u64 x;
+					memcpy(&x, &data[pos], 8);
+					if(x & UTF8_ASCII_MASK){ break; }
+				}
+				for(; pos < len && want > 0 && data[pos] < 0x80; pos += 1){
+					want -= 1;
 				}
 			}
+			done = n - want;
+			continue;
+		}
 
-			if(to_be_cut){
-				cut_until -= n;
+		/* A rune is at most 4 bytes, no need to look further than that */
+		isize end = utf8_window_end(data, len, pos, want > (len / 4) ? len : want * 4);
+
+		if(end > pos && utf8_validate(&data[pos], end - pos)){
+			isize c = utf8_count_valid(&data[pos], end - pos);
+			if(c <= want){
+				done += c;
+				pos = end;
 			}
 			else {
-				break; // Reached first rune that isn't in cutset
+				pos += utf8_offset_valid(&data[pos], end - pos, want);
+				done = n;
 			}
+			continue;
+		}
 
+		/* Same behavior as utf8_iter_next(), errors skip a single byte */
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end && done < n){
+			UTF8_Decode_Result res = utf8_decode(&data[pos], len - pos);
+			pos += res.len > 0 ? res.len : 1;
+			done += 1;
 		}
 	}
 
-	return str_sub(s, 0, cut_until);
+	if(skipped != null){ *skipped = done; }
+	return pos;
 }
-//// Logger ////////////////////////////////////////////////////////////////////
-i32 log_ex_str(Logger l, String message, Source_Location loc, u8 level_n){
-    i32 n = l.log_func(l.impl, message, l.options, level_n, loc);
-	if(level_n == Log_Fatal){
-		panic("Fatal error");
+
+/* UTF-16 units are in native byte order. Unpaired surrogates and UTF-32 values
+ * that are not scalar values (surrogates, negative or past U+10FFFF) become
+ * UTF8_ERROR, so does invalid UTF-8, the same way utf8_iter_next() steps. */
+
+static inline
+bool utf16_is_high(u16 u){ return (u & 0xfc00) == UTF16_SURROGATE1; }
+
+static inline
+bool utf16_is_low(u16 u){ return (u & 0xfc00) == 0xdc00; }
+
+/* Decode the codepoint at data[*pos] and step over it */
+static inline
+rune utf16_next(u16 const* data, isize len, isize* pos){
+	u16 u = data[*pos];
+	*pos += 1;
+	if(u < UTF16_SURROGATE1 || u > UTF16_SURROGATE2){ return u; }
+	if(utf16_is_high(u) && *pos < len && utf16_is_low(data[*pos])){
+		rune r = 0x10000 + ((rune)(u - UTF16_SURROGATE1) << 10) + (rune)(data[*pos] - 0xdc00);
+		*pos += 1;
+		return r;
 	}
-	return n;
+	return UTF8_ERROR;
 }
 
-i32 log_ex_cstr(Logger l, cstring message, Source_Location loc, u8 level_n){
-    return log_ex_str(l, str_from(message), loc, level_n);
+static inline
+rune utf32_scalar(rune r){
+	if(r < 0 || r > UTF8_RANGE4 || (r >= UTF16_SURROGATE1 && r <= UTF16_SURROGATE2)){
+		return UTF8_ERROR;
+	}
+	return r;
 }
 
-static i32 _console_logger_func(void* impl, String message, u32 options, u8 level_num, Source_Location location){
-    (void)impl;
-    cstring header = log_level_map[level_num];
-    i32 n = printf("[%-5s %s:%d %s] %.*s\n", header, location.filename, location.line, location.caller_name, fmt_bytes(message));
-    return n;
+/* Encoded sizes of a scalar value */
+static inline
+isize utf8_rune_size(rune r){
+	return 1 + (r > UTF8_RANGE1) + (r > UTF8_RANGE2) + (r > UTF8_RANGE3);
 }
 
-Console_Logger* log_create_console_logger(Mem_Allocator allocator){
-	Console_Logger* cl = mem_new(Console_Logger, 1, allocator);
-	if(cl == null){	return null; }
-	cl->parent_allocator = allocator;
-	return cl;
+static inline
+isize utf16_rune_size(rune r){
+	return 1 + (r > UTF8_RANGE3);
 }
 
-void log_destroy_console_logger(Console_Logger* cl){
-	mem_free_ex(cl->parent_allocator, cl, sizeof(*cl), alignof(Console_Logger));
+/* Encode a scalar value, `out` must have utf8_rune_size(r) bytes */
+static inline
+void utf8_put(byte* out, rune r){
+	if(r <= UTF8_RANGE1){
+		out[0] = (byte)r;
+	}
+	else if(r <= UTF8_RANGE2){
+		out[0] = UTF8_SIZE2 | ((r >> 6) & UTF8_MASK2);
+		out[1] = CONT | (r & UTF8_MASKX);
+	}
+	else if(r <= UTF8_RANGE3){
+		out[0] = UTF8_SIZE3 | ((r >> 12) & UTF8_MASK3);
+		out[1] = CONT | ((r >> 6) & UTF8_MASKX);
+		out[2] = CONT | (r & UTF8_MASKX);
+	}
+	else {
+		out[0] = UTF8_SIZE4 | ((r >> 18) & UTF8_MASK4);
+		out[1] = CONT | ((r >> 12) & UTF8_MASKX);
+		out[2] = CONT | ((r >> 6) & UTF8_MASKX);
+		out[3] = CONT | (r & UTF8_MASKX);
+	}
 }
 
-Logger log_console_logger(Console_Logger* cl,u32 options){
-	Logger logger = {0};
-	logger.impl = cl;
-	logger.options = options;
-	logger.log_func = _console_logger_func;
-	return logger;
+/* Encode a scalar value, `out` must have utf16_rune_size(r) units */
+static inline
+void utf16_put(u16* out, rune r){
+	if(r <= UTF8_RANGE3){
+		out[0] = (u16)r;
+	}
+	else {
+		r -= 0x10000;
+		out[0] = (u16)(UTF16_SURROGATE1 + (r >> 10));
+		out[1] = (u16)(0xdc00 + (r & 0x3ff));
+	}
 }
 
-//// Arena Allocator ///////////////////////////////////////////////////////////
+/* Decode valid UTF-8 straight into UTF-16, `out` must have room for `len`
+ * units (no sequence takes more units than bytes) */
 static
-uintptr arena_required_mem(uintptr cur, isize nbytes, isize align){
-	debug_assert(mem_valid_alignment(align), "Alignment must be a power of 2");
-	uintptr_t aligned  = align_forward_ptr(cur, align);
-	uintptr_t padding  = (uintptr)(aligned - cur);
-	uintptr_t required = padding + nbytes;
-	return required;
+isize utf8_to_utf16_valid_scalar(u16* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	rune r;
+	while(i + 4 <= len){
+		i += utf8_decode_valid_wide(&r, &data[i]);
+		utf16_put(&out[n], r);
+		n += utf16_rune_size(r);
+	}
+	while(i < len){
+		i += utf8_decode_valid_one(&r, &data[i]);
+		utf16_put(&out[n], r);
+		n += utf16_rune_size(r);
+	}
+	return n;
 }
 
-void *arena_alloc(Mem_Arena* a, isize size, isize align){
-	uintptr base = (uintptr)a->data;
-	uintptr current = (uintptr)base + (uintptr)a->offset;
+/* Number of 4 byte sequence leads (1111_xxxx) in 8 bytes */
+static inline
+isize utf8_count_lead4_word(u64 x){
+	const u64 ones = 0x0101010101010101ull;
+	u64 leads = (x & (x << 1) & (x << 2) & (x << 3)) >> 7 & ones;
+	return (isize)((leads * ones) >> 56);
+}
 
-	uintptr available = (uintptr)a->capacity - (current - base);
-	uintptr required = arena_required_mem(current, size, align);
+/* Runes that need a surrogate pair in valid UTF-8 */
+static
+isize utf8_count_lead4(byte const* data, isize len){
+	isize i = 0, count = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		memcpy(&x, &data[i], 8);
+		count += utf8_count_lead4_word(x);
+	}
+	for(; i < len; i += 1){
+		count += data[i] >= UTF8_SIZE4;
+	}
+	return count;
+}
 
-	if(required > available){
-		return null;
+/* Extra UTF-8 bytes past the first of every unit, and the number of surrogate
+ * pairs. A pair is 4 bytes but its units would count 3 each. */
+static
+void utf16_measure_scalar(u16 const* data, isize len, isize* extra, isize* pairs){
+	isize e = 0, p = 0;
+	for(isize i = 0; i < len; i += 1){
+		u16 u = data[i];
+		e += (u > UTF8_RANGE1) + (u > UTF8_RANGE2);
+		p += utf16_is_high(u) & (i + 1 < len && utf16_is_low(data[i + 1]));
 	}
+	*extra += e;
+	*pairs += p;
+}
 
-	a->offset += required;
-	void* allocation = &a->data[a->offset - size];
-	a->last_allocation = (uintptr)allocation;
-	return allocation;
+#ifdef SIMD_X86
+/* Widen the leading 16 byte blocks of ASCII, returns the bytes done */
+SIMD_TARGET("sse4.1")
+static
+isize utf8_ascii_to_utf16_sse4(u16* out, byte const* data, isize len){
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) != 0){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_cvtepu8_epi16(v));
+		_mm_storeu_si128((__m128i*)&out[i + 8], _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+	}
+	return i;
 }
 
-void arena_free_all(Mem_Arena* a){
-	a->offset = 0;
+/* Shuffles that move the 16-bit lanes picked by a 4-bit mask to the front */
+static const u8 utf16_compact_shuffle[16][8] = {
+	{0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x02, 0x03, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x80, 0x80, 0x80, 0x80},
+	{0x04, 0x05, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80},
+	{0x02, 0x03, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x80, 0x80},
+	{0x06, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+	{0x02, 0x03, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x06, 0x07, 0x80, 0x80},
+	{0x04, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80},
+	{0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07},
+};
+static const u8 utf16_compact_count[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+/* Store the 8 units of v whose bits are set in mask (low 8 bits) next to each
+ * other, returns how many. Always writes 8 units. */
+SIMD_TARGET("sse4.1")
+static inline
+isize utf16_store_compact_sse4(u16* out, __m128i v, u32 mask){
+	u32 lo = mask & 15, hi = (mask >> 4) & 15;
+	__m128i a = _mm_shuffle_epi8(v, _mm_loadl_epi64((__m128i const*)utf16_compact_shuffle[lo]));
+	__m128i b = _mm_shuffle_epi8(_mm_srli_si128(v, 8), _mm_loadl_epi64((__m128i const*)utf16_compact_shuffle[hi]));
+	_mm_storel_epi64((__m128i*)out, a);
+	_mm_storel_epi64((__m128i*)&out[utf16_compact_count[lo]], b);
+	return utf16_compact_count[lo] + utf16_compact_count[hi];
+}
+
+/* UTF-16 unit for each of 8 positions, from the first three bytes of the
+ * sequence starting there (widened to 16 bits). A 4-byte sequence puts the high
+ * surrogate in its lead's lane and the low one in the next lane, `four` and
+ * `second` mark those lanes. */
+SIMD_TARGET("sse4.1")
+static inline
+__m128i utf8_units_sse4(__m128i b0, __m128i b1, __m128i b2, __m128i four, __m128i second){
+	const __m128i x_mask = _mm_set1_epi16(UTF8_MASKX);
+	__m128i tail1 = _mm_and_si128(b1, x_mask);
+	__m128i tail2 = _mm_and_si128(b2, x_mask);
+	__m128i two = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b0, _mm_set1_epi16(UTF8_MASK2)), 6), tail1);
+	__m128i three = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b0, _mm_set1_epi16(UTF8_MASK3)), 12),
+		_mm_or_si128(_mm_slli_epi16(tail1, 6), tail2));
+	/* (codepoint - 0x10000) >> 10 from the lead, and the low 10 bits from the
+	 * two bytes after the second lane */
+	__m128i high = _mm_add_epi16(_mm_set1_epi16((short)(UTF16_SURROGATE1 - 0x40)),
+		_mm_or_si128(_mm_slli_epi16(_mm_and_si128(b0, _mm_set1_epi16(UTF8_MASK4)), 8),
+		_mm_or_si128(_mm_slli_epi16(tail1, 2), _mm_and_si128(_mm_srli_epi16(b2, 4), _mm_set1_epi16(3)))));
+	__m128i low = _mm_or_si128(_mm_set1_epi16((short)0xdc00),
+		_mm_or_si128(_mm_slli_epi16(_mm_and_si128(b1, _mm_set1_epi16(0x0f)), 6), tail2));
+
+	__m128i units = _mm_blendv_epi8(three, two, _mm_cmplt_epi16(b0, _mm_set1_epi16(UTF8_SIZE3)));
+	units = _mm_blendv_epi8(units, b0, _mm_cmplt_epi16(b0, _mm_set1_epi16(0x80)));
+	units = _mm_blendv_epi8(units, high, four);
+	return _mm_blendv_epi8(units, low, second);
 }
 
+/* Same as utf8_to_utf16_valid_scalar(). Every position of a block is decoded
+ * as if a sequence started there, then the lanes of continuation bytes are
+ * squeezed out. */
+SIMD_TARGET("sse4.1")
 static
-void* arena_allocator_func(
-	void* impl,
-	byte op,
-	void* old_ptr,
-	isize size,
-	isize align,
-	i32* capabilities)
-{
-	Mem_Arena* a = impl;
-	(void)old_ptr;
-	enum Allocator_Op operation = op;
+isize utf8_to_utf16_valid_sse4(u16* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	/* Blocks always start on a sequence boundary, the 3 spare bytes cover a
+	 * sequence that starts in the block's last byte */
+	while(i + 16 + 3 <= len){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) == 0){
+			_mm_storeu_si128((__m128i*)&out[n], _mm_cvtepu8_epi16(v));
+			_mm_storeu_si128((__m128i*)&out[n + 8], _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+			i += 16;
+			n += 16;
+			continue;
+		}
 
-	switch(operation){
-		case Mem_Op_Alloc: {
-			return arena_alloc(a, size, align);
-		} break;
+		__m128i four = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8((char)UTF8_SIZE4)), v);
+		u32 leads = (u32)_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(-65)));
+		u32 fours = (u32)_mm_movemask_epi8(four);
+		bool split_pair = (fours & 0x8000) != 0;
+		if(split_pair){
+			/* Low surrogate would land past the block, leave that sequence
+			 * to the next one */
+			leads &= 0x7fff;
+			fours &= 0x7fff;
+			four = _mm_insert_epi8(four, 0, 15);
+		}
+		__m128i second = _mm_slli_si128(four, 1);
+		__m128i v1 = _mm_loadu_si128((__m128i const*)&data[i + 1]);
+		__m128i v2 = _mm_loadu_si128((__m128i const*)&data[i + 2]);
+		__m128i lo = utf8_units_sse4(_mm_cvtepu8_epi16(v), _mm_cvtepu8_epi16(v1), _mm_cvtepu8_epi16(v2),
+			_mm_cvtepi8_epi16(four), _mm_cvtepi8_epi16(second));
+		__m128i hi = utf8_units_sse4(_mm_cvtepu8_epi16(_mm_srli_si128(v, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(v1, 8)),
+			_mm_cvtepu8_epi16(_mm_srli_si128(v2, 8)), _mm_cvtepi8_epi16(_mm_srli_si128(four, 8)),
+			_mm_cvtepi8_epi16(_mm_srli_si128(second, 8)));
+		u32 keep = leads | (fours << 1);
+		n += utf16_store_compact_sse4(&out[n], lo, keep);
+		n += utf16_store_compact_sse4(&out[n], hi, keep >> 8);
+
+		if(split_pair){
+			i += 15;
+			continue;
+		}
+		/* The last sequence may run 1 or 2 bytes past the block */
+		isize past = is_continuation_byte(data[i + 16]);
+		i += 16 + past + (past & is_continuation_byte(data[i + 17]));
+	}
+	return n + utf8_to_utf16_valid_scalar(&out[n], &data[i], len - i);
+}
 
-		case Mem_Op_Free_All: {
-			arena_free_all(a);
-		} break;
+/* Narrow the leading 16 unit blocks of ASCII, returns the units done */
+SIMD_TARGET("sse4.1")
+static
+isize utf16_ascii_to_utf8_sse4(byte* out, u16 const* data, isize len){
+	const __m128i non_ascii = _mm_set1_epi16((short)0xff80);
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i a = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&data[i + 8]);
+		if(!_mm_testz_si128(_mm_or_si128(a, b), non_ascii)){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_packus_epi16(a, b));
+	}
+	return i;
+}
 
-		case Mem_Op_Resize: {
-			return arena_resize(a, old_ptr, size);
-		} break;
+/* Widen the leading 8 unit blocks without surrogates, returns the units done */
+SIMD_TARGET("sse4.1")
+static
+isize utf16_bmp_to_utf32_sse4(rune* out, u16 const* data, isize len){
+	const __m128i top = _mm_set1_epi16((short)0xf800);
+	const __m128i surrogate = _mm_set1_epi16((short)UTF16_SURROGATE1);
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i s = _mm_cmpeq_epi16(_mm_and_si128(v, top), surrogate);
+		if(!_mm_testz_si128(s, s)){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_cvtepu16_epi32(v));
+		_mm_storeu_si128((__m128i*)&out[i + 4], _mm_cvtepu16_epi32(_mm_srli_si128(v, 8)));
+	}
+	return i;
+}
 
-		case Mem_Op_Free: {} break;
+/* Narrow the leading 8 rune blocks of BMP scalar values, returns the runes done */
+SIMD_TARGET("sse4.1")
+static
+isize utf32_bmp_to_utf16_sse4(u16* out, rune const* data, isize len){
+	const __m128i high = _mm_set1_epi32((int)0xffff0000);
+	const __m128i top = _mm_set1_epi32(0xf800);
+	const __m128i surrogate = _mm_set1_epi32(UTF16_SURROGATE1);
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		__m128i a = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&data[i + 4]);
+		__m128i s = _mm_or_si128(
+			_mm_cmpeq_epi32(_mm_and_si128(a, top), surrogate),
+			_mm_cmpeq_epi32(_mm_and_si128(b, top), surrogate));
+		if(!_mm_testz_si128(_mm_or_si128(a, b), high) || !_mm_testz_si128(s, s)){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_packus_epi32(a, b));
+	}
+	return i;
+}
 
-		case Mem_Op_Query: {
-			*capabilities = Allocator_Alloc_Any | Allocator_Free_All | Allocator_Align_Any | Allocator_Resize;
-		} break;
+/* Narrow the leading 16 rune blocks of ASCII, returns the runes done */
+SIMD_TARGET("sse4.1")
+static
+isize utf32_ascii_to_utf8_sse4(byte* out, rune const* data, isize len){
+	const __m128i non_ascii = _mm_set1_epi32(~0x7f);
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i a = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&data[i + 4]);
+		__m128i c = _mm_loadu_si128((__m128i const*)&data[i + 8]);
+		__m128i d = _mm_loadu_si128((__m128i const*)&data[i + 12]);
+		if(!_mm_testz_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), non_ascii)){ break; }
+		__m128i lo = _mm_packus_epi32(a, b);
+		__m128i hi = _mm_packus_epi32(c, d);
+		_mm_storeu_si128((__m128i*)&out[i], _mm_packus_epi16(lo, hi));
+	}
+	return i;
+}
 
-		default: panic("Bad enum access");
+/* Same as utf16_measure_scalar(), the counts are kept in 16-bit lanes and
+ * flushed before they can overflow (each lane grows by at most 2 per step) */
+SIMD_TARGET("sse4.1")
+static
+void utf16_measure_sse4(u16 const* data, isize len, isize* extra, isize* pairs){
+	const __m128i ascii_max = _mm_set1_epi16(UTF8_RANGE1 + 1);
+	const __m128i two_max = _mm_set1_epi16(UTF8_RANGE2 + 1);
+	const __m128i ten_bits = _mm_set1_epi16((short)0xfc00);
+	const __m128i high = _mm_set1_epi16((short)UTF16_SURROGATE1);
+	const __m128i low = _mm_set1_epi16((short)0xdc00);
+	const __m128i ones = _mm_set1_epi16(1);
+
+	isize i = 0;
+	/* Reads one unit ahead for the low half of a pair */
+	while(i + 9 <= len){
+		__m128i e = _mm_setzero_si128();
+		__m128i p = _mm_setzero_si128();
+		isize end = min(len - 1, i + 8 * 8192);
+		for(; i + 8 <= end; i += 8){
+			__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+			__m128i next = _mm_loadu_si128((__m128i const*)&data[i + 1]);
+			/* max(v, n) == v is an unsigned v >= n, comparisons are -1 when true */
+			e = _mm_sub_epi16(e, _mm_cmpeq_epi16(_mm_max_epu16(v, ascii_max), v));
+			e = _mm_sub_epi16(e, _mm_cmpeq_epi16(_mm_max_epu16(v, two_max), v));
+			p = _mm_sub_epi16(p, _mm_and_si128(
+				_mm_cmpeq_epi16(_mm_and_si128(v, ten_bits), high),
+				_mm_cmpeq_epi16(_mm_and_si128(next, ten_bits), low)));
+		}
+		__m128i sums = _mm_hadd_epi32(_mm_madd_epi16(e, ones), _mm_madd_epi16(p, ones));
+		sums = _mm_hadd_epi32(sums, sums);
+		*extra += (isize)(u32)_mm_extract_epi32(sums, 0);
+		*pairs += (isize)(u32)_mm_extract_epi32(sums, 1);
 	}
+	utf16_measure_scalar(&data[i], len - i, extra, pairs);
+}
+#endif
 
-	return null;
+static
+void utf16_measure(u16 const* data, isize len, isize* extra, isize* pairs){
+	*extra = 0;
+	*pairs = 0;
+#ifdef SIMD_X86
+	if(simd_level() >= SIMD_SSE4){
+		utf16_measure_sse4(data, len, extra, pairs);
+		return;
+	}
+#endif
+	utf16_measure_scalar(data, len, extra, pairs);
 }
 
-void* arena_resize(Mem_Arena* a, void* ptr, isize new_size){
-	if((uintptr)ptr == a->last_allocation){
-		uintptr base = (uintptr)a->data;
-		uintptr current = base + (uintptr)a->offset;
-		uintptr limit = base + (uintptr)a->capacity;
-		isize last_allocation_size = current - a->last_allocation;
+isize utf8_to_utf16_len(byte const* data, isize len){
+	isize pos = 0, count = 0;
 
-		if((current - last_allocation_size + new_size) > limit){
-			return null; /* No space left*/
+	while(pos < len){
+		isize end = utf8_window_end(data, len, pos, len);
+
+		if(end > pos && utf8_validate(&data[pos], end - pos)){
+			count += utf8_count_valid(&data[pos], end - pos) + utf8_count_lead4(&data[pos], end - pos);
+			pos = end;
+			continue;
 		}
 
-		a->offset += new_size - last_allocation_size;
-		return ptr;
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end){
+			UTF8_Decode_Result res = utf8_decode(&data[pos], len - pos);
+			count += res.len == 4 ? 2 : 1;
+			pos += res.len > 0 ? res.len : 1;
+		}
 	}
-
-	return null;
+	return count;
 }
 
-Mem_Allocator arena_allocator(Mem_Arena* a){
-	Mem_Allocator allocator = {
-		.data = a,
-		.func = arena_allocator_func,
-	};
-	return allocator;
+isize utf16_to_utf8_len(u16 const* data, isize len){
+	isize extra = 0, pairs = 0;
+	utf16_measure(data, len, &extra, &pairs);
+	return len + extra - 2 * pairs;
 }
 
-void arena_init(Mem_Arena* a, byte* data, isize len){
-	a->capacity = len;
-	a->data = data;
-	a->offset = 0;
+isize utf16_to_utf32_len(u16 const* data, isize len){
+	isize extra = 0, pairs = 0;
+	utf16_measure(data, len, &extra, &pairs);
+	return len - pairs;
 }
 
-void arena_destroy(Mem_Arena* a){
-	arena_free_all(a);
-	a->capacity = 0;
-	a->data = null;
+isize utf32_to_utf8_len(rune const* data, isize len){
+	isize count = 0;
+	for(isize i = 0; i < len; i += 1){
+		count += utf8_rune_size(utf32_scalar(data[i]));
+	}
+	return count;
 }
 
-//// String Builder ////////////////////////////////////////////////////////////
-
-bool sb_init(String_Builder* sb, Mem_Allocator allocator, isize initial_cap){
-	sb->allocator = allocator;
-	sb->len = 0;
-	sb->data = mem_new(byte, initial_cap, allocator);
-	sb->cap = initial_cap;
-	return sb->data != null;
+isize utf32_to_utf16_len(rune const* data, isize len){
+	isize count = 0;
+	for(isize i = 0; i < len; i += 1){
+		count += utf16_rune_size(utf32_scalar(data[i]));
+	}
+	return count;
 }
 
-void sb_destroy(String_Builder* sb){
-	mem_free_ex(sb->allocator, sb->data, sb->cap, alignof(byte));
+static
+isize utf8_to_utf16_valid(u16* out, byte const* data, isize len){
+#ifdef SIMD_X86
+	if(simd_level() >= SIMD_SSE4){
+		return utf8_to_utf16_valid_sse4(out, data, len);
+	}
+#endif
+	return utf8_to_utf16_valid_scalar(out, data, len);
 }
 
-isize sb_append_bytes(String_Builder* sb, byte const* buf, isize nbytes){
-	if((sb->len + nbytes) > sb->cap){
-		byte* new_data = mem_realloc(sb->allocator, sb->data, sb->cap, max(16, (sb->cap * 7) / 4), alignof(byte));
-		if(new_data == null){ return -1; }
+isize utf8_to_utf16(u16* out, isize out_len, byte const* data, isize len, isize* consumed){
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+#endif
+
+	while(pos < len && n < out_len){
+#ifdef SIMD_X86
+		if(sse4 && data[pos] < 0x80){
+			/* ASCII needs no validation */
+			isize done = utf8_ascii_to_utf16_sse4(&out[n], &data[pos], min(len - pos, out_len - n));
+			pos += done;
+			n += done;
+			if(pos == len || n == out_len){ break; }
+		}
+#endif
+		/* Window is capped by the space left, a valid one always fits */
+		isize end = utf8_window_end(data, len, pos, out_len - n);
+
+		if(end > pos && utf8_validate(&data[pos], end - pos)){
+			n += utf8_to_utf16_valid(&out[n], &data[pos], end - pos);
+			pos = end;
+			continue;
+		}
+
+		if(end <= pos){ end = pos + 1; }
+		bool full = false;
+		while(pos < end){
+			UTF8_Decode_Result res = utf8_decode(&data[pos], len - pos);
+			isize size = utf16_rune_size(res.codepoint);
+			full = n + size > out_len;
+			if(full){ break; }
+			utf16_put(&out[n], res.codepoint);
+			n += size;
+			pos += res.len > 0 ? res.len : 1;
+		}
+		if(full){ break; }
 	}
-	mem_copy(&sb->data[sb->len], buf, nbytes);
-	sb->len += nbytes;
-	return nbytes;
-}
 
-String sb_build(String_Builder* sb){
-	mem_resize(sb->allocator, sb->data, sb->len);
-	String s = str_from_bytes(sb->data, sb->len);
-	sb->len = 0;
-	sb->cap = 0;
-	sb->data = null;
-	return s;
+	if(consumed != null){ *consumed = pos; }
+	return n;
 }
 
-isize sb_append_str(String_Builder* sb, String s){
-	return sb_append_bytes(sb, s.data, s.len);
+isize utf16_to_utf8(byte* out, isize out_len, u16 const* data, isize len, isize* consumed){
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+#endif
+
+	while(pos < len){
+#ifdef SIMD_X86
+		if(sse4 && data[pos] <= UTF8_RANGE1){
+			isize done = utf16_ascii_to_utf8_sse4(&out[n], &data[pos], min(len - pos, out_len - n));
+			pos += done;
+			n += done;
+			if(pos == len){ break; }
+		}
+#endif
+		isize next = pos;
+		rune r = utf16_next(data, len, &next);
+		isize size = utf8_rune_size(r);
+		if(n + size > out_len){ break; }
+		utf8_put(&out[n], r);
+		n += size;
+		pos = next;
+	}
+
+	if(consumed != null){ *consumed = pos; }
+	return n;
 }
 
-isize sb_append_rune(String_Builder* sb, rune r){
-	UTF8_Encode_Result enc = utf8_encode(r);
-	return sb_append_bytes(sb, enc.bytes, enc.len);
+isize utf16_to_utf32(rune* out, isize out_len, u16 const* data, isize len, isize* consumed){
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+#endif
+
+	while(pos < len && n < out_len){
+#ifdef SIMD_X86
+		if(sse4){
+			isize done = utf16_bmp_to_utf32_sse4(&out[n], &data[pos], min(len - pos, out_len - n));
+			pos += done;
+			n += done;
+			if(pos == len || n == out_len){ break; }
+		}
+#endif
+		out[n] = utf16_next(data, len, &pos);
+		n += 1;
+	}
+
+	if(consumed != null){ *consumed = pos; }
+	return n;
+}
+
+isize utf32_to_utf16(u16* out, isize out_len, rune const* data, isize len, isize* consumed){
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+#endif
+
+	while(pos < len){
+#ifdef SIMD_X86
+		if(sse4){
+			isize done = utf32_bmp_to_utf16_sse4(&out[n], &data[pos], min(len - pos, out_len - n));
+			pos += done;
+			n += done;
+			if(pos == len){ break; }
+		}
+#endif
+		rune r = utf32_scalar(data[pos]);
+		isize size = utf16_rune_size(r);
+		if(n + size > out_len){ break; }
+		utf16_put(&out[n], r);
+		n += size;
+		pos += 1;
+	}
+
+	if(consumed != null){ *consumed = pos; }
+	return n;
+}
+
+isize utf32_to_utf8(byte* out, isize out_len, rune const* data, isize len, isize* consumed){
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+#endif
+
+	while(pos < len){
+#ifdef SIMD_X86
+		if(sse4 && (u32)data[pos] < 0x80){
+			isize done = utf32_ascii_to_utf8_sse4(&out[n], &data[pos], min(len - pos, out_len - n));
+			pos += done;
+			n += done;
+			if(pos == len){ break; }
+		}
+#endif
+		rune r = utf32_scalar(data[pos]);
+		isize size = utf8_rune_size(r);
+		if(n + size > out_len){ break; }
+		utf8_put(&out[n], r);
+		n += size;
+		pos += 1;
+	}
+
+	if(consumed != null){ *consumed = pos; }
+	return n;
+}
+
+#undef UTF8_TOO_SHORT
+#undef UTF8_TOO_LONG
+#undef UTF8_OVERLONG_3
+#undef UTF8_TOO_LARGE
+#undef UTF8_SURROGATE
+#undef UTF8_OVERLONG_2
+#undef UTF8_TOO_LARGE_1000
+#undef UTF8_OVERLONG_4
+#undef UTF8_TWO_CONTS
+#undef UTF8_CARRY
+#undef UTF8_BYTE_1_HIGH
+#undef UTF8_BYTE_1_LOW
+#undef UTF8_BYTE_2_HIGH
+#undef UTF8_INCOMPLETE_TAIL
+#undef UTF8_DECODE_WINDOW
+#undef UTF8_ASCII_MASK
+#undef UTF8_ASCII_RUN
+#undef UTF8_ASCII_PROBE
+#undef UTF16_DECODE_CHUNK
+
+#undef CONT
+
+
+//// Strings ///////////////////////////////////////////////////////////////////
+bool str_empty(String s){
+	return s.len == 0 || s.data == null;
+}
+
+String str_from(cstring data){
+	String s = {
+		.data = (byte const *)data,
+		.len = cstring_len(data),
+	};
+	return s;
+}
+
+String str_from_bytes(byte const* data, isize length){
+	String s = {
+		.data = (byte const *)data,
+		.len = length,
+	};
+	return s;
+}
+
+String str_concat(String a, String b, Mem_Allocator allocator){
+	byte* data = mem_new(byte, a.len + b.len, allocator);
+	String s = {0};
+	if(data != null){
+		mem_copy(&data[0], a.data, a.len);
+		mem_copy(&data[a.len], b.data, b.len);
+		s.data = data;
+		s.len = a.len + b.len;
+	}
+	return s;
+}
+
+String str_from_range(cstring data, isize start, isize length){
+	String s = {
+		.data = (byte const *)&data[start],
+		.len = length,
+	};
+	return s;
+}
+
+isize str_codepoint_count(String s){
+	if(str_empty(s)){ return 0; }
+	isize count = 0;
+	utf8_rune_offset(s.data, s.len, s.len, &count);
+	return count;
+}
+
+bool str_starts_with(String s, String prefix){
+	if(prefix.len > s.len){ return false; }
+
+	s = str_sub(s, 0, prefix.len);
+
+	i32 res = mem_compare(prefix.data, s.data, prefix.len);
+	return res == 0;
+}
+
+bool str_ends_with(String s, String suffix){
+	if(suffix.len > s.len){ return false; }
+
+	s = str_sub(s, s.len - suffix.len, suffix.len);
+
+	i32 res = mem_compare(suffix.data, s.data, suffix.len);
+	return res == 0;
+}
+
+isize str_codepoint_offset(String s, isize n){
+	if(str_empty(s) || n <= 0){ return 0; }
+	return utf8_rune_offset(s.data, s.len, n, null);
+}
+
+String str_sub(String s, isize start, isize byte_count){
+	if(start < 0 || byte_count < 0 || (start + byte_count) > s.len){ return (String){0}; }
+
+	String sub = {
+		.data = &s.data[start],
+		.len = byte_count,
+	};
+
+	return sub;
+}
+
+String str_sub_runes(String s, isize start, isize count){
+	if(start < 0 || count < 0){ return (String){0}; }
+	isize begin = str_codepoint_offset(s, start);
+	isize end = begin + str_codepoint_offset(str_sub(s, begin, s.len - begin), count);
+	return str_sub(s, begin, end - begin);
+}
+
+bool str_index_init(Str_Index* idx, String s, Mem_Allocator allocator){
+	*idx = (Str_Index){ .str = s, .allocator = allocator };
+	/* There's never more runes than bytes */
+	isize cap = s.len / STR_INDEX_STRIDE + 1;
+	idx->offsets = mem_new(isize, cap, allocator);
+	if(idx->offsets == null){ return false; }
+
+	if(!str_empty(s)){
+		idx->rune_count = utf8_rune_checkpoints(s.data, s.len, STR_INDEX_STRIDE, idx->offsets, &idx->len);
+	}
+	return true;
+}
+
+void str_index_destroy(Str_Index* idx){
+	mem_free(idx->allocator, idx->offsets);
+	*idx = (Str_Index){0};
+}
+
+isize str_index_offset(Str_Index const* idx, isize n){
+	if(n <= 0){ return 0; }
+	if(n >= idx->rune_count){ return idx->str.len; }
+
+	isize base = idx->offsets[n / STR_INDEX_STRIDE];
+	isize rest = n % STR_INDEX_STRIDE;
+	return base + utf8_rune_offset(&idx->str.data[base], idx->str.len - base, rest, null);
+}
+
+String str_index_sub(Str_Index const* idx, isize start, isize count){
+	if(start < 0 || count < 0){ return (String){0}; }
+	isize begin = str_index_offset(idx, start);
+	isize end = str_index_offset(idx, start + count);
+	return str_sub(idx->str, begin, end - begin);
+}
+
+String str_clone(String s, Mem_Allocator allocator){
+	char* mem = mem_new(char, s.len, allocator);
+	if(mem == null){ return (String){0}; }
+	return (String){
+		.data = (byte const *)mem,
+		.len = s.len,
+	};
+}
+
+UTF8_Iterator str_iterator(String s){
+	return (UTF8_Iterator){
+		.current = 0,
+		.data_length = s.len,
+		.data = s.data,
+	};
+}
+
+UTF8_Iterator str_iterator_reversed(String s){
+	return (UTF8_Iterator){
+		.current = s.len,
+		.data_length = s.len,
+		.data = s.data,
+	};
+}
+
+void str_destroy(String s, Mem_Allocator allocator){
+	mem_free(allocator, (void*)s.data);
+}
+
+String str_trim(String s, String cutset){
+	String st = str_trim_leading(str_trim_trailing(s, cutset), cutset);
+	return st;
+}
+
+/* Fills a 128-bit membership bitmap when the cutset is pure ASCII, returns
+ * false otherwise. */
+static bool str_ascii_cutset(String cutset, u64 ascii_set[2]){
+	ascii_set[0] = 0;
+	ascii_set[1] = 0;
+	for(isize i = 0; i < cutset.len; i += 1){
+		byte c = cutset.data[i];
+		if(c >= 0x80){ return false; }
+		ascii_set[c >> 6] |= (u64)1 << (c & 63);
+	}
+	return true;
+}
+
+/* Linear search over a non-ASCII cutset, use a Cutset when trimming often */
+static bool str_cutset_has(String cutset, rune r){
+	rune c; i8 n;
+	UTF8_Iterator iter = str_iterator(cutset);
+	while(utf8_iter_next(&iter, &c, &n)){
+		if(c == r){ return true; }
+	}
+	return false;
+}
+
+String str_trim_leading(String s, String cutset){
+	isize cut_after = 0;
+	u64 ascii_set[2];
+
+	if(str_ascii_cutset(cutset, ascii_set)){
+		/* Only ASCII can be cut, so work on raw bytes */
+		while(cut_after < s.len && s.data[cut_after] < 0x80 &&
+		      (ascii_set[s.data[cut_after] >> 6] & ((u64)1 << (s.data[cut_after] & 63))))
+		{
+			cut_after += 1;
+		}
+		return str_sub(s, cut_after, s.len - cut_after);
+	}
+
+	rune c; i8 n;
+	UTF8_Iterator iter = str_iterator(s);
+	while(utf8_iter_next(&iter, &c, &n)){
+		if(!str_cutset_has(cutset, c)){
+			break; // Reached first rune that isn't in cutset
+		}
+		cut_after += n;
+	}
+
+	return str_sub(s, cut_after, s.len - cut_after);
+}
+
+String str_trim_trailing(String s, String cutset){
+	isize cut_until = s.len;
+	u64 ascii_set[2];
+
+	if(str_ascii_cutset(cutset, ascii_set)){
+		/* Only ASCII can be cut, so work on raw bytes */
+		while(cut_until > 0 && s.data[cut_until - 1] < 0x80 &&
+		      (ascii_set[s.data[cut_until - 1] >> 6] & ((u64)1 << (s.data[cut_until - 1] & 63))))
+		{
+			cut_until -= 1;
+		}
+		return str_sub(s, 0, cut_until);
+	}
+
+	rune c; i8 n;
+	UTF8_Iterator iter = str_iterator_reversed(s);
+	while(utf8_iter_prev(&iter, &c, &n)){
+		if(!str_cutset_has(cutset, c)){
+			break; // Reached first rune that isn't in cutset
+		}
+		cut_until -= n;
+	}
+
+	return str_sub(s, 0, cut_until);
+}
+
+//// Cutset ////////////////////////////////////////////////////////////////////
+/* The bitmap is laid out as two 16 byte tables indexed by the low nibble, one
+ * for bytes under 0x80 and one for the rest, with bit `(b >> 4) & 7` set for
+ * each member byte `b`. That lets the vector paths look bytes up with shuffles. */
+static inline
+bool cutset_has_byte(Cutset const* set, byte b){
+	return (set->bitmap[(b >> 7) * 16 + (b & 15)] >> ((b >> 4) & 7)) & 1;
+}
+
+static inline
+void cutset_add_byte(Cutset* set, byte b){
+	set->bitmap[(b >> 7) * 16 + (b & 15)] |= (byte)(1 << ((b >> 4) & 7));
+}
+
+static
+int cutset_rune_cmp(void const* a, void const* b){
+	rune x = *(rune const*)a;
+	rune y = *(rune const*)b;
+	return (x > y) - (x < y);
+}
+
+bool cutset_init(Cutset* set, String runes, Mem_Allocator allocator){
+	*set = (Cutset){ .allocator = allocator };
+
+	/* Every non-ASCII rune has at least one byte over 0x7f */
+	isize wide = 0;
+	for(isize i = 0; i < runes.len; i += 1){
+		wide += runes.data[i] >= 0x80;
+	}
+	if(wide > 0){
+		set->runes = mem_new(rune, wide, allocator);
+		if(set->runes == null){ return false; }
+	}
+
+	rune c; i8 n;
+	UTF8_Iterator iter = str_iterator(runes);
+	while(utf8_iter_next(&iter, &c, &n)){
+		if(c < 0x80){
+			cutset_add_byte(set, (byte)c);
+			continue;
+		}
+
+		set->runes[set->runes_len] = c;
+		set->runes_len += 1;
+		if(c == UTF8_ERROR){
+			/* Invalid bytes also decode to the error rune, so any non-ASCII byte can match */
+			for(isize b = 0x80; b <= 0xff; b += 1){
+				cutset_add_byte(set, (byte)b);
+			}
+		}
+		else {
+			cutset_add_byte(set, utf8_encode(c).bytes[0]);
+		}
+	}
+
+	if(set->runes_len > 1){
+		qsort(set->runes, set->runes_len, sizeof(rune), cutset_rune_cmp);
+		isize unique = 1;
+		for(isize i = 1; i < set->runes_len; i += 1){
+			if(set->runes[i] != set->runes[unique - 1]){
+				set->runes[unique] = set->runes[i];
+				unique += 1;
+			}
+		}
+		set->runes_len = unique;
+	}
+	return true;
+}
+
+void cutset_destroy(Cutset* set){
+	if(set->runes != null){
+		mem_free(set->allocator, set->runes);
+	}
+	*set = (Cutset){0};
+}
+
+bool cutset_contains(Cutset const* set, rune r){
+	if(r < 0x80){
+		return r >= 0 && cutset_has_byte(set, (byte)r);
+	}
+
+	isize lo = 0, hi = set->runes_len;
+	while(lo < hi){
+		isize mid = lo + (hi - lo) / 2;
+		if(set->runes[mid] < r){
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo < set->runes_len && set->runes[lo] == r;
+}
+
+/* Scanning stops at member bytes, or with `span` at anything but an ASCII
+ * member byte. Non-ASCII stops still have to be decoded and looked up. */
+static inline
+bool cutset_stops_at(Cutset const* set, byte b, bool span){
+	if(span){
+		return b >= 0x80 || !cutset_has_byte(set, b);
+	}
+	return cutset_has_byte(set, b);
+}
+
+static
+isize cutset_find_scalar(Cutset const* set, byte const* data, isize len, bool span){
+	isize i = 0;
+	for(; i < len; i += 1){
+		if(cutset_stops_at(set, data[i], span)){ break; }
+	}
+	return i;
+}
+
+static
+isize cutset_rfind_scalar(Cutset const* set, byte const* data, isize len, bool span){
+	isize i = len - 1;
+	for(; i >= 0; i -= 1){
+		if(cutset_stops_at(set, data[i], span)){ break; }
+	}
+	return i;
+}
+
+#ifdef SIMD_X86
+/* Bitmask of the stops in a block, see cutset_stops_at() */
+SIMD_TARGET("sse4.1")
+static inline
+u32 cutset_stops_sse4(__m128i low, __m128i high, __m128i v, bool span){
+	const __m128i nibble = _mm_set1_epi8(0x0f);
+	const __m128i rows = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	__m128i lo = _mm_and_si128(v, nibble);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+	/* blendv picks the high table for bytes with their top bit set */
+	__m128i cols = _mm_blendv_epi8(_mm_shuffle_epi8(low, lo), _mm_shuffle_epi8(high, lo), v);
+	__m128i hits = _mm_and_si128(cols, _mm_shuffle_epi8(rows, hi));
+	u32 misses = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(hits, _mm_setzero_si128()));
+	if(span){
+		return misses | (u32)_mm_movemask_epi8(v);
+	}
+	return ~misses & 0xffff;
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize cutset_find_sse4(Cutset const* set, byte const* data, isize len, bool span){
+	__m128i low = _mm_loadu_si128((__m128i const*)&set->bitmap[0]);
+	__m128i high = _mm_loadu_si128((__m128i const*)&set->bitmap[16]);
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		u32 stops = cutset_stops_sse4(low, high, _mm_loadu_si128((__m128i const*)&data[i]), span);
+		if(stops != 0){ return i + simd_ctz(stops); }
+	}
+	return i + cutset_find_scalar(set, &data[i], len - i, span);
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize cutset_rfind_sse4(Cutset const* set, byte const* data, isize len, bool span){
+	__m128i low = _mm_loadu_si128((__m128i const*)&set->bitmap[0]);
+	__m128i high = _mm_loadu_si128((__m128i const*)&set->bitmap[16]);
+	isize i = len;
+	for(; i >= 16; i -= 16){
+		u32 stops = cutset_stops_sse4(low, high, _mm_loadu_si128((__m128i const*)&data[i - 16]), span);
+		if(stops != 0){ return i - 16 + simd_msb(stops); }
+	}
+	return cutset_rfind_scalar(set, data, i, span);
+}
+
+SIMD_TARGET("avx2")
+static inline
+u32 cutset_stops_avx2(__m256i low, __m256i high, __m256i v, bool span){
+	const __m256i nibble = _mm256_set1_epi8(0x0f);
+	const __m256i rows = _mm256_setr_epi8(
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	__m256i lo = _mm256_and_si256(v, nibble);
+	__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+	__m256i cols = _mm256_blendv_epi8(_mm256_shuffle_epi8(low, lo), _mm256_shuffle_epi8(high, lo), v);
+	__m256i hits = _mm256_and_si256(cols, _mm256_shuffle_epi8(rows, hi));
+	u32 misses = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hits, _mm256_setzero_si256()));
+	if(span){
+		return misses | (u32)_mm256_movemask_epi8(v);
+	}
+	return ~misses;
+}
+
+SIMD_TARGET("avx2")
+static
+isize cutset_find_avx2(Cutset const* set, byte const* data, isize len, bool span){
+	__m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set->bitmap[0]));
+	__m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set->bitmap[16]));
+	isize i = 0;
+	for(; i + 32 <= len; i += 32){
+		u32 stops = cutset_stops_avx2(low, high, _mm256_loadu_si256((__m256i const*)&data[i]), span);
+		if(stops != 0){ return i + simd_ctz(stops); }
+	}
+	return i + cutset_find_scalar(set, &data[i], len - i, span);
+}
+
+SIMD_TARGET("avx2")
+static
+isize cutset_rfind_avx2(Cutset const* set, byte const* data, isize len, bool span){
+	__m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set->bitmap[0]));
+	__m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set->bitmap[16]));
+	isize i = len;
+	for(; i >= 32; i -= 32){
+		u32 stops = cutset_stops_avx2(low, high, _mm256_loadu_si256((__m256i const*)&data[i - 32]), span);
+		if(stops != 0){ return i - 32 + simd_msb(stops); }
+	}
+	return cutset_rfind_scalar(set, data, i, span);
+}
+#endif
+
+/* Index of the first stop byte, or `len`. Short inputs, like most trimmed
+ * runs, are cheaper to scan than to dispatch. */
+static
+isize cutset_find(Cutset const* set, byte const* data, isize len, bool span){
+#ifdef SIMD_X86
+	if(len >= 32){
+		switch(simd_level()){
+			case SIMD_AVX2: return cutset_find_avx2(set, data, len, span);
+			case SIMD_SSE4: return cutset_find_sse4(set, data, len, span);
+			default: break;
+		}
+	}
+#endif
+	return cutset_find_scalar(set, data, len, span);
+}
+
+/* Index of the last stop byte, or -1 */
+static
+isize cutset_rfind(Cutset const* set, byte const* data, isize len, bool span){
+#ifdef SIMD_X86
+	if(len >= 32){
+		switch(simd_level()){
+			case SIMD_AVX2: return cutset_rfind_avx2(set, data, len, span);
+			case SIMD_SSE4: return cutset_rfind_sse4(set, data, len, span);
+			default: break;
+		}
+	}
+#endif
+	return cutset_rfind_scalar(set, data, len, span);
+}
+
+/* Decode the rune at `pos` like utf8_iter_next() and store its length in `n`,
+ * returns whether it's a member */
+static inline
+bool cutset_match(Cutset const* set, String s, isize pos, isize* n){
+	byte b = s.data[pos];
+	if(b < 0x80){
+		*n = 1;
+		return cutset_has_byte(set, b);
+	}
+	UTF8_Decode_Result res = utf8_decode(&s.data[pos], s.len - pos);
+	*n = res.len > 0 ? res.len : 1;
+	return cutset_has_byte(set, b) && cutset_contains(set, res.codepoint);
+}
+
+/* Byte offset and length of the first member rune at or after `pos` */
+static
+isize cutset_find_rune(Cutset const* set, String s, isize pos, isize* n){
+	while(pos < s.len){
+		pos += cutset_find(set, &s.data[pos], s.len - pos, false);
+		if(pos >= s.len){ break; }
+		if(cutset_match(set, s, pos, n)){ return pos; }
+		pos += *n;
+	}
+	*n = 0;
+	return -1;
+}
+
+String str_trim_leading_set(String s, Cutset const* set){
+	isize cut_after = 0;
+	while(cut_after < s.len){
+		cut_after += cutset_find(set, &s.data[cut_after], s.len - cut_after, true);
+		if(cut_after >= s.len){ break; }
+
+		/* ASCII stops and lead bytes of no member end the trim without decoding */
+		byte b = s.data[cut_after];
+		if(b < 0x80 || !cutset_has_byte(set, b)){ break; }
+
+		isize n;
+		if(!cutset_match(set, s, cut_after, &n)){ break; }
+		cut_after += n;
+	}
+	return str_sub(s, cut_after, s.len - cut_after);
+}
+
+String str_trim_trailing_set(String s, Cutset const* set){
+	isize cut_until = s.len;
+	while(cut_until > 0){
+		cut_until = cutset_rfind(set, s.data, cut_until, true) + 1;
+		if(cut_until <= 0 || s.data[cut_until - 1] < 0x80){ break; }
+
+		/* Same rune boundaries as utf8_iter_prev() */
+		UTF8_Iterator iter = { .data = s.data, .data_length = s.len, .current = cut_until };
+		rune c; i8 n;
+		utf8_iter_prev(&iter, &c, &n);
+		if(!cutset_contains(set, c)){ break; }
+		cut_until = iter.current;
+	}
+	return str_sub(s, 0, cut_until);
+}
+
+String str_trim_set(String s, Cutset const* set){
+	return str_trim_leading_set(str_trim_trailing_set(s, set), set);
+}
+
+isize str_find_any(String s, Cutset const* set){
+	isize n;
+	return cutset_find_rune(set, s, 0, &n);
+}
+
+isize str_rfind_any(String s, Cutset const* set){
+	isize n;
+	if(cutset_has_byte(set, 0x80)){
+		/* Continuation bytes are members, so a match could start anywhere
+		 * before it: walk forward instead */
+		isize last = -1;
+		for(isize pos = cutset_find_rune(set, s, 0, &n); pos >= 0; pos = cutset_find_rune(set, s, pos + n, &n)){
+			last = pos;
+		}
+		return last;
+	}
+
+	/* Member bytes are ASCII or lead bytes, which always start a rune */
+	isize end = s.len;
+	while(end > 0){
+		isize pos = cutset_rfind(set, s.data, end, false);
+		if(pos < 0){ break; }
+		if(cutset_match(set, s, pos, &n)){ return pos; }
+		end = pos;
+	}
+	return -1;
+}
+
+bool str_cut_any(String s, Cutset const* set, String* before, String* after){
+	isize n;
+	isize pos = cutset_find_rune(set, s, 0, &n);
+	if(pos < 0){
+		*before = s;
+		*after = (String){0};
+		return false;
+	}
+	*before = str_sub(s, 0, pos);
+	*after = str_sub(s, pos + n, s.len - (pos + n));
+	return true;
+}
+
+//// Byte Search ///////////////////////////////////////////////////////////////
+/* The vector loops look at 64 bytes per iteration and only extract masks once
+ * something matched, then finish with one block overlapping the bytes already
+ * scanned instead of a scalar tail. Buffers under a block go byte by byte. */
+
+#define CSTR_MAX_LENGTH ((isize)((~(u32)0) >> 1))
+
+/* cstring_len() reads whole aligned blocks, which can go past the terminator
+ * but never into another page, so they can't fault. Address sanitizer would
+ * still report them. */
+#if defined(__GNUC__) || defined(__clang__)
+#define MEM_ALIGNED_OVERREAD __attribute__((no_sanitize_address))
+#elif defined(_MSC_VER)
+#define MEM_ALIGNED_OVERREAD __declspec(no_sanitize_address)
+#else
+#define MEM_ALIGNED_OVERREAD
+#endif
+
+/* Word with the top bit set in exactly the bytes of `x` that are 0 */
+static inline
+u64 mem_zero_bytes(u64 x){
+	const u64 low7 = 0x7f7f7f7f7f7f7f7full;
+	return ~(((x & low7) + low7) | x | low7);
+}
+
+static
+isize mem_find_byte_scalar(byte const* data, byte val, isize len){
+	const u64 pattern = 0x0101010101010101ull * val;
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		memcpy(&x, &data[i], 8);
+		if(mem_zero_bytes(x ^ pattern) != 0){ break; }
+	}
+	for(; i < len; i += 1){
+		if(data[i] == val){ return i; }
+	}
+	return -1;
+}
+
+static
+isize mem_rfind_byte_scalar(byte const* data, byte val, isize len){
+	const u64 pattern = 0x0101010101010101ull * val;
+	isize i = len;
+	for(; i >= 8; i -= 8){
+		u64 x;
+		memcpy(&x, &data[i - 8], 8);
+		if(mem_zero_bytes(x ^ pattern) != 0){ break; }
+	}
+	for(isize j = i - 1; j >= 0 && j >= i - 8; j -= 1){
+		if(data[j] == val){ return j; }
+	}
+	return -1;
+}
+
+/* Byte by byte so the load can't go through an intercepted memcpy, compilers
+ * turn it into a single read */
+MEM_ALIGNED_OVERREAD
+static inline
+u64 mem_load_word(byte const* p){
+	return (u64)p[0] | (u64)p[1] << 8 | (u64)p[2] << 16 | (u64)p[3] << 24 |
+		(u64)p[4] << 32 | (u64)p[5] << 40 | (u64)p[6] << 48 | (u64)p[7] << 56;
+}
+
+MEM_ALIGNED_OVERREAD
+static
+isize cstring_len_scalar(byte const* s){
+	isize i = 0;
+	for(; ((uintptr)&s[i] & 7) != 0; i += 1){
+		if(s[i] == 0){ return i; }
+	}
+	for(; i < CSTR_MAX_LENGTH; i += 8){
+		if(mem_zero_bytes(mem_load_word(&s[i])) != 0){ break; }
+	}
+	while(i < CSTR_MAX_LENGTH && s[i] != 0){
+		i += 1;
+	}
+	return i;
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static
+isize mem_find_byte_sse4(byte const* data, byte val, isize len){
+	const __m128i v = _mm_set1_epi8((char)val);
+	isize i = 0;
+	for(; i + 64 <= len; i += 64){
+		__m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i]), v);
+		__m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i + 16]), v);
+		__m128i c = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i + 32]), v);
+		__m128i d = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i + 48]), v);
+		if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0){ break; }
+	}
+	for(; i + 16 <= len; i += 16){
+		u32 hits = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i]), v));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	if(i < len){
+		i = len - 16;
+		u32 hits = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i]), v));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	return -1;
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize mem_rfind_byte_sse4(byte const* data, byte val, isize len){
+	const __m128i v = _mm_set1_epi8((char)val);
+	isize i = len;
+	for(; i >= 64; i -= 64){
+		__m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 64]), v);
+		__m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 48]), v);
+		__m128i c = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 32]), v);
+		__m128i d = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 16]), v);
+		if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0){ break; }
+	}
+	for(; i >= 16; i -= 16){
+		u32 hits = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 16]), v));
+		if(hits != 0){ return i - 16 + simd_msb(hits); }
+	}
+	if(i > 0){
+		u32 hits = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[0]), v));
+		if(hits != 0){ return simd_msb(hits); }
+	}
+	return -1;
+}
+
+MEM_ALIGNED_OVERREAD
+SIMD_TARGET("sse4.1")
+static
+isize cstring_len_sse4(byte const* s){
+	const __m128i zero = _mm_setzero_si128();
+	isize skew = (isize)((uintptr)s & 15);
+	u32 hits = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((__m128i const*)(s - skew)), zero)) >> skew;
+	if(hits != 0){ return simd_ctz(hits); }
+	isize i = 16 - skew;
+	for(; i < CSTR_MAX_LENGTH; i += 16){
+		hits = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((__m128i const*)&s[i]), zero));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	return i;
+}
+
+SIMD_TARGET("avx2")
+static
+isize mem_find_byte_avx2(byte const* data, byte val, isize len){
+	const __m256i v = _mm256_set1_epi8((char)val);
+	isize i = 0;
+	for(; i + 64 <= len; i += 64){
+		__m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i]), v);
+		__m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i + 32]), v);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0){ break; }
+	}
+	for(; i + 32 <= len; i += 32){
+		u32 hits = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i]), v));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	if(i < len){
+		i = len - 32;
+		u32 hits = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i]), v));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	return -1;
+}
+
+SIMD_TARGET("avx2")
+static
+isize mem_rfind_byte_avx2(byte const* data, byte val, isize len){
+	const __m256i v = _mm256_set1_epi8((char)val);
+	isize i = len;
+	for(; i >= 64; i -= 64){
+		__m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i - 64]), v);
+		__m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i - 32]), v);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0){ break; }
+	}
+	for(; i >= 32; i -= 32){
+		u32 hits = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i - 32]), v));
+		if(hits != 0){ return i - 32 + simd_msb(hits); }
+	}
+	if(i > 0){
+		u32 hits = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[0]), v));
+		if(hits != 0){ return simd_msb(hits); }
+	}
+	return -1;
+}
+
+MEM_ALIGNED_OVERREAD
+SIMD_TARGET("avx2")
+static
+isize cstring_len_avx2(byte const* s){
+	const __m256i zero = _mm256_setzero_si256();
+	isize skew = (isize)((uintptr)s & 31);
+	u32 hits = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)(s - skew)), zero)) >> skew;
+	if(hits != 0){ return simd_ctz(hits); }
+	isize i = 32 - skew;
+	/* Pairs of blocks are only page safe from a 64 byte boundary */
+	if(((uintptr)&s[i] & 32) != 0){
+		hits = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)&s[i]), zero));
+		if(hits != 0){ return i + simd_ctz(hits); }
+		i += 32;
+	}
+	for(; i < CSTR_MAX_LENGTH; i += 64){
+		__m256i a = _mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)&s[i]), zero);
+		__m256i b = _mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)&s[i + 32]), zero);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0){
+			hits = (u32)_mm256_movemask_epi8(a);
+			if(hits != 0){ return i + simd_ctz(hits); }
+			return i + 32 + simd_ctz((u32)_mm256_movemask_epi8(b));
+		}
+	}
+	return i;
+}
+#endif
+
+isize mem_find_byte(void const* p, byte val, isize nbytes){
+	byte const* data = (byte const*)p;
+#ifdef SIMD_X86
+	if(nbytes >= 16){
+		int level = simd_level();
+		if(level == SIMD_AVX2 && nbytes >= 32){ return mem_find_byte_avx2(data, val, nbytes); }
+		if(level >= SIMD_SSE4){ return mem_find_byte_sse4(data, val, nbytes); }
+	}
+#endif
+	return mem_find_byte_scalar(data, val, nbytes);
+}
+
+isize mem_rfind_byte(void const* p, byte val, isize nbytes){
+	byte const* data = (byte const*)p;
+#ifdef SIMD_X86
+	if(nbytes >= 16){
+		int level = simd_level();
+		if(level == SIMD_AVX2 && nbytes >= 32){ return mem_rfind_byte_avx2(data, val, nbytes); }
+		if(level >= SIMD_SSE4){ return mem_rfind_byte_sse4(data, val, nbytes); }
+	}
+#endif
+	return mem_rfind_byte_scalar(data, val, nbytes);
+}
+
+isize mem_find_any_of(void const* p, byte const* set, isize set_len, isize nbytes){
+	if(set_len == 1){ return mem_find_byte(p, set[0], nbytes); }
+	/* Same lookup as a Cutset without runes, any byte in the bitmap stops */
+	Cutset bytes = {0};
+	for(isize i = 0; i < set_len; i += 1){
+		cutset_add_byte(&bytes, set[i]);
+	}
+	isize i = cutset_find(&bytes, (byte const*)p, nbytes, false);
+	return i < nbytes ? i : -1;
+}
+
+isize cstring_len(cstring cstr){
+	byte const* s = (byte const*)cstr;
+	isize len;
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case SIMD_AVX2: len = cstring_len_avx2(s); break;
+		case SIMD_SSE4: len = cstring_len_sse4(s); break;
+		default: len = cstring_len_scalar(s); break;
+	}
+#else
+	len = cstring_len_scalar(s);
+#endif
+	return min(len, CSTR_MAX_LENGTH);
+}
+
+#undef MEM_ALIGNED_OVERREAD
+#undef CSTR_MAX_LENGTH
+
+//// String Compare ////////////////////////////////////////////////////////////
+/* Everything goes through str_mismatch(), which compares a word or a vector
+ * block at a time and only looks at single bytes inside the block that
+ * differs. Short strings are compared with a couple of overlapping loads. */
+
+static inline
+u64 str_load_u64(byte const* p){
+	u64 x;
+	memcpy(&x, p, 8);
+	return x;
+}
+
+static inline
+u32 str_load_u32(byte const* p){
+	u32 x;
+	memcpy(&x, p, 4);
+	return x;
+}
+
+/* Equality of up to 16 bytes */
+static inline
+bool str_eq_short(byte const* a, byte const* b, isize n){
+	if(n >= 8){
+		return ((str_load_u64(a) ^ str_load_u64(b)) | (str_load_u64(&a[n - 8]) ^ str_load_u64(&b[n - 8]))) == 0;
+	}
+	if(n >= 4){
+		return ((str_load_u32(a) ^ str_load_u32(b)) | (str_load_u32(&a[n - 4]) ^ str_load_u32(&b[n - 4]))) == 0;
+	}
+	if(n > 0){
+		return a[0] == b[0] && a[n / 2] == b[n / 2] && a[n - 1] == b[n - 1];
+	}
+	return true;
+}
+
+static
+isize str_mismatch_scalar(byte const* a, byte const* b, isize n){
+	isize i = 0;
+	for(; i + 8 <= n; i += 8){
+		if(str_load_u64(&a[i]) != str_load_u64(&b[i])){ break; }
+	}
+	for(; i < n; i += 1){
+		if(a[i] != b[i]){ break; }
+	}
+	return i;
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static
+isize str_mismatch_sse4(byte const* a, byte const* b, isize n){
+	isize i = 0;
+	for(; i + 16 <= n; i += 16){
+		__m128i x = _mm_loadu_si128((__m128i const*)&a[i]);
+		__m128i y = _mm_loadu_si128((__m128i const*)&b[i]);
+		u32 same = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+		if(same != 0xffff){ return i + simd_ctz(~same); }
+	}
+	if(i < n){
+		/* Last block overlaps bytes already known to be equal */
+		i = n - 16;
+		__m128i x = _mm_loadu_si128((__m128i const*)&a[i]);
+		__m128i y = _mm_loadu_si128((__m128i const*)&b[i]);
+		u32 same = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+		if(same != 0xffff){ return i + simd_ctz(~same); }
+	}
+	return n;
+}
+
+SIMD_TARGET("avx2")
+static
+isize str_mismatch_avx2(byte const* a, byte const* b, isize n){
+	isize i = 0;
+	for(; i + 32 <= n; i += 32){
+		__m256i x = _mm256_loadu_si256((__m256i const*)&a[i]);
+		__m256i y = _mm256_loadu_si256((__m256i const*)&b[i]);
+		u32 same = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+		if(same != 0xffffffffu){ return i + simd_ctz(~same); }
+	}
+	if(i < n){
+		i = n - 32;
+		__m256i x = _mm256_loadu_si256((__m256i const*)&a[i]);
+		__m256i y = _mm256_loadu_si256((__m256i const*)&b[i]);
+		u32 same = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+		if(same != 0xffffffffu){ return i + simd_ctz(~same); }
+	}
+	return n;
+}
+#endif
+
+/* Is the byte at `i` a continuation byte? The end of the string is not */
+static inline
+bool str_continues(String s, isize i){
+	return i < s.len && (s.data[i] & 0xc0) == 0x80;
+}
+
+/* Offset of the first byte that differs in the first `n` bytes, or `n` */
+static inline
+isize str_mismatch(byte const* a, byte const* b, isize n){
+	if(a == b){ return n; }
+#ifdef SIMD_X86
+	if(n >= 16){
+		int level = simd_level();
+		if(level == SIMD_AVX2 && n >= 32){ return str_mismatch_avx2(a, b, n); }
+		if(level >= SIMD_SSE4){ return str_mismatch_sse4(a, b, n); }
+	}
+#endif
+	return str_mismatch_scalar(a, b, n);
+}
+
+bool str_eq(String a, String b){
+	if(a.len != b.len){ return false; }
+	if(a.len <= 16){ return str_eq_short(a.data, b.data, a.len); }
+	return str_mismatch(a.data, b.data, a.len) == a.len;
+}
+
+isize str_common_prefix_len(String a, String b){
+	return str_mismatch(a.data, b.data, min(a.len, b.len));
+}
+
+i32 str_compare(String a, String b){
+	isize n = min(a.len, b.len);
+	isize i = str_mismatch(a.data, b.data, n);
+	if(i < n){
+		return a.data[i] < b.data[i] ? -1 : 1;
+	}
+	return (a.len > b.len) - (a.len < b.len);
+}
+
+i32 str_compare_runes(String a, String b){
+	isize n = min(a.len, b.len);
+	isize i = str_mismatch(a.data, b.data, n);
+	if(i == n && a.len == b.len){ return 0; }
+	/* Invalid bytes are skipped one at a time, so any byte that isn't a
+	 * continuation byte starts a rune. Decoding resumes from the closest such
+	 * byte (in both strings) before the difference. Without one in the 3
+	 * bytes before it, no rune can span the difference and it starts one.
+	 * Even a byte prefix needs this, its last rune may be cut short. */
+	isize start = i;
+	while(start > 0 && start > i - 3 && (str_continues(a, start) || str_continues(b, start))){
+		start -= 1;
+	}
+	if(start > 0 && (str_continues(a, start) || str_continues(b, start))){
+		start = i;
+	}
+	UTF8_Iterator ia = str_iterator(str_sub(a, start, a.len - start));
+	UTF8_Iterator ib = str_iterator(str_sub(b, start, b.len - start));
+	for(;;){
+		rune ra, rb;
+		i8 la, lb;
+		bool more_a = utf8_iter_next(&ia, &ra, &la);
+		bool more_b = utf8_iter_next(&ib, &rb, &lb);
+		if(!more_a || !more_b){ return (i32)more_a - (i32)more_b; }
+		if(ra != rb){ return ra < rb ? -1 : 1; }
+	}
+}
+
+//// String Search /////////////////////////////////////////////////////////////
+/* Two-Way string matching (Crochemore & Perrin), linear time and constant
+ * space. It backs up the vector filters below once they degenerate, so it
+ * skips the usual bad character table. With `rev` both strings are read back
+ * to front, which finds the last match instead of the first. */
+static inline
+byte two_way_at(byte const* s, isize len, isize i, bool rev){
+	return rev ? s[len - 1 - i] : s[i];
+}
+
+/* Start (minus one) and period of the maximal suffix under either byte order */
+static
+isize two_way_max_suffix(byte const* p, isize m, bool rev, bool flip, isize* period){
+	isize ip = -1, jp = 0, k = 1, per = 1;
+	while(jp + k < m){
+		byte a = two_way_at(p, m, ip + k, rev);
+		byte b = two_way_at(p, m, jp + k, rev);
+		if(a == b){
+			if(k == per){
+				jp += per;
+				k = 1;
+			}
+			else {
+				k += 1;
+			}
+		}
+		else if((a > b) != flip){
+			jp += k;
+			k = 1;
+			per = jp - ip;
+		}
+		else {
+			ip = jp;
+			jp += 1;
+			k = 1;
+			per = 1;
+		}
+	}
+	*period = per;
+	return ip;
+}
+
+/* Offset of the first match (the last one with `rev`), or -1 */
+static
+isize two_way_search(byte const* h, isize n, byte const* p, isize m, bool rev){
+	isize period, flip_period;
+	isize ms = two_way_max_suffix(p, m, rev, false, &period);
+	isize flip_ms = two_way_max_suffix(p, m, rev, true, &flip_period);
+	if(flip_ms > ms){
+		ms = flip_ms;
+		period = flip_period;
+	}
+
+	/* Periodic needles remember how much of their left half already matched */
+	bool periodic = ms + 1 + period <= m;
+	for(isize i = 0; periodic && i <= ms; i += 1){
+		periodic = two_way_at(p, m, i, rev) == two_way_at(p, m, i + period, rev);
+	}
+	isize mem0 = 0;
+	if(periodic){
+		mem0 = m - period;
+	}
+	else {
+		period = max(ms, m - ms - 1) + 1;
+	}
+
+	isize mem = 0;
+	for(isize j = 0; j + m <= n;){
+		isize k = max(ms + 1, mem);
+		while(k < m && two_way_at(p, m, k, rev) == two_way_at(h, n, j + k, rev)){
+			k += 1;
+		}
+		if(k < m){
+			j += k - ms;
+			mem = 0;
+			continue;
+		}
+
+		k = ms + 1;
+		while(k > mem && two_way_at(p, m, k - 1, rev) == two_way_at(h, n, j + k - 1, rev)){
+			k -= 1;
+		}
+		if(k <= mem){
+			return rev ? n - j - m : j;
+		}
+		j += period;
+		mem = mem0;
+	}
+	return -1;
+}
+
+/* The vector filters compare the first and last byte of the pattern against
+ * a whole block of candidate positions at once and only verify the survivors.
+ * Verification work past this budget (plus twice the bytes scanned) means the
+ * input is adversarial for the filter, the rest goes through Two-Way. */
+#define STR_SEARCH_SLACK 4096
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static
+isize str_find_sse4(byte const* h, isize n, byte const* p, isize m){
+	const __m128i first = _mm_set1_epi8((char)p[0]);
+	const __m128i last = _mm_set1_epi8((char)p[m - 1]);
+	isize work = 0;
+	isize i = 0;
+	for(; i + m - 1 + 16 <= n && work <= 2 * i + STR_SEARCH_SLACK; i += 16){
+		__m128i a = _mm_loadu_si128((__m128i const*)&h[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&h[i + m - 1]);
+		u32 hits = (u32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+		for(; hits != 0; hits &= hits - 1){
+			isize at = i + simd_ctz(hits);
+			if(m <= 2 || mem_compare(&h[at + 1], &p[1], m - 2) == 0){ return at; }
+			work += m;
+		}
+	}
+	isize r = two_way_search(&h[i], n - i, p, m, false);
+	return r < 0 ? -1 : i + r;
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize str_rfind_sse4(byte const* h, isize n, byte const* p, isize m){
+	const __m128i first = _mm_set1_epi8((char)p[0]);
+	const __m128i last = _mm_set1_epi8((char)p[m - 1]);
+	isize work = 0;
+	/* Candidate positions left are [0, end) */
+	isize end = n - m + 1;
+	for(; end >= 16 && work <= 2 * (n - m + 1 - end) + STR_SEARCH_SLACK; end -= 16){
+		isize base = end - 16;
+		__m128i a = _mm_loadu_si128((__m128i const*)&h[base]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&h[base + m - 1]);
+		u32 hits = (u32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+		while(hits != 0){
+			isize bit = simd_msb(hits);
+			if(m <= 2 || mem_compare(&h[base + bit + 1], &p[1], m - 2) == 0){ return base + bit; }
+			hits &= ~((u32)1 << bit);
+			work += m;
+		}
+	}
+	return two_way_search(h, end + m - 1, p, m, true);
+}
+
+SIMD_TARGET("avx2")
+static
+isize str_find_avx2(byte const* h, isize n, byte const* p, isize m){
+	const __m256i first = _mm256_set1_epi8((char)p[0]);
+	const __m256i last = _mm256_set1_epi8((char)p[m - 1]);
+	isize work = 0;
+	isize i = 0;
+	for(; i + m - 1 + 32 <= n && work <= 2 * i + STR_SEARCH_SLACK; i += 32){
+		__m256i a = _mm256_loadu_si256((__m256i const*)&h[i]);
+		__m256i b = _mm256_loadu_si256((__m256i const*)&h[i + m - 1]);
+		u32 hits = (u32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+		for(; hits != 0; hits &= hits - 1){
+			isize at = i + simd_ctz(hits);
+			if(m <= 2 || mem_compare(&h[at + 1], &p[1], m - 2) == 0){ return at; }
+			work += m;
+		}
+	}
+	isize r = two_way_search(&h[i], n - i, p, m, false);
+	return r < 0 ? -1 : i + r;
+}
+
+SIMD_TARGET("avx2")
+static
+isize str_rfind_avx2(byte const* h, isize n, byte const* p, isize m){
+	const __m256i first = _mm256_set1_epi8((char)p[0]);
+	const __m256i last = _mm256_set1_epi8((char)p[m - 1]);
+	isize work = 0;
+	isize end = n - m + 1;
+	for(; end >= 32 && work <= 2 * (n - m + 1 - end) + STR_SEARCH_SLACK; end -= 32){
+		isize base = end - 32;
+		__m256i a = _mm256_loadu_si256((__m256i const*)&h[base]);
+		__m256i b = _mm256_loadu_si256((__m256i const*)&h[base + m - 1]);
+		u32 hits = (u32)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+		while(hits != 0){
+			isize bit = simd_msb(hits);
+			if(m <= 2 || mem_compare(&h[base + bit + 1], &p[1], m - 2) == 0){ return base + bit; }
+			hits &= ~((u32)1 << bit);
+			work += m;
+		}
+	}
+	return two_way_search(h, end + m - 1, p, m, true);
+}
+#endif
+
+#undef STR_SEARCH_SLACK
+
+isize str_find(String s, String pattern){
+	if(pattern.len == 0){ return 0; }
+	if(pattern.len > s.len){ return -1; }
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case SIMD_AVX2: return str_find_avx2(s.data, s.len, pattern.data, pattern.len);
+		case SIMD_SSE4: return str_find_sse4(s.data, s.len, pattern.data, pattern.len);
+		default: break;
+	}
+#endif
+	return two_way_search(s.data, s.len, pattern.data, pattern.len, false);
+}
+
+isize str_rfind(String s, String pattern){
+	if(pattern.len == 0){ return s.len; }
+	if(pattern.len > s.len){ return -1; }
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case SIMD_AVX2: return str_rfind_avx2(s.data, s.len, pattern.data, pattern.len);
+		case SIMD_SSE4: return str_rfind_sse4(s.data, s.len, pattern.data, pattern.len);
+		default: break;
+	}
+#endif
+	return two_way_search(s.data, s.len, pattern.data, pattern.len, true);
+}
+
+isize str_count(String s, String pattern){
+	if(pattern.len == 0){ return 0; }
+
+	isize count = 0;
+	if(pattern.len == 1){
+		byte c = pattern.data[0];
+		for(isize i = 0; i < s.len; i += 1){
+			count += s.data[i] == c;
+		}
+		return count;
+	}
+
+	for(isize pos = 0;;){
+		isize at = str_find(str_sub(s, pos, s.len - pos), pattern);
+		if(at < 0){ break; }
+		count += 1;
+		pos += at + pattern.len;
+	}
+	return count;
+}
+
+//// String Split //////////////////////////////////////////////////////////////
+/* Space, \t, \n, \v, \f and \r in the Cutset bitmap layout */
+static const Cutset ascii_whitespace = {
+	.bitmap = { [0] = 1 << 2, [9] = 1, [10] = 1, [11] = 1, [12] = 1, [13] = 1 },
+};
+
+Str_Splitter str_split_byte(String s, byte delim){
+	return (Str_Splitter){ .rest = s, .kind = Str_Split_Byte, .byte_delim = delim };
+}
+
+Str_Splitter str_split(String s, String delim){
+	return (Str_Splitter){ .rest = s, .kind = Str_Split_String, .delim = delim };
+}
+
+Str_Splitter str_split_any(String s, Cutset const* set){
+	return (Str_Splitter){ .rest = s, .kind = Str_Split_Cutset, .cutset = set };
+}
+
+Str_Splitter str_fields(String s){
+	return (Str_Splitter){ .rest = s, .kind = Str_Split_Fields };
+}
+
+bool str_split_next(Str_Splitter* it, String* token){
+	if(it->done){ return false; }
+	String rest = it->rest;
+
+	if(it->kind == Str_Split_Fields){
+		isize start = cutset_find(&ascii_whitespace, rest.data, rest.len, true);
+		if(start >= rest.len){
+			it->done = true;
+			return false;
+		}
+		isize end = start + cutset_find(&ascii_whitespace, &rest.data[start], rest.len - start, false);
+		*token = str_sub(rest, start, end - start);
+		it->rest = str_sub(rest, end, rest.len - end);
+		return true;
+	}
+
+	/* Position and length of the next delimiter */
+	isize at = -1, n = 0;
+	switch(it->kind){
+		case Str_Split_Byte:
+			at = str_find(rest, (String){ .data = &it->byte_delim, .len = 1 });
+			n = 1;
+		break;
+		case Str_Split_String:
+			if(it->delim.len > 0){
+				at = str_find(rest, it->delim);
+				n = it->delim.len;
+			}
+		break;
+		case Str_Split_Cutset:
+			at = cutset_find_rune(it->cutset, rest, 0, &n);
+		break;
+		default: break;
+	}
+
+	if(at < 0){
+		*token = rest;
+		it->rest = (String){0};
+		it->done = true;
+		return true;
+	}
+	*token = str_sub(rest, 0, at);
+	it->rest = str_sub(rest, at + n, rest.len - (at + n));
+	return true;
+}
+
+//// Pattern Set ///////////////////////////////////////////////////////////////
+/* Aho-Corasick turned into a DFA over byte classes. Transitions hold the row
+ * offset of their target (state * class_count) so stepping doesn't multiply,
+ * and are complemented when the target ends at least one pattern. */
+bool pattern_set_init(Pattern_Set* set, String const* patterns, isize count, Mem_Allocator allocator){
+	*set = (Pattern_Set){ .allocator = allocator, .pattern_count = count };
+
+	/* Bytes that never show up in a pattern all share class 0 */
+	bool used[256] = {0};
+	isize used_count = 0, total = 0;
+	for(isize i = 0; i < count; i += 1){
+		total += patterns[i].len;
+		for(isize k = 0; k < patterns[i].len; k += 1){
+			used_count += !used[patterns[i].data[k]];
+			used[patterns[i].data[k]] = true;
+		}
+	}
+	isize next_class = used_count < 256 ? 1 : 0;
+	for(isize b = 0; b < 256; b += 1){
+		set->classes[b] = used[b] ? (byte)next_class++ : 0;
+	}
+	set->class_count = next_class;
+
+	isize cap = total + 1;
+	isize C = set->class_count;
+	if(cap * C > INT32_MAX){ return false; }
+
+	set->delta = mem_new(i32, cap * C, allocator);
+	set->output = mem_new(i32, cap, allocator);
+	set->dict = mem_new(i32, cap, allocator);
+	set->pattern = mem_new(i32, cap, allocator);
+	set->lengths = mem_new(isize, max(count, 1), allocator);
+	i32* fail = mem_new(i32, cap, allocator);
+	i32* queue = mem_new(i32, cap, allocator);
+	bool ok = set->delta != null && set->output != null && set->dict != null &&
+		set->pattern != null && set->lengths != null && fail != null && queue != null;
+	/* Plain trie first, missing transitions are -1 */
+	if(ok){
+		for(isize i = 0; i < cap * C; i += 1){
+			set->delta[i] = -1;
+		}
+		set->pattern[0] = -1;
+		set->state_count = 1;
+
+		for(isize i = 0; i < count; i += 1){
+			String p = patterns[i];
+			set->lengths[i] = p.len;
+			if(p.len == 0){ continue; } /* Never matches */
+
+			i32 s = 0;
+			for(isize k = 0; k < p.len; k += 1){
+				isize slot = s * C + set->classes[p.data[k]];
+				if(set->delta[slot] < 0){
+					set->delta[slot] = (i32)set->state_count;
+					set->pattern[set->state_count] = -1;
+					set->state_count += 1;
+				}
+				s = set->delta[slot];
+			}
+			/* Duplicates report the first one */
+			if(set->pattern[s] < 0){
+				set->pattern[s] = (i32)i;
+			}
+		}
+	}
+
+	/* Failure links and the missing transitions, breadth first so the failure
+	 * state of every state already has its row filled in */
+	if(ok){
+		isize head = 0, tail = 0;
+		set->dict[0] = -1;
+		set->output[0] = -1;
+		for(isize c = 0; c < C; c += 1){
+			i32 t = set->delta[c];
+			if(t < 0){
+				set->delta[c] = 0;
+			}
+			else {
+				fail[t] = 0;
+				queue[tail++] = t;
+			}
+		}
+
+		while(head < tail){
+			i32 s = queue[head++];
+			i32 f = fail[s];
+			set->dict[s] = set->pattern[f] >= 0 ? f : set->dict[f];
+			set->output[s] = set->pattern[s] >= 0 ? s : set->dict[s];
+			for(isize c = 0; c < C; c += 1){
+				i32 t = set->delta[s * C + c];
+				if(t < 0){
+					set->delta[s * C + c] = set->delta[f * C + c];
+				}
+				else {
+					fail[t] = set->delta[f * C + c];
+					queue[tail++] = t;
+				}
+			}
+		}
+	}
+
+	for(isize i = 0; ok && i < set->state_count * C; i += 1){
+		i32 t = set->delta[i];
+		set->delta[i] = set->output[t] >= 0 ? ~(i32)(t * C) : (i32)(t * C);
+	}
+
+	if(fail != null){ mem_free(allocator, fail); }
+	if(queue != null){ mem_free(allocator, queue); }
+	if(!ok){ pattern_set_destroy(set); }
+	return ok;
+}
+
+void pattern_set_destroy(Pattern_Set* set){
+	if(set->delta != null){ mem_free(set->allocator, set->delta); }
+	if(set->output != null){ mem_free(set->allocator, set->output); }
+	if(set->dict != null){ mem_free(set->allocator, set->dict); }
+	if(set->pattern != null){ mem_free(set->allocator, set->pattern); }
+	if(set->lengths != null){ mem_free(set->allocator, set->lengths); }
+	*set = (Pattern_Set){0};
+}
+
+/* Run the automaton from `*row` over a chunk that starts `base` bytes into the
+ * input, returns false if `func` asked to stop */
+static
+bool pattern_set_run(Pattern_Set const* set, i32* row, isize base, String chunk, Pattern_Match_Func func, void* ctx){
+	i32 r = *row;
+	for(isize i = 0; i < chunk.len; i += 1){
+		r = set->delta[r + set->classes[chunk.data[i]]];
+		if(r >= 0){ continue; }
+
+		r = ~r;
+		for(i32 o = set->output[r / set->class_count]; o >= 0; o = set->dict[o]){
+			i32 id = set->pattern[o];
+			isize len = set->lengths[id];
+			Pattern_Match m = { .pattern = id, .offset = base + i + 1 - len, .len = len };
+			if(!func(ctx, m)){
+				*row = r;
+				return false;
+			}
+		}
+	}
+	*row = r;
+	return true;
+}
+
+static
+bool pattern_match_first(void* ctx, Pattern_Match m){
+	*(Pattern_Match*)ctx = m;
+	return false;
+}
+
+bool pattern_set_find(Pattern_Set const* set, String s, Pattern_Match* match){
+	i32 row = 0;
+	return !pattern_set_run(set, &row, 0, s, pattern_match_first, match);
+}
+
+typedef struct {
+	Pattern_Match* out;
+	isize cap;
+	isize count;
+} Pattern_Match_List;
+
+static
+bool pattern_match_append(void* ctx, Pattern_Match m){
+	Pattern_Match_List* list = ctx;
+	if(list->count < list->cap){
+		list->out[list->count] = m;
+	}
+	list->count += 1;
+	return true;
+}
+
+isize pattern_set_find_all(Pattern_Set const* set, String s, Pattern_Match* out, isize cap){
+	Pattern_Match_List list = { .out = out, .cap = cap };
+	i32 row = 0;
+	pattern_set_run(set, &row, 0, s, pattern_match_append, &list);
+	return list.count;
+}
+
+void pattern_scanner_init(Pattern_Scanner* sc, Pattern_Set const* set){
+	*sc = (Pattern_Scanner){ .set = set };
+}
+
+bool pattern_scanner_feed(Pattern_Scanner* sc, String chunk, Pattern_Match_Func func, void* ctx){
+	bool ok = pattern_set_run(sc->set, &sc->row, sc->offset, chunk, func, ctx);
+	sc->offset += chunk.len;
+	return ok;
+}
+
+i64 pattern_set_match_stream(Pattern_Set const* set, IO_Stream s, byte* buf, isize buflen, Pattern_Match_Func func, void* ctx){
+	Pattern_Scanner sc;
+	pattern_scanner_init(&sc, set);
+	for(;;){
+		i64 n = io_read(s, buf, buflen);
+		if(n == IO_Err_End_Of_Stream || n == 0){ break; }
+		if(n < 0){ return n; }
+		if(!pattern_scanner_feed(&sc, str_from_bytes(buf, n), func, ctx)){ break; }
+	}
+	return sc.offset;
+}
+
+//// Logger ////////////////////////////////////////////////////////////////////
+i32 log_ex_str(Logger l, String message, Source_Location loc, u8 level_n){
+    i32 n = l.log_func(l.impl, message, l.options, level_n, loc);
+	if(level_n == Log_Fatal){
+		panic("Fatal error");
+	}
+	return n;
+}
+
+i32 log_ex_cstr(Logger l, cstring message, Source_Location loc, u8 level_n){
+    return log_ex_str(l, str_from(message), loc, level_n);
+}
+
+static i32 _console_logger_func(void* impl, String message, u32 options, u8 level_num, Source_Location location){
+    (void)impl;
+    cstring header = log_level_map[level_num];
+    i32 n = printf("[%-5s %s:%d %s] %.*s\n", header, location.filename, location.line, location.caller_name, fmt_bytes(message));
+    return n;
+}
+
+Console_Logger* log_create_console_logger(Mem_Allocator allocator){
+	Console_Logger* cl = mem_new(Console_Logger, 1, allocator);
+	if(cl == null){	return null; }
+	cl->parent_allocator = allocator;
+	return cl;
+}
+
+void log_destroy_console_logger(Console_Logger* cl){
+	mem_free_ex(cl->parent_allocator, cl, sizeof(*cl), alignof(Console_Logger));
+}
+
+Logger log_console_logger(Console_Logger* cl,u32 options){
+	Logger logger = {0};
+	logger.impl = cl;
+	logger.options = options;
+	logger.log_func = _console_logger_func;
+	return logger;
+}
+
+//// Arena Allocator ///////////////////////////////////////////////////////////
+static
+uintptr arena_required_mem(uintptr cur, isize nbytes, isize align){
+	debug_assert(mem_valid_alignment(align), "Alignment must be a power of 2");
+	uintptr_t aligned  = align_forward_ptr(cur, align);
+	uintptr_t padding  = (uintptr)(aligned - cur);
+	uintptr_t required = padding + nbytes;
+	return required;
+}
+
+void *arena_alloc(Mem_Arena* a, isize size, isize align){
+	uintptr base = (uintptr)a->data;
+	uintptr current = (uintptr)base + (uintptr)a->offset;
+
+	uintptr available = (uintptr)a->capacity - (current - base);
+	uintptr required = arena_required_mem(current, size, align);
+
+	if(required > available){
+		return null;
+	}
+
+	a->offset += required;
+	void* allocation = &a->data[a->offset - size];
+	a->last_allocation = (uintptr)allocation;
+	return allocation;
+}
+
+void arena_free_all(Mem_Arena* a){
+	a->offset = 0;
+}
+
+static
+void* arena_allocator_func(
+	void* impl,
+	byte op,
+	void* old_ptr,
+	isize size,
+	isize align,
+	i32* capabilities)
+{
+	Mem_Arena* a = impl;
+	(void)old_ptr;
+	enum Allocator_Op operation = op;
+
+	switch(operation){
+		case Mem_Op_Alloc: {
+			return arena_alloc(a, size, align);
+		} break;
+
+		case Mem_Op_Free_All: {
+			arena_free_all(a);
+		} break;
+
+		case Mem_Op_Resize: {
+			return arena_resize(a, old_ptr, size);
+		} break;
+
+		case Mem_Op_Free: {} break;
+
+		case Mem_Op_Query: {
+			*capabilities = Allocator_Alloc_Any | Allocator_Free_All | Allocator_Align_Any | Allocator_Resize;
+		} break;
+
+		default: panic("Bad enum access");
+	}
+
+	return null;
+}
+
+void* arena_resize(Mem_Arena* a, void* ptr, isize new_size){
+	if((uintptr)ptr == a->last_allocation){
+		uintptr base = (uintptr)a->data;
+		uintptr current = base + (uintptr)a->offset;
+		uintptr limit = base + (uintptr)a->capacity;
+		isize last_allocation_size = current - a->last_allocation;
+
+		if((current - last_allocation_size + new_size) > limit){
+			return null; /* No space left*/
+		}
+
+		a->offset += new_size - last_allocation_size;
+		return ptr;
+	}
+
+	return null;
+}
+
+Mem_Allocator arena_allocator(Mem_Arena* a){
+	Mem_Allocator allocator = {
+		.data = a,
+		.func = arena_allocator_func,
+	};
+	return allocator;
+}
+
+void arena_init(Mem_Arena* a, byte* data, isize len){
+	a->capacity = len;
+	a->data = data;
+	a->offset = 0;
+}
+
+void arena_destroy(Mem_Arena* a){
+	arena_free_all(a);
+	a->capacity = 0;
+	a->data = null;
+}
+
+//// String Builder ////////////////////////////////////////////////////////////
+
+bool sb_init(String_Builder* sb, Mem_Allocator allocator, isize initial_cap){
+	sb->allocator = allocator;
+	sb->len = 0;
+	sb->data = mem_new(byte, initial_cap, allocator);
+	sb->cap = initial_cap;
+	return sb->data != null;
+}
+
+void sb_destroy(String_Builder* sb){
+	mem_free_ex(sb->allocator, sb->data, sb->cap, alignof(byte));
+}
+
+/* Make room for `nbytes` more bytes */
+static
+bool sb_grow(String_Builder* sb, isize nbytes){
+	if((sb->len + nbytes) <= sb->cap){ return true; }
+	isize new_cap = max(max(16, (sb->cap * 7) / 4), sb->len + nbytes);
+	byte* new_data = mem_realloc(sb->allocator, sb->data, sb->cap, new_cap, alignof(byte));
+	if(new_data == null){ return false; }
+	sb->data = new_data;
+	sb->cap = new_cap;
+	return true;
+}
+
+isize sb_append_bytes(String_Builder* sb, byte const* buf, isize nbytes){
+	if(!sb_grow(sb, nbytes)){ return -1; }
+	mem_copy(&sb->data[sb->len], buf, nbytes);
+	sb->len += nbytes;
+	return nbytes;
+}
+
+String sb_build(String_Builder* sb){
+	mem_resize(sb->allocator, sb->data, sb->len);
+	String s = str_from_bytes(sb->data, sb->len);
+	sb->len = 0;
+	sb->cap = 0;
+	sb->data = null;
+	return s;
+}
+
+isize sb_append_str(String_Builder* sb, String s){
+	return sb_append_bytes(sb, s.data, s.len);
+}
+
+isize sb_append_rune(String_Builder* sb, rune r){
+	UTF8_Encode_Result enc = utf8_encode(r);
+	return sb_append_bytes(sb, enc.bytes, enc.len);
+}
+
+isize sb_append_utf16(String_Builder* sb, u16 const* data, isize len){
+	isize nbytes = utf16_to_utf8_len(data, len);
+	if(!sb_grow(sb, nbytes)){ return -1; }
+	sb->len += utf16_to_utf8(&sb->data[sb->len], nbytes, data, len, null);
+	return nbytes;
+}
+
+isize sb_append_utf32(String_Builder* sb, rune const* data, isize len){
+	isize nbytes = utf32_to_utf8_len(data, len);
+	if(!sb_grow(sb, nbytes)){ return -1; }
+	sb->len += utf32_to_utf8(&sb->data[sb->len], nbytes, data, len, null);
+	return nbytes;
+}
+
+void sb_clear(String_Builder* sb){
+	sb->len = 0;
+}
+
+//// Chunk Builder /////////////////////////////////////////////////////////////
+static
+Builder_Chunk* chunk_builder_new_chunk(Chunk_Builder* cb){
+	Builder_Chunk* c = mem_alloc(cb->allocator, (isize)sizeof(Builder_Chunk) + cb->chunk_size, alignof(Builder_Chunk));
+	if(c == null){ return null; }
+	c->next = null;
+	c->len = 0;
+	c->cap = cb->chunk_size;
+	return c;
+}
+
+bool chunk_builder_init(Chunk_Builder* cb, Mem_Allocator allocator, isize chunk_size){
+	debug_assert(chunk_size > 0, "Chunk size must be positive");
+	mem_set(cb, 0, sizeof(*cb));
+	cb->allocator = allocator;
+	/* Whole chunk allocations stay a multiple of their alignment */
+	cb->chunk_size = (isize)align_forward_size(chunk_size, alignof(Builder_Chunk));
+	cb->head = chunk_builder_new_chunk(cb);
+	cb->tail = cb->head;
+	return cb->head != null;
+}
+
+bool chunk_builder_init_stream(Chunk_Builder* cb, Mem_Allocator allocator, isize chunk_size, IO_Stream s){
+	bool ok = chunk_builder_init(cb, allocator, chunk_size);
+	cb->stream = s;
+	return ok;
+}
+
+void chunk_builder_destroy(Chunk_Builder* cb){
+	Builder_Chunk* c = cb->head;
+	while(c != null){
+		Builder_Chunk* next = c->next;
+		mem_free_ex(cb->allocator, c, (isize)sizeof(Builder_Chunk) + c->cap, alignof(Builder_Chunk));
+		c = next;
+	}
+	cb->head = null;
+	cb->tail = null;
+	cb->len = 0;
+}
+
+static
+void chunk_builder_write(Chunk_Builder* cb, byte const* data, isize len){
+	while(len > 0 && cb->error == 0){
+		i64 n = io_write(cb->stream, (byte*)data, len);
+		if(n <= 0){
+			cb->error = n < 0 ? n : IO_Err_Broken_Handle;
+			return;
+		}
+		cb->written += n;
+		data += n;
+		len -= n;
+	}
+}
+
+/* Write the chunks up to the tail and empty them */
+static
+void chunk_builder_spill(Chunk_Builder* cb){
+	for(Builder_Chunk* c = cb->head; c != null && c->len > 0; c = c->next){
+		chunk_builder_write(cb, chunk_data(c), c->len);
+		c->len = 0;
+		if(c == cb->tail){ break; }
+	}
+	cb->tail = cb->head;
+	cb->len = 0;
+}
+
+/* Move on to the next chunk after the tail filled up */
+static
+bool chunk_builder_next_chunk(Chunk_Builder* cb){
+	if(cb->stream.func != null){
+		chunk_builder_spill(cb);
+		return cb->error == 0;
+	}
+	if(cb->tail->next == null){
+		cb->tail->next = chunk_builder_new_chunk(cb);
+		if(cb->tail->next == null){ return false; }
+	}
+	cb->tail = cb->tail->next;
+	return true;
+}
+
+isize chunk_builder_append_bytes(Chunk_Builder* cb, byte const* buf, isize nbytes){
+	if(cb->error != 0 || cb->tail == null){ return -1; }
+	if(cb->stream.func != null && nbytes >= cb->chunk_size){
+		/* Would only go through the chunk to be written right away */
+		chunk_builder_spill(cb);
+		chunk_builder_write(cb, buf, nbytes);
+		return cb->error == 0 ? nbytes : -1;
+	}
+	isize done = 0;
+	while(done < nbytes){
+		Builder_Chunk* c = cb->tail;
+		if(c->len == c->cap){
+			if(!chunk_builder_next_chunk(cb)){ return -1; }
+			c = cb->tail;
+		}
+		isize n = min(nbytes - done, c->cap - c->len);
+		mem_copy(&chunk_data(c)[c->len], &buf[done], n);
+		c->len += n;
+		cb->len += n;
+		done += n;
+	}
+	return nbytes;
+}
+
+isize chunk_builder_append_str(Chunk_Builder* cb, String s){
+	return chunk_builder_append_bytes(cb, s.data, s.len);
+}
+
+isize chunk_builder_append_rune(Chunk_Builder* cb, rune r){
+	UTF8_Encode_Result enc = utf8_encode(r);
+	return chunk_builder_append_bytes(cb, enc.bytes, enc.len);
+}
+
+i64 chunk_builder_flush(Chunk_Builder* cb){
+	if(cb->stream.func == null){ return IO_Err_Unsupported; }
+	if(cb->error == 0){ chunk_builder_spill(cb); }
+	return cb->error != 0 ? cb->error : cb->written;
+}
+
+String chunk_builder_build(Chunk_Builder* cb){
+	String s = {0};
+	byte* data = mem_alloc(cb->allocator, cb->len, alignof(byte));
+	if(data == null){ return s; }
+	isize n = 0;
+	for(Builder_Chunk* c = cb->head; c != null; c = c->next){
+		mem_copy(&data[n], chunk_data(c), c->len);
+		n += c->len;
+		if(c == cb->tail){ break; }
+	}
+	chunk_builder_clear(cb);
+	return str_from_bytes(data, n);
+}
+
+void chunk_builder_clear(Chunk_Builder* cb){
+	for(Builder_Chunk* c = cb->head; c != null; c = c->next){
+		c->len = 0;
+	}
+	cb->tail = cb->head;
+	cb->len = 0;
+}
+
+//// Rope //////////////////////////////////////////////////////////////////////
+/* Concatenation is AVL join: descend the spine of the taller tree until the
+ * heights are within one, link there and rotate on the way back up. Every
+ * operation copies the nodes on the paths it touches and shares the rest. */
+
+/* Runes started in a piece of UTF-8, counting non-continuation bytes */
+static
+isize utf8_count_starts(byte const* data, isize len){
+	isize count = 0, i = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		memcpy(&x, &data[i], 8);
+		/* Continuation bytes are the ones with the top bits 10 */
+		u64 cont = (x & ~(x << 1) & 0x8080808080808080ull) >> 7;
+		count += 8 - (isize)((cont * 0x0101010101010101ull) >> 56);
+	}
+	for(; i < len; i += 1){
+		count += (data[i] & 0xc0) != 0x80;
+	}
+	return count;
+}
+
+static inline
+i32 rope_height(Rope_Node const* n){
+	return n == null ? -1 : n->height;
+}
+
+static
+Rope_Node const* rope_leaf(Mem_Allocator allocator, String s, isize runes){
+	Rope_Node* n = mem_new(Rope_Node, 1, allocator);
+	if(n == null){ return null; }
+	n->left = null;
+	n->right = null;
+	n->leaf = s;
+	n->len = s.len;
+	n->runes = runes;
+	n->height = 0;
+	return n;
+}
+
+static
+Rope_Node const* rope_node(Mem_Allocator allocator, Rope_Node const* left, Rope_Node const* right){
+	if(left == null || right == null){ return null; }
+	Rope_Node* n = mem_new(Rope_Node, 1, allocator);
+	if(n == null){ return null; }
+	n->left = left;
+	n->right = right;
+	n->leaf = (String){0};
+	n->len = left->len + right->len;
+	n->runes = left->runes + right->runes;
+	n->height = max(left->height, right->height) + 1;
+	return n;
+}
+
+/* Node over 2 subtrees whose heights differ by at most 2 */
+static
+Rope_Node const* rope_balance(Mem_Allocator allocator, Rope_Node const* a, Rope_Node const* b){
+	if(a == null || b == null){ return null; }
+	if(a->height > b->height + 1){
+		if(rope_height(a->left) >= rope_height(a->right)){
+			return rope_node(allocator, a->left, rope_node(allocator, a->right, b));
+		}
+		Rope_Node const* m = a->right;
+		return rope_node(allocator,
+			rope_node(allocator, a->left, m->left),
+			rope_node(allocator, m->right, b));
+	}
+	if(b->height > a->height + 1){
+		if(rope_height(b->right) >= rope_height(b->left)){
+			return rope_node(allocator, rope_node(allocator, a, b->left), b->right);
+		}
+		Rope_Node const* m = b->left;
+		return rope_node(allocator,
+			rope_node(allocator, a, m->left),
+			rope_node(allocator, m->right, b->right));
+	}
+	return rope_node(allocator, a, b);
+}
+
+/* Join 2 trees, `ok` is cleared if an allocation fails */
+static
+Rope_Node const* rope_join(Mem_Allocator allocator, Rope_Node const* a, Rope_Node const* b, bool* ok){
+	if(a == null){ return b; }
+	if(b == null){ return a; }
+
+	if(a->height == 0 && b->height == 0 && a->len + b->len <= ROPE_LEAF_MERGE){
+		byte* data = mem_new(byte, a->len + b->len, allocator);
+		if(data == null){
+			*ok = false;
+			return null;
+		}
+		mem_copy(data, a->leaf.data, a->len);
+		mem_copy(&data[a->len], b->leaf.data, b->len);
+		Rope_Node const* n = rope_leaf(allocator, str_from_bytes(data, a->len + b->len), a->runes + b->runes);
+		*ok = *ok && n != null;
+		return n;
+	}
+
+	Rope_Node const* n;
+	if(a->height > b->height + 1){
+		Rope_Node const* right = rope_join(allocator, a->right, b, ok);
+		n = *ok ? rope_balance(allocator, a->left, right) : null;
+	}
+	else if(b->height > a->height + 1){
+		Rope_Node const* left = rope_join(allocator, a, b->left, ok);
+		n = *ok ? rope_balance(allocator, left, b->right) : null;
+	}
+	else {
+		n = rope_node(allocator, a, b);
+	}
+	*ok = *ok && n != null;
+	return n;
+}
+
+/* Bytes [start, end) of a tree, which has to overlap the range */
+static
+Rope_Node const* rope_slice(Mem_Allocator allocator, Rope_Node const* n, isize start, isize end, bool* ok){
+	if(!*ok){ return null; }
+	if(start <= 0 && end >= n->len){ return n; }
+	if(n->height == 0){
+		String s = str_sub(n->leaf, max(start, 0), min(end, n->len) - max(start, 0));
+		Rope_Node const* leaf = rope_leaf(allocator, s, utf8_count_starts(s.data, s.len));
+		*ok = leaf != null;
+		return leaf;
+	}
+	isize split = n->left->len;
+	if(end <= split){ return rope_slice(allocator, n->left, start, end, ok); }
+	if(start >= split){ return rope_slice(allocator, n->right, start - split, end - split, ok); }
+	Rope_Node const* left = rope_slice(allocator, n->left, start, split, ok);
+	Rope_Node const* right = rope_slice(allocator, n->right, 0, end - split, ok);
+	return *ok ? rope_join(allocator, left, right, ok) : null;
+}
+
+bool rope_init(Rope* r, String s, Mem_Allocator allocator){
+	r->allocator = allocator;
+	r->root = null;
+	if(s.len == 0){ return true; }
+	r->root = rope_leaf(allocator, s, utf8_count_starts(s.data, s.len));
+	return r->root != null;
+}
+
+bool rope_concat(Rope* out, Rope a, Rope b){
+	bool ok = true;
+	Rope_Node const* root = rope_join(a.allocator, a.root, b.root, &ok);
+	if(!ok){ return false; }
+	out->root = root;
+	out->allocator = a.allocator;
+	return true;
+}
+
+bool rope_sub(Rope* out, Rope r, isize start, isize length){
+	isize len = rope_len(r);
+	start = clamp(0, start, len);
+	isize end = start + clamp(0, length, len - start);
+	if(start == end){
+		out->root = null;
+		out->allocator = r.allocator;
+		return true;
+	}
+	bool ok = true;
+	Rope_Node const* root = rope_slice(r.allocator, r.root, start, end, &ok);
+	if(!ok){ return false; }
+	out->root = root;
+	out->allocator = r.allocator;
+	return true;
+}
+
+bool rope_sub_runes(Rope* out, Rope r, isize start, isize count){
+	if(start < 0 || count < 0){
+		return rope_sub(out, r, 0, 0);
+	}
+	isize begin = rope_rune_offset(r, start);
+	isize end = rope_rune_offset(r, start + count);
+	return rope_sub(out, r, begin, end - begin);
+}
+
+isize rope_len(Rope r){
+	return r.root == null ? 0 : r.root->len;
+}
+
+isize rope_rune_count(Rope r){
+	return r.root == null ? 0 : r.root->runes;
+}
+
+byte rope_byte_at(Rope r, isize offset){
+	debug_assert(offset >= 0 && offset < rope_len(r), "Rope offset out of bounds");
+	Rope_Node const* n = r.root;
+	while(n->height > 0){
+		if(offset < n->left->len){
+			n = n->left;
+		}
+		else {
+			offset -= n->left->len;
+			n = n->right;
+		}
+	}
+	return n->leaf.data[offset];
+}
+
+isize rope_rune_offset(Rope r, isize n){
+	if(n < 0){ return 0; }
+	if(n >= rope_rune_count(r)){ return rope_len(r); }
+	Rope_Node const* node = r.root;
+	isize base = 0;
+	while(node->height > 0){
+		if(n < node->left->runes){
+			node = node->left;
+		}
+		else {
+			n -= node->left->runes;
+			base += node->left->len;
+			node = node->right;
+		}
+	}
+	/* Skip to the n-th rune start in the leaf, past any continuation bytes
+	 * left over from the previous leaf */
+	byte const* data = node->leaf.data;
+	isize i = 0;
+	for(;; i += 1){
+		if((data[i] & 0xc0) != 0x80){
+			if(n == 0){ break; }
+			n -= 1;
+		}
+	}
+	return base + i;
+}
+
+rune rope_rune_at(Rope r, isize n){
+	if(n < 0 || n >= rope_rune_count(r)){ return UTF8_ERROR; }
+	isize offset = rope_rune_offset(r, n);
+	isize len = rope_len(r);
+	byte buf[4];
+	isize count = 0;
+	for(; count < 4 && offset + count < len; count += 1){
+		buf[count] = rope_byte_at(r, offset + count);
+		if(count > 0 && (buf[count] & 0xc0) != 0x80){ break; }
+	}
+	UTF8_Decode_Result res = utf8_decode(buf, count);
+	return res.len > 0 ? res.codepoint : UTF8_ERROR;
+}
+
+isize rope_flatten(Rope r, String_Builder* sb){
+	isize len = rope_len(r);
+	if(!sb_grow(sb, len)){ return -1; }
+	Rope_Iter it;
+	rope_iter_init(&it, r);
+	for(String leaf; rope_iter_next(&it, &leaf);){
+		mem_copy(&sb->data[sb->len], leaf.data, leaf.len);
+		sb->len += leaf.len;
+	}
+	return len;
+}
+
+void rope_iter_init(Rope_Iter* it, Rope r){
+	it->depth = 0;
+	if(r.root != null){
+		it->stack[it->depth++] = r.root;
+	}
+}
+
+bool rope_iter_next(Rope_Iter* it, String* leaf){
+	while(it->depth > 0){
+		Rope_Node const* n = it->stack[--it->depth];
+		if(n->height == 0){
+			*leaf = n->leaf;
+			return true;
+		}
+		it->stack[it->depth++] = n->right;
+		it->stack[it->depth++] = n->left;
+	}
+	return false;
+}
+
+//// Buffered IO ///////////////////////////////////////////////////////////////
+bool buf_reader_init(Buffered_Reader* r, IO_Stream source, Mem_Allocator allocator, isize size){
+	debug_assert(size > 0, "Buffer size must be positive");
+	byte* buf = mem_alloc(allocator, size, alignof(byte));
+	buf_reader_init_buffer(r, source, buf, buf == null ? 0 : size);
+	r->allocator = allocator;
+	return buf != null;
+}
+
+void buf_reader_init_buffer(Buffered_Reader* r, IO_Stream source, byte* buf, isize size){
+	mem_set(r, 0, sizeof(*r));
+	r->source = source;
+	r->buf = buf;
+	r->cap = size;
+	if(buf == null){ r->error = IO_Err_Memory_Error; }
+}
+
+void buf_reader_destroy(Buffered_Reader* r){
+	if(r->allocator.func != null && r->buf != null){
+		mem_free_ex(r->allocator, r->buf, r->cap, alignof(byte));
+	}
+	r->buf = null;
+	r->cap = 0;
+	r->start = 0;
+	r->end = 0;
+}
+
+/* Move the unread bytes to the front and do one read from the source into the
+ * free space after them */
+static
+void buf_reader_fill(Buffered_Reader* r){
+	if(r->start > 0){
+		mem_copy(r->buf, &r->buf[r->start], r->end - r->start);
+		r->end -= r->start;
+		r->start = 0;
+	}
+	if(r->error != 0 || r->end == r->cap){ return; }
+	i64 n = io_read(r->source, &r->buf[r->end], r->cap - r->end);
+	if(n <= 0){
+		r->error = n < 0 ? n : IO_Err_End_Of_Stream;
+		return;
+	}
+	r->end += n;
+}
+
+i64 buf_reader_read(Buffered_Reader* r, byte* buf, isize buflen){
+	if(buflen <= 0){ return 0; }
+	if(r->start == r->end){
+		if(r->error != 0){ return r->error; }
+		if(buflen >= r->cap){
+			/* Would only go through the buffer to be copied out right away */
+			i64 n = io_read(r->source, buf, buflen);
+			if(n <= 0){
+				r->error = n < 0 ? n : IO_Err_End_Of_Stream;
+				return r->error;
+			}
+			return n;
+		}
+		buf_reader_fill(r);
+		if(r->start == r->end){ return r->error; }
+	}
+	isize n = min(buflen, r->end - r->start);
+	mem_copy(buf, &r->buf[r->start], n);
+	r->start += n;
+	return n;
+}
+
+String buf_reader_peek(Buffered_Reader* r, isize n){
+	n = min(max(n, 0), r->cap);
+	while(r->end - r->start < n && r->error == 0){
+		buf_reader_fill(r);
+	}
+	return str_from_bytes(&r->buf[r->start], min(n, r->end - r->start));
+}
+
+i64 buf_reader_read_until(Buffered_Reader* r, byte delim, String* out){
+	/* Bytes after start that are known not to hold the delimiter */
+	isize scanned = 0;
+	for(;;){
+		isize pos = mem_find_byte(&r->buf[r->start + scanned], delim, r->end - r->start - scanned);
+		if(pos >= 0){
+			isize len = scanned + pos + 1;
+			*out = str_from_bytes(&r->buf[r->start], len);
+			r->start += len;
+			return len;
+		}
+		scanned = r->end - r->start;
+		if(scanned == r->cap || r->error != 0){ break; }
+		buf_reader_fill(r);
+	}
+	*out = str_from_bytes(&r->buf[r->start], scanned);
+	r->start = r->end;
+	return scanned > 0 ? scanned : r->error;
+}
+
+i64 buf_reader_append_until(Buffered_Reader* r, byte delim, String_Builder* sb){
+	i64 total = 0;
+	for(;;){
+		String part;
+		i64 n = buf_reader_read_until(r, delim, &part);
+		if(n < 0){
+			/* Report what was read, the error comes back on the next call */
+			return total > 0 ? total : n;
+		}
+		if(sb_append_bytes(sb, part.data, part.len) < 0){ return IO_Err_Memory_Error; }
+		total += n;
+		if(part.data[part.len - 1] == delim){ return total; }
+	}
+}
+
+static
+i64 buf_reader_stream_func(void* impl, byte op, byte* buf, isize buflen){
+	switch(op){
+	case IO_Query: return IO_Stream_Read;
+	case IO_Read: return buf_reader_read(impl, buf, buflen);
+	default: return IO_Err_Unsupported;
+	}
+}
+
+IO_Stream buf_reader_stream(Buffered_Reader* r){
+	return (IO_Stream){ .data = r, .func = buf_reader_stream_func };
+}
+
+bool buf_writer_init(Buffered_Writer* w, IO_Stream sink, Mem_Allocator allocator, isize size){
+	debug_assert(size > 0, "Buffer size must be positive");
+	byte* buf = mem_alloc(allocator, size, alignof(byte));
+	buf_writer_init_buffer(w, sink, buf, buf == null ? 0 : size);
+	w->allocator = allocator;
+	return buf != null;
+}
+
+void buf_writer_init_buffer(Buffered_Writer* w, IO_Stream sink, byte* buf, isize size){
+	mem_set(w, 0, sizeof(*w));
+	w->sink = sink;
+	w->buf = buf;
+	w->cap = size;
+	if(buf == null){ w->error = IO_Err_Memory_Error; }
+}
+
+void buf_writer_destroy(Buffered_Writer* w){
+	if(w->allocator.func != null && w->buf != null){
+		mem_free_ex(w->allocator, w->buf, w->cap, alignof(byte));
+	}
+	w->buf = null;
+	w->cap = 0;
+	w->len = 0;
+}
+
+static
+void buf_writer_send(Buffered_Writer* w, byte const* data, isize len){
+	while(len > 0 && w->error == 0){
+		i64 n = io_write(w->sink, (byte*)data, len);
+		if(n <= 0){
+			w->error = n < 0 ? n : IO_Err_Broken_Handle;
+			return;
+		}
+		w->written += n;
+		data += n;
+		len -= n;
+	}
+}
+
+i64 buf_writer_write(Buffered_Writer* w, byte const* buf, isize buflen){
+	isize done = 0;
+	while(buflen - done > w->cap - w->len && w->error == 0){
+		if(w->len == 0){
+			/* Would only go through the buffer to be written right away */
+			buf_writer_send(w, &buf[done], buflen - done);
+			done = buflen;
+			break;
+		}
+		isize n = w->cap - w->len;
+		mem_copy(&w->buf[w->len], &buf[done], n);
+		buf_writer_send(w, w->buf, w->cap);
+		w->len = 0;
+		done += n;
+	}
+	if(w->error != 0){ return w->error; }
+	mem_copy(&w->buf[w->len], &buf[done], buflen - done);
+	w->len += buflen - done;
+	return buflen;
+}
+
+i64 buf_writer_flush(Buffered_Writer* w){
+	if(w->error == 0){
+		buf_writer_send(w, w->buf, w->len);
+		w->len = 0;
+	}
+	return w->error != 0 ? w->error : w->written;
+}
+
+static
+i64 buf_writer_stream_func(void* impl, byte op, byte* buf, isize buflen){
+	switch(op){
+	case IO_Query: return IO_Stream_Write;
+	case IO_Write: return buf_writer_write(impl, buf, buflen);
+	default: return IO_Err_Unsupported;
+	}
+}
+
+IO_Stream buf_writer_stream(Buffered_Writer* w){
+	return (IO_Stream){ .data = w, .func = buf_writer_stream_func };
+}
+
+//// Case Folding //////////////////////////////////////////////////////////////
+/* Case mappings are stored as deltas in a two-level table: the upper bits of a
+ * rune pick a block of 64 entries, each entry indexes into a small table of
+ * (fold, lowercase) delta pairs. Most blocks have no mappings and share the
+ * all-zero block. */
+/* Generated by case-tables.py (Unicode 14.0.0), do not edit */
+#define CASE_LIMIT 0x1e922
+#define CASE_BLOCK_SHIFT 6
+
+static const u8 case_stage1[1957] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0, 0, 10, 11, 12, 13, 14, 15, 16, 17, 18, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 19, 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 21, 22, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23, 0, 0, 0, 0, 0, 24, 24, 25, 24, 26, 27, 28, 29,
+	0, 0, 0, 0, 30, 31, 32, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 33, 34, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 35, 36, 24, 37, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 38, 39, 0, 40, 41, 42, 43,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 44, 45, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 46, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 47, 0, 48, 49, 0, 50, 51, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 52, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 53, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 54, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 55,
+};
+
+static const u8 case_stage2[3584] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 100, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 72, 72, 72, 72, 72, 72, 72, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 61, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0, 65, 0, 65, 0, 65,
+	0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 40, 65, 0, 65, 0, 65, 0, 34,
+	0, 93, 65, 0, 65, 0, 90, 65, 0, 89, 89, 65, 0, 0, 83, 87, 88, 65, 0, 89, 91, 0, 94, 92, 65, 0, 0, 0, 94, 95, 0, 96,
+	65, 0, 65, 0, 65, 0, 98, 65, 0, 98, 0, 0, 65, 0, 98, 65, 0, 97, 97, 65, 0, 65, 0, 99, 65, 0, 0, 0, 65, 0, 0, 0,
+	0, 0, 0, 0, 66, 65, 0, 66, 65, 0, 66, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 66, 65, 0, 65, 0, 43, 49, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	37, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 104, 65, 0, 36, 103, 0,
+	0, 65, 0, 35, 81, 82, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 85, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 86,
+	0, 0, 0, 0, 0, 0, 75, 0, 74, 74, 74, 0, 80, 0, 79, 79, 0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	72, 72, 0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 64, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 67, 53, 54, 0, 0, 0, 56, 55, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 50, 52, 0, 0, 47, 46, 0, 65, 0, 60, 65, 0, 0, 37, 37, 37,
+	84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	68, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78,
+	78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102,
+	102, 102, 102, 102, 102, 102, 0, 102, 0, 0, 0, 0, 0, 102, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 62, 62, 62, 62, 62, 62, 0, 0, 59, 59, 59, 59, 59, 59, 0, 0,
+	25, 26, 27, 29, 29, 28, 30, 31, 105, 0, 0, 0, 0, 0, 0, 0, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33,
+	33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 0, 0, 33, 33, 33,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 48, 0, 0, 22, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 58, 0, 58, 0, 58, 0, 58,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 45, 45, 57, 0, 24, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 44, 44, 44, 44, 57, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 42, 42, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 41, 41, 60, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 38, 38, 39, 39, 57, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 23, 0, 0, 0, 20, 21, 0, 0, 0, 0, 0, 0, 71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70,
+	70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78,
+	78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 18, 32, 19, 0, 0, 65, 0, 65, 0, 65, 0, 16, 17, 14, 15, 0, 65, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 13, 13,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 12, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 65, 0, 7, 0, 0, 65, 0, 65, 0, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 3, 1, 2, 5, 3, 0, 9, 6, 8, 101, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 51, 4, 11, 65, 0, 65, 0, 0, 0, 0, 0, 0, 65, 0, 0, 0, 0, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+	10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+	10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0,
+	77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+	77, 77, 77, 77, 77, 77, 77, 77, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+	77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 0, 76, 76, 76, 76,
+	76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 0, 76, 76, 76, 76, 76, 76, 76, 0, 76, 76, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80,
+	80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73,
+	73, 73, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+/* Fold and lowercase deltas */
+static const i32 case_deltas[106][2] = {
+	{0, 0}, {-42319, -42319}, {-42315, -42315}, {-42308, -42308}, {-42307, -42307}, {-42305, -42305},
+	{-42282, -42282}, {-42280, -42280}, {-42261, -42261}, {-42258, -42258}, {-38864, 0}, {-35384, -35384},
+	{-35332, -35332}, {-10815, -10815}, {-10783, -10783}, {-10782, -10782}, {-10780, -10780}, {-10749, -10749},
+	{-10743, -10743}, {-10727, -10727}, {-8383, -8383}, {-8262, -8262}, {-7615, -7615}, {-7517, -7517},
+	{-7173, 0}, {-6222, 0}, {-6221, 0}, {-6212, 0}, {-6211, 0}, {-6210, 0},
+	{-6204, 0}, {-6180, 0}, {-3814, -3814}, {-3008, -3008}, {-268, 0}, {-195, -195},
+	{-163, -163}, {-130, -130}, {-128, -128}, {-126, -126}, {-121, -121}, {-112, -112},
+	{-100, -100}, {-97, -97}, {-86, -86}, {-74, -74}, {-64, 0}, {-60, -60},
+	{-58, 0}, {-56, -56}, {-54, 0}, {-48, -48}, {-48, 0}, {-30, 0},
+	{-25, 0}, {-22, 0}, {-15, 0}, {-9, -9}, {-8, -8}, {-8, 0},
+	{-7, -7}, {0, -199}, {0, 8}, {0, 38864}, {1, 0}, {1, 1},
+	{2, 2}, {8, 8}, {15, 15}, {16, 16}, {26, 26}, {28, 28},
+	{32, 32}, {34, 34}, {37, 37}, {38, 38}, {39, 39}, {40, 40},
+	{48, 48}, {63, 63}, {64, 64}, {69, 69}, {71, 71}, {79, 79},
+	{80, 80}, {116, 0}, {116, 116}, {202, 202}, {203, 203}, {205, 205},
+	{206, 206}, {207, 207}, {209, 209}, {210, 210}, {211, 211}, {213, 213},
+	{214, 214}, {217, 217}, {218, 218}, {219, 219}, {775, 0}, {928, 928},
+	{7264, 7264}, {10792, 10792}, {10795, 10795}, {35267, 0},
+};
+
+#define CASE_BLOCK_MASK ((1 << CASE_BLOCK_SHIFT) - 1)
+
+static inline
+u8 case_index(rune r){
+	if((u32)r >= CASE_LIMIT){ return 0; }
+	return case_stage2[(case_stage1[r >> CASE_BLOCK_SHIFT] << CASE_BLOCK_SHIFT) | (r & CASE_BLOCK_MASK)];
+}
+
+rune rune_fold(rune r){
+	return r + case_deltas[case_index(r)][0];
+}
+
+rune rune_to_lower(rune r){
+	return r + case_deltas[case_index(r)][1];
+}
+
+/* ASCII letters fold (and lowercase) to ASCII, the only other runes that fold
+ * into ASCII are U+017F and U+212A, which are multibyte */
+static inline
+byte ascii_lower(byte b){
+	return b | ((u8)(b - 'A') < 26 ? 0x20 : 0);
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static inline
+__m128i ascii_lower_sse4(__m128i v){
+	__m128i upper = _mm_and_si128(
+		_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+		_mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+	return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+/* Lowercase the leading 16 byte blocks of ASCII into `out`, returns the bytes
+ * done */
+SIMD_TARGET("sse4.1")
+static
+isize ascii_lower_blocks_sse4(byte* out, byte const* data, isize len){
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) != 0){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], ascii_lower_sse4(v));
+	}
+	return i;
+}
+
+/* Compare the leading 16 byte blocks where both sides are ASCII, returns the
+ * bytes that matched. A mismatch in such a block sets `differ`. */
+SIMD_TARGET("sse4.1")
+static
+isize ascii_eq_fold_sse4(byte const* a, byte const* b, isize len, bool* differ){
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i x = _mm_loadu_si128((__m128i const*)&a[i]);
+		__m128i y = _mm_loadu_si128((__m128i const*)&b[i]);
+		if(_mm_movemask_epi8(_mm_or_si128(x, y)) != 0){ break; }
+		__m128i eq = _mm_cmpeq_epi8(ascii_lower_sse4(x), ascii_lower_sse4(y));
+		if(_mm_movemask_epi8(eq) != 0xffff){
+			*differ = true;
+			break;
+		}
+	}
+	return i;
+}
+#endif
+
+bool str_eq_fold(String a, String b){
+	isize i = 0, j = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+	isize retry = 0;
+#endif
+
+	while(i < a.len && j < b.len){
+		byte x = a.data[i], y = b.data[j];
+		if((x | y) < 0x80){
+#ifdef SIMD_X86
+			/* A block that wasn't all ASCII is not tried again */
+			if(sse4 && i >= retry){
+				bool differ = false;
+				isize done = ascii_eq_fold_sse4(&a.data[i], &b.data[j], min(a.len - i, b.len - j), &differ);
+				if(differ){ return false; }
+				i += done;
+				j += done;
+				retry = i + 16;
+				continue;
+			}
+#endif
+			if(ascii_lower(x) != ascii_lower(y)){ return false; }
+			i += 1;
+			j += 1;
+			continue;
+		}
+
+		UTF8_Decode_Result ra = utf8_decode(&a.data[i], a.len - i);
+		UTF8_Decode_Result rb = utf8_decode(&b.data[j], b.len - j);
+		/* Invalid bytes only match themselves */
+		if(ra.len == 0 || rb.len == 0){
+			if(ra.len != rb.len || x != y){ return false; }
+			i += 1;
+			j += 1;
+			continue;
+		}
+		if(rune_fold(ra.codepoint) != rune_fold(rb.codepoint)){ return false; }
+		i += ra.len;
+		j += rb.len;
+	}
+
+	return i == a.len && j == b.len;
+}
+
+/* Hashes the folded UTF-8 in 32 byte stripes over 4 lanes (the same rounds as
+ * xxHash64), the input is folded through a small buffer first */
+#define FOLD_HASH_P1 0x9e3779b185ebca87ull
+#define FOLD_HASH_P2 0xc2b2ae3d27d4eb4full
+#define FOLD_HASH_P3 0x165667b19e3779f9ull
+#define FOLD_HASH_BUF 256
+
+typedef struct {
+	u64 lanes[4];
+	u64 total;
+	byte buf[FOLD_HASH_BUF + 16];
+	isize fill;
+} Fold_Hasher;
+
+static inline
+u64 fold_hash_rotl(u64 x, int r){
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline
+u64 fold_hash_round(u64 acc, u64 w){
+	return fold_hash_rotl(acc + w * FOLD_HASH_P2, 31) * FOLD_HASH_P1;
+}
+
+/* Hash every whole stripe in the buffer, keeping the rest */
+static
+void fold_hasher_flush(Fold_Hasher* h){
+	isize i = 0;
+	for(; i + 32 <= h->fill; i += 32){
+		for(int k = 0; k < 4; k += 1){
+			u64 w;
+			memcpy(&w, &h->buf[i + k * 8], 8);
+			h->lanes[k] = fold_hash_round(h->lanes[k], w);
+		}
+	}
+	h->total += i;
+	mem_copy(h->buf, &h->buf[i], h->fill - i);
+	h->fill -= i;
+}
+
+static
+u64 fold_hasher_finish(Fold_Hasher* h){
+	u64 x = fold_hash_rotl(h->lanes[0], 1) + fold_hash_rotl(h->lanes[1], 7) +
+		fold_hash_rotl(h->lanes[2], 12) + fold_hash_rotl(h->lanes[3], 18);
+	x += h->total + h->fill;
+	/* Leftover bytes, zero padded, go through a single lane */
+	mem_set(&h->buf[h->fill], 0, 8);
+	for(isize i = 0; i < h->fill; i += 8){
+		u64 w;
+		memcpy(&w, &h->buf[i], 8);
+		x = fold_hash_rotl(x ^ fold_hash_round(0, w), 27) * FOLD_HASH_P1 + FOLD_HASH_P3;
+	}
+	x ^= x >> 33;
+	x *= FOLD_HASH_P2;
+	x ^= x >> 29;
+	x *= FOLD_HASH_P3;
+	x ^= x >> 32;
+	return x;
+}
+
+u64 str_hash_fold(String s){
+	Fold_Hasher h = {
+		.lanes = {
+			FOLD_HASH_P1 + FOLD_HASH_P2, FOLD_HASH_P2, 0, (u64)0 - FOLD_HASH_P1,
+		},
+	};
+	isize i = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+	isize retry = 0;
+#endif
+
+	while(i < s.len){
+		byte b = s.data[i];
+		if(b < 0x80){
+#ifdef SIMD_X86
+			if(sse4 && i >= retry){
+				isize room = FOLD_HASH_BUF - h.fill;
+				isize done = ascii_lower_blocks_sse4(&h.buf[h.fill], &s.data[i], min(s.len - i, room));
+				i += done;
+				h.fill += done;
+				retry = i + 16;
+			}
+#endif
+			if(i < s.len && s.data[i] < 0x80){
+				h.buf[h.fill++] = ascii_lower(s.data[i]);
+				i += 1;
+			}
+		}
+		else {
+			UTF8_Decode_Result res = utf8_decode(&s.data[i], s.len - i);
+			if(res.len == 0){
+				h.buf[h.fill++] = b;
+				i += 1;
+			}
+			else {
+				rune r = rune_fold(res.codepoint);
+				utf8_put(&h.buf[h.fill], r);
+				h.fill += utf8_rune_size(r);
+				i += res.len;
+			}
+		}
+		if(h.fill > FOLD_HASH_BUF - 16){
+			fold_hasher_flush(&h);
+		}
+	}
+
+	fold_hasher_flush(&h);
+	return fold_hasher_finish(&h);
+}
+
+isize str_to_lower(String_Builder* sb, String s){
+	isize start = sb->len;
+	isize i = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= SIMD_SSE4;
+	isize retry = 0;
+#endif
+	if(!sb_grow(sb, s.len)){ return -1; }
+
+	while(i < s.len){
+		byte b = s.data[i];
+		if(b < 0x80){
+#ifdef SIMD_X86
+			if(sse4 && i >= retry){
+				if(!sb_grow(sb, s.len - i)){ return -1; }
+				isize done = ascii_lower_blocks_sse4(&sb->data[sb->len], &s.data[i], s.len - i);
+				i += done;
+				sb->len += done;
+				retry = i + 16;
+				if(i == s.len){ break; }
+				continue;
+			}
+#endif
+			if(!sb_grow(sb, 1)){ return -1; }
+			sb->data[sb->len++] = ascii_lower(s.data[i]);
+			i += 1;
+			continue;
+		}
+
+		/* Invalid bytes are kept as they are */
+		UTF8_Decode_Result res = utf8_decode(&s.data[i], s.len - i);
+		if(res.len == 0){
+			if(!sb_grow(sb, 1)){ return -1; }
+			sb->data[sb->len++] = b;
+			i += 1;
+			continue;
+		}
+		rune r = rune_to_lower(res.codepoint);
+		isize size = utf8_rune_size(r);
+		if(!sb_grow(sb, size)){ return -1; }
+		utf8_put(&sb->data[sb->len], r);
+		sb->len += size;
+		i += res.len;
+	}
+
+	return sb->len - start;
+}
+
+#undef CASE_LIMIT
+#undef CASE_BLOCK_SHIFT
+#undef CASE_BLOCK_MASK
+#undef FOLD_HASH_P1
+#undef FOLD_HASH_P2
+#undef FOLD_HASH_P3
+#undef FOLD_HASH_BUF
+
+//// Numbers ///////////////////////////////////////////////////////////////////
+/* Generated by pow10-table.py, do not edit. Significands of 10^k for k in
+ * [POW10_MIN, POW10_MAX], rounded down to 128 bits as {high, low} */
+#define POW10_MIN (-342)
+#define POW10_MAX 324
+static const u64 pow10_table[667][2] = {
+	{0xeef453d6923bd65a, 0x113faa2906a13b3f}, {0x9558b4661b6565f8, 0x4ac7ca59a424c507},
+	{0xbaaee17fa23ebf76, 0x5d79bcf00d2df649}, {0xe95a99df8ace6f53, 0xf4d82c2c107973dc},
+	{0x91d8a02bb6c10594, 0x79071b9b8a4be869}, {0xb64ec836a47146f9, 0x9748e2826cdee284},
+	{0xe3e27a444d8d98b7, 0xfd1b1b2308169b25}, {0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7},
+	{0xb208ef855c969f4f, 0xbdbd2d335e51a935}, {0xde8b2b66b3bc4723, 0xad2c788035e61382},
+	{0x8b16fb203055ac76, 0x4c3bcb5021afcc31}, {0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d},
+	{0xd953e8624b85dd78, 0xd71d6dad34a2af0d}, {0x87d4713d6f33aa6b, 0x8672648c40e5ad68},
+	{0xa9c98d8ccb009506, 0x680efdaf511f18c2}, {0xd43bf0effdc0ba48, 0x0212bd1b2566def2},
+	{0x84a57695fe98746d, 0x014bb630f7604b57}, {0xa5ced43b7e3e9188, 0x419ea3bd35385e2d},
+	{0xcf42894a5dce35ea, 0x52064cac828675b9}, {0x818995ce7aa0e1b2, 0x7343efebd1940993},
+	{0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8}, {0xca66fa129f9b60a6, 0xd41a26e077774ef6},
+	{0xfd00b897478238d0, 0x8920b098955522b4}, {0x9e20735e8cb16382, 0x55b46e5f5d5535b0},
+	{0xc5a890362fddbc62, 0xeb2189f734aa831d}, {0xf712b443bbd52b7b, 0xa5e9ec7501d523e4},
+	{0x9a6bb0aa55653b2d, 0x47b233c92125366e}, {0xc1069cd4eabe89f8, 0x999ec0bb696e840a},
+	{0xf148440a256e2c76, 0xc00670ea43ca250d}, {0x96cd2a865764dbca, 0x380406926a5e5728},
+	{0xbc807527ed3e12bc, 0xc605083704f5ecf2}, {0xeba09271e88d976b, 0xf7864a44c633682e},
+	{0x93445b8731587ea3, 0x7ab3ee6afbe0211d}, {0xb8157268fdae9e4c, 0x5960ea05bad82964},
+	{0xe61acf033d1a45df, 0x6fb92487298e33bd}, {0x8fd0c16206306bab, 0xa5d3b6d479f8e056},
+	{0xb3c4f1ba87bc8696, 0x8f48a4899877186c}, {0xe0b62e2929aba83c, 0x331acdabfe94de87},
+	{0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14}, {0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9},
+	{0xdb71e91432b1a24a, 0xc9e82cd9f69d6150}, {0x892731ac9faf056e, 0xbe311c083a225cd2},
+	{0xab70fe17c79ac6ca, 0x6dbd630a48aaf406}, {0xd64d3d9db981787d, 0x092cbbccdad5b108},
+	{0x85f0468293f0eb4e, 0x25bbf56008c58ea5}, {0xa76c582338ed2621, 0xaf2af2b80af6f24e},
+	{0xd1476e2c07286faa, 0x1af5af660db4aee1}, {0x82cca4db847945ca, 0x50d98d9fc890ed4d},
+	{0xa37fce126597973c, 0xe50ff107bab528a0}, {0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8},
+	{0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a}, {0x9faacf3df73609b1, 0x77b191618c54e9ac},
+	{0xc795830d75038c1d, 0xd59df5b9ef6a2417}, {0xf97ae3d0d2446f25, 0x4b0573286b44ad1d},
+	{0x9becce62836ac577, 0x4ee367f9430aec32}, {0xc2e801fb244576d5, 0x229c41f793cda73f},
+	{0xf3a20279ed56d48a, 0x6b43527578c1110f}, {0x9845418c345644d6, 0x830a13896b78aaa9},
+	{0xbe5691ef416bd60c, 0x23cc986bc656d553}, {0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8},
+	{0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9}, {0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53},
+	{0xe858ad248f5c22c9, 0xd1b3400f8f9cff68}, {0x91376c36d99995be, 0x23100809b9c21fa1},
+	{0xb58547448ffffb2d, 0xabd40a0c2832a78a}, {0xe2e69915b3fff9f9, 0x16c90c8f323f516c},
+	{0x8dd01fad907ffc3b, 0xae3da7d97f6792e3}, {0xb1442798f49ffb4a, 0x99cd11cfdf41779c},
+	{0xdd95317f31c7fa1d, 0x40405643d711d583}, {0x8a7d3eef7f1cfc52, 0x482835ea666b2572},
+	{0xad1c8eab5ee43b66, 0xda3243650005eecf}, {0xd863b256369d4a40, 0x90bed43e40076a82},
+	{0x873e4f75e2224e68, 0x5a7744a6e804a291}, {0xa90de3535aaae202, 0x711515d0a205cb36},
+	{0xd3515c2831559a83, 0x0d5a5b44ca873e03}, {0x8412d9991ed58091, 0xe858790afe9486c2},
+	{0xa5178fff668ae0b6, 0x626e974dbe39a872}, {0xce5d73ff402d98e3, 0xfb0a3d212dc8128f},
+	{0x80fa687f881c7f8e, 0x7ce66634bc9d0b99}, {0xa139029f6a239f72, 0x1c1fffc1ebc44e80},
+	{0xc987434744ac874e, 0xa327ffb266b56220}, {0xfbe9141915d7a922, 0x4bf1ff9f0062baa8},
+	{0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9}, {0xc4ce17b399107c22, 0xcb550fb4384d21d3},
+	{0xf6019da07f549b2b, 0x7e2a53a146606a48}, {0x99c102844f94e0fb, 0x2eda7444cbfc426d},
+	{0xc0314325637a1939, 0xfa911155fefb5308}, {0xf03d93eebc589f88, 0x793555ab7eba27ca},
+	{0x96267c7535b763b5, 0x4bc1558b2f3458de}, {0xbbb01b9283253ca2, 0x9eb1aaedfb016f16},
+	{0xea9c227723ee8bcb, 0x465e15a979c1cadc}, {0x92a1958a7675175f, 0x0bfacd89ec191ec9},
+	{0xb749faed14125d36, 0xcef980ec671f667b}, {0xe51c79a85916f484, 0x82b7e12780e7401a},
+	{0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810}, {0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15},
+	{0xdfbdcece67006ac9, 0x67a791e093e1d49a}, {0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0},
+	{0xaecc49914078536d, 0x58fae9f773886e18}, {0xda7f5bf590966848, 0xaf39a475506a899e},
+	{0x888f99797a5e012d, 0x6d8406c952429603}, {0xaab37fd7d8f58178, 0xc8e5087ba6d33b83},
+	{0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64}, {0x855c3be0a17fcd26, 0x5cf2eea09a55067f},
+	{0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e}, {0xd0601d8efc57b08b, 0xf13b94daf124da26},
+	{0x823c12795db6ce57, 0x76c53d08d6b70858}, {0xa2cb1717b52481ed, 0x54768c4b0c64ca6e},
+	{0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09}, {0xfe5d54150b090b02, 0xd3f93b35435d7c4c},
+	{0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf}, {0xc6b8e9b0709f109a, 0x359ab6419ca1091b},
+	{0xf867241c8cc6d4c0, 0xc30163d203c94b62}, {0x9b407691d7fc44f8, 0x79e0de63425dcf1d},
+	{0xc21094364dfb5636, 0x985915fc12f542e4}, {0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d},
+	{0x979cf3ca6cec5b5a, 0xa705992ceecf9c42}, {0xbd8430bd08277231, 0x50c6ff782a838353},
+	{0xece53cec4a314ebd, 0xa4f8bf5635246428}, {0x940f4613ae5ed136, 0x871b7795e136be99},
+	{0xb913179899f68584, 0x28e2557b59846e3f}, {0xe757dd7ec07426e5, 0x331aeada2fe589cf},
+	{0x9096ea6f3848984f, 0x3ff0d2c85def7621}, {0xb4bca50b065abe63, 0x0fed077a756b53a9},
+	{0xe1ebce4dc7f16dfb, 0xd3e8495912c62894}, {0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c},
+	{0xb080392cc4349dec, 0xbd8d794d96aacfb3}, {0xdca04777f541c567, 0xecf0d7a0fc5583a0},
+	{0x89e42caaf9491b60, 0xf41686c49db57244}, {0xac5d37d5b79b6239, 0x311c2875c522ced5},
+	{0xd77485cb25823ac7, 0x7d633293366b828b}, {0x86a8d39ef77164bc, 0xae5dff9c02033197},
+	{0xa8530886b54dbdeb, 0xd9f57f830283fdfc}, {0xd267caa862a12d66, 0xd072df63c324fd7b},
+	{0x8380dea93da4bc60, 0x4247cb9e59f71e6d}, {0xa46116538d0deb78, 0x52d9be85f074e608},
+	{0xcd795be870516656, 0x67902e276c921f8b}, {0x806bd9714632dff6, 0x00ba1cd8a3db53b6},
+	{0xa086cfcd97bf97f3, 0x80e8a40eccd228a4}, {0xc8a883c0fdaf7df0, 0x6122cd128006b2cd},
+	{0xfad2a4b13d1b5d6c, 0x796b805720085f81}, {0x9cc3a6eec6311a63, 0xcbe3303674053bb0},
+	{0xc3f490aa77bd60fc, 0xbedbfc4411068a9c}, {0xf4f1b4d515acb93b, 0xee92fb5515482d44},
+	{0x991711052d8bf3c5, 0x751bdd152d4d1c4a}, {0xbf5cd54678eef0b6, 0xd262d45a78a0635d},
+	{0xef340a98172aace4, 0x86fb897116c87c34}, {0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0},
+	{0xbae0a846d2195712, 0x8974836059cca109}, {0xe998d258869facd7, 0x2bd1a438703fc94b},
+	{0x91ff83775423cc06, 0x7b6306a34627ddcf}, {0xb67f6455292cbf08, 0x1a3bc84c17b1d542},
+	{0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93}, {0x8e938662882af53e, 0x547eb47b7282ee9c},
+	{0xb23867fb2a35b28d, 0xe99e619a4f23aa43}, {0xdec681f9f4c31f31, 0x6405fa00e2ec94d4},
+	{0x8b3c113c38f9f37e, 0xde83bc408dd3dd04}, {0xae0b158b4738705e, 0x9624ab50b148d445},
+	{0xd98ddaee19068c76, 0x3badd624dd9b0957}, {0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6},
+	{0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c}, {0xd47487cc8470652b, 0x7647c3200069671f},
+	{0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073}, {0xa5fb0a17c777cf09, 0xf468107100525890},
+	{0xcf79cc9db955c2cc, 0x7182148d4066eeb4}, {0x81ac1fe293d599bf, 0xc6f14cd848405530},
+	{0xa21727db38cb002f, 0xb8ada00e5a506a7c}, {0xca9cf1d206fdc03b, 0xa6d90811f0e4851c},
+	{0xfd442e4688bd304a, 0x908f4a166d1da663}, {0x9e4a9cec15763e2e, 0x9a598e4e043287fe},
+	{0xc5dd44271ad3cdba, 0x40eff1e1853f29fd}, {0xf7549530e188c128, 0xd12bee59e68ef47c},
+	{0x9a94dd3e8cf578b9, 0x82bb74f8301958ce}, {0xc13a148e3032d6e7, 0xe36a52363c1faf01},
+	{0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1}, {0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9},
+	{0xbcb2b812db11a5de, 0x7415d448f6b6f0e7}, {0xebdf661791d60f56, 0x111b495b3464ad21},
+	{0x936b9fcebb25c995, 0xcab10dd900beec34}, {0xb84687c269ef3bfb, 0x3d5d514f40eea742},
+	{0xe65829b3046b0afa, 0x0cb4a5a3112a5112}, {0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab},
+	{0xb3f4e093db73a093, 0x59ed216765690f56}, {0xe0f218b8d25088b8, 0x306869c13ec3532c},
+	{0x8c974f7383725573, 0x1e414218c73a13fb}, {0xafbd2350644eeacf, 0xe5d1929ef90898fa},
+	{0xdbac6c247d62a583, 0xdf45f746b74abf39}, {0x894bc396ce5da772, 0x6b8bba8c328eb783},
+	{0xab9eb47c81f5114f, 0x066ea92f3f326564}, {0xd686619ba27255a2, 0xc80a537b0efefebd},
+	{0x8613fd0145877585, 0xbd06742ce95f5f36}, {0xa798fc4196e952e7, 0x2c48113823b73704},
+	{0xd17f3b51fca3a7a0, 0xf75a15862ca504c5}, {0x82ef85133de648c4, 0x9a984d73dbe722fb},
+	{0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba}, {0xcc963fee10b7d1b3, 0x318df905079926a8},
+	{0xffbbcfe994e5c61f, 0xfdf17746497f7052}, {0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633},
+	{0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0}, {0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0},
+	{0x9c1661a651213e2d, 0x06bea10ca65c084e}, {0xc31bfa0fe5698db8, 0x486e494fcff30a62},
+	{0xf3e2f893dec3f126, 0x5a89dba3c3efccfa}, {0x986ddb5c6b3a76b7, 0xf89629465a75e01c},
+	{0xbe89523386091465, 0xf6bbb397f1135823}, {0xee2ba6c0678b597f, 0x746aa07ded582e2c},
+	{0x94db483840b717ef, 0xa8c2a44eb4571cdc}, {0xba121a4650e4ddeb, 0x92f34d62616ce413},
+	{0xe896a0d7e51e1566, 0x77b020baf9c81d17}, {0x915e2486ef32cd60, 0x0ace1474dc1d122e},
+	{0xb5b5ada8aaff80b8, 0x0d819992132456ba}, {0xe3231912d5bf60e6, 0x10e1fff697ed6c69},
+	{0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1}, {0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2},
+	{0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde}, {0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b},
+	{0xad4ab7112eb3929d, 0x86c16c98d2c953c6}, {0xd89d64d57a607744, 0xe871c7bf077ba8b7},
+	{0x87625f056c7c4a8b, 0x11471cd764ad4972}, {0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf},
+	{0xd389b47879823479, 0x4aff1d108d4ec2c3}, {0x843610cb4bf160cb, 0xcedf722a585139ba},
+	{0xa54394fe1eedb8fe, 0xc2974eb4ee658828}, {0xce947a3da6a9273e, 0x733d226229feea32},
+	{0x811ccc668829b887, 0x0806357d5a3f525f}, {0xa163ff802a3426a8, 0xca07c2dcb0cf26f7},
+	{0xc9bcff6034c13052, 0xfc89b393dd02f0b5}, {0xfc2c3f3841f17c67, 0xbbac2078d443ace2},
+	{0x9d9ba7832936edc0, 0xd54b944b84aa4c0d}, {0xc5029163f384a931, 0x0a9e795e65d4df11},
+	{0xf64335bcf065d37d, 0x4d4617b5ff4a16d5}, {0x99ea0196163fa42e, 0x504bced1bf8e4e45},
+	{0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6}, {0xf07da27a82c37088, 0x5d767327bb4e5a4c},
+	{0x964e858c91ba2655, 0x3a6a07f8d510f86f}, {0xbbe226efb628afea, 0x890489f70a55368b},
+	{0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e}, {0x92c8ae6b464fc96f, 0x3b0b8bc90012929d},
+	{0xb77ada0617e3bbcb, 0x09ce6ebb40173744}, {0xe55990879ddcaabd, 0xcc420a6a101d0515},
+	{0x8f57fa54c2a9eab6, 0x9fa946824a12232d}, {0xb32df8e9f3546564, 0x47939822dc96abf9},
+	{0xdff9772470297ebd, 0x59787e2b93bc56f7}, {0x8bfbea76c619ef36, 0x57eb4edb3c55b65a},
+	{0xaefae51477a06b03, 0xede622920b6b23f1}, {0xdab99e59958885c4, 0xe95fab368e45eced},
+	{0x88b402f7fd75539b, 0x11dbcb0218ebb414}, {0xaae103b5fcd2a881, 0xd652bdc29f26a119},
+	{0xd59944a37c0752a2, 0x4be76d3346f0495f}, {0x857fcae62d8493a5, 0x6f70a4400c562ddb},
+	{0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952}, {0xd097ad07a71f26b2, 0x7e2000a41346a7a7},
+	{0x825ecc24c873782f, 0x8ed400668c0c28c8}, {0xa2f67f2dfa90563b, 0x728900802f0f32fa},
+	{0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9}, {0xfea126b7d78186bc, 0xe2f610c84987bfa8},
+	{0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9}, {0xc6ede63fa05d3143, 0x91503d1c79720dbb},
+	{0xf8a95fcf88747d94, 0x75a44c6397ce912a}, {0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba},
+	{0xc24452da229b021b, 0xfbe85badce996168}, {0xf2d56790ab41c2a2, 0xfae27299423fb9c3},
+	{0x97c560ba6b0919a5, 0xdccd879fc967d41a}, {0xbdb6b8e905cb600f, 0x5400e987bbc1c920},
+	{0xed246723473e3813, 0x290123e9aab23b68}, {0x9436c0760c86e30b, 0xf9a0b6720aaf6521},
+	{0xb94470938fa89bce, 0xf808e40e8d5b3e69}, {0xe7958cb87392c2c2, 0xb60b1d1230b20e04},
+	{0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2}, {0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3},
+	{0xe2280b6c20dd5232, 0x25c6da63c38de1b0}, {0x8d590723948a535f, 0x579c487e5a38ad0e},
+	{0xb0af48ec79ace837, 0x2d835a9df0c6d851}, {0xdcdb1b2798182244, 0xf8e431456cf88e65},
+	{0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff}, {0xac8b2d36eed2dac5, 0xe272467e3d222f3f},
+	{0xd7adf884aa879177, 0x5b0ed81dcc6abb0f}, {0x86ccbb52ea94baea, 0x98e947129fc2b4e9},
+	{0xa87fea27a539e9a5, 0x3f2398d747b36224}, {0xd29fe4b18e88640e, 0x8eec7f0d19a03aad},
+	{0x83a3eeeef9153e89, 0x1953cf68300424ac}, {0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7},
+	{0xcdb02555653131b6, 0x3792f412cb06794d}, {0x808e17555f3ebf11, 0xe2bbd88bbee40bd0},
+	{0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4}, {0xc8de047564d20a8b, 0xf245825a5a445275},
+	{0xfb158592be068d2e, 0xeed6e2f0f0d56712}, {0x9ced737bb6c4183d, 0x55464dd69685606b},
+	{0xc428d05aa4751e4c, 0xaa97e14c3c26b886}, {0xf53304714d9265df, 0xd53dd99f4b3066a8},
+	{0x993fe2c6d07b7fab, 0xe546a8038efe4029}, {0xbf8fdb78849a5f96, 0xde98520472bdd033},
+	{0xef73d256a5c0f77c, 0x963e66858f6d4440}, {0x95a8637627989aad, 0xdde7001379a44aa8},
+	{0xbb127c53b17ec159, 0x5560c018580d5d52}, {0xe9d71b689dde71af, 0xaab8f01e6e10b4a6},
+	{0x9226712162ab070d, 0xcab3961304ca70e8}, {0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22},
+	{0xe45c10c42a2b3b05, 0x8cb89a7db77c506a}, {0x8eb98a7a9a5b04e3, 0x77f3608e92adb242},
+	{0xb267ed1940f1c61c, 0x55f038b237591ed3}, {0xdf01e85f912e37a3, 0x6b6c46dec52f6688},
+	{0x8b61313bbabce2c6, 0x2323ac4b3b3da015}, {0xae397d8aa96c1b77, 0xabec975e0a0d081a},
+	{0xd9c7dced53c72255, 0x96e7bd358c904a21}, {0x881cea14545c7575, 0x7e50d64177da2e54},
+	{0xaa242499697392d2, 0xdde50bd1d5d0b9e9}, {0xd4ad2dbfc3d07787, 0x955e4ec64b44e864},
+	{0x84ec3c97da624ab4, 0xbd5af13bef0b113e}, {0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e},
+	{0xcfb11ead453994ba, 0x67de18eda5814af2}, {0x81ceb32c4b43fcf4, 0x80eacf948770ced7},
+	{0xa2425ff75e14fc31, 0xa1258379a94d028d}, {0xcad2f7f5359a3b3e, 0x096ee45813a04330},
+	{0xfd87b5f28300ca0d, 0x8bca9d6e188853fc}, {0x9e74d1b791e07e48, 0x775ea264cf55347d},
+	{0xc612062576589dda, 0x95364afe032a819d}, {0xf79687aed3eec551, 0x3a83ddbd83f52204},
+	{0x9abe14cd44753b52, 0xc4926a9672793542}, {0xc16d9a0095928a27, 0x75b7053c0f178293},
+	{0xf1c90080baf72cb1, 0x5324c68b12dd6338}, {0x971da05074da7bee, 0xd3f6fc16ebca5e03},
+	{0xbce5086492111aea, 0x88f4bb1ca6bcf584}, {0xec1e4a7db69561a5, 0x2b31e9e3d06c32e5},
+	{0x9392ee8e921d5d07, 0x3aff322e62439fcf}, {0xb877aa3236a4b449, 0x09befeb9fad487c2},
+	{0xe69594bec44de15b, 0x4c2ebe687989a9b3}, {0x901d7cf73ab0acd9, 0x0f9d37014bf60a10},
+	{0xb424dc35095cd80f, 0x538484c19ef38c94}, {0xe12e13424bb40e13, 0x2865a5f206b06fb9},
+	{0x8cbccc096f5088cb, 0xf93f87b7442e45d3}, {0xafebff0bcb24aafe, 0xf78f69a51539d748},
+	{0xdbe6fecebdedd5be, 0xb573440e5a884d1b}, {0x89705f4136b4a597, 0x31680a88f8953030},
+	{0xabcc77118461cefc, 0xfdc20d2b36ba7c3d}, {0xd6bf94d5e57a42bc, 0x3d32907604691b4c},
+	{0x8637bd05af6c69b5, 0xa63f9a49c2c1b10f}, {0xa7c5ac471b478423, 0x0fcf80dc33721d53},
+	{0xd1b71758e219652b, 0xd3c36113404ea4a8}, {0x83126e978d4fdf3b, 0x645a1cac083126e9},
+	{0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a3}, {0xcccccccccccccccc, 0xcccccccccccccccc},
+	{0x8000000000000000, 0x0000000000000000}, {0xa000000000000000, 0x0000000000000000},
+	{0xc800000000000000, 0x0000000000000000}, {0xfa00000000000000, 0x0000000000000000},
+	{0x9c40000000000000, 0x0000000000000000}, {0xc350000000000000, 0x0000000000000000},
+	{0xf424000000000000, 0x0000000000000000}, {0x9896800000000000, 0x0000000000000000},
+	{0xbebc200000000000, 0x0000000000000000}, {0xee6b280000000000, 0x0000000000000000},
+	{0x9502f90000000000, 0x0000000000000000}, {0xba43b74000000000, 0x0000000000000000},
+	{0xe8d4a51000000000, 0x0000000000000000}, {0x9184e72a00000000, 0x0000000000000000},
+	{0xb5e620f480000000, 0x0000000000000000}, {0xe35fa931a0000000, 0x0000000000000000},
+	{0x8e1bc9bf04000000, 0x0000000000000000}, {0xb1a2bc2ec5000000, 0x0000000000000000},
+	{0xde0b6b3a76400000, 0x0000000000000000}, {0x8ac7230489e80000, 0x0000000000000000},
+	{0xad78ebc5ac620000, 0x0000000000000000}, {0xd8d726b7177a8000, 0x0000000000000000},
+	{0x878678326eac9000, 0x0000000000000000}, {0xa968163f0a57b400, 0x0000000000000000},
+	{0xd3c21bcecceda100, 0x0000000000000000}, {0x84595161401484a0, 0x0000000000000000},
+	{0xa56fa5b99019a5c8, 0x0000000000000000}, {0xcecb8f27f4200f3a, 0x0000000000000000},
+	{0x813f3978f8940984, 0x4000000000000000}, {0xa18f07d736b90be5, 0x5000000000000000},
+	{0xc9f2c9cd04674ede, 0xa400000000000000}, {0xfc6f7c4045812296, 0x4d00000000000000},
+	{0x9dc5ada82b70b59d, 0xf020000000000000}, {0xc5371912364ce305, 0x6c28000000000000},
+	{0xf684df56c3e01bc6, 0xc732000000000000}, {0x9a130b963a6c115c, 0x3c7f400000000000},
+	{0xc097ce7bc90715b3, 0x4b9f100000000000}, {0xf0bdc21abb48db20, 0x1e86d40000000000},
+	{0x96769950b50d88f4, 0x1314448000000000}, {0xbc143fa4e250eb31, 0x17d955a000000000},
+	{0xeb194f8e1ae525fd, 0x5dcfab0800000000}, {0x92efd1b8d0cf37be, 0x5aa1cae500000000},
+	{0xb7abc627050305ad, 0xf14a3d9e40000000}, {0xe596b7b0c643c719, 0x6d9ccd05d0000000},
+	{0x8f7e32ce7bea5c6f, 0xe4820023a2000000}, {0xb35dbf821ae4f38b, 0xdda2802c8a800000},
+	{0xe0352f62a19e306e, 0xd50b2037ad200000}, {0x8c213d9da502de45, 0x4526f422cc340000},
+	{0xaf298d050e4395d6, 0x9670b12b7f410000}, {0xdaf3f04651d47b4c, 0x3c0cdd765f114000},
+	{0x88d8762bf324cd0f, 0xa5880a69fb6ac800}, {0xab0e93b6efee0053, 0x8eea0d047a457a00},
+	{0xd5d238a4abe98068, 0x72a4904598d6d880}, {0x85a36366eb71f041, 0x47a6da2b7f864750},
+	{0xa70c3c40a64e6c51, 0x999090b65f67d924}, {0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d},
+	{0x82818f1281ed449f, 0xbff8f10e7a8921a4}, {0xa321f2d7226895c7, 0xaff72d52192b6a0d},
+	{0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490}, {0xfee50b7025c36a08, 0x02f236d04753d5b4},
+	{0x9f4f2726179a2245, 0x01d762422c946590}, {0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5},
+	{0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2}, {0x9b934c3b330c8577, 0x63cc55f49f88eb2f},
+	{0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb}, {0xf316271c7fc3908a, 0x8bef464e3945ef7a},
+	{0x97edd871cfda3a56, 0x97758bf0e3cbb5ac}, {0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317},
+	{0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd}, {0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a},
+	{0xb975d6b6ee39e436, 0xb3e2fd538e122b44}, {0xe7d34c64a9c85d44, 0x60dbbca87196b616},
+	{0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd}, {0xb51d13aea4a488dd, 0x6babab6398bdbe41},
+	{0xe264589a4dcdab14, 0xc696963c7eed2dd1}, {0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2},
+	{0xb0de65388cc8ada8, 0x3b25a55f43294bcb}, {0xdd15fe86affad912, 0x49ef0eb713f39ebe},
+	{0x8a2dbf142dfcc7ab, 0x6e3569326c784337}, {0xacb92ed9397bf996, 0x49c2c37f07965404},
+	{0xd7e77a8f87daf7fb, 0xdc33745ec97be906}, {0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3},
+	{0xa8acd7c0222311bc, 0xc40832ea0d68ce0c}, {0xd2d80db02aabd62b, 0xf50a3fa490c30190},
+	{0x83c7088e1aab65db, 0x792667c6da79e0fa}, {0xa4b8cab1a1563f52, 0x577001b891185938},
+	{0xcde6fd5e09abcf26, 0xed4c0226b55e6f86}, {0x80b05e5ac60b6178, 0x544f8158315b05b4},
+	{0xa0dc75f1778e39d6, 0x696361ae3db1c721}, {0xc913936dd571c84c, 0x03bc3a19cd1e38e9},
+	{0xfb5878494ace3a5f, 0x04ab48a04065c723}, {0x9d174b2dcec0e47b, 0x62eb0d64283f9c76},
+	{0xc45d1df942711d9a, 0x3ba5d0bd324f8394}, {0xf5746577930d6500, 0xca8f44ec7ee36479},
+	{0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb}, {0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e},
+	{0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e}, {0x95d04aee3b80ece5, 0xbba1f1d158724a12},
+	{0xbb445da9ca61281f, 0x2a8a6e45ae8edc97}, {0xea1575143cf97226, 0xf52d09d71a3293bd},
+	{0x924d692ca61be758, 0x593c2626705f9c56}, {0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c},
+	{0xe498f455c38b997a, 0x0b6dfb9c0f956447}, {0x8edf98b59a373fec, 0x4724bd4189bd5eac},
+	{0xb2977ee300c50fe7, 0x58edec91ec2cb657}, {0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed},
+	{0x8b865b215899f46c, 0xbd79e0d20082ee74}, {0xae67f1e9aec07187, 0xecd8590680a3aa11},
+	{0xda01ee641a708de9, 0xe80e6f4820cc9495}, {0x884134fe908658b2, 0x3109058d147fdcdd},
+	{0xaa51823e34a7eede, 0xbd4b46f0599fd415}, {0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a},
+	{0x850fadc09923329e, 0x03e2cf6bc604ddb0}, {0xa6539930bf6bff45, 0x84db8346b786151c},
+	{0xcfe87f7cef46ff16, 0xe612641865679a63}, {0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e},
+	{0xa26da3999aef7749, 0xe3be5e330f38f09d}, {0xcb090c8001ab551c, 0x5cadf5bfd3072cc5},
+	{0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6}, {0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa},
+	{0xc646d63501a1511d, 0xb281e1fd541501b8}, {0xf7d88bc24209a565, 0x1f225a7ca91a4226},
+	{0x9ae757596946075f, 0x3375788de9b06958}, {0xc1a12d2fc3978937, 0x0052d6b1641c83ae},
+	{0xf209787bb47d6b84, 0xc0678c5dbd23a49a}, {0x9745eb4d50ce6332, 0xf840b7ba963646e0},
+	{0xbd176620a501fbff, 0xb650e5a93bc3d898}, {0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe},
+	{0x93ba47c980e98cdf, 0xc66f336c36b10137}, {0xb8a8d9bbe123f017, 0xb80b0047445d4184},
+	{0xe6d3102ad96cec1d, 0xa60dc059157491e5}, {0x9043ea1ac7e41392, 0x87c89837ad68db2f},
+	{0xb454e4a179dd1877, 0x29babe4598c311fb}, {0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a},
+	{0x8ce2529e2734bb1d, 0x1899e4a65f58660c}, {0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f},
+	{0xdc21a1171d42645d, 0x76707543f4fa1f73}, {0x899504ae72497eba, 0x6a06494a791c53a8},
+	{0xabfa45da0edbde69, 0x0487db9d17636892}, {0xd6f8d7509292d603, 0x45a9d2845d3c42b6},
+	{0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2}, {0xa7f26836f282b732, 0x8e6cac7768d7141e},
+	{0xd1ef0244af2364ff, 0x3207d795430cd926}, {0x8335616aed761f1f, 0x7f44e6bd49e807b8},
+	{0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6}, {0xcd036837130890a1, 0x36dba887c37a8c0f},
+	{0x802221226be55a64, 0xc2494954da2c9789}, {0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c},
+	{0xc83553c5c8965d3d, 0x6f92829494e5acc7}, {0xfa42a8b73abbf48c, 0xcb772339ba1f17f9},
+	{0x9c69a97284b578d7, 0xff2a760414536efb}, {0xc38413cf25e2d70d, 0xfef5138519684aba},
+	{0xf46518c2ef5b8cd1, 0x7eb258665fc25d69}, {0x98bf2f79d5993802, 0xef2f773ffbd97a61},
+	{0xbeeefb584aff8603, 0xaafb550ffacfd8fa}, {0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38},
+	{0x952ab45cfa97a0b2, 0xdd945a747bf26183}, {0xba756174393d88df, 0x94f971119aeef9e4},
+	{0xe912b9d1478ceb17, 0x7a37cd5601aab85d}, {0x91abb422ccb812ee, 0xac62e055c10ab33a},
+	{0xb616a12b7fe617aa, 0x577b986b314d6009}, {0xe39c49765fdf9d94, 0xed5a7e85fda0b80b},
+	{0x8e41ade9fbebc27d, 0x14588f13be847307}, {0xb1d219647ae6b31c, 0x596eb2d8ae258fc8},
+	{0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb}, {0x8aec23d680043bee, 0x25de7bb9480d5854},
+	{0xada72ccc20054ae9, 0xaf561aa79a10ae6a}, {0xd910f7ff28069da4, 0x1b2ba1518094da04},
+	{0x87aa9aff79042286, 0x90fb44d2f05d0842}, {0xa99541bf57452b28, 0x353a1607ac744a53},
+	{0xd3fa922f2d1675f2, 0x42889b8997915ce8}, {0x847c9b5d7c2e09b7, 0x69956135febada11},
+	{0xa59bc234db398c25, 0x43fab9837e699095}, {0xcf02b2c21207ef2e, 0x94f967e45e03f4bb},
+	{0x8161afb94b44f57d, 0x1d1be0eebac278f5}, {0xa1ba1ba79e1632dc, 0x6462d92a69731732},
+	{0xca28a291859bbf93, 0x7d7b8f7503cfdcfe}, {0xfcb2cb35e702af78, 0x5cda735244c3d43e},
+	{0x9defbf01b061adab, 0x3a0888136afa64a7}, {0xc56baec21c7a1916, 0x088aaa1845b8fdd0},
+	{0xf6c69a72a3989f5b, 0x8aad549e57273d45}, {0x9a3c2087a63f6399, 0x36ac54e2f678864b},
+	{0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd}, {0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5},
+	{0x969eb7c47859e743, 0x9f644ae5a4b1b325}, {0xbc4665b596706114, 0x873d5d9f0dde1fee},
+	{0xeb57ff22fc0c7959, 0xa90cb506d155a7ea}, {0x9316ff75dd87cbd8, 0x09a7f12442d588f2},
+	{0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f}, {0xe5d3ef282a242e81, 0x8f1668c8a86da5fa},
+	{0x8fa475791a569d10, 0xf96e017d694487bc}, {0xb38d92d760ec4455, 0x37c981dcc395a9ac},
+	{0xe070f78d3927556a, 0x85bbe253f47b1417}, {0x8c469ab843b89562, 0x93956d7478ccec8e},
+	{0xaf58416654a6babb, 0x387ac8d1970027b2}, {0xdb2e51bfe9d0696a, 0x06997b05fcc0319e},
+	{0x88fcf317f22241e2, 0x441fece3bdf81f03}, {0xab3c2fddeeaad25a, 0xd527e81cad7626c3},
+	{0xd60b3bd56a5586f1, 0x8a71e223d8d3b074}, {0x85c7056562757456, 0xf6872d5667844e49},
+	{0xa738c6bebb12d16c, 0xb428f8ac016561db}, {0xd106f86e69d785c7, 0xe13336d701beba52},
+	{0x82a45b450226b39c, 0xecc0024661173473}, {0xa34d721642b06084, 0x27f002d7f95d0190},
+	{0xcc20ce9bd35c78a5, 0x31ec038df7b441f4}, {0xff290242c83396ce, 0x7e67047175a15271},
+	{0x9f79a169bd203e41, 0x0f0062c6e984d386}, {0xc75809c42c684dd1, 0x52c07b78a3e60868},
+	{0xf92e0c3537826145, 0xa7709a56ccdf8a82}, {0x9bbcc7a142b17ccb, 0x88a66076400bb691},
+	{0xc2abf989935ddbfe, 0x6acff893d00ea435}, {0xf356f7ebf83552fe, 0x0583f6b8c4124d43},
+	{0x98165af37b2153de, 0xc3727a337a8b704a}, {0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c},
+	{0xeda2ee1c7064130c, 0x1162def06f79df73}, {0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8},
+	{0xb9a74a0637ce2ee1, 0x6d953e2bd7173692}, {0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437},
+	{0x910ab1d4db9914a0, 0x1d9c9892400a22a2}, {0xb54d5e4a127f59c8, 0x2503beb6d00cab4b},
+	{0xe2a0b5dc971f303a, 0x2e44ae64840fd61d}, {0x8da471a9de737e24, 0x5ceaecfed289e5d2},
+	{0xb10d8e1456105dad, 0x7425a83e872c5f47}, {0xdd50f1996b947518, 0xd12f124e28f77719},
+	{0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f}, {0xace73cbfdc0bfb7b, 0x636cc64d1001550b},
+	{0xd8210befd30efa5a, 0x3c47f7e05401aa4e}, {0x8714a775e3e95c78, 0x65acfaec34810a71},
+	{0xa8d9d1535ce3b396, 0x7f1839a741a14d0d}, {0xd31045a8341ca07c, 0x1ede48111209a050},
+	{0x83ea2b892091e44d, 0x934aed0aab460432}, {0xa4e4b66b68b65d60, 0xf81da84d5617853f},
+	{0xce1de40642e3f4b9, 0x36251260ab9d668e}, {0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019},
+	{0xa1075a24e4421730, 0xb24cf65b8612f81f}, {0xc94930ae1d529cfc, 0xdee033f26797b627},
+	{0xfb9b7cd9a4a7443c, 0x169840ef017da3b1}, {0x9d412e0806e88aa5, 0x8e1f289560ee864e},
+	{0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2}, {0xf5b5d7ec8acb58a2, 0xae10af696774b1db},
+	{0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29}, {0xbff610b0cc6edd3f, 0x17fd090a58d32af3},
+	{0xeff394dcff8a948e, 0xddfc4b4cef07f5b0}, {0x95f83d0a1fb69cd9, 0x4abdaf101564f98e},
+	{0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1}, {0xea53df5fd18d5513, 0x84c86189216dc5ed},
+	{0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4}, {0xb7118682dbb66a77, 0x3fbc8c33221dc2a1},
+	{0xe4d5e82392a40515, 0x0fabaf3feaa5334a}, {0x8f05b1163ba6832d, 0x29cb4d87f2a7400e},
+	{0xb2c71d5bca9023f8, 0x743e20e9ef511012}, {0xdf78e4b2bd342cf6, 0x914da9246b255416},
+	{0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e}, {0xae9672aba3d0c320, 0xa184ac2473b529b1},
+	{0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e}, {0x8865899617fb1871, 0x7e2fa67c7a658892},
+	{0xaa7eebfb9df9de8d, 0xddbb901b98feeab7}, {0xd51ea6fa85785631, 0x552a74227f3ea565},
+	{0x8533285c936b35de, 0xd53a88958f87275f}, {0xa67ff273b8460356, 0x8a892abaf368f137},
+	{0xd01fef10a657842c, 0x2d2b7569b0432d85}, {0x8213f56a67f6b29b, 0x9c3b29620e29fc73},
+	{0xa298f2c501f45f42, 0x8349f3ba91b47b8f}, {0xcb3f2f7642717713, 0x241c70a936219a73},
+	{0xfe0efb53d30dd4d7, 0xed238cd383aa0110}, {0x9ec95d1463e8a506, 0xf4363804324a40aa},
+	{0xc67bb4597ce2ce48, 0xb143c6053edcd0d5}, {0xf81aa16fdc1b81da, 0xdd94b7868e94050a},
+	{0x9b10a4e5e9913128, 0xca7cf2b4191c8326}, {0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0},
+	{0xf24a01a73cf2dccf, 0xbc633b39673c8cec}, {0x976e41088617ca01, 0xd5be0503e085d813},
+	{0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18}, {0xec9c459d51852ba2, 0xddf8e7d60ed1219e},
+	{0x93e1ab8252f33b45, 0xcabb90e5c942b503}, {0xb8da1662e7b00a17, 0x3d6a751f3b936243},
+	{0xe7109bfba19c0c9d, 0x0cc512670a783ad4}, {0x906a617d450187e2, 0x27fb2b80668b24c5},
+	{0xb484f9dc9641e9da, 0xb1f9f660802dedf6}, {0xe1a63853bbd26451, 0x5e7873f8a0396973},
+	{0x8d07e33455637eb2, 0xdb0b487b6423e1e8}, {0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62},
+	{0xdc5c5301c56b75f7, 0x7641a140cc7810fb}, {0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d},
+	{0xac2820d9623bf429, 0x546345fa9fbdcd44}, {0xd732290fbacaf133, 0xa97c177947ad4095},
+	{0x867f59a9d4bed6c0, 0x49ed8eabcccc485d}, {0xa81f301449ee8c70, 0x5c68f256bfff5a74},
+	{0xd226fc195c6a2f8c, 0x73832eec6fff3111}, {0x83585d8fd9c25db7, 0xc831fd53c5ff7eab},
+	{0xa42e74f3d032f525, 0xba3e7ca8b77f5e55}, {0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb},
+	{0x80444b5e7aa7cf85, 0x7980d163cf5b81b3}, {0xa0555e361951c366, 0xd7e105bcc332621f},
+	{0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7}, {0xfa856334878fc150, 0xb14f98f6f0feb951},
+	{0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3}, {0xc3b8358109e84f07, 0x0a862f80ec4700c8},
+	{0xf4a642e14c6262c8, 0xcd27bb612758c0fa}, {0x98e7e9cccfbd7dbd, 0x8038d51cb897789c},
+	{0xbf21e44003acdd2c, 0xe0470a63e6bd56c3}, {0xeeea5d5004981478, 0x1858ccfce06cac74},
+	{0x95527a5202df0ccb, 0x0f37801e0c43ebc8}, {0xbaa718e68396cffd, 0xd30560258f54e6ba},
+	{0xe950df20247c83fd, 0x47c6b82ef32a2069}, {0x91d28b7416cdd27e, 0x4cdc331d57fa5441},
+	{0xb6472e511c81471d, 0xe0133fe4adf8e952}, {0xe3d8f9e563a198e5, 0x58180fddd97723a6},
+	{0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648}, {0xb201833b35d63f73, 0x2cd2cc6551e513da},
+	{0xde81e40a034bcf4f, 0xf8077f7ea65e58d1}, {0x8b112e86420f6191, 0xfb04afaf27faf782},
+	{0xadd57a27d29339f6, 0x79c5db9af1f9b563}, {0xd94ad8b1c7380874, 0x18375281ae7822bc},
+	{0x87cec76f1c830548, 0x8f2293910d0b15b5}, {0xa9c2794ae3a3c69a, 0xb2eb3875504ddb22},
+	{0xd433179d9c8cb841, 0x5fa60692a46151eb}, {0x849feec281d7f328, 0xdbc7c41ba6bcd333},
+	{0xa5c7ea73224deff3, 0x12b9b522906c0800}, {0xcf39e50feae16bef, 0xd768226b34870a00},
+	{0x81842f29f2cce375, 0xe6a1158300d46640}, {0xa1e53af46f801c53, 0x60495ae3c1097fd0},
+	{0xca5e89b18b602368, 0x385bb19cb14bdfc4}, {0xfcf62c1dee382c42, 0x46729e03dd9ed7b5},
+	{0x9e19db92b4e31ba9, 0x6c07a2c26a8346d1},
+};
+
+static const char digit_pairs[200] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/* Exact powers of ten for the fast path of str_parse_f64() */
+static const f64 f64_pow10[23] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+#define F64_MANTISSA_BITS 52
+#define F64_MANTISSA_MASK ((1ull << F64_MANTISSA_BITS) - 1)
+#define F64_EXPONENT_BIAS 1023
+#define F64_SIGN_BIT (1ull << 63)
+#define U64_MASK63 ((1ull << 63) - 1)
+
+/* Full 64x64 bit product, returns the high half */
+static inline
+u64 mul_u64(u64 a, u64 b, u64* lo){
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 r = (unsigned __int128)a * b;
+	*lo = (u64)r;
+	return (u64)(r >> 64);
+#else
+	u64 a_lo = (u32)a, a_hi = a >> 32;
+	u64 b_lo = (u32)b, b_hi = b >> 32;
+	u64 p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+	u64 mid = (p0 >> 32) + (u32)p1 + (u32)p2;
+	*lo = (mid << 32) | (u32)p0;
+	return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
+
+static inline
+int u64_clz(u64 x){
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long idx;
+	_BitScanReverse64(&idx, x);
+	return 63 - (int)idx;
+#else
+	return __builtin_clzll(x);
+#endif
+}
+
+isize fmt_u64(byte* out, u64 v){
+	byte buf[FMT_INT_MAX];
+	isize i = FMT_INT_MAX;
+	while(v >= 100){
+		u64 q = v / 100;
+		isize r = (isize)(v - q * 100);
+		i -= 2;
+		memcpy(&buf[i], &digit_pairs[r * 2], 2);
+		v = q;
+	}
+	if(v >= 10){
+		i -= 2;
+		memcpy(&buf[i], &digit_pairs[v * 2], 2);
+	}
+	else {
+		i -= 1;
+		buf[i] = (byte)('0' + v);
+	}
+	memcpy(out, &buf[i], FMT_INT_MAX - i);
+	return FMT_INT_MAX - i;
+}
+
+isize fmt_i64(byte* out, i64 v){
+	if(v < 0){
+		out[0] = '-';
+		return 1 + fmt_u64(&out[1], (u64)0 - (u64)v);
+	}
+	return fmt_u64(out, (u64)v);
+}
+
+/* Shortest decimal that rounds back to the same double, using Schubfach
+ * (Raffaello Giulietti, "The Schubfach way to render doubles", 2020) */
+#define SCHUBFACH_C_MIN (1ull << F64_MANTISSA_BITS)
+#define SCHUBFACH_Q_MIN (-1074)
+
+static inline
+i32 flog10_pow2(i32 q){
+	return (i32)(((i64)q * 661971961083ll) >> 41);
+}
+
+static inline
+i32 flog10_three_quarters_pow2(i32 q){
+	return (i32)(((i64)q * 661971961083ll - 274743187321ll) >> 41);
+}
+
+static inline
+i32 flog2_pow10(i32 e){
+	return (i32)(((i64)e * 1741647) >> 19);
+}
+
+/* Round to odd of g * cp, with g = g1 * 2^63 + g0 */
+static inline
+u64 schubfach_round(u64 g1, u64 g0, u64 cp){
+	u64 x0, y0;
+	u64 x1 = mul_u64(g0, cp, &x0);
+	u64 y1 = mul_u64(g1, cp, &y0);
+	u64 z = (y0 >> 1) + x1;
+	u64 vbp = y1 + (z >> 63);
+	return vbp | (((z & U64_MASK63) + U64_MASK63) >> 63);
+}
+
+/* Decimal f * 10^e closest to c * 2^q among the shortest ones in its rounding
+ * interval. `dk` corrects the exponent when c was scaled by 10. */
+static
+void schubfach(i32 q, u64 c, i32 dk, u64* f, i32* e){
+	u64 out = c & 1;
+	u64 cb = c << 2;
+	u64 cbr = cb + 2;
+	u64 cbl;
+	i32 k;
+	if(c != SCHUBFACH_C_MIN || q == SCHUBFACH_Q_MIN){
+		cbl = cb - 2;
+		k = flog10_pow2(q);
+	}
+	else {
+		cbl = cb - 1;
+		k = flog10_three_quarters_pow2(q);
+	}
+	i32 h = q + flog2_pow10(-k) + 2;
+
+	/* g = floor(10^-k * 2^(125 - flog2(10^-k))) + 1, from the 128-bit table */
+	u64 const* p = pow10_table[-k - POW10_MIN];
+	u64 g_hi = p[0] >> 2;
+	u64 g_lo = ((p[0] << 62) | (p[1] >> 2)) + 1;
+	g_hi += g_lo == 0;
+	u64 g1 = (g_hi << 1) | (g_lo >> 63);
+	u64 g0 = g_lo & U64_MASK63;
+
+	u64 vb = schubfach_round(g1, g0, cb << h);
+	u64 vbl = schubfach_round(g1, g0, cbl << h);
+	u64 vbr = schubfach_round(g1, g0, cbr << h);
+
+	u64 s = vb >> 2;
+	if(s >= 10){
+		u64 sp10 = 10 * (s / 10);
+		u64 tp10 = sp10 + 10;
+		bool upin = vbl + out <= sp10 << 2;
+		bool wpin = (tp10 << 2) + out <= vbr;
+		if(upin != wpin){
+			*f = upin ? sp10 : tp10;
+			*e = k;
+			return;
+		}
+	}
+	u64 t = s + 1;
+	bool uin = vbl + out <= s << 2;
+	bool win = (t << 2) + out <= vbr;
+	if(uin != win){
+		*f = uin ? s : t;
+		*e = k + dk;
+		return;
+	}
+	i64 cmp = (i64)(vb - ((s + t) << 1));
+	*f = (cmp < 0 || (cmp == 0 && (s & 1) == 0)) ? s : t;
+	*e = k + dk;
+}
+
+/* Finite, non-zero doubles only */
+static
+void f64_to_decimal(u64 bits, u64* f, i32* e){
+	u64 t = bits & F64_MANTISSA_MASK;
+	i32 bq = (i32)(bits >> F64_MANTISSA_BITS) & 0x7ff;
+	if(bq == 0){
+		schubfach(SCHUBFACH_Q_MIN, t, 0, f, e);
+		return;
+	}
+
+	i32 mq = -SCHUBFACH_Q_MIN + 1 - bq;
+	u64 c = SCHUBFACH_C_MIN | t;
+	/* Integers are printed as they are */
+	if(mq > 0 && mq <= F64_MANTISSA_BITS){
+		u64 fi = c >> mq;
+		if((fi << mq) == c){
+			*f = fi;
+			*e = 0;
+			return;
+		}
+	}
+	schubfach(-mq, c, 0, f, e);
+}
+
+isize fmt_f64(byte* out, f64 v){
+	u64 bits;
+	memcpy(&bits, &v, 8);
+	isize n = 0;
+	bool neg = (bits & F64_SIGN_BIT) != 0;
+	u64 abs_bits = bits & ~F64_SIGN_BIT;
+
+	if(abs_bits >= (0x7ffull << F64_MANTISSA_BITS)){
+		if(abs_bits != (0x7ffull << F64_MANTISSA_BITS)){
+			memcpy(out, "nan", 3);
+			return 3;
+		}
+		if(neg){ out[n++] = '-'; }
+		memcpy(&out[n], "inf", 3);
+		return n + 3;
+	}
+	if(neg){ out[n++] = '-'; }
+	if(abs_bits == 0){
+		out[n++] = '0';
+		return n;
+	}
+
+	u64 f;
+	i32 e;
+	f64_to_decimal(abs_bits, &f, &e);
+	while(f % 10 == 0){
+		f /= 10;
+		e += 1;
+	}
+
+	byte digits[FMT_INT_MAX];
+	i32 k = (i32)fmt_u64(digits, f);
+	/* Same layout as JavaScript: the value is 0.digits * 10^point */
+	i32 point = e + k;
+
+	if(k <= point && point <= 21){
+		memcpy(&out[n], digits, k);
+		n += k;
+		mem_set(&out[n], '0', point - k);
+		n += point - k;
+	}
+	else if(0 < point && point <= 21){
+		memcpy(&out[n], digits, point);
+		n += point;
+		out[n++] = '.';
+		memcpy(&out[n], &digits[point], k - point);
+		n += k - point;
+	}
+	else if(-6 < point && point <= 0){
+		out[n++] = '0';
+		out[n++] = '.';
+		mem_set(&out[n], '0', -point);
+		n += -point;
+		memcpy(&out[n], digits, k);
+		n += k;
+	}
+	else {
+		out[n++] = digits[0];
+		if(k > 1){
+			out[n++] = '.';
+			memcpy(&out[n], &digits[1], k - 1);
+			n += k - 1;
+		}
+		out[n++] = 'e';
+		out[n++] = point - 1 < 0 ? '-' : '+';
+		n += fmt_u64(&out[n], (u64)(point - 1 < 0 ? 1 - point : point - 1));
+	}
+	return n;
+}
+
+isize sb_append_u64(String_Builder* sb, u64 v){
+	if(!sb_grow(sb, FMT_INT_MAX)){ return -1; }
+	isize n = fmt_u64(&sb->data[sb->len], v);
+	sb->len += n;
+	return n;
+}
+
+isize sb_append_i64(String_Builder* sb, i64 v){
+	if(!sb_grow(sb, FMT_INT_MAX)){ return -1; }
+	isize n = fmt_i64(&sb->data[sb->len], v);
+	sb->len += n;
+	return n;
+}
+
+isize sb_append_f64(String_Builder* sb, f64 v){
+	if(!sb_grow(sb, FMT_F64_MAX)){ return -1; }
+	isize n = fmt_f64(&sb->data[sb->len], v);
+	sb->len += n;
+	return n;
+}
+
+static inline
+bool is_digit(byte c){
+	return (u8)(c - '0') < 10;
+}
+
+/* Check if the 8 bytes are all ASCII digits */
+static inline
+bool swar_is_8_digits(u64 x){
+	return ((x & 0xf0f0f0f0f0f0f0f0ull) | (((x + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) ==
+		0x3333333333333333ull;
+}
+
+/* Value of 8 ASCII digits loaded as a little endian word */
+static inline
+u64 swar_parse_8_digits(u64 x){
+	x -= 0x3030303030303030ull;
+	x = (x * 10 + (x >> 8)) & 0x00ff00ff00ff00ffull;
+	x = (x * 100 + (x >> 16)) & 0x0000ffff0000ffffull;
+	return (x * 10000 + (x >> 32)) & 0xffffffffull;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SWAR_DIGITS 0
+#else
+#define SWAR_DIGITS 1
+#endif
+
+/* Parse the digits in data[*pos..len], stops at anything that's not a digit.
+ * Returns false on overflow. */
+static
+bool parse_u64_digits(byte const* data, isize len, isize* pos, u64* out){
+	isize i = *pos;
+	u64 v = 0;
+	while(i < len && data[i] == '0'){ i += 1; }
+
+	/* 19 digits always fit */
+	isize end = min(len, i + 19);
+#if SWAR_DIGITS
+	while(i + 8 <= end){
+		u64 x;
+		memcpy(&x, &data[i], 8);
+		if(!swar_is_8_digits(x)){ break; }
+		v = v * 100000000 + swar_parse_8_digits(x);
+		i += 8;
+	}
+#endif
+	while(i < end && is_digit(data[i])){
+		v = v * 10 + (data[i] - '0');
+		i += 1;
+	}
+	if(i < len && is_digit(data[i])){
+		u64 d = data[i] - '0';
+		if(v > (~(u64)0 - d) / 10){ return false; }
+		v = v * 10 + d;
+		i += 1;
+		if(i < len && is_digit(data[i])){ return false; }
+	}
+
+	*pos = i;
+	*out = v;
+	return true;
+}
+
+bool str_parse_u64(String s, u64* out){
+	isize i = 0;
+	if(s.len > 0 && s.data[0] == '+'){ i += 1; }
+	if(i == s.len){ return false; }
+	u64 v;
+	if(!parse_u64_digits(s.data, s.len, &i, &v) || i != s.len){ return false; }
+	*out = v;
+	return true;
+}
+
+bool str_parse_i64(String s, i64* out){
+	isize i = 0;
+	bool neg = false;
+	if(s.len > 0 && (s.data[0] == '+' || s.data[0] == '-')){
+		neg = s.data[0] == '-';
+		i += 1;
+	}
+	if(i == s.len){ return false; }
+	u64 v;
+	if(!parse_u64_digits(s.data, s.len, &i, &v) || i != s.len){ return false; }
+	if(v > (u64)INT64_MAX + neg){ return false; }
+	*out = neg ? (i64)((u64)0 - v) : (i64)v;
+	return true;
+}
+
+/* Eisel-Lemire: rounds man * 10^exp10 using a 128-bit approximation of the
+ * power, gives up (returns false) when that's not enough to decide. Follows
+ * Nigel Tao's simplified version, which works with a rounded down table. */
+static
+bool eisel_lemire(u64 man, i32 exp10, f64* out){
+	if(exp10 < POW10_MIN || exp10 > POW10_MAX){ return false; }
+	int clz = u64_clz(man);
+	man <<= clz;
+	u64 ret_exp2 = (u64)((((i64)217706 * exp10) >> 16) + 64 + F64_EXPONENT_BIAS) - (u64)clz;
+
+	u64 const* p = pow10_table[exp10 - POW10_MIN];
+	u64 x_lo;
+	u64 x_hi = mul_u64(man, p[0], &x_lo);
+	/* The low half of the power only matters when the high product is close to
+	 * a rounding boundary */
+	if((x_hi & 0x1ff) == 0x1ff && x_lo + man < man){
+		u64 y_lo;
+		u64 y_hi = mul_u64(man, p[1], &y_lo);
+		u64 merged_hi = x_hi, merged_lo = x_lo + y_hi;
+		if(merged_lo < x_lo){ merged_hi += 1; }
+		if((merged_hi & 0x1ff) == 0x1ff && merged_lo + 1 == 0 && y_lo + man < man){ return false; }
+		x_hi = merged_hi;
+		x_lo = merged_lo;
+	}
+
+	u64 msb = x_hi >> 63;
+	u64 ret_mantissa = x_hi >> (msb + 9);
+	ret_exp2 -= 1 ^ msb;
+	/* Exactly halfway between two doubles */
+	if(x_lo == 0 && (x_hi & 0x1ff) == 0 && (ret_mantissa & 3) == 1){ return false; }
+
+	ret_mantissa += ret_mantissa & 1;
+	ret_mantissa >>= 1;
+	if((ret_mantissa >> 53) > 0){
+		ret_mantissa >>= 1;
+		ret_exp2 += 1;
+	}
+	/* Subnormals, infinities and overflow go to the slow path */
+	if(ret_exp2 - 1 >= 0x7ff - 1){ return false; }
+
+	u64 bits = (ret_exp2 << F64_MANTISSA_BITS) | (ret_mantissa & F64_MANTISSA_MASK);
+	memcpy(out, &bits, 8);
+	return true;
+}
+
+/* Slow path for the rare inputs Eisel-Lemire can't decide: exact decimal
+ * arithmetic on up to DECIMAL_DIGITS digits, scaled by powers of two until
+ * the mantissa can be read off (the algorithm from Go's strconv). */
+#define DECIMAL_DIGITS 800
+#define DECIMAL_MAX_SHIFT 60
+
+typedef struct {
+	u8 d[DECIMAL_DIGITS]; /* Digit values, not characters */
+	i32 nd;               /* Number of digits used */
+	i32 dp;               /* Decimal point */
+	bool trunc;           /* Nonzero digits were dropped */
+} Decimal;
+
+static
+void decimal_trim(Decimal* a){
+	while(a->nd > 0 && a->d[a->nd - 1] == 0){ a->nd -= 1; }
+	if(a->nd == 0){ a->dp = 0; }
+}
+
+/* Digits of a string already checked by str_parse_f64() */
+static
+void decimal_from_string(Decimal* a, String s){
+	isize i = 0;
+	bool seen_dot = false;
+	a->nd = 0;
+	a->dp = 0;
+	a->trunc = false;
+	if(s.data[0] == '+' || s.data[0] == '-'){ i += 1; }
+
+	for(; i < s.len; i += 1){
+		byte c = s.data[i];
+		if(c == '.'){
+			seen_dot = true;
+			continue;
+		}
+		if(!is_digit(c)){ break; }
+		if(a->nd == 0 && c == '0'){
+			a->dp -= seen_dot;
+			continue;
+		}
+		a->dp += !seen_dot;
+		if(a->nd < DECIMAL_DIGITS){
+			a->d[a->nd++] = c - '0';
+		}
+		else if(c != '0'){
+			a->trunc = true;
+		}
+	}
+
+	if(i < s.len){
+		i += 1;
+		bool neg = false;
+		if(s.data[i] == '+' || s.data[i] == '-'){
+			neg = s.data[i] == '-';
+			i += 1;
+		}
+		i32 e = 0;
+		for(; i < s.len; i += 1){
+			if(e < 100000){ e = e * 10 + (s.data[i] - '0'); }
+		}
+		a->dp += neg ? -e : e;
+	}
+	decimal_trim(a);
+}
+
+static
+void decimal_right_shift(Decimal* a, u32 k){
+	i32 r = 0, w = 0;
+	u64 n = 0;
+	for(; (n >> k) == 0; r += 1){
+		if(r >= a->nd){
+			if(n == 0){
+				a->nd = 0;
+				return;
+			}
+			while((n >> k) == 0){
+				n *= 10;
+				r += 1;
+			}
+			break;
+		}
+		n = n * 10 + a->d[r];
+	}
+	a->dp -= r - 1;
+
+	u64 mask = ((u64)1 << k) - 1;
+	for(; r < a->nd; r += 1){
+		u64 c = a->d[r];
+		a->d[w++] = (u8)(n >> k);
+		n = (n & mask) * 10 + c;
+	}
+	while(n > 0){
+		u64 dig = n >> k;
+		n &= mask;
+		if(w < DECIMAL_DIGITS){
+			a->d[w++] = (u8)dig;
+		}
+		else if(dig > 0){
+			a->trunc = true;
+		}
+		n *= 10;
+	}
+	a->nd = w;
+	decimal_trim(a);
+}
+
+static
+void decimal_left_shift(Decimal* a, u32 k){
+	u8 tmp[DECIMAL_DIGITS + 24];
+	i32 t = DECIMAL_DIGITS + 24;
+	u64 n = 0;
+	for(i32 r = a->nd - 1; r >= 0; r -= 1){
+		n += (u64)a->d[r] << k;
+		u64 q = n / 10;
+		tmp[--t] = (u8)(n - q * 10);
+		n = q;
+	}
+	while(n > 0){
+		u64 q = n / 10;
+		tmp[--t] = (u8)(n - q * 10);
+		n = q;
+	}
+
+	i32 count = DECIMAL_DIGITS + 24 - t;
+	a->dp += count - a->nd;
+	if(count > DECIMAL_DIGITS){
+		for(i32 i = DECIMAL_DIGITS; i < count; i += 1){
+			if(tmp[t + i] != 0){ a->trunc = true; }
+		}
+		count = DECIMAL_DIGITS;
+	}
+	memcpy(a->d, &tmp[t], count);
+	a->nd = count;
+	decimal_trim(a);
+}
+
+static
+void decimal_shift(Decimal* a, i32 k){
+	if(a->nd == 0){ return; }
+	while(k > DECIMAL_MAX_SHIFT){
+		decimal_left_shift(a, DECIMAL_MAX_SHIFT);
+		k -= DECIMAL_MAX_SHIFT;
+	}
+	while(k < -DECIMAL_MAX_SHIFT){
+		decimal_right_shift(a, DECIMAL_MAX_SHIFT);
+		k += DECIMAL_MAX_SHIFT;
+	}
+	if(k > 0){ decimal_left_shift(a, k); }
+	if(k < 0){ decimal_right_shift(a, -k); }
+}
+
+/* Integer part, rounded half to even */
+static
+u64 decimal_rounded_integer(Decimal* a){
+	if(a->dp > 20){ return ~(u64)0; }
+	i32 i = 0;
+	u64 n = 0;
+	for(; i < a->dp && i < a->nd; i += 1){
+		n = n * 10 + a->d[i];
+	}
+	for(; i < a->dp; i += 1){
+		n *= 10;
+	}
+
+	bool round_up = false;
+	if(a->dp >= 0 && a->dp < a->nd){
+		if(a->d[a->dp] == 5 && a->dp + 1 == a->nd){
+			round_up = a->trunc || (a->dp > 0 && (a->d[a->dp - 1] & 1));
+		}
+		else {
+			round_up = a->d[a->dp] >= 5;
+		}
+	}
+	return n + round_up;
+}
+
+static
+u64 decimal_to_f64_bits(Decimal* a){
+	static const u8 powtab[9] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+	const u64 inf = 0x7ffull << F64_MANTISSA_BITS;
+
+	if(a->nd == 0 || a->dp < -330){ return 0; }
+	if(a->dp > 310){ return inf; }
+
+	/* Scale by powers of two until the value is in [0.5, 1) */
+	i32 exp = 0;
+	while(a->dp > 0){
+		i32 n = a->dp >= 9 ? 27 : powtab[a->dp];
+		decimal_shift(a, -n);
+		exp += n;
+	}
+	while(a->dp < 0 || (a->dp == 0 && a->d[0] < 5)){
+		i32 n = -a->dp >= 9 ? 27 : powtab[-a->dp];
+		decimal_shift(a, n);
+		exp -= n;
+	}
+	/* Doubles are in [1, 2) */
+	exp -= 1;
+
+	if(exp < 1 - F64_EXPONENT_BIAS){
+		i32 n = 1 - F64_EXPONENT_BIAS - exp;
+		decimal_shift(a, -n);
+		exp += n;
+	}
+	if(exp + F64_EXPONENT_BIAS >= 0x7ff){ return inf; }
+
+	decimal_shift(a, 1 + F64_MANTISSA_BITS);
+	u64 mant = decimal_rounded_integer(a);
+	if(mant == (2ull << F64_MANTISSA_BITS)){
+		mant >>= 1;
+		exp += 1;
+		if(exp + F64_EXPONENT_BIAS >= 0x7ff){ return inf; }
+	}
+	/* Subnormal */
+	if((mant & (1ull << F64_MANTISSA_BITS)) == 0){
+		exp = -F64_EXPONENT_BIAS;
+	}
+	return (mant & F64_MANTISSA_MASK) | ((u64)(exp + F64_EXPONENT_BIAS) << F64_MANTISSA_BITS);
+}
+
+static
+bool str_eq_ascii_fold(byte const* data, isize len, cstring lower){
+	isize i = 0;
+	for(; i < len && lower[i] != 0; i += 1){
+		if((data[i] | 0x20) != lower[i]){ return false; }
+	}
+	return i == len && lower[i] == 0;
+}
+
+bool str_parse_f64(String s, f64* out){
+	isize i = 0;
+	bool neg = false;
+	if(s.len > 0 && (s.data[0] == '+' || s.data[0] == '-')){
+		neg = s.data[0] == '-';
+		i += 1;
+	}
+
+	u64 bits;
+	byte const* rest = &s.data[i];
+	if(str_eq_ascii_fold(rest, s.len - i, "inf") || str_eq_ascii_fold(rest, s.len - i, "infinity")){
+		bits = (0x7ffull << F64_MANTISSA_BITS) | (neg ? F64_SIGN_BIT : 0);
+		memcpy(out, &bits, 8);
+		return true;
+	}
+	if(str_eq_ascii_fold(rest, s.len - i, "nan")){
+		bits = 0x7ff8000000000000ull;
+		memcpy(out, &bits, 8);
+		return true;
+	}
+
+	/* Up to 19 significant digits go in `w`, the rest only move the exponent */
+	u64 w = 0;
+	i32 digits = 0;
+	i64 exp10 = 0;
+	bool any = false, truncated = false;
+	for(; i < s.len && is_digit(s.data[i]); i += 1){
+		u64 d = s.data[i] - '0';
+		any = true;
+		if(digits == 0 && d == 0){ continue; }
+		if(digits < 19){
+			w = w * 10 + d;
+			digits += 1;
+		}
+		else {
+			exp10 += 1;
+			truncated |= d != 0;
+		}
+	}
+	if(i < s.len && s.data[i] == '.'){
+		for(i += 1; i < s.len && is_digit(s.data[i]); i += 1){
+			u64 d = s.data[i] - '0';
+			any = true;
+			if(digits == 0 && d == 0){
+				exp10 -= 1;
+			}
+			else if(digits < 19){
+				w = w * 10 + d;
+				digits += 1;
+				exp10 -= 1;
+			}
+			else {
+				truncated |= d != 0;
+			}
+		}
+	}
+	if(!any){ return false; }
+
+	if(i < s.len && (s.data[i] | 0x20) == 'e'){
+		i += 1;
+		bool exp_neg = false;
+		if(i < s.len && (s.data[i] == '+' || s.data[i] == '-')){
+			exp_neg = s.data[i] == '-';
+			i += 1;
+		}
+		if(i == s.len){ return false; }
+		i64 e = 0;
+		for(; i < s.len && is_digit(s.data[i]); i += 1){
+			if(e < 100000){ e = e * 10 + (s.data[i] - '0'); }
+		}
+		exp10 += exp_neg ? -e : e;
+	}
+	if(i != s.len){ return false; }
+
+	f64 v;
+	if(w == 0 || exp10 < POW10_MIN){
+		v = 0.0;
+	}
+	else if(exp10 > 308){
+		bits = 0x7ffull << F64_MANTISSA_BITS;
+		memcpy(&v, &bits, 8);
+	}
+	else if(!truncated && w <= (1ull << 53) && exp10 >= -22 && exp10 <= 22){
+		/* Both are exact, so is the rounded result (Clinger's fast path) */
+		v = (f64)w;
+		v = exp10 < 0 ? v / f64_pow10[-exp10] : v * f64_pow10[exp10];
+	}
+	else {
+		f64 upper;
+		bool ok = eisel_lemire(w, (i32)exp10, &v);
+		/* Dropped digits are between w and w + 1, both have to agree */
+		if(ok && truncated){
+			ok = eisel_lemire(w + 1, (i32)exp10, &upper) && upper == v;
+		}
+		if(!ok){
+			Decimal dec;
+			decimal_from_string(&dec, s);
+			bits = decimal_to_f64_bits(&dec);
+			memcpy(&v, &bits, 8);
+		}
+	}
+
+	*out = neg ? -v : v;
+	return true;
+}
+
+#undef POW10_MIN
+#undef POW10_MAX
+#undef F64_MANTISSA_BITS
+#undef F64_MANTISSA_MASK
+#undef F64_EXPONENT_BIAS
+#undef F64_SIGN_BIT
+#undef U64_MASK63
+#undef SCHUBFACH_C_MIN
+#undef SCHUBFACH_Q_MIN
+#undef SWAR_DIGITS
+#undef DECIMAL_DIGITS
+#undef DECIMAL_MAX_SHIFT
+
+//// Format ////////////////////////////////////////////////////////////////////
+/* Builder writers borrow the builder's buffer as their window and only touch
+ * the builder itself when it has to grow and on flush. Stream writers send
+ * the window to the stream whenever it fills up. */
+Format_Writer fmt_writer_builder(String_Builder* sb){
+	Format_Writer w = {0};
+	w.sb = sb;
+	w.buf = sb->data;
+	w.len = sb->len;
+	w.cap = sb->cap;
+	return w;
+}
+
+Format_Writer fmt_writer_stream(IO_Stream s, byte* buf, isize buflen){
+	debug_assert(buflen >= FMT_F64_MAX, "Format buffer is too small");
+	Format_Writer w = {0};
+	w.stream = s;
+	w.buf = buf;
+	w.cap = buflen;
+	return w;
+}
+
+static
+void fmt_writer_stream_out(Format_Writer* w, byte const* data, isize len){
+	while(len > 0 && w->error == 0){
+		i64 n = io_write(w->stream, (byte*)data, len);
+		if(n <= 0){
+			w->error = n < 0 ? n : IO_Err_Broken_Handle;
+			return;
+		}
+		w->written += n;
+		data += n;
+		len -= n;
+	}
+}
+
+i64 fmt_writer_flush(Format_Writer* w){
+	if(w->sb != null){
+		w->written += w->len - w->sb->len;
+		w->sb->len = w->len;
+	}
+	else {
+		fmt_writer_stream_out(w, w->buf, w->len);
+		w->len = 0;
+	}
+	return w->error != 0 ? w->error : w->written;
+}
+
+/* Make room for `nbytes` in the window, returns false on error */
+static
+bool fmt_writer_room(Format_Writer* w, isize nbytes){
+	if(w->error != 0){ return false; }
+	if(w->sb != null){
+		fmt_writer_flush(w);
+		if(!sb_grow(w->sb, nbytes)){
+			w->error = IO_Err_Memory_Error;
+			return false;
+		}
+		w->buf = w->sb->data;
+		w->cap = w->sb->cap;
+		return true;
+	}
+	fmt_writer_flush(w);
+	return w->error == 0 && nbytes <= w->cap;
+}
+
+void fmt_write_bytes(Format_Writer* w, byte const* data, isize len){
+	if(len <= w->cap - w->len){
+		mem_copy(&w->buf[w->len], data, len);
+		w->len += len;
+		return;
+	}
+	if(w->sb == null && w->error == 0){
+		/* Too big for the buffer, goes straight to the stream */
+		fmt_writer_flush(w);
+		if(len >= w->cap){
+			fmt_writer_stream_out(w, data, len);
+			return;
+		}
+	}
+	if(!fmt_writer_room(w, len)){ return; }
+	mem_copy(&w->buf[w->len], data, len);
+	w->len += len;
+}
+
+/* Room for a number that's at most `nbytes` long */
+static inline
+byte* fmt_writer_reserve(Format_Writer* w, isize nbytes){
+	if(nbytes > w->cap - w->len && !fmt_writer_room(w, nbytes)){ return null; }
+	return &w->buf[w->len];
+}
+
+static
+void fmt_write_arg(Format_Writer* w, Format_Arg const* arg){
+	byte* out;
+	switch(arg->kind){
+	case Fmt_Kind_I64:
+		if((out = fmt_writer_reserve(w, FMT_INT_MAX)) != null){ w->len += fmt_i64(out, arg->i); }
+		break;
+	case Fmt_Kind_U64:
+		if((out = fmt_writer_reserve(w, FMT_INT_MAX)) != null){ w->len += fmt_u64(out, arg->u); }
+		break;
+	case Fmt_Kind_F64:
+		if((out = fmt_writer_reserve(w, FMT_F64_MAX)) != null){ w->len += fmt_f64(out, arg->f); }
+		break;
+	case Fmt_Kind_Bool:
+		if(arg->u){ fmt_write_bytes(w, (byte const*)"true", 4); }
+		else { fmt_write_bytes(w, (byte const*)"false", 5); }
+		break;
+	case Fmt_Kind_Char: {
+		byte c = (byte)arg->u;
+		fmt_write_bytes(w, &c, 1);
+	} break;
+	case Fmt_Kind_String:
+		fmt_write_bytes(w, arg->s.data, arg->s.len);
+		break;
+	case Fmt_Kind_Cstr:
+		if(arg->cs != null){ fmt_write_bytes(w, (byte const*)arg->cs, cstring_len(arg->cs)); }
+		break;
+	case Fmt_Kind_Custom:
+		arg->custom.func(w, arg->custom.value);
+		break;
+	default:
+		debug_assert(false, "Unknown format argument");
+	}
+}
+
+void fmt_write_args(Format_Writer* w, String format, Format_Arg const* args, isize nargs){
+	byte const* f = format.data;
+	isize start = 0;
+	isize arg = 0;
+	for(isize i = 0; i < format.len; i += 1){
+		if(f[i] != '{' && f[i] != '}'){ continue; }
+		fmt_write_bytes(w, &f[start], i - start);
+		start = i + 1;
+		if(i + 1 < format.len && f[i + 1] == f[i]){
+			/* Escaped brace, the second one starts the next run */
+			i += 1;
+			continue;
+		}
+		if(f[i] == '{' && i + 1 < format.len && f[i + 1] == '}'){
+			debug_assert(arg < nargs, "Format string has more '{}' than arguments");
+			if(arg < nargs){ fmt_write_arg(w, &args[arg]); }
+			arg += 1;
+			i += 1;
+			start = i + 1;
+			continue;
+		}
+		debug_assert(false, "Unmatched brace in format string");
+		start = i;
+	}
+	fmt_write_bytes(w, &f[start], format.len - start);
+	debug_assert(arg == nargs, "Format string has fewer '{}' than arguments");
+}
+
+isize sb_format_args(String_Builder* sb, String format, Format_Arg const* args, isize nargs){
+	isize start = sb->len;
+	Format_Writer w = fmt_writer_builder(sb);
+	fmt_write_args(&w, format, args, nargs);
+	i64 n = fmt_writer_flush(&w);
+	if(n < 0){
+		sb->len = start;
+		return -1;
+	}
+	return (isize)n;
 }
 
-void sb_clear(String_Builder* sb){
-	mem_set(sb, 0, max(sb->len, 1));
-	sb->len = 0;
+i64 io_format_args(IO_Stream s, byte* buf, isize buflen, String format, Format_Arg const* args, isize nargs){
+	Format_Writer w = fmt_writer_stream(s, buf, buflen);
+	fmt_write_args(&w, format, args, nargs);
+	return fmt_writer_flush(&w);
 }
 
 //// Time //////////////////////////////////////////////////////////////////////
@@ -944,3 +6091,774 @@ Mem_Allocator pool_allocator(Mem_Pool* pool){
 	};
 }
 
+
+//// Thread ////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+#include <pthread.h>
+#endif
+
+typedef struct {
+	Thread_Func func;
+	void* arg;
+	Mem_Allocator parent_allocator;
+	Thread_Context context;
+} Thread_Launch;
+
+static _Thread_local Thread_Context thread_context_;
+static _Thread_local bool thread_context_initialized_;
+
+static Console_Logger default_console_logger_;
+
+Thread_Context* thread_context(){
+	if(!thread_context_initialized_){
+		Thread_Context* ctx = &thread_context_;
+		ctx->allocator = libc_allocator();
+		ctx->logger = log_console_logger(&default_console_logger_, 0);
+
+		byte* temp = mem_new(byte, THREAD_TEMP_SIZE_DEFAULT, ctx->allocator);
+		arena_init(&ctx->temp_arena, temp, temp != null ? THREAD_TEMP_SIZE_DEFAULT : 0);
+		thread_context_initialized_ = true;
+	}
+	return &thread_context_;
+}
+
+static
+void thread_entry(Thread_Launch* launch){
+	thread_context_ = launch->context;
+	thread_context_initialized_ = true;
+	launch->func(launch->arg);
+}
+
+#if defined(TARGET_OS_LINUX)
+static
+void* thread_entry_posix(void* launch){
+	thread_entry(launch);
+	return null;
+}
+#elif defined(TARGET_OS_WINDOWS)
+static
+DWORD WINAPI thread_entry_win32(void* launch){
+	thread_entry(launch);
+	return 0;
+}
+#endif
+
+bool thread_create(Thread* t, Thread_Func func, void* arg, isize temp_size){
+	Thread_Context* parent = thread_context();
+	Mem_Allocator allocator = parent->allocator;
+	temp_size = temp_size > 0 ? temp_size : THREAD_TEMP_SIZE_DEFAULT;
+
+	Thread_Launch* launch = mem_new(Thread_Launch, 1, allocator);
+	if(launch == null){ return false; }
+	byte* temp = mem_new(byte, temp_size, allocator);
+	if(temp == null){
+		mem_free_ex(allocator, launch, sizeof(*launch), alignof(Thread_Launch));
+		return false;
+	}
+
+	launch->func = func;
+	launch->arg = arg;
+	launch->parent_allocator = allocator;
+	launch->context.allocator = parent->allocator;
+	launch->context.logger = parent->logger;
+	arena_init(&launch->context.temp_arena, temp, temp_size);
+
+	bool ok = false;
+#if defined(TARGET_OS_LINUX)
+	pthread_t handle;
+	ok = pthread_create(&handle, null, thread_entry_posix, launch) == 0;
+	t->_handle = (uintptr)handle;
+#elif defined(TARGET_OS_WINDOWS)
+	HANDLE handle = CreateThread(null, 0, thread_entry_win32, launch, 0, null);
+	ok = handle != null;
+	t->_handle = (uintptr)handle;
+#endif
+
+	if(!ok){
+		mem_free_ex(allocator, temp, temp_size, alignof(byte));
+		mem_free_ex(allocator, launch, sizeof(*launch), alignof(Thread_Launch));
+		t->_launch = null;
+		return false;
+	}
+
+	t->_launch = launch;
+	return true;
+}
+
+bool thread_join(Thread* t){
+	Thread_Launch* launch = t->_launch;
+	if(launch == null){ return false; }
+
+	bool ok = false;
+#if defined(TARGET_OS_LINUX)
+	ok = pthread_join((pthread_t)t->_handle, null) == 0;
+#elif defined(TARGET_OS_WINDOWS)
+	ok = WaitForSingleObject((HANDLE)t->_handle, INFINITE) == WAIT_OBJECT_0;
+	CloseHandle((HANDLE)t->_handle);
+#endif
+
+	Mem_Allocator allocator = launch->parent_allocator;
+	Mem_Arena* temp = &launch->context.temp_arena;
+	mem_free_ex(allocator, temp->data, temp->capacity, alignof(byte));
+	mem_free_ex(allocator, launch, sizeof(*launch), alignof(Thread_Launch));
+	t->_launch = null;
+	return ok;
+}
+
+Mem_Allocator context_push_allocator(Mem_Allocator allocator){
+	Thread_Context* ctx = thread_context();
+	Mem_Allocator previous = ctx->allocator;
+	ctx->allocator = allocator;
+	return previous;
+}
+
+void context_pop_allocator(Mem_Allocator previous){
+	thread_context()->allocator = previous;
+}
+
+Logger context_push_logger(Logger logger){
+	Thread_Context* ctx = thread_context();
+	Logger previous = ctx->logger;
+	ctx->logger = logger;
+	return previous;
+}
+
+void context_pop_logger(Logger previous){
+	thread_context()->logger = previous;
+}
+
+Mem_Allocator context_allocator(){
+	return thread_context()->allocator;
+}
+
+Logger context_logger(){
+	return thread_context()->logger;
+}
+
+Mem_Allocator temp_allocator(){
+	return arena_allocator(&thread_context()->temp_arena);
+}
+
+isize temp_begin(){
+	return thread_context()->temp_arena.offset;
+}
+
+void temp_end(isize mark){
+	Mem_Arena* arena = &thread_context()->temp_arena;
+	debug_assert(mark >= 0 && mark <= arena->offset, "Invalid temp arena mark");
+	arena->offset = mark;
+	arena->last_allocation = 0;
+}
+
+//// Epoch Reclamation ///////////////////////////////////////////////////////
+#define EPOCH_ACTIVE ((u64)1)
+
+void epoch_domain_init(Epoch_Domain* d, Mem_Allocator allocator){
+	atomic_store_explicit(&d->_epoch, 1, memory_order_relaxed);
+	atomic_store_explicit(&d->lock._state, SPINLOCK_UNLOCKED, memory_order_relaxed);
+	d->participants = null;
+	d->allocator = allocator;
+}
+
+void epoch_domain_destroy(Epoch_Domain* d){
+	debug_assert(d->participants == null, "Epoch domain still has participants");
+	d->participants = null;
+}
+
+Epoch_Participant* epoch_register(Epoch_Domain* d){
+	Epoch_Participant* p = mem_new(Epoch_Participant, 1, d->allocator);
+	if(p == null){ return null; }
+
+	p->domain = d;
+	atomic_store_explicit(&p->_local_epoch, 0, memory_order_relaxed);
+
+	spinlock_acquire(&d->lock);
+	p->next = d->participants;
+	d->participants = p;
+	spinlock_release(&d->lock);
+	return p;
+}
+
+void epoch_unregister(Epoch_Participant* p){
+	Epoch_Domain* d = p->domain;
+	epoch_barrier(p);
+
+	spinlock_acquire(&d->lock);
+	Epoch_Participant** link = &d->participants;
+	while(*link != p){
+		link = &(*link)->next;
+	}
+	*link = p->next;
+	spinlock_release(&d->lock);
+
+	for(isize i = 0; i < 3; i += 1){
+		Epoch_Limbo* l = &p->limbo[i];
+		mem_free_ex(d->allocator, l->items, l->cap * (isize)sizeof(Epoch_Retired), alignof(Epoch_Retired));
+	}
+	mem_free_ex(d->allocator, p, sizeof(*p), alignof(Epoch_Participant));
+}
+
+void epoch_enter(Epoch_Participant* p){
+	p->nesting += 1;
+	if(p->nesting > 1){ return; }
+
+	u64 e = atomic_load_explicit(&p->domain->_epoch, memory_order_relaxed);
+	atomic_store_explicit(&p->_local_epoch, (e << 1) | EPOCH_ACTIVE, memory_order_relaxed);
+	/* Announcement must be visible before any shared pointer is loaded */
+	atomic_thread_fence(memory_order_seq_cst);
+}
+
+void epoch_exit(Epoch_Participant* p){
+	debug_assert(p->nesting > 0, "Unbalanced epoch_exit()");
+	p->nesting -= 1;
+	if(p->nesting > 0){ return; }
+
+	atomic_store_explicit(&p->_local_epoch, 0, memory_order_release);
+}
+
+static
+bool epoch_try_advance(Epoch_Domain* d){
+	u64 global = atomic_load_explicit(&d->_epoch, memory_order_relaxed);
+	bool all_caught_up = true;
+
+	atomic_thread_fence(memory_order_seq_cst);
+	spinlock_acquire(&d->lock);
+	for(Epoch_Participant* it = d->participants; it != null; it = it->next){
+		u64 local = atomic_load_explicit(&it->_local_epoch, memory_order_relaxed);
+		if((local & EPOCH_ACTIVE) && (local >> 1) != global){
+			all_caught_up = false;
+			break;
+		}
+	}
+	spinlock_release(&d->lock);
+
+	if(!all_caught_up){ return false; }
+	atomic_thread_fence(memory_order_acquire);
+	/* Failing means someone else advanced it, which is just as good */
+	atomic_compare_exchange_strong_explicit(&d->_epoch, &global, global + 1, memory_order_release, memory_order_relaxed);
+	return true;
+}
+
+static
+isize epoch_limbo_free(Epoch_Limbo* l){
+	isize n = l->len;
+	for(isize i = 0; i < n; i += 1){
+		Epoch_Retired r = l->items[i];
+		mem_free_ex(r.allocator, r.ptr, r.size, r.align);
+	}
+	l->len = 0;
+	return n;
+}
+
+isize epoch_collect(Epoch_Participant* p){
+	Epoch_Domain* d = p->domain;
+	epoch_try_advance(d);
+
+	u64 global = atomic_load_explicit(&d->_epoch, memory_order_acquire);
+	isize freed = 0;
+	for(isize i = 0; i < 3; i += 1){
+		Epoch_Limbo* l = &p->limbo[i];
+		if(l->len > 0 && (l->epoch + 2) <= global){
+			freed += epoch_limbo_free(l);
+		}
+	}
+	p->retired_since_collect = 0;
+	return freed;
+}
+
+bool epoch_retire(Epoch_Participant* p, void* ptr, isize size, isize align, Mem_Allocator allocator){
+	if(ptr == null){ return true; }
+	Epoch_Domain* d = p->domain;
+
+	u64 global = atomic_load_explicit(&d->_epoch, memory_order_acquire);
+	Epoch_Limbo* l = &p->limbo[global % 3];
+	if(l->epoch != global){
+		/* Bucket holds stuff from at least 3 epochs ago, safe to free */
+		epoch_limbo_free(l);
+		l->epoch = global;
+	}
+
+	if(l->len >= l->cap){
+		isize new_cap = max(EPOCH_BATCH_SIZE, l->cap * 2);
+		Epoch_Retired* items = mem_realloc(d->allocator, l->items,
+			l->cap * (isize)sizeof(Epoch_Retired), new_cap * (isize)sizeof(Epoch_Retired), alignof(Epoch_Retired));
+		if(items == null){ return false; }
+		l->items = items;
+		l->cap = new_cap;
+	}
+
+	l->items[l->len] = (Epoch_Retired){ .ptr = ptr, .size = size, .align = align, .allocator = allocator };
+	l->len += 1;
+
+	p->retired_since_collect += 1;
+	if(p->retired_since_collect >= EPOCH_BATCH_SIZE){
+		epoch_collect(p);
+	}
+	return true;
+}
+
+void epoch_barrier(Epoch_Participant* p){
+	debug_assert(p->nesting == 0, "epoch_barrier() called inside critical section");
+	for(;;){
+		epoch_collect(p);
+		bool empty = p->limbo[0].len == 0 && p->limbo[1].len == 0 && p->limbo[2].len == 0;
+		if(empty){ break; }
+		time_sleep(time_microsecond * 50);
+	}
+}
+
+#undef EPOCH_ACTIVE
+
+//// Lock Profiling ////////////////////////////////////////////////////////////
+#if defined(ENABLE_LOCK_PROFILING) && !defined(TARGET_DISABLE_ATOMICS)
+#include <time.h>
+
+typedef struct {
+	_Atomic(void const*) lock; /* Published last, readers see a complete location */
+	Source_Location location;
+	_Atomic(u64) acquires;
+	_Atomic(u64) contended;
+	_Atomic(u64) spins;
+	_Atomic(i64) wait_ns;
+	_Atomic(i64) hold_ns;
+} Lock_Profile_Slot;
+
+typedef struct Lock_Profile_Buffer Lock_Profile_Buffer;
+struct Lock_Profile_Buffer {
+	Lock_Profile_Slot slots[LOCK_PROFILE_SLOTS];
+	_Atomic(u64) dropped;
+	Lock_Profile_Buffer* next;
+};
+
+/* Buffers are never freed so the stats of finished threads stay readable */
+static _Atomic(Lock_Profile_Buffer*) lock_profile_buffers = null;
+static _Thread_local Lock_Profile_Buffer* lock_profile_local = null;
+
+/* Only the owning thread writes its slots, so a relaxed load + store is enough
+ * and avoids a locked instruction on every acquisition. */
+#define PROFILE_BUMP(Field, Delta) \
+	atomic_store_explicit(&(Field), atomic_load_explicit(&(Field), memory_order_relaxed) + (Delta), memory_order_relaxed)
+
+static inline
+i64 lock_profile_clock(){
+#if defined(TARGET_OS_LINUX)
+	struct timespec spec = {0};
+	clock_gettime(CLOCK_MONOTONIC, &spec);
+	return (i64)spec.tv_sec * 1000000000ll + (i64)spec.tv_nsec;
+#elif defined(TARGET_OS_WINDOWS)
+	static LARGE_INTEGER freq = {0};
+	if(freq.QuadPart == 0){ QueryPerformanceFrequency(&freq); }
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	return (i64)((double)count.QuadPart * (1e9 / (double)freq.QuadPart));
+#endif
+}
+
+static
+Lock_Profile_Buffer* lock_profile_buffer(){
+	if(lock_profile_local == null){
+		Lock_Profile_Buffer* buf = calloc(1, sizeof(*buf));
+		if(buf == null){ return null; }
+		Lock_Profile_Buffer* head = atomic_load_explicit(&lock_profile_buffers, memory_order_relaxed);
+		do {
+			buf->next = head;
+		} while(!atomic_compare_exchange_weak_explicit(&lock_profile_buffers, &head, buf,
+			memory_order_release, memory_order_relaxed));
+		lock_profile_local = buf;
+	}
+	return lock_profile_local;
+}
+
+static
+Lock_Profile_Slot* lock_profile_slot(void const* lock, Source_Location loc){
+	Lock_Profile_Buffer* buf = lock_profile_buffer();
+	if(buf == null){ return null; }
+
+	uintptr h = ((uintptr)lock >> 4) ^ (uintptr)loc.filename ^ ((uintptr)loc.line * 2654435761u);
+	for(isize i = 0; i < LOCK_PROFILE_SLOTS; i += 1){
+		Lock_Profile_Slot* slot = &buf->slots[(h + i) & (LOCK_PROFILE_SLOTS - 1)];
+		void const* owner = atomic_load_explicit(&slot->lock, memory_order_relaxed);
+		if(owner == lock && slot->location.line == loc.line && slot->location.filename == loc.filename){
+			return slot;
+		}
+		if(owner == null){
+			slot->location = loc;
+			atomic_store_explicit(&slot->lock, lock, memory_order_release);
+			return slot;
+		}
+	}
+	PROFILE_BUMP(buf->dropped, 1);
+	return null;
+}
+
+void spinlock_acquire_profiled(Spinlock* l, Source_Location loc){
+	Lock_Profile_Slot* slot = lock_profile_slot(l, loc);
+	u64 spins = 0;
+	i64 wait_start = 0;
+	bool contended = false;
+
+	for(;;){
+		if(!atomic_exchange_explicit(&l->_state, SPINLOCK_LOCKED, memory_order_acquire)){
+			break;
+		}
+		if(!contended){
+			contended = true;
+			wait_start = lock_profile_clock();
+		}
+		while(atomic_load_explicit(&l->_state, memory_order_relaxed)){
+			spins += 1;
+		}
+	}
+
+	i64 now = lock_profile_clock();
+	if(slot != null){
+		PROFILE_BUMP(slot->acquires, 1);
+		if(contended){
+			PROFILE_BUMP(slot->contended, 1);
+			PROFILE_BUMP(slot->spins, spins);
+			PROFILE_BUMP(slot->wait_ns, now - wait_start);
+		}
+	}
+	l->_acquired_at = now;
+	l->_profile_slot = slot;
+}
+
+bool spinlock_try_acquire_profiled(Spinlock* l, Source_Location loc){
+	Lock_Profile_Slot* slot = lock_profile_slot(l, loc);
+	bool ok = !atomic_exchange_explicit(&l->_state, SPINLOCK_LOCKED, memory_order_acquire);
+	if(ok){
+		if(slot != null){ PROFILE_BUMP(slot->acquires, 1); }
+		l->_acquired_at = lock_profile_clock();
+		l->_profile_slot = slot;
+	}
+	else if(slot != null){
+		PROFILE_BUMP(slot->contended, 1);
+	}
+	return ok;
+}
+
+static
+void lock_profile_release(Spinlock* l){
+	/* Read the holder's bookkeeping before another thread can overwrite it */
+	Lock_Profile_Slot* slot = l->_profile_slot;
+	i64 held = lock_profile_clock() - l->_acquired_at;
+	l->_profile_slot = null;
+	atomic_store(&l->_state, SPINLOCK_UNLOCKED);
+	if(slot != null){
+		PROFILE_BUMP(slot->hold_ns, held);
+	}
+}
+
+static
+int lock_profile_entry_cmp(void const* a, void const* b){
+	i64 wa = ((Lock_Profile_Entry const*)a)->wait_ns;
+	i64 wb = ((Lock_Profile_Entry const*)b)->wait_ns;
+	return (wa < wb) - (wa > wb);
+}
+
+isize lock_profile_collect(Lock_Profile_Entry* out, isize cap){
+	isize count = 0;
+	Lock_Profile_Buffer* buf = atomic_load_explicit(&lock_profile_buffers, memory_order_acquire);
+	for(; buf != null; buf = buf->next){
+		for(isize i = 0; i < LOCK_PROFILE_SLOTS; i += 1){
+			Lock_Profile_Slot* slot = &buf->slots[i];
+			void const* lock = atomic_load_explicit(&slot->lock, memory_order_acquire);
+			if(lock == null){ continue; }
+
+			/* Same lock and call site from different threads merge into one entry */
+			isize n = 0;
+			for(; n < count; n += 1){
+				if(out[n].lock == lock && out[n].location.line == slot->location.line &&
+				   out[n].location.filename == slot->location.filename){
+					break;
+				}
+			}
+			if(n == count){
+				if(count >= cap){ continue; }
+				out[n] = (Lock_Profile_Entry){ .lock = lock, .location = slot->location };
+				count += 1;
+			}
+			out[n].acquires  += atomic_load_explicit(&slot->acquires, memory_order_relaxed);
+			out[n].contended += atomic_load_explicit(&slot->contended, memory_order_relaxed);
+			out[n].spins     += atomic_load_explicit(&slot->spins, memory_order_relaxed);
+			out[n].wait_ns   += atomic_load_explicit(&slot->wait_ns, memory_order_relaxed);
+			out[n].hold_ns   += atomic_load_explicit(&slot->hold_ns, memory_order_relaxed);
+		}
+	}
+	qsort(out, count, sizeof(*out), lock_profile_entry_cmp);
+	return count;
+}
+
+void lock_profile_report(){
+	enum { max_entries = 64 };
+	Lock_Profile_Entry entries[max_entries];
+	isize count = lock_profile_collect(entries, max_entries);
+
+	u64 dropped = 0;
+	Lock_Profile_Buffer* buf = atomic_load_explicit(&lock_profile_buffers, memory_order_acquire);
+	for(; buf != null; buf = buf->next){
+		dropped += atomic_load_explicit(&buf->dropped, memory_order_relaxed);
+	}
+
+	printf("Lock profile (%td call sites, %llu dropped records)\n", count, (unsigned long long)dropped);
+	for(isize i = 0; i < count; i += 1){
+		Lock_Profile_Entry* e = &entries[i];
+		printf("  %p %s:%d %s(): acquires=%llu contended=%llu spins=%llu wait=%.3fms hold=%.3fms\n",
+			e->lock, e->location.filename, e->location.line, e->location.caller_name,
+			(unsigned long long)e->acquires, (unsigned long long)e->contended, (unsigned long long)e->spins,
+			(double)e->wait_ns / 1e6, (double)e->hold_ns / 1e6);
+	}
+}
+
+void lock_profile_reset(){
+	Lock_Profile_Buffer* buf = atomic_load_explicit(&lock_profile_buffers, memory_order_acquire);
+	for(; buf != null; buf = buf->next){
+		for(isize i = 0; i < LOCK_PROFILE_SLOTS; i += 1){
+			Lock_Profile_Slot* slot = &buf->slots[i];
+			atomic_store_explicit(&slot->acquires, 0, memory_order_relaxed);
+			atomic_store_explicit(&slot->contended, 0, memory_order_relaxed);
+			atomic_store_explicit(&slot->spins, 0, memory_order_relaxed);
+			atomic_store_explicit(&slot->wait_ns, 0, memory_order_relaxed);
+			atomic_store_explicit(&slot->hold_ns, 0, memory_order_relaxed);
+		}
+		atomic_store_explicit(&buf->dropped, 0, memory_order_relaxed);
+	}
+}
+
+#undef PROFILE_BUMP
+#endif
+
+//// Files /////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+static_assert(sizeof(IO_Buffer) == sizeof(struct iovec) &&
+	offsetof(IO_Buffer, data) == offsetof(struct iovec, iov_base) &&
+	offsetof(IO_Buffer, len) == offsetof(struct iovec, iov_len), "IO_Buffer must match struct iovec");
+
+static
+i64 file_error(int err){
+	switch(err){
+	case ENOMEM: return IO_Err_Memory_Error;
+	case EINVAL: case ESPIPE: return IO_Err_Unsupported;
+	default: return IO_Err_Broken_Handle;
+	}
+}
+
+/* Result of a read(2)-like call, 0 bytes for a non-empty read is the end */
+static
+i64 file_read_result(ssize_t n, isize buflen){
+	if(n < 0){ return file_error(errno); }
+	if(n == 0 && buflen > 0){ return IO_Err_End_Of_Stream; }
+	return n;
+}
+
+static
+i64 file_write_result(ssize_t n){
+	return n < 0 ? file_error(errno) : n;
+}
+
+bool file_open(File* f, String path, u32 mode){
+	f->fd = -1;
+	f->mode = mode;
+	char cpath[FILE_PATH_MAX];
+	if(path.len >= FILE_PATH_MAX){ return false; }
+	memcpy(cpath, path.data, path.len);
+	cpath[path.len] = 0;
+
+	int flags = O_CLOEXEC;
+	if((mode & File_Read) && (mode & File_Write)){ flags |= O_RDWR; }
+	else if(mode & File_Write){ flags |= O_WRONLY; }
+	else { flags |= O_RDONLY; }
+	if(mode & File_Create){ flags |= O_CREAT; }
+	if(mode & File_Truncate){ flags |= O_TRUNC; }
+	if(mode & File_Append){ flags |= O_APPEND; }
+	if(mode & File_Exclusive){ flags |= O_EXCL; }
+
+	int fd;
+	do { fd = open(cpath, flags, 0666); } while(fd < 0 && errno == EINTR);
+	f->fd = fd;
+	return fd >= 0;
+}
+
+File file_from_fd(i32 fd, u32 mode){
+	return (File){ .fd = fd, .mode = mode };
+}
+
+bool file_close(File* f){
+	if(f->fd < 0){ return false; }
+	/* The descriptor is released even if close() is interrupted */
+	bool ok = close(f->fd) == 0 || errno == EINTR;
+	f->fd = -1;
+	return ok;
+}
+
+i64 file_read(File* f, byte* buf, isize buflen){
+	ssize_t n;
+	do { n = read(f->fd, buf, buflen); } while(n < 0 && errno == EINTR);
+	return file_read_result(n, buflen);
+}
+
+i64 file_write(File* f, byte const* buf, isize buflen){
+	ssize_t n;
+	do { n = write(f->fd, buf, buflen); } while(n < 0 && errno == EINTR);
+	return file_write_result(n);
+}
+
+i64 file_read_at(File* f, byte* buf, isize buflen, i64 offset){
+	ssize_t n;
+	do { n = pread(f->fd, buf, buflen, offset); } while(n < 0 && errno == EINTR);
+	return file_read_result(n, buflen);
+}
+
+i64 file_write_at(File* f, byte const* buf, isize buflen, i64 offset){
+	ssize_t n;
+	do { n = pwrite(f->fd, buf, buflen, offset); } while(n < 0 && errno == EINTR);
+	return file_write_result(n);
+}
+
+i64 file_readv(File* f, IO_Buffer const* bufs, isize count){
+	count = min(count, FILE_IO_BUFFERS_MAX);
+	isize total = 0;
+	for(isize i = 0; i < count; i++){ total += bufs[i].len; }
+	ssize_t n;
+	do { n = readv(f->fd, (struct iovec const*)bufs, (int)count); } while(n < 0 && errno == EINTR);
+	return file_read_result(n, total);
+}
+
+i64 file_writev(File* f, IO_Buffer const* bufs, isize count){
+	count = min(count, FILE_IO_BUFFERS_MAX);
+	ssize_t n;
+	do { n = writev(f->fd, (struct iovec const*)bufs, (int)count); } while(n < 0 && errno == EINTR);
+	return file_write_result(n);
+}
+
+i64 file_size(File* f){
+	struct stat st;
+	if(fstat(f->fd, &st) < 0){ return file_error(errno); }
+	return st.st_size;
+}
+
+bool file_advise(File* f, i64 offset, i64 len, u8 advice){
+	static int const advice_flags[] = {
+		[File_Advice_Normal]     = POSIX_FADV_NORMAL,
+		[File_Advice_Sequential] = POSIX_FADV_SEQUENTIAL,
+		[File_Advice_Random]     = POSIX_FADV_RANDOM,
+		[File_Advice_Will_Need]  = POSIX_FADV_WILLNEED,
+		[File_Advice_Dont_Need]  = POSIX_FADV_DONTNEED,
+	};
+	if(advice > File_Advice_Dont_Need){ return false; }
+	return posix_fadvise(f->fd, offset, len, advice_flags[advice]) == 0;
+}
+
+static
+i64 file_stream_func(void* impl, byte op, byte* buf, isize buflen){
+	File* f = impl;
+	switch(op){
+	case IO_Query:
+		return ((f->mode & File_Read) ? IO_Stream_Read : 0) | ((f->mode & File_Write) ? IO_Stream_Write : 0);
+	case IO_Read: return file_read(f, buf, buflen);
+	case IO_Write: return file_write(f, buf, buflen);
+	default: return IO_Err_Unsupported;
+	}
+}
+
+IO_Stream file_stream(File* f){
+	return (IO_Stream){ .data = f, .func = file_stream_func };
+}
+#endif
+
+//// Mapped Files //////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+#include <sys/mman.h>
+#include <sys/auxv.h>
+
+static
+isize mmap_page_size(){
+	return (isize)getauxval(AT_PAGESZ);
+}
+
+/* Reserve address space with room for `len` bytes after a huge page boundary,
+ * returns the whole reservation */
+static
+byte* mmap_reserve(isize len, isize* reserved){
+	*reserved = len + MMAP_HUGE_PAGE_SIZE;
+	void* p = mmap(null, *reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return p == MAP_FAILED ? null : p;
+}
+
+bool mmap_file(Mapped_File* m, String path, u32 mode){
+	m->data = null;
+	m->len = 0;
+	bool shared_write = (mode & Map_Write) && !(mode & Map_Private);
+	File f;
+	if(!file_open(&f, path, shared_write ? File_Read | File_Write : File_Read)){ return false; }
+	i64 size = file_size(&f);
+	if(size <= 0){
+		file_close(&f);
+		return size == 0;
+	}
+
+	int prot = PROT_READ | ((mode & (Map_Write | Map_Private)) ? PROT_WRITE : 0);
+	int flags = (mode & Map_Private) ? MAP_PRIVATE : MAP_SHARED;
+	if(mode & Map_Populate){ flags |= MAP_POPULATE; }
+
+	/* The kernel only uses huge pages for a range that is aligned to them, so
+	 * the file is mapped over an aligned spot in a bigger reservation and the
+	 * rest of it is given back */
+	byte* reservation = null;
+	isize reserved = 0;
+	byte* at = null;
+	if((mode & Map_Huge_Pages) && size >= MMAP_HUGE_PAGE_SIZE){
+		reservation = mmap_reserve(size, &reserved);
+		if(reservation != null){
+			at = (byte*)align_forward_ptr((uintptr)reservation, MMAP_HUGE_PAGE_SIZE);
+			flags |= MAP_FIXED;
+		}
+	}
+
+	void* p = mmap(at, size, prot, flags, f.fd, 0);
+	file_close(&f);
+	if(p == MAP_FAILED){
+		if(reservation != null){ munmap(reservation, reserved); }
+		return false;
+	}
+
+	if(reservation != null){
+		byte* end = at + align_forward_size(size, mmap_page_size());
+		if(at > reservation){ munmap(reservation, at - reservation); }
+		if(end < reservation + reserved){ munmap(end, reservation + reserved - end); }
+		/* Only a hint, file systems that can't do it leave regular pages */
+		madvise(at, size, MADV_HUGEPAGE);
+	}
+
+	m->data = p;
+	m->len = size;
+	return true;
+}
+
+bool mmap_file_advise(Mapped_File* m, isize offset, isize len, u8 advice){
+	static int const advice_flags[] = {
+		[File_Advice_Normal]     = MADV_NORMAL,
+		[File_Advice_Sequential] = MADV_SEQUENTIAL,
+		[File_Advice_Random]     = MADV_RANDOM,
+		[File_Advice_Will_Need]  = MADV_WILLNEED,
+		[File_Advice_Dont_Need]  = MADV_DONTNEED,
+	};
+	if(advice > File_Advice_Dont_Need || offset < 0 || offset > m->len){ return false; }
+	if(m->data == null){ return true; }
+	isize end = len > 0 ? min(offset + len, m->len) : m->len;
+	/* The mapping starts on a page, so rounding down stays inside it */
+	isize start = offset & ~(mmap_page_size() - 1);
+	return madvise(&m->data[start], end - start, advice_flags[advice]) == 0;
+}
+
+bool mmap_file_unmap(Mapped_File* m){
+	bool ok = m->data == null || munmap(m->data, m->len) == 0;
+	m->data = null;
+	m->len = 0;
+	return ok;
+}
+#endif
@@ -11,6 +11,9 @@
 #elif defined(TARGET_OS_LINUX)
 	#define TARGET_OS_NAME "Linux"
 	#define _XOPEN_SOURCE 800
+	#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE
+	#endif
 #else
 	#error "Platform macro `TARGET_OS_*` is not defined, this means you probably forgot to define it or this platform is not suported."
 #endif
@@ -82,12 +85,43 @@ typedef _Bool bool;
 #define static_assert(Pred, Msg) _Static_assert(Pred, Msg)
 #endif
 
+// Assumed size of a cache line, things that are written by different threads
+// should be at least this far apart to avoid false sharing
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+// Put a struct member in its own cache line(s)
+#define cache_padded alignas(CACHE_LINE_SIZE)
+
 static_assert(sizeof(f32) == 4 && sizeof(f64) == 8, "Bad float size");
 static_assert(sizeof(isize) == sizeof(usize), "Mismatched (i/u)size");
 static_assert(sizeof(void(*)(void)) == sizeof(void*), "Function pointers and data pointers must be of the same width");
 static_assert(sizeof(void(*)(void)) == sizeof(uintptr), "Mismatched pointer types");
 static_assert(CHAR_BIT == 8, "Invalid char size");
 
+//// Atomic ////////////////////////////////////////////////////////////////////
+#ifndef TARGET_DISABLE_ATOMICS
+// Loads, stores, exchange, compare exchange (strong and weak), fetch operations
+// and fences are all covered by C11's `atomic_*_explicit`, what is missing is
+// being able to sleep on an atomic variable.
+
+// Block current thread while `*ptr == old`, wakeups may be spurious. Only
+// valid within the same process.
+void atomic_wait(atomic_int* ptr, int old, memory_order order);
+
+// Same as atomic_wait, but gives up after `timeout_ns` nanoseconds. Spurious
+// wakeups don't end the wait early. Returns false if it timed out with `*ptr`
+// still equal to `old`.
+bool atomic_wait_timeout(atomic_int* ptr, int old, memory_order order, i64 timeout_ns);
+
+// Wake one thread blocked on atomic_wait()
+void atomic_notify_one(atomic_int* ptr);
+
+// Wake all threads blocked on atomic_wait()
+void atomic_notify_all(atomic_int* ptr);
+#endif
+
 //// Spinlock //////////////////////////////////////////////////////////////////
 #ifndef TARGET_DISABLE_ATOMICS
 #define SPINLOCK_LOCKED 1
@@ -98,6 +132,10 @@ static_assert(CHAR_BIT == 8, "Invalid char size");
 // a thread_local struct.
 typedef struct {
 	atomic_int _state;
+#ifdef ENABLE_LOCK_PROFILING
+	i64 _acquired_at;
+	void* _profile_slot;
+#endif
 } Spinlock;
 
 
@@ -113,6 +151,45 @@ void spinlock_release(Spinlock* l);
 #define spinlock_guard(LockPtr, Scope) \
 	do { spinlock_acquire(LockPtr); do { Scope } while(0); spinlock_release(LockPtr); } while(0)
 
+#ifdef ENABLE_LOCK_PROFILING
+typedef struct Source_Location Source_Location;
+
+// Profiled versions of acquire/try_acquire, used through the spinlock_* macros
+// below so every call site reports its own location.
+void spinlock_acquire_profiled(Spinlock* l, Source_Location loc);
+bool spinlock_try_acquire_profiled(Spinlock* l, Source_Location loc);
+
+#define spinlock_acquire(LockPtr) spinlock_acquire_profiled((LockPtr), this_location())
+#define spinlock_try_acquire(LockPtr) spinlock_try_acquire_profiled((LockPtr), this_location())
+#endif
+
+#endif
+
+//// Sharded Counter ///////////////////////////////////////////////////////////
+#ifndef TARGET_DISABLE_ATOMICS
+#define SHARDED_COUNTER_SLOTS 64
+
+// Counter split into per-CPU slots, increments only touch the slot of the CPU
+// the caller is running on so they don't bounce cache lines between cores.
+// Reading has to sum every slot, so it's meant for counters that are written
+// far more often than they are read. The zeroed state is a counter at 0.
+typedef struct {
+	struct {
+		cache_padded _Atomic(i64) value;
+	} _slots[SHARDED_COUNTER_SLOTS];
+} Sharded_Counter;
+
+static_assert(sizeof(((Sharded_Counter*)0)->_slots[0]) == CACHE_LINE_SIZE &&
+	alignof(Sharded_Counter) == CACHE_LINE_SIZE, "Counter slots must occupy exactly one cache line");
+
+// Add delta to the current CPU's slot
+void sharded_counter_add(Sharded_Counter* c, i64 delta);
+
+// Sum of all slots, not a snapshot if there are concurrent writers
+i64 sharded_counter_sum(Sharded_Counter* c);
+
+// Set all slots back to 0
+void sharded_counter_reset(Sharded_Counter* c);
 #endif
 
 //// Memory ////////////////////////////////////////////////////////////////////
@@ -168,6 +245,17 @@ i32 mem_compare(void const * a, void const * b, isize nbytes);
 // to be faster then mem_copy
 void mem_copy_no_overlap(void* dest, void const * src, isize nbytes);
 
+// Offset of the first byte equal to `val`, -1 if there is none. Uses SSE4/AVX2
+// when the CPU has them, like the other byte searches below.
+isize mem_find_byte(void const* p, byte val, isize nbytes);
+
+// Offset of the last byte equal to `val`, -1 if there is none
+isize mem_rfind_byte(void const* p, byte val, isize nbytes);
+
+// Offset of the first byte that is any of the `set_len` bytes in `set`, -1 if
+// there is none
+isize mem_find_any_of(void const* p, byte const* set, isize set_len, isize nbytes);
+
 // Align p to alignment a, this only works if a is a non-zero power of 2
 uintptr align_forward_ptr(uintptr p, uintptr a);
 
@@ -302,6 +390,85 @@ void* pool_alloc(Mem_Pool* pool);
 // Get pool as a conforming instance to the allocator interface
 Mem_Allocator pool_allocator(Mem_Pool* pool);
 
+//// Epoch Reclamation ///////////////////////////////////////////////////////
+#ifndef TARGET_DISABLE_ATOMICS
+typedef struct Epoch_Domain Epoch_Domain;
+typedef struct Epoch_Participant Epoch_Participant;
+typedef struct Epoch_Limbo Epoch_Limbo;
+typedef struct Epoch_Retired Epoch_Retired;
+
+// How many retired pointers a participant accumulates before it tries to
+// advance the epoch and free what is safe
+#define EPOCH_BATCH_SIZE 64
+
+// Memory that was unlinked from a shared structure but may still be read
+struct Epoch_Retired {
+	void* ptr;
+	isize size;
+	isize align;
+	Mem_Allocator allocator;
+};
+
+// Pointers retired during a particular epoch
+struct Epoch_Limbo {
+	Epoch_Retired* items;
+	isize len;
+	isize cap;
+	u64 epoch;
+};
+
+// One per thread (per domain), readers only touch their own participant.
+struct Epoch_Participant {
+	cache_padded _Atomic(u64) _local_epoch;
+	Epoch_Domain* domain;
+	Epoch_Participant* next;
+	Epoch_Limbo limbo[3];
+	isize nesting;
+	isize retired_since_collect;
+};
+
+// Epoch based memory reclamation: memory retired while some thread may still
+// be reading it is kept in the retiring thread's limbo lists and released in
+// batches once every active thread has moved 2 epochs past it.
+struct Epoch_Domain {
+	cache_padded _Atomic(u64) _epoch;
+	Spinlock lock;
+	Epoch_Participant* participants;
+	Mem_Allocator allocator;
+};
+
+// Initialize domain, allocator is used for participants and their limbo lists
+void epoch_domain_init(Epoch_Domain* d, Mem_Allocator allocator);
+
+// Destroy domain, all participants must have been unregistered
+void epoch_domain_destroy(Epoch_Domain* d);
+
+// Register a participant for the calling thread, returns null on failure
+Epoch_Participant* epoch_register(Epoch_Domain* d);
+
+// Unregister participant, blocks until all its retired memory can be freed
+void epoch_unregister(Epoch_Participant* p);
+
+// Enter a read side critical section, pointers loaded from shared structures
+// stay valid until epoch_exit(). Can be nested.
+void epoch_enter(Epoch_Participant* p);
+
+// Leave read side critical section
+void epoch_exit(Epoch_Participant* p);
+
+// Hand memory (already unlinked from any shared structure) over to be freed
+// into `allocator` once no reader can still see it. Returns success status,
+// it can only fail if the limbo list could not grow.
+bool epoch_retire(Epoch_Participant* p, void* ptr, isize size, isize align, Mem_Allocator allocator);
+
+// Try to advance the epoch and free what is safe. Returns number of pointers freed.
+isize epoch_collect(Epoch_Participant* p);
+
+// Block until all memory retired by p is freed. Must not be called inside a
+// critical section.
+void epoch_barrier(Epoch_Participant* p);
+#endif
+
 //// UTF-8 /////////////////////////////////////////////////////////////////////
 typedef i32 rune;
 typedef struct UTF8_Encode_Result UTF8_Encode_Result;
@@ -350,25 +517,61 @@ bool utf8_iter_next(UTF8_Iterator* iter, rune* r, i8* len);
 // returns false when finished.
 bool utf8_iter_prev(UTF8_Iterator* iter, rune* r, i8* len);
 
+// Check that a buffer is entirely valid UTF-8: no truncated sequences,
+// overlong encodings, surrogates or codepoints past U+10FFFF. Uses SSE4/AVX2
+// when the CPU has them (define DISABLE_SIMD to always use the scalar path).
+bool utf8_validate(byte const* data, isize len);
+
+// Decode a buffer into runes, stopping when either the input is consumed or
+// `out` is full. Results are the same as stepping with utf8_iter_next():
+// invalid bytes become UTF8_ERROR and are skipped one at a time. Returns the
+// number of runes written, the number of bytes used is stored in `consumed`
+// (may be null). An `out` with as many runes as input bytes always fits.
+isize utf8_decode_runes(rune* out, isize out_len, byte const* data, isize len, isize* consumed);
+
+// Get the byte offset after stepping `n` runes (as utf8_iter_next() would) into
+// the buffer, or `len` if it has fewer runes. The number of runes actually
+// stepped over is stored in `skipped` (may be null).
+isize utf8_rune_offset(byte const* data, isize len, isize n, isize* skipped);
+
+// Transcoding between UTF-8, UTF-16 (native byte order) and UTF-32. Unpaired
+// surrogates and UTF-32 values outside the scalar range become UTF8_ERROR, as
+// does invalid UTF-8 (one per skipped byte, like utf8_iter_next()). UTF-8 to
+// UTF-32 is utf8_decode_runes(), counted by str_codepoint_count().
+//
+// The *_len() functions return the exact output size in units, converting
+// stops when the input is consumed or the next codepoint does not fit in
+// `out`. They return the number of units written and store the number of input
+// units used in `consumed` (may be null). ASCII runs (and surrogate free text
+// between UTF-16 and UTF-32) are done with SSE4 when the CPU has it, so is
+// UTF-8 to UTF-16 for text of any width that validates.
+isize utf8_to_utf16_len(byte const* data, isize len);
+isize utf8_to_utf16(u16* out, isize out_len, byte const* data, isize len, isize* consumed);
+
+isize utf16_to_utf8_len(u16 const* data, isize len);
+isize utf16_to_utf8(byte* out, isize out_len, u16 const* data, isize len, isize* consumed);
+
+isize utf16_to_utf32_len(u16 const* data, isize len);
+isize utf16_to_utf32(rune* out, isize out_len, u16 const* data, isize len, isize* consumed);
+
+isize utf32_to_utf8_len(rune const* data, isize len);
+isize utf32_to_utf8(byte* out, isize out_len, rune const* data, isize len, isize* consumed);
+
+isize utf32_to_utf16_len(rune const* data, isize len);
+isize utf32_to_utf16(u16* out, isize out_len, rune const* data, isize len, isize* consumed);
+
 //// Strings ///////////////////////////////////////////////////////////////////
 typedef struct String String;
 
-#define str_lit(CstrLit) (String){ .data = (byte const*)(CstrLit), .len = (sizeof(CstrLit) - 1) }
+#define str_lit(CstrLit) ((String){ .data = (byte const*)(CstrLit), .len = (sizeof(CstrLit) - 1) })
 
 struct String {
 	byte const * data;
-	isize _length;
+	isize len;
 };
 
-static inline
-isize cstring_len(cstring cstr){
-	static const isize CSTR_MAX_LENGTH = (~(u32)0) >> 1;
-	isize size = 0;
-	for(isize i = 0; i < CSTR_MAX_LENGTH && cstr[i] != 0; i += 1){
-		size += 1;
-	}
-	return size;
-}
+// Length of a C string (in bytes), counting stops at 2^31 - 1
+isize cstring_len(cstring cstr);
 
 // Create substring from a cstring
 String str_from(cstring data);
@@ -382,6 +585,9 @@ String str_from_bytes(byte const* data, isize length);
 // Get a sub string, starting at `start` with `length`
 String str_sub(String s, isize start, isize length);
 
+// Get a sub string of `count` codepoints, starting at the `start`-th codepoint
+String str_sub_runes(String s, isize start, isize count);
+
 // Get how many codeponits are in a string
 isize str_codepoint_count(String s);
 
@@ -400,6 +606,18 @@ String str_concat(String a, String b, Mem_Allocator allocator);
 // Check if 2 strings are equal
 bool str_eq(String a, String b);
 
+// Three-way lexicographic comparison of the bytes (as unsigned), a string sorts
+// after its prefixes. Returns -1, 0 or 1.
+i32 str_compare(String a, String b);
+
+// Three-way comparison by codepoint, decoding like utf8_iter_next(). Same order
+// as str_compare() for valid UTF-8, invalid bytes compare as UTF8_ERROR.
+i32 str_compare_runes(String a, String b);
+
+// Length (in bytes) of the longest common prefix, which may end in the middle
+// of a codepoint
+isize str_common_prefix_len(String a, String b);
+
 // Trim leading codepoints that belong to the cutset
 String str_trim_leading(String s, String cutset);
 
@@ -415,6 +633,18 @@ bool str_starts_with(String s, String prefix);
 // Check if string ends with a suffix
 bool str_ends_with(String s, String suffix);
 
+// Byte offset of the first occurrence of `pattern`, -1 if there is none. An
+// empty pattern is found at 0. Linear time even on adversarial input, uses
+// SSE4/AVX2 when available.
+isize str_find(String s, String pattern);
+
+// Byte offset of the last occurrence of `pattern`, -1 if there is none. An
+// empty pattern is found at the end of the string.
+isize str_rfind(String s, String pattern);
+
+// Number of non-overlapping occurrences of `pattern`, 0 for an empty pattern
+isize str_count(String s, String pattern);
+
 // Get an utf8 iterator from string
 UTF8_Iterator str_iterator(String s);
 
@@ -424,6 +654,176 @@ UTF8_Iterator str_iterator_reversed(String s);
 // Is string empty?
 bool str_empty(String s);
 
+//// Cutset ////////////////////////////////////////////////////////////////////
+// Precompiled set of codepoints for trimming, splitting and searching, meant to
+// be built once and reused. Bytes are first tested against a 256-bit bitmap
+// (ASCII members and lead bytes of the others) with SSE4/AVX2 when available,
+// non-ASCII codepoints are then looked up in a sorted array.
+typedef struct {
+	byte bitmap[32];
+	rune* runes;
+	isize runes_len;
+	Mem_Allocator allocator;
+} Cutset;
+
+// Build a cutset out of every codepoint in `runes`, returns false if
+// allocation fails. Only non-ASCII codepoints take memory.
+bool cutset_init(Cutset* set, String runes, Mem_Allocator allocator);
+
+// Free the cutset
+void cutset_destroy(Cutset* set);
+
+// Check if a codepoint belongs to the cutset
+bool cutset_contains(Cutset const* set, rune r);
+
+// Trim leading codepoints that belong to the cutset
+String str_trim_leading_set(String s, Cutset const* set);
+
+// Trim trailing codepoints that belong to the cutset
+String str_trim_trailing_set(String s, Cutset const* set);
+
+// Trim leading and trailing codepoints that belong to the cutset
+String str_trim_set(String s, Cutset const* set);
+
+// Byte offset of the first codepoint that belongs to the cutset, -1 if none does
+isize str_find_any(String s, Cutset const* set);
+
+// Byte offset of the last codepoint that belongs to the cutset, -1 if none does
+isize str_rfind_any(String s, Cutset const* set);
+
+// Split around the first codepoint that belongs to the cutset, which is left
+// out of both halves. Returns false (and all of `s` in `before`) if none does.
+bool str_cut_any(String s, Cutset const* set, String* before, String* after);
+
+//// String Index //////////////////////////////////////////////////////////////
+// Runes between two entries of a Str_Index
+#ifndef STR_INDEX_STRIDE
+#define STR_INDEX_STRIDE 64
+#endif
+
+// Sparse codepoint -> byte offset index of a string, makes codepoint offsets
+// and codepoint based substrings O(1) instead of a walk over the whole string.
+// It keeps one offset per STR_INDEX_STRIDE codepoints, the string must outlive
+// the index and not change.
+typedef struct {
+	String str;
+	isize* offsets;
+	isize len;
+	isize rune_count;
+	Mem_Allocator allocator;
+} Str_Index;
+
+// Build the index of a string, returns false if allocation fails
+bool str_index_init(Str_Index* idx, String s, Mem_Allocator allocator);
+
+// Free the index
+void str_index_destroy(Str_Index* idx);
+
+// Get the byte offset of the n-th codepoint
+isize str_index_offset(Str_Index const* idx, isize n);
+
+// Get a sub string of `count` codepoints, starting at the `start`-th codepoint
+String str_index_sub(Str_Index const* idx, isize start, isize count);
+
+//// Pattern Set ///////////////////////////////////////////////////////////////
+// Set of patterns compiled once (Aho-Corasick) and then matched against any
+// input in a single pass, no matter how many patterns there are. Memory is
+// about 4 bytes per distinct pattern byte for every prefix of every pattern.
+typedef struct {
+	i32* delta;
+	i32* output;
+	i32* dict;
+	i32* pattern;
+	isize* lengths;
+	isize pattern_count;
+	isize state_count;
+	isize class_count;
+	byte classes[256];
+	Mem_Allocator allocator;
+} Pattern_Set;
+
+typedef struct {
+	isize pattern; // Index of the pattern that matched
+	isize offset;  // Byte offset of the match from the start of the input
+	isize len;
+} Pattern_Match;
+
+// Called for every match, return false to stop matching
+typedef bool (*Pattern_Match_Func)(void* ctx, Pattern_Match match);
+
+// Incremental matcher, for input that comes in chunks. Matches can span
+// chunks.
+typedef struct {
+	Pattern_Set const* set;
+	i32 row;
+	isize offset;
+} Pattern_Scanner;
+
+// Compile a set of patterns, returns false if allocation fails or the patterns
+// are too big. Empty patterns never match, duplicates report the first index.
+bool pattern_set_init(Pattern_Set* set, String const* patterns, isize count, Mem_Allocator allocator);
+
+// Free the set
+void pattern_set_destroy(Pattern_Set* set);
+
+// Find the match that ends first (the longest one if several end together),
+// returns false if nothing matches.
+bool pattern_set_find(Pattern_Set const* set, String s, Pattern_Match* match);
+
+// Find every match, including overlapping ones, in order of where they end.
+// Stores up to `cap` of them in `out` and returns how many there are in total.
+isize pattern_set_find_all(Pattern_Set const* set, String s, Pattern_Match* out, isize cap);
+
+// Match everything read from a stream, using `buf` as the read buffer. Returns
+// the number of bytes read or (if negative) an IO error code.
+i64 pattern_set_match_stream(Pattern_Set const* set, IO_Stream s, byte* buf, isize buflen, Pattern_Match_Func func, void* ctx);
+
+// Start matching a new input
+void pattern_scanner_init(Pattern_Scanner* sc, Pattern_Set const* set);
+
+// Match the next chunk of the input, returns false if `func` stopped matching
+bool pattern_scanner_feed(Pattern_Scanner* sc, String chunk, Pattern_Match_Func func, void* ctx);
+
+//// String Split //////////////////////////////////////////////////////////////
+enum Str_Split_Kind {
+	Str_Split_Byte   = 0,
+	Str_Split_String = 1,
+	Str_Split_Cutset = 2,
+	Str_Split_Fields = 3,
+};
+
+// Lazy splitter, tokens are views into the original string and nothing is
+// allocated. Delimiters are searched with the vector paths of str_find() and
+// the Cutset functions. Use as:
+//   Str_Splitter it = str_split(s, str_lit(", "));
+//   for(String tok; str_split_next(&it, &tok);){ ... }
+typedef struct {
+	String rest;
+	String delim;
+	Cutset const* cutset;
+	byte byte_delim;
+	u8 kind;
+	bool done;
+} Str_Splitter;
+
+// Split around every occurrence of a byte, n delimiters give n + 1 tokens
+// (which may be empty)
+Str_Splitter str_split_byte(String s, byte delim);
+
+// Split around every occurrence of a string, an empty delimiter gives back the
+// whole string
+Str_Splitter str_split(String s, String delim);
+
+// Split around every codepoint that belongs to the cutset, which must outlive
+// the splitter
+Str_Splitter str_split_any(String s, Cutset const* set);
+
+// Split into the non-empty runs between ASCII whitespace
+Str_Splitter str_fields(String s);
+
+// Get the next token, returns false when there are no more
+bool str_split_next(Str_Splitter* it, String* token);
+
 //// Source Location ///////////////////////////////////////////////////////////
 typedef struct Source_Location Source_Location;
 typedef enum Logger_Option Logger_Option;
@@ -442,6 +842,47 @@ struct Source_Location {
     .line = __LINE__, \
 }
 
+//// Lock Profiling ////////////////////////////////////////////////////////////
+// Opt-in contention profiler for spinlocks, enabled by defining
+// ENABLE_LOCK_PROFILING. Every acquisition is recorded into a buffer owned by
+// the calling thread, keyed by (lock, call site), so the uncontended path only
+// pays for a clock read and a few relaxed stores. When disabled the Spinlock
+// is not instrumented at all and the functions below compile to nothing.
+typedef struct {
+	void const* lock;
+	Source_Location location;
+	u64 acquires;  // Successful acquisitions
+	u64 contended; // Acquisitions that had to wait, or failed try_acquire calls
+	u64 spins;     // Busy wait iterations spent waiting for the lock
+	i64 wait_ns;   // Total time spent waiting to acquire
+	i64 hold_ns;   // Total time the lock was held after acquisition
+} Lock_Profile_Entry;
+
+#if defined(ENABLE_LOCK_PROFILING) && !defined(TARGET_DISABLE_ATOMICS)
+// Maximum number of distinct (lock, call site) pairs tracked per thread, extra
+// pairs are counted as dropped.
+#ifndef LOCK_PROFILE_SLOTS
+#define LOCK_PROFILE_SLOTS 256
+#endif
+
+// Merge the records of every thread (including finished ones) into `out`,
+// sorted by total wait time, most contended first. Returns the number of
+// entries written, at most `cap`. Numbers are approximate while other threads
+// are still taking locks.
+isize lock_profile_collect(Lock_Profile_Entry* out, isize cap);
+
+// Print the merged records to stdout.
+void lock_profile_report();
+
+// Zero the records of every thread.
+void lock_profile_reset();
+
+#else
+#define lock_profile_collect(Out, Cap) ((void)(Out), (void)(Cap), (isize)0)
+#define lock_profile_report() ((void)0)
+#define lock_profile_reset() ((void)0)
+#endif
+
 //// Assert ////////////////////////////////////////////////////////////////////
 // Crash if `pred` is false, this is disabled in non-debug builds
 void debug_assert_ex(bool pred, cstring msg, Source_Location loc);
@@ -581,9 +1022,465 @@ isize sb_append_str(String_Builder* sb, String s);
 // Append encoded rune to string builder
 isize sb_append_rune(String_Builder* sb, rune r);
 
+// Append UTF-16 text as UTF-8, growing the buffer at most once. Returns < 0
+// on allocation failure and number of bytes added otherwise
+isize sb_append_utf16(String_Builder* sb, u16 const* data, isize len);
+
+// Append UTF-32 text as UTF-8, growing the buffer at most once. Returns < 0
+// on allocation failure and number of bytes added otherwise
+isize sb_append_utf32(String_Builder* sb, rune const* data, isize len);
+
 // Reset builder's buffer and length, does not free memory
 void sb_clear(String_Builder* sb);
 
+//// Chunk Builder /////////////////////////////////////////////////////////////
+typedef struct Chunk_Builder Chunk_Builder;
+typedef struct Builder_Chunk Builder_Chunk;
+
+// Chunk header, followed by `cap` bytes of data
+struct Builder_Chunk {
+	Builder_Chunk* next;
+	isize len;
+	isize cap;
+};
+
+// String builder made of a list of fixed size chunks, nothing is copied when
+// it grows. When a stream is attached every chunk is written out as soon as it
+// fills up and then reused, so memory stays at a single chunk no matter how
+// much is appended. Chunks are linked from `head`, the ones after `tail` are
+// empty and kept for reuse.
+struct Chunk_Builder {
+	Builder_Chunk* head;
+	Builder_Chunk* tail;
+	isize chunk_size;
+	isize len;        // Bytes currently held
+	i64 written;      // Bytes written to the stream so far
+	i64 error;        // First stream error, later appends fail
+	IO_Stream stream; // Only used if `stream.func` is not null
+	Mem_Allocator allocator;
+};
+
+// Chunk data
+static inline
+byte* chunk_data(Builder_Chunk* c){
+	return (byte*)(c + 1);
+}
+
+// Initialize a chunk builder, returns false on failure. `chunk_size` is rounded
+// up to a multiple of the chunk header alignment.
+bool chunk_builder_init(Chunk_Builder* cb, Mem_Allocator allocator, isize chunk_size);
+
+// Initialize a chunk builder that writes full chunks to a stream, returns false
+// on failure
+bool chunk_builder_init_stream(Chunk_Builder* cb, Mem_Allocator allocator, isize chunk_size, IO_Stream s);
+
+// Free all chunks, does not flush
+void chunk_builder_destroy(Chunk_Builder* cb);
+
+// Append buffer of bytes. Returns < 0 if an error occours and number of bytes
+// added otherwhise
+isize chunk_builder_append_bytes(Chunk_Builder* cb, byte const* buf, isize nbytes);
+
+// Append utf-8 string
+isize chunk_builder_append_str(Chunk_Builder* cb, String s);
+
+// Append encoded rune
+isize chunk_builder_append_rune(Chunk_Builder* cb, rune r);
+
+// Write everything held to the stream. Returns total number of bytes written
+// or (if negative) an error code.
+i64 chunk_builder_flush(Chunk_Builder* cb);
+
+// Copy the contents into a single owned string (from the builder's
+// allocator) and reset the builder. Returns an empty string on failure.
+String chunk_builder_build(Chunk_Builder* cb);
+
+// Reset contents, keeping the chunks for reuse
+void chunk_builder_clear(Chunk_Builder* cb);
+
+//// Rope //////////////////////////////////////////////////////////////////////
+// Maximum height of a rope, enough for any rope that fits in memory
+#define ROPE_MAX_HEIGHT 96
+
+// Leaves this short (in bytes) are copied together on concatenation instead of
+// getting a node of their own
+#define ROPE_LEAF_MERGE 128
+
+typedef struct Rope Rope;
+typedef struct Rope_Node Rope_Node;
+typedef struct Rope_Iter Rope_Iter;
+
+// Immutable tree node, leaves have no children
+struct Rope_Node {
+	Rope_Node const* left;
+	Rope_Node const* right;
+	String leaf;
+	isize len;   // Bytes
+	isize runes; // Codepoints
+	i32 height;  // 0 for leaves
+};
+
+// Text as a balanced (AVL) tree of string views, concatenation and substrings
+// are O(log n) and share all untouched nodes with their inputs. Ropes are
+// immutable values: nodes are never changed or freed on their own, so they
+// should come from an arena that is freed as a whole once the ropes are done.
+// The strings a rope is made from must outlive it.
+//
+// Concatenation is cheap in time, not in memory: each one copies the O(log n)
+// nodes along the join path, and joining 2 short leaves copies both into a
+// merged leaf of up to ROPE_LEAF_MERGE bytes. None of it is released before
+// the arena, so growing a rope by many small appends costs several hundred
+// bytes of arena per append. Collect such text in a builder and add it once.
+//
+// Rune counts and offsets assume valid UTF-8, every byte that is not a
+// continuation byte starts a rune. This keeps them exact when a byte range
+// cuts through a codepoint.
+struct Rope {
+	Rope_Node const* root;
+	Mem_Allocator allocator;
+};
+
+// Walks the leaves in order
+struct Rope_Iter {
+	Rope_Node const* stack[ROPE_MAX_HEIGHT + 1];
+	isize depth;
+};
+
+// Rope of a single string (which is not copied), returns false on failure
+bool rope_init(Rope* r, String s, Mem_Allocator allocator);
+
+// Concatenation of 2 ropes, with nodes from the allocator of `a`. Returns false
+// on failure.
+bool rope_concat(Rope* out, Rope a, Rope b);
+
+// Rope of `length` bytes starting at `start`, the range is clamped to the
+// rope. Returns false on failure.
+bool rope_sub(Rope* out, Rope r, isize start, isize length);
+
+// Rope of `count` codepoints starting at the `start`-th codepoint
+bool rope_sub_runes(Rope* out, Rope r, isize start, isize count);
+
+// Size (in bytes)
+isize rope_len(Rope r);
+
+// Size (in codepoints)
+isize rope_rune_count(Rope r);
+
+// Byte at an offset, which must be in range
+byte rope_byte_at(Rope r, isize offset);
+
+// Byte offset of the n-th codepoint, the rope's length if it's past the end
+isize rope_rune_offset(Rope r, isize n);
+
+// Decode the n-th codepoint, which may span leaves. UTF8_ERROR if it's out of
+// range or invalid.
+rune rope_rune_at(Rope r, isize n);
+
+// Append all the rope's text to a builder. Returns < 0 if an error occours and
+// number of bytes added otherwhise
+isize rope_flatten(Rope r, String_Builder* sb);
+
+// Start walking the leaves of a rope
+void rope_iter_init(Rope_Iter* it, Rope r);
+
+// Get the next leaf, returns false at the end
+bool rope_iter_next(Rope_Iter* it, String* leaf);
+
+//// Buffered IO ///////////////////////////////////////////////////////////////
+typedef struct Buffered_Reader Buffered_Reader;
+typedef struct Buffered_Writer Buffered_Writer;
+
+// Reads from a stream in buffer sized pieces. Reads that are at least as big as
+// the buffer skip it when it's empty. A source that returns 0 is at its end.
+struct Buffered_Reader {
+	IO_Stream source;
+	byte* buf;
+	isize cap;
+	isize start;   // Unread bytes are [start, end)
+	isize end;
+	i64 error;     // First source error (or IO_Err_End_Of_Stream), returned once the buffer is empty
+	Mem_Allocator allocator; // Only used if the buffer was allocated
+};
+
+// Writes to a stream in buffer sized pieces. Writes that are at least as big as
+// the buffer skip it.
+struct Buffered_Writer {
+	IO_Stream sink;
+	byte* buf;
+	isize cap;
+	isize len;
+	i64 written;   // Bytes written to the sink so far
+	i64 error;     // First sink error, later writes fail
+	Mem_Allocator allocator; // Only used if the buffer was allocated
+};
+
+// Initialize a reader with a buffer from the allocator, returns false on failure
+bool buf_reader_init(Buffered_Reader* r, IO_Stream source, Mem_Allocator allocator, isize size);
+
+// Initialize a reader over a caller owned buffer
+void buf_reader_init_buffer(Buffered_Reader* r, IO_Stream source, byte* buf, isize size);
+
+// Free the buffer if it was allocated
+void buf_reader_destroy(Buffered_Reader* r);
+
+// Read up to `buflen` bytes. Returns number of bytes read or (if negative) an
+// error code, IO_Err_End_Of_Stream once everything was read.
+i64 buf_reader_read(Buffered_Reader* r, byte* buf, isize buflen);
+
+// View of the next `n` bytes without consuming them, shorter if the stream ends
+// first or `n` is bigger than the buffer. Valid until the next read.
+String buf_reader_peek(Buffered_Reader* r, isize n);
+
+// Read up to and including the next `delim`, the result is a view into the
+// buffer valid until the next read. When the delimiter isn't found before the
+// buffer fills up or the stream ends, the view holds everything buffered and
+// doesn't end with `delim`; call again for the rest. Returns the length of the
+// view or (if negative) an error code.
+i64 buf_reader_read_until(Buffered_Reader* r, byte delim, String* out);
+
+// Append everything up to and including the next `delim` to a builder, of any
+// length. Returns the number of bytes appended or (if negative) an error code.
+i64 buf_reader_append_until(Buffered_Reader* r, byte delim, String_Builder* sb);
+
+// Stream interface that reads through the buffer
+IO_Stream buf_reader_stream(Buffered_Reader* r);
+
+// Initialize a writer with a buffer from the allocator, returns false on failure
+bool buf_writer_init(Buffered_Writer* w, IO_Stream sink, Mem_Allocator allocator, isize size);
+
+// Initialize a writer over a caller owned buffer
+void buf_writer_init_buffer(Buffered_Writer* w, IO_Stream sink, byte* buf, isize size);
+
+// Free the buffer if it was allocated, does not flush
+void buf_writer_destroy(Buffered_Writer* w);
+
+// Write buffer of bytes. Returns number of bytes taken or (if negative) an error
+// code.
+i64 buf_writer_write(Buffered_Writer* w, byte const* buf, isize buflen);
+
+// Write everything buffered to the sink. Returns total number of bytes written
+// or (if negative) an error code.
+i64 buf_writer_flush(Buffered_Writer* w);
+
+// Stream interface that writes through the buffer
+IO_Stream buf_writer_stream(Buffered_Writer* w);
+
+//// Case Folding //////////////////////////////////////////////////////////////
+// Simple (one to one) Unicode case folding, runes without a folding are
+// returned as they are. Tables are generated by case-tables.py.
+rune rune_fold(rune r);
+
+// Simple Unicode lowercase mapping
+rune rune_to_lower(rune r);
+
+// Check if 2 strings are equal ignoring case (simple case folding). Invalid
+// UTF-8 bytes only match the same byte. ASCII runs are compared with SSE4 when
+// available.
+bool str_eq_fold(String a, String b);
+
+// Hash of the case folded string, strings that are equal under str_eq_fold()
+// have the same hash. Not suited for untrusted keys, there is no seed.
+u64 str_hash_fold(String s);
+
+// Append lowercase string to builder, invalid UTF-8 bytes are copied as they
+// are. Returns < 0 if an error occours and number of bytes added otherwhise
+isize str_to_lower(String_Builder* sb, String s);
+
+//// Numbers ///////////////////////////////////////////////////////////////////
+// Locale independent number formatting and parsing, nothing is allocated.
+
+// Maximum number of bytes written by fmt_u64() and fmt_i64()
+#define FMT_INT_MAX 20
+
+// Maximum number of bytes written by fmt_f64()
+#define FMT_F64_MAX 25
+
+// Write decimal representation of integer to `out`, returns number of bytes written
+isize fmt_u64(byte* out, u64 v);
+
+isize fmt_i64(byte* out, i64 v);
+
+// Write shortest decimal representation that parses back to the same value
+// (Schubfach algorithm). Uses plain notation for exponents in [-6, 21) and
+// scientific ("1.5e+300") otherwise, like JavaScript. Non finite values are
+// written as "nan", "inf" and "-inf". Returns number of bytes written.
+isize fmt_f64(byte* out, f64 v);
+
+// Append decimal integer to builder. Returns < 0 if an error occours and number
+// of bytes added otherwhise
+isize sb_append_u64(String_Builder* sb, u64 v);
+
+isize sb_append_i64(String_Builder* sb, i64 v);
+
+// Append shortest round trip representation of float to builder, see fmt_f64()
+isize sb_append_f64(String_Builder* sb, f64 v);
+
+// Parse whole string as an unsigned decimal integer with an optional '+'.
+// Returns false on invalid input or overflow, `out` is left untouched.
+bool str_parse_u64(String s, u64* out);
+
+// Parse whole string as a signed decimal integer
+bool str_parse_i64(String s, i64* out);
+
+// Parse whole string as a float: [+-]digits[.digits][(e|E)[+-]digits],
+// "inf", "infinity" or "nan" (any case). The result is correctly rounded,
+// digits past the 19th only go to the slow path when they affect rounding.
+bool str_parse_f64(String s, f64* out);
+
+//// Format ////////////////////////////////////////////////////////////////////
+// Type safe formatting: every `{}` in the format string is replaced by the next
+// argument, `{{` and `}}` stand for literal braces. Arguments are tagged with
+// their type through _Generic, so there are no format specifiers to get wrong:
+//   sb_format(&sb, "{} of {} done ({}%)", done, total, 100.0 * done / total);
+// Integers, floats, bool, char variables (as characters, character literals
+// are int in C), String and C strings are supported, other types go through
+// fmt_custom(). Up to 12 arguments, compound literals have to be wrapped in
+// parentheses.
+typedef struct Format_Writer Format_Writer;
+typedef struct Format_Arg Format_Arg;
+
+// Formats a user type, see fmt_custom()
+typedef void (*Format_Func)(Format_Writer* w, void const* value);
+
+enum Format_Kind {
+	Fmt_Kind_I64    = 0,
+	Fmt_Kind_U64    = 1,
+	Fmt_Kind_F64    = 2,
+	Fmt_Kind_Bool   = 3,
+	Fmt_Kind_Char   = 4,
+	Fmt_Kind_String = 5,
+	Fmt_Kind_Cstr   = 6,
+	Fmt_Kind_Custom = 7,
+};
+
+struct Format_Arg {
+	u8 kind;
+	union {
+		i64 i;
+		u64 u;
+		f64 f;
+		String s;
+		cstring cs;
+		struct {
+			void const* value;
+			Format_Func func;
+		} custom;
+	};
+};
+
+// Formatted output goes either straight into a string builder or into a
+// caller supplied buffer that is flushed to a stream whenever it fills up.
+struct Format_Writer {
+	byte* buf;
+	isize len;
+	isize cap;
+	String_Builder* sb;
+	IO_Stream stream;
+	i64 written;
+	i64 error;
+};
+
+// Writer that appends to a builder, call fmt_writer_flush() when done
+Format_Writer fmt_writer_builder(String_Builder* sb);
+
+// Writer that buffers into `buf` (at least FMT_F64_MAX bytes) and writes to a
+// stream, call fmt_writer_flush() when done
+Format_Writer fmt_writer_stream(IO_Stream s, byte* buf, isize buflen);
+
+// Push pending output to the builder or stream. Returns total number of bytes
+// written by the writer or (if negative) the first error it ran into.
+i64 fmt_writer_flush(Format_Writer* w);
+
+// Write raw bytes
+void fmt_write_bytes(Format_Writer* w, byte const* data, isize len);
+
+// Write a formatted argument list, see the macros below
+void fmt_write_args(Format_Writer* w, String format, Format_Arg const* args, isize nargs);
+
+// Append formatted text to builder. Returns < 0 if an error occours and number
+// of bytes added otherwhise
+isize sb_format_args(String_Builder* sb, String format, Format_Arg const* args, isize nargs);
+
+// Write formatted text to a stream, using `buf` to batch the writes. Returns
+// number of bytes written or (if negative) an error code.
+i64 io_format_args(IO_Stream s, byte* buf, isize buflen, String format, Format_Arg const* args, isize nargs);
+
+static inline Format_Arg fmt_arg_i64(i64 v){ return (Format_Arg){ .kind = Fmt_Kind_I64, .i = v }; }
+static inline Format_Arg fmt_arg_u64(u64 v){ return (Format_Arg){ .kind = Fmt_Kind_U64, .u = v }; }
+static inline Format_Arg fmt_arg_f64(f64 v){ return (Format_Arg){ .kind = Fmt_Kind_F64, .f = v }; }
+static inline Format_Arg fmt_arg_bool(bool v){ return (Format_Arg){ .kind = Fmt_Kind_Bool, .u = v }; }
+static inline Format_Arg fmt_arg_char(char v){ return (Format_Arg){ .kind = Fmt_Kind_Char, .u = (u8)v }; }
+static inline Format_Arg fmt_arg_str(String v){ return (Format_Arg){ .kind = Fmt_Kind_String, .s = v }; }
+static inline Format_Arg fmt_arg_cstr(cstring v){ return (Format_Arg){ .kind = Fmt_Kind_Cstr, .cs = v }; }
+static inline Format_Arg fmt_arg_self(Format_Arg v){ return v; }
+
+// Argument formatted by `func`, `value` must stay alive until it's written
+#define fmt_custom(ValuePtr, Func) \
+	((Format_Arg){ .kind = Fmt_Kind_Custom, .custom = { .value = (ValuePtr), .func = (Func) } })
+
+// Tag a value with its type
+#define fmt_arg(X) _Generic((X), \
+	bool: fmt_arg_bool, \
+	char: fmt_arg_char, \
+	signed char: fmt_arg_i64, \
+	short: fmt_arg_i64, \
+	int: fmt_arg_i64, \
+	long: fmt_arg_i64, \
+	long long: fmt_arg_i64, \
+	unsigned char: fmt_arg_u64, \
+	unsigned short: fmt_arg_u64, \
+	unsigned int: fmt_arg_u64, \
+	unsigned long: fmt_arg_u64, \
+	unsigned long long: fmt_arg_u64, \
+	float: fmt_arg_f64, \
+	double: fmt_arg_f64, \
+	String: fmt_arg_str, \
+	char*: fmt_arg_cstr, \
+	char const*: fmt_arg_cstr, \
+	Format_Arg: fmt_arg_self)(X)
+
+#define FMT_CAT_(A, B) A##B
+#define FMT_CAT(A, B) FMT_CAT_(A, B)
+#define FMT_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, N, ...) N
+#define FMT_NARGS(...) FMT_NARGS_(__VA_ARGS__, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, _)
+#define FMT_MAP_1(X) fmt_arg(X)
+#define FMT_MAP_2(X, ...) fmt_arg(X), FMT_MAP_1(__VA_ARGS__)
+#define FMT_MAP_3(X, ...) fmt_arg(X), FMT_MAP_2(__VA_ARGS__)
+#define FMT_MAP_4(X, ...) fmt_arg(X), FMT_MAP_3(__VA_ARGS__)
+#define FMT_MAP_5(X, ...) fmt_arg(X), FMT_MAP_4(__VA_ARGS__)
+#define FMT_MAP_6(X, ...) fmt_arg(X), FMT_MAP_5(__VA_ARGS__)
+#define FMT_MAP_7(X, ...) fmt_arg(X), FMT_MAP_6(__VA_ARGS__)
+#define FMT_MAP_8(X, ...) fmt_arg(X), FMT_MAP_7(__VA_ARGS__)
+#define FMT_MAP_9(X, ...) fmt_arg(X), FMT_MAP_8(__VA_ARGS__)
+#define FMT_MAP_10(X, ...) fmt_arg(X), FMT_MAP_9(__VA_ARGS__)
+#define FMT_MAP_11(X, ...) fmt_arg(X), FMT_MAP_10(__VA_ARGS__)
+#define FMT_MAP_12(X, ...) fmt_arg(X), FMT_MAP_11(__VA_ARGS__)
+#define FMT_ARGS_0(Fmt) str_lit(Fmt), null, 0
+#define FMT_ARGS_N(N, Fmt, ...) str_lit(Fmt), (Format_Arg[]){ FMT_CAT(FMT_MAP_, N)(__VA_ARGS__) }, N
+#define FMT_ARGS_1(Fmt, ...) FMT_ARGS_N(1, Fmt, __VA_ARGS__)
+#define FMT_ARGS_2(Fmt, ...) FMT_ARGS_N(2, Fmt, __VA_ARGS__)
+#define FMT_ARGS_3(Fmt, ...) FMT_ARGS_N(3, Fmt, __VA_ARGS__)
+#define FMT_ARGS_4(Fmt, ...) FMT_ARGS_N(4, Fmt, __VA_ARGS__)
+#define FMT_ARGS_5(Fmt, ...) FMT_ARGS_N(5, Fmt, __VA_ARGS__)
+#define FMT_ARGS_6(Fmt, ...) FMT_ARGS_N(6, Fmt, __VA_ARGS__)
+#define FMT_ARGS_7(Fmt, ...) FMT_ARGS_N(7, Fmt, __VA_ARGS__)
+#define FMT_ARGS_8(Fmt, ...) FMT_ARGS_N(8, Fmt, __VA_ARGS__)
+#define FMT_ARGS_9(Fmt, ...) FMT_ARGS_N(9, Fmt, __VA_ARGS__)
+#define FMT_ARGS_10(Fmt, ...) FMT_ARGS_N(10, Fmt, __VA_ARGS__)
+#define FMT_ARGS_11(Fmt, ...) FMT_ARGS_N(11, Fmt, __VA_ARGS__)
+#define FMT_ARGS_12(Fmt, ...) FMT_ARGS_N(12, Fmt, __VA_ARGS__)
+// Expands a string literal and its arguments to `format, args, nargs`
+#define FMT_ARGS(...) FMT_CAT(FMT_ARGS_, FMT_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+// Append formatted text to builder, format must be a string literal
+#define sb_format(Builder, ...) sb_format_args((Builder), FMT_ARGS(__VA_ARGS__))
+
+// Write formatted text to a stream through a buffer
+#define io_format(Stream, Buf, Buflen, ...) io_format_args((Stream), (Buf), (Buflen), FMT_ARGS(__VA_ARGS__))
+
+// Write formatted text to a writer, for use inside Format_Func
+#define fmt_write(Writer, ...) fmt_write_args((Writer), FMT_ARGS(__VA_ARGS__))
+
 //// Time //////////////////////////////////////////////////////////////////////
 typedef struct Time_Point Time_Point;
 
@@ -629,3 +1526,196 @@ Time_Duration time_duration_diff(Time_Duration a, Time_Duration b);
 Mem_Allocator libc_allocator();
 
 #endif
+
+//// Thread ////////////////////////////////////////////////////////////////////
+#ifndef TARGET_OS_FREESTANDING
+typedef struct Thread Thread;
+typedef struct Thread_Context Thread_Context;
+
+typedef void (*Thread_Func)(void* arg);
+
+// Default size of a thread's temp arena
+#define THREAD_TEMP_SIZE_DEFAULT (1024ll * 1024ll)
+
+// Implicit per-thread state, used by code that does not want to receive an
+// allocator or logger through every call.
+struct Thread_Context {
+	Mem_Allocator allocator;
+	Logger logger;
+	Mem_Arena temp_arena;
+};
+
+struct Thread {
+	uintptr _handle;
+	void* _launch;
+};
+
+// Spawn a thread running func(arg). The new thread inherits the caller's
+// context allocator and logger, and gets its own temp arena of `temp_size`
+// bytes (THREAD_TEMP_SIZE_DEFAULT if <= 0) allocated up front from the
+// caller's context allocator. Returns success status.
+bool thread_create(Thread* t, Thread_Func func, void* arg, isize temp_size);
+
+// Wait for thread to finish and release its temp arena. Returns success status.
+bool thread_join(Thread* t);
+
+// Get current thread's context. Threads not started with thread_create()
+// (including main) start with libc_allocator(), a console logger and a
+// THREAD_TEMP_SIZE_DEFAULT temp arena that is allocated on first use and
+// never released.
+Thread_Context* thread_context();
+
+// Override context's allocator, returns previous one, which must be given back
+// to context_pop_allocator()
+Mem_Allocator context_push_allocator(Mem_Allocator allocator);
+
+// Restore context's allocator
+void context_pop_allocator(Mem_Allocator previous);
+
+// Override context's logger, returns previous one, which must be given back
+// to context_pop_logger()
+Logger context_push_logger(Logger logger);
+
+// Restore context's logger
+void context_pop_logger(Logger previous);
+
+// Get allocator of the current context
+Mem_Allocator context_allocator();
+
+// Get logger of the current context
+Logger context_logger();
+
+// Get the temp arena of the current context as an allocator
+Mem_Allocator temp_allocator();
+
+// Mark the current position of the temp arena, everything allocated after it
+// is released by temp_end(mark)
+isize temp_begin();
+
+// Release temp allocations done after mark
+void temp_end(isize mark);
+#endif
+
+//// Files /////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+typedef struct File File;
+typedef struct IO_Buffer IO_Buffer;
+
+enum File_Mode {
+	File_Read      = 1 << 0,
+	File_Write     = 1 << 1,
+	File_Create    = 1 << 2, // Create the file if it doesn't exist
+	File_Truncate  = 1 << 3,
+	File_Append    = 1 << 4, // Every write goes to the end of the file
+	File_Exclusive = 1 << 5, // Fail if the file exists (with File_Create)
+};
+
+// Access pattern hints, see posix_fadvise()
+enum File_Advice {
+	File_Advice_Normal     = 0,
+	File_Advice_Sequential = 1,
+	File_Advice_Random     = 2,
+	File_Advice_Will_Need  = 3,
+	File_Advice_Dont_Need  = 4,
+};
+
+// Longest path file_open() accepts (in bytes)
+#define FILE_PATH_MAX 4096
+
+// Most buffers a single vectored read or write takes
+#define FILE_IO_BUFFERS_MAX 1024
+
+// File descriptor and the mode it was opened with
+struct File {
+	i32 fd;
+	u32 mode;
+};
+
+// Buffer for vectored IO, same layout as `struct iovec` so lists of them are
+// handed to the kernel as is
+struct IO_Buffer {
+	byte* data;
+	isize len;
+};
+
+// Open a file, `mode` is a combination of File_Mode flags. Created files get
+// permissions 0666 minus the process umask. Returns success status.
+bool file_open(File* f, String path, u32 mode);
+
+// Wrap an already open descriptor (e.g. 0, 1, 2 for the standard streams)
+File file_from_fd(i32 fd, u32 mode);
+
+// Close the file. Returns success status.
+bool file_close(File* f);
+
+// Read at the current position. Returns number of bytes read or (if negative)
+// an error code, IO_Err_End_Of_Stream at the end of the file.
+i64 file_read(File* f, byte* buf, isize buflen);
+
+// Write at the current position. Returns number of bytes written or (if
+// negative) an error code.
+i64 file_write(File* f, byte const* buf, isize buflen);
+
+// Read at an offset without moving the current position, safe to use from
+// several threads at once. Returns like file_read().
+i64 file_read_at(File* f, byte* buf, isize buflen, i64 offset);
+
+// Write at an offset without moving the current position. Returns like
+// file_write().
+i64 file_write_at(File* f, byte const* buf, isize buflen, i64 offset);
+
+// Read into several buffers with one call, filling them in order. At most
+// FILE_IO_BUFFERS_MAX buffers are used. Returns like file_read().
+i64 file_readv(File* f, IO_Buffer const* bufs, isize count);
+
+// Write several buffers with one call, in order. At most FILE_IO_BUFFERS_MAX
+// buffers are used. Returns like file_write().
+i64 file_writev(File* f, IO_Buffer const* bufs, isize count);
+
+// Size of the file (in bytes) or (if negative) an error code
+i64 file_size(File* f);
+
+// Tell the kernel how a range will be accessed (`len` 0 is up to the end),
+// File_Advice_Sequential makes it read ahead further. Returns success status.
+bool file_advise(File* f, i64 offset, i64 len, u8 advice);
+
+// Stream interface reading and writing at the current position
+IO_Stream file_stream(File* f);
+#endif
+
+//// Mapped Files //////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+typedef struct Mapped_File Mapped_File;
+
+enum Map_Mode {
+	Map_Read       = 1 << 0,
+	Map_Write      = 1 << 1, // Writes go back to the file
+	Map_Private    = 1 << 2, // Writable, but writes stay private to the mapping
+	Map_Populate   = 1 << 3, // Read the whole file in up front, no page faults later
+	Map_Huge_Pages = 1 << 4, // Align to huge pages and ask for them, if the kernel can back the file with them
+};
+
+// Huge page size used to align mappings, files smaller than this are mapped
+// with regular pages
+#define MMAP_HUGE_PAGE_SIZE (2ll * 1024ll * 1024ll)
+
+// File contents mapped into memory, `data` and `len` can be used as a String
+// (str_from_bytes) as long as the mapping lives
+struct Mapped_File {
+	byte* data;
+	isize len;
+};
+
+// Map a whole file, `mode` is a combination of Map_Mode flags. The file does
+// not need to stay open. Empty files succeed with no data. Returns success
+// status.
+bool mmap_file(Mapped_File* m, String path, u32 mode);
+
+// Tell the kernel how a range (`len` 0 is up to the end) will be accessed,
+// takes the same File_Advice hints as file_advise(). File_Advice_Dont_Need
+// drops private changes. Returns success status.
+bool mmap_file_advise(Mapped_File* m, isize offset, isize len, u8 advice);
+
+// Unmap the file, its data must not be used anymore. Returns success status.
+bool mmap_file_unmap(Mapped_File* m);
+#endif
@@ -3,12 +3,241 @@
 
 #define MEM_SIZE (400ll)
 
+static
+i64 string_source(void* impl, byte op, byte* buf, isize buflen){
+	String* s = impl;
+	if(op != IO_Read){ return IO_Err_Unsupported; }
+	isize n = min(buflen, s->len);
+	mem_copy(buf, s->data, n);
+	*s = str_from_bytes(s->data + n, s->len - n);
+	return n;
+}
+
+/* Forwards to the libc allocator, counting frees into an isize at impl */
+static
+void* counting_allocator_func(void * restrict impl, byte op, void* old_ptr, isize size, isize align, i32* capabilities){
+	if(op == Mem_Op_Free){ *(isize*)impl += 1; }
+	Mem_Allocator libc = libc_allocator();
+	return libc.func(libc.data, op, old_ptr, size, align, capabilities);
+}
+
+static
+void count_to_thousand(void* counter){
+	for(int i = 0; i < 1000; i += 1){
+		sharded_counter_add(counter, 1);
+	}
+}
+
+typedef struct {
+	Mem_Arena* parent_temp;
+	Mem_Allocator override;
+	_Atomic(int) stage;
+	bool own_temp;
+	bool pushed;
+	bool popped;
+} Context_Probe;
+
+/* Pushes an allocator, holds it until main has looked at its own context,
+ * then pops it */
+static
+void probe_context(void* arg){
+	Context_Probe* p = arg;
+	Mem_Arena* temp = &thread_context()->temp_arena;
+	p->own_temp = temp != p->parent_temp && temp->data != p->parent_temp->data && temp->capacity == 4096;
+
+	Mem_Allocator previous = context_push_allocator(p->override);
+	p->pushed = context_allocator().data == p->override.data;
+	atomic_store(&p->stage, 1);
+	while(atomic_load(&p->stage) != 2){}
+
+	context_pop_allocator(previous);
+	p->popped = context_allocator().func == previous.func && context_allocator().data == previous.data;
+}
+
+static
+void wake_later(void* flag){
+	time_sleep(time_millisecond);
+	atomic_store((atomic_int*)flag, 1);
+	atomic_notify_all(flag);
+}
+
 int main(){
 	bool ok = 0;
 
+#if defined(ENABLE_LOCK_PROFILING)
+	/* Runs first so no other lock has been profiled yet */
+	static Spinlock profiled;
+	Lock_Profile_Entry entries[4];
+	for(int i = 0; i < 3; i += 1){ spinlock_acquire(&profiled); spinlock_release(&profiled); }
+	spinlock_acquire(&profiled); spinlock_release(&profiled);
+	isize sites = lock_profile_collect(entries, 4);
+	/* Entries come sorted by wait time, the loop is the call site on the earlier line */
+	Lock_Profile_Entry loop = entries[0], once = entries[1];
+	if(loop.location.line > once.location.line){ loop = entries[1]; once = entries[0]; }
+	ok = sites == 2 && loop.lock == &profiled && once.lock == &profiled &&
+		loop.location.line + 1 == once.location.line && loop.acquires == 3 && once.acquires == 1;
+	printf("%d\n", ok);
+#endif
+
 	ok = str_ends_with(str_lit("Some/Path.json"), str_lit(".json"));
 	printf("%d\n", ok);
 	ok = str_starts_with(str_lit(""), str_lit("Some/Path.json"));
 	printf("%d\n", ok);
+	ok = utf8_validate((byte const*)"caf\xc3\xa9 \xe2\x82\xac", 9) && !utf8_validate((byte const*)"\xc0\xaf", 2);
+	printf("%d\n", ok);
+	String_Builder mixed;
+	sb_init(&mixed, libc_allocator(), 16);
+	for(isize i = 0; i < 100; i += 1){ sb_append_str(&mixed, str_lit("ab\xc3\xa9\xe4\xb8\xad")); }
+	String text = str_from_bytes(mixed.data, mixed.len);
+	Str_Index text_index;
+	ok = str_index_init(&text_index, text, libc_allocator()) && str_codepoint_count(text) == 400 &&
+		str_codepoint_offset(text, 130) == 226 && str_index_offset(&text_index, 130) == 226 &&
+		str_eq(str_index_sub(&text_index, 398, 5), str_lit("\xc3\xa9\xe4\xb8\xad")) &&
+		str_index_offset(&text_index, 1000) == 700 && str_index_sub(&text_index, 500, 1).len == 0;
+	printf("%d\n", ok);
+	str_index_destroy(&text_index);
+	sb_destroy(&mixed);
+	String ascii_around = str_lit("plain ascii run \xe2\x82\xac another ascii run");
+	UTF8_Iterator fwd = str_iterator(ascii_around), back = str_iterator_reversed(ascii_around);
+	rune cur = 0, euro_fwd = 0, euro_back = 0;
+	i8 cur_len = 0;
+	isize runes_fwd = 0, runes_back = 0;
+	while(utf8_iter_next(&fwd, &cur, &cur_len)){ runes_fwd += 1; if(cur_len == 3){ euro_fwd = cur; } }
+	while(utf8_iter_prev(&back, &cur, &cur_len)){ runes_back += 1; if(cur_len == 3){ euro_back = cur; } }
+	ok = runes_fwd == 35 && runes_back == 35 && euro_fwd == 0x20ac && euro_back == 0x20ac &&
+		utf8_rune_offset(ascii_around.data, ascii_around.len, 17, null) == 19 &&
+		str_codepoint_offset(ascii_around, 16) == 16 && str_codepoint_offset(ascii_around, 34) == 36 &&
+		str_eq(str_trim(str_lit(" \t\xc2\xa0x y\xc2\xa0 "), str_lit(" \t")), str_lit("\xc2\xa0x y\xc2\xa0")) &&
+		str_eq(str_trim(str_lit(" \t\xc2\xa0x y\xc2\xa0 "), str_lit(" \t\xc2\xa0")), str_lit("x y"));
+	printf("%d\n", ok);
+	Cutset spaces;
+	cutset_init(&spaces, str_lit(" \t"), libc_allocator());
+	ok = str_eq(str_trim_set(str_lit(" \t key \t"), &spaces), str_lit("key"));
+	printf("%d\n", ok);
+	cutset_destroy(&spaces);
+	ok = str_find(str_lit("a=b=c"), str_lit("=")) == 1 && str_rfind(str_lit("a=b=c"), str_lit("=")) == 3;
+	printf("%d\n", ok);
+	isize tokens = 0;
+	Str_Splitter it = str_fields(str_lit("  one two\tthree \n"));
+	for(String tok; str_split_next(&it, &tok);){ tokens += 1; }
+	printf("%d\n", tokens == 3);
+	u16 wide[4];
+	isize units = utf8_to_utf16(wide, 4, (byte const*)"a\xf0\x9f\x98\x80", 5, null);
+	ok = units == 3 && wide[1] == 0xd83d && utf16_to_utf8_len(wide, units) == 5;
+	printf("%d\n", ok);
+	ok = str_eq_fold(str_lit("Content-Type \xce\xa3"), str_lit("content-TYPE \xcf\x82")) &&
+		str_hash_fold(str_lit("Host")) == str_hash_fold(str_lit("hOST")) && rune_to_lower(0x130) == 'i';
+	printf("%d\n", ok);
+	byte num[FMT_F64_MAX];
+	f64 parsed = 0;
+	isize num_len = fmt_f64(num, 0.1);
+	ok = num_len == 3 && str_parse_f64(str_from_bytes(num, num_len), &parsed) && parsed == 0.1;
+	printf("%d\n", ok);
+	String_Builder sb;
+	sb_init(&sb, libc_allocator(), 4);
+	sb_format(&sb, "{{{}}}={}", str_lit("pi"), 3.25);
+	ok = str_eq(str_from_bytes(sb.data, sb.len), str_lit("{pi}=3.25"));
+	printf("%d\n", ok);
+	sb_destroy(&sb);
+	Chunk_Builder cb;
+	chunk_builder_init(&cb, libc_allocator(), 8);
+	chunk_builder_append_str(&cb, str_lit("split across "));
+	chunk_builder_append_str(&cb, str_lit("several chunks"));
+	String built = chunk_builder_build(&cb);
+	ok = cb.head->next != null && str_eq(built, str_lit("split across several chunks"));
+	printf("%d\n", ok);
+	mem_free(libc_allocator(), (void*)built.data);
+	chunk_builder_destroy(&cb);
+	static byte rope_mem[4096];
+	Mem_Arena rope_arena;
+	arena_init(&rope_arena, rope_mem, sizeof(rope_mem));
+	Rope hello, world, greeting, tail;
+	rope_init(&hello, str_lit("h\xc3\xa9llo, "), arena_allocator(&rope_arena));
+	rope_init(&world, str_lit("w\xc3\xb6rld"), hello.allocator);
+	ok = rope_concat(&greeting, hello, world) && rope_sub_runes(&tail, greeting, 7, 5) &&
+		rope_rune_count(greeting) == 12 && rope_rune_at(tail, 1) == 0xf6 && rope_len(tail) == 6;
+	printf("%d\n", ok);
+	Rope euro, cut, first;
+	rope_init(&euro, str_lit("\xe2\x82\xac" "abc"), hello.allocator);
+	ok = rope_sub(&cut, euro, 1, 5) && rope_rune_count(cut) == 3 && rope_rune_offset(cut, 0) == 2 &&
+		rope_rune_at(cut, 0) == 'a' && rope_sub_runes(&first, cut, 0, 1) && rope_len(first) == 1;
+	printf("%d\n", ok);
+	arena_destroy(&rope_arena);
+	cstring line = "key: value\r\nnext: line, with \"quotes\"";
+	isize line_len = cstring_len(line);
+	ok = line_len == 37 && mem_find_byte(line, '\n', line_len) == 11 &&
+		mem_rfind_byte(line, ':', line_len) == 16 && mem_find_any_of(line, (byte const*)",\"", 2, line_len) == 22;
+	printf("%d\n", ok);
+	ok = str_compare(str_lit("apple"), str_lit("apples")) < 0 && str_compare(str_lit("b"), str_lit("apple")) > 0 &&
+		str_compare_runes(str_lit("\xc3\xa9"), str_lit("z")) > 0 && str_common_prefix_len(str_lit("/api/users"), str_lit("/api/items")) == 5 &&
+		str_eq(str_lit("a key longer than sixteen bytes"), str_lit("a key longer than sixteen bytes"));
+	printf("%d\n", ok);
+	String request = str_lit("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+	byte line_buf[16];
+	Buffered_Reader reader;
+	buf_reader_init_buffer(&reader, (IO_Stream){ .data = &request, .func = string_source }, line_buf, sizeof(line_buf));
+	String req_line, host_start, host_rest;
+	ok = str_eq(buf_reader_peek(&reader, 3), str_lit("GET")) && buf_reader_read_until(&reader, '\n', &req_line) == 16 &&
+		buf_reader_read_until(&reader, '\n', &host_start) == 16 && str_eq(host_start, str_lit("Host: example.co")) &&
+		buf_reader_read_until(&reader, '\n', &host_rest) == 3 && buf_reader_read_until(&reader, '\n', &host_rest) == 2 &&
+		buf_reader_read_until(&reader, '\n', &host_rest) == IO_Err_End_Of_Stream;
+	printf("%d\n", ok);
+	File null_file;
+	IO_Buffer parts[2] = { { (byte*)"to ", 3 }, { (byte*)"nowhere", 7 } };
+	ok = file_open(&null_file, str_lit("/dev/null"), File_Read | File_Write) && file_writev(&null_file, parts, 2) == 10 &&
+		file_read(&null_file, line_buf, sizeof(line_buf)) == IO_Err_End_Of_Stream && file_close(&null_file);
+	printf("%d\n", ok);
+	isize epoch_freed = 0;
+	Mem_Allocator counting = { .func = counting_allocator_func, .data = &epoch_freed };
+	Epoch_Domain domain;
+	epoch_domain_init(&domain, libc_allocator());
+	Epoch_Participant* retirer = epoch_register(&domain);
+	Epoch_Participant* pinned = epoch_register(&domain);
+	epoch_enter(pinned);
+	epoch_enter(pinned);
+	epoch_exit(pinned);
+	ok = epoch_retire(retirer, mem_alloc(counting, 64, 8), 64, 8, counting);
+	for(int i = 0; i < 4; i += 1){ epoch_collect(retirer); }
+	ok = ok && epoch_freed == 0;
+	epoch_exit(pinned);
+	epoch_barrier(retirer);
+	ok = ok && epoch_freed == 1 && pinned->nesting == 0;
+	printf("%d\n", ok);
+	epoch_unregister(pinned);
+	epoch_unregister(retirer);
+	epoch_domain_destroy(&domain);
+	isize override_frees = 0;
+	Context_Probe probe = {
+		.parent_temp = &thread_context()->temp_arena,
+		.override = { .func = counting_allocator_func, .data = &override_frees },
+	};
+	Thread prober;
+	ok = thread_create(&prober, probe_context, &probe, 4096);
+	while(ok && atomic_load(&probe.stage) != 1){}
+	ok = ok && context_allocator().data != probe.override.data;
+	atomic_store(&probe.stage, 2);
+	ok = ok && thread_join(&prober) && probe.own_temp && probe.pushed && probe.popped;
+	printf("%d\n", ok);
+	atomic_int wake_flag = 0;
+	Thread waker;
+	Time_Point wait_start = time_now();
+	ok = !atomic_wait_timeout(&wake_flag, 0, memory_order_acquire, 200 * time_microsecond) &&
+		time_since(wait_start) >= 200 * time_microsecond && thread_create(&waker, wake_later, &wake_flag, 4096);
+	if(ok){ atomic_wait(&wake_flag, 0, memory_order_acquire); }
+	ok = ok && atomic_load(&wake_flag) == 1 && atomic_wait_timeout(&wake_flag, 0, memory_order_acquire, time_second) &&
+		thread_join(&waker);
+	printf("%d\n", ok);
+	static Sharded_Counter counter;
+	Thread counters[4];
+	ok = true;
+	for(int i = 0; i < 4; i += 1){ ok = ok && thread_create(&counters[i], count_to_thousand, &counter, 4096); }
+	for(int i = 0; i < 4; i += 1){ ok = ok && thread_join(&counters[i]); }
+	ok = ok && sharded_counter_sum(&counter) == 4000;
+	printf("%d\n", ok);
+	Mapped_File self_exe;
+	ok = mmap_file(&self_exe, str_lit("/proc/self/exe"), Map_Read | Map_Huge_Pages) &&
+		str_starts_with(str_from_bytes(self_exe.data, self_exe.len), str_lit("\x7f" "ELF")) &&
+		mmap_file_advise(&self_exe, 0, 0, File_Advice_Sequential) && mmap_file_unmap(&self_exe);
+	printf("%d\n", ok);
 }
 
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+# Generates the two-level case mapping tables used by rune_fold() and
+# rune_to_lower(), paste the output over the tables in c/prelude.c and
+# cpp/prelude.cpp. Data comes from Python's unicodedata, so the Unicode version
+# is whatever the interpreter ships with.
+#
+#   python3 case-tables.py > tables.txt
+#   python3 case-tables.py --cpp > tables.txt
+import sys
+import unicodedata
+
+BLOCK_SHIFT = 6
+BLOCK_SIZE = 1 << BLOCK_SHIFT
+
+def simple_fold(cp):
+	# Simple (1:1) case folding: the C and S entries of CaseFolding.txt. Runes
+	# with only a multi-rune full folding (F) fall back to their lowercase
+	# mapping when it's a single rune, which is the S entry.
+	ch = chr(cp)
+	folded = ch.casefold()
+	if len(folded) == 1:
+		return ord(folded)
+	lower = ch.lower()
+	if len(lower) == 1:
+		return ord(lower)
+	return cp
+
+# Runes whose full lowercase (SpecialCasing.txt) is several runes while the
+# simple one in UnicodeData.txt (field 13) is a single rune. unicodedata only
+# exposes the full mappings.
+SIMPLE_LOWER = {
+	0x130: 0x69, # LATIN CAPITAL LETTER I WITH DOT ABOVE -> i
+}
+
+def simple_lower(cp):
+	if cp in SIMPLE_LOWER:
+		return SIMPLE_LOWER[cp]
+	lower = chr(cp).lower()
+	return ord(lower) if len(lower) == 1 else cp
+
+def main():
+	runes = [cp for cp in range(0x110000) if not (0xd800 <= cp <= 0xdfff)]
+	deltas = {cp: (simple_fold(cp) - cp, simple_lower(cp) - cp) for cp in runes}
+	deltas = {cp: d for cp, d in deltas.items() if d != (0, 0)}
+
+	limit = max(deltas) + 1
+	pairs = [(0, 0)] + sorted(set(deltas.values()))
+	pair_index = {p: i for i, p in enumerate(pairs)}
+
+	blocks = {}
+	stage1 = []
+	for b in range((limit + BLOCK_SIZE - 1) // BLOCK_SIZE):
+		key = tuple(pair_index[deltas.get(b * BLOCK_SIZE + i, (0, 0))] for i in range(BLOCK_SIZE))
+		if key not in blocks:
+			blocks[key] = len(blocks)
+		stage1.append(blocks[key])
+	stage2 = [i for block in blocks for i in block]
+
+	assert len(pairs) <= 256 and len(blocks) <= 256
+
+	def numbers(values, per_line):
+		lines = []
+		for i in range(0, len(values), per_line):
+			lines.append('\t' + ', '.join(str(v) for v in values[i:i + per_line]) + ',')
+		return '\n'.join(lines)
+
+	cpp = '--cpp' in sys.argv[1:]
+	array = 'constexpr' if cpp else 'static const'
+
+	print('/* Generated by case-tables.py (Unicode %s), do not edit */' % unicodedata.unidata_version)
+	if cpp:
+		print('constexpr rune CASE_LIMIT = 0x%x;' % limit)
+		print('constexpr int CASE_BLOCK_SHIFT = %d;' % BLOCK_SHIFT)
+	else:
+		print('#define CASE_LIMIT 0x%x' % limit)
+		print('#define CASE_BLOCK_SHIFT %d' % BLOCK_SHIFT)
+	print()
+	print('%s u8 case_stage1[%d] = {' % (array, len(stage1)))
+	print(numbers(stage1, 32))
+	print('};')
+	print()
+	print('%s u8 case_stage2[%d] = {' % (array, len(stage2)))
+	print(numbers(stage2, 32))
+	print('};')
+	print()
+	print('/* Fold and lowercase deltas */')
+	print('%s i32 case_deltas[%d][2] = {' % (array, len(pairs)))
+	for i in range(0, len(pairs), 6):
+		print('\t' + ' '.join('{%d, %d},' % p for p in pairs[i:i + 6]))
+	print('};')
+
+main()
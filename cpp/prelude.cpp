@@ -1,9 +1,67 @@
 #include "prelude.hpp"
 
+//// Atomic ////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+
+// Can't include <unistd.h> as its `sync()` collides with namespace sync
+extern "C" long syscall(long number, ...) noexcept;
+
+namespace atomic {
+void futex_wait(void const volatile * addr, u32 expected){
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+bool futex_wait_timeout(void const volatile * addr, u32 expected, i64 timeout_ns){
+	struct timespec spec = {};
+	spec.tv_sec  = timeout_ns / 1000000000ll;
+	spec.tv_nsec = timeout_ns % 1000000000ll;
+	long res = syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, &spec, nullptr, 0);
+	return !(res < 0 && errno == ETIMEDOUT);
+}
+
+void futex_wake_one(void volatile * addr){
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void futex_wake_all(void volatile * addr){
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+} /* Namespace atomic */
+
+#elif defined(TARGET_OS_WINDOWS)
+#pragma comment(lib, "Synchronization.lib")
+
+namespace atomic {
+void futex_wait(void const volatile * addr, u32 expected){
+	WaitOnAddress((void volatile*)addr, &expected, sizeof(expected), INFINITE);
+}
+
+bool futex_wait_timeout(void const volatile * addr, u32 expected, i64 timeout_ns){
+	/* Round up, so a sub-millisecond wait doesn't turn into a busy loop */
+	DWORD ms = (DWORD)((timeout_ns + 999999ll) / 1000000ll);
+	return WaitOnAddress((void volatile*)addr, &expected, sizeof(expected), ms) || GetLastError() != ERROR_TIMEOUT;
+}
+
+void futex_wake_one(void volatile * addr){
+	WakeByAddressSingle((void*)addr);
+}
+
+void futex_wake_all(void volatile * addr){
+	WakeByAddressAll((void*)addr);
+}
+} /* Namespace atomic */
+#endif
+
 //// Sync //////////////////////////////////////////////////////////////////////
 namespace sync {
 using atomic::Memory_Order;
 
+#ifndef ENABLE_LOCK_PROFILING
 void Spinlock::acquire(){
 	for(;;){
 		if(!atomic::exchange(&_state, SPINLOCK_LOCKED, Memory_Order::Acquire)){
@@ -22,6 +80,259 @@ bool Spinlock::try_acquire(){
 void Spinlock::release(){
 	atomic::store(&_state, SPINLOCK_UNLOCKED, Memory_Order::Release);
 }
+#else
+} /* namespace sync */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace sync {
+struct Lock_Profile_Slot {
+	atomic::Atomic<void const*> lock; /* Published last, readers see a complete location */
+	Source_Location location;
+	atomic::Atomic<u64> acquires;
+	atomic::Atomic<u64> contended;
+	atomic::Atomic<u64> spins;
+	atomic::Atomic<i64> wait_ns;
+	atomic::Atomic<i64> hold_ns;
+};
+
+struct Lock_Profile_Buffer {
+	Lock_Profile_Slot slots[LOCK_PROFILE_SLOTS];
+	atomic::Atomic<u64> dropped;
+	Lock_Profile_Buffer* next;
+};
+
+/* Buffers are never freed so the stats of finished threads stay readable */
+static atomic::Atomic<Lock_Profile_Buffer*> lock_profile_buffers{nullptr};
+static thread_local Lock_Profile_Buffer* lock_profile_local = nullptr;
+
+/* Only the owning thread writes its slots, so a relaxed load + store is enough
+ * and avoids a locked instruction on every acquisition. */
+template<typename T>
+static inline
+void profile_bump(atomic::Atomic<T>* field, T delta){
+	atomic::store(field, atomic::load(field, Memory_Order::Relaxed) + delta, Memory_Order::Relaxed);
+}
+
+static inline
+i64 lock_profile_clock(){
+#if defined(TARGET_OS_LINUX)
+	struct timespec spec = {};
+	clock_gettime(CLOCK_MONOTONIC, &spec);
+	return i64(spec.tv_sec) * 1000000000ll + i64(spec.tv_nsec);
+#elif defined(TARGET_OS_WINDOWS)
+	static LARGE_INTEGER freq = {};
+	if(freq.QuadPart == 0){ QueryPerformanceFrequency(&freq); }
+	LARGE_INTEGER count;
+	QueryPerformanceCounter(&count);
+	return i64(double(count.QuadPart) * (1e9 / double(freq.QuadPart)));
+#endif
+}
+
+static
+Lock_Profile_Buffer* lock_profile_buffer(){
+	if(lock_profile_local == nullptr){
+		void* mem = calloc(1, sizeof(Lock_Profile_Buffer));
+		if(mem == nullptr){ return nullptr; }
+		auto buf = new (mem) Lock_Profile_Buffer{};
+		Lock_Profile_Buffer* head = atomic::load(&lock_profile_buffers, Memory_Order::Relaxed);
+		do {
+			buf->next = head;
+		} while(!atomic::compare_exchange_weak(&lock_profile_buffers, &head, buf,
+			Memory_Order::Release, Memory_Order::Relaxed));
+		lock_profile_local = buf;
+	}
+	return lock_profile_local;
+}
+
+static
+Lock_Profile_Slot* lock_profile_slot(void const* lock, Source_Location loc){
+	Lock_Profile_Buffer* buf = lock_profile_buffer();
+	if(buf == nullptr){ return nullptr; }
+
+	uintptr h = (uintptr(lock) >> 4) ^ uintptr(loc.filename) ^ (uintptr(loc.line) * 2654435761u);
+	for(isize i = 0; i < LOCK_PROFILE_SLOTS; i += 1){
+		Lock_Profile_Slot* slot = &buf->slots[(h + i) & (LOCK_PROFILE_SLOTS - 1)];
+		void const* owner = atomic::load(&slot->lock, Memory_Order::Relaxed);
+		if(owner == lock && slot->location.line == loc.line && slot->location.filename == loc.filename){
+			return slot;
+		}
+		if(owner == nullptr){
+			slot->location = loc;
+			atomic::store(&slot->lock, lock, Memory_Order::Release);
+			return slot;
+		}
+	}
+	profile_bump<u64>(&buf->dropped, 1);
+	return nullptr;
+}
+
+void Spinlock::acquire(Source_Location loc){
+	Lock_Profile_Slot* slot = lock_profile_slot(this, loc);
+	u64 spins = 0;
+	i64 wait_start = 0;
+	bool contended = false;
+
+	for(;;){
+		if(!atomic::exchange(&_state, SPINLOCK_LOCKED, Memory_Order::Acquire)){
+			break;
+		}
+		if(!contended){
+			contended = true;
+			wait_start = lock_profile_clock();
+		}
+		/* Busy wait while locked */
+		while(atomic::load(&_state, Memory_Order::Relaxed)){
+			spins += 1;
+		}
+	}
+
+	i64 now = lock_profile_clock();
+	if(slot != nullptr){
+		profile_bump<u64>(&slot->acquires, 1);
+		if(contended){
+			profile_bump<u64>(&slot->contended, 1);
+			profile_bump<u64>(&slot->spins, spins);
+			profile_bump<i64>(&slot->wait_ns, now - wait_start);
+		}
+	}
+	_acquired_at = now;
+	_profile_slot = slot;
+}
+
+bool Spinlock::try_acquire(Source_Location loc){
+	Lock_Profile_Slot* slot = lock_profile_slot(this, loc);
+	bool ok = !atomic::load(&_state, Memory_Order::Relaxed) &&
+		!atomic::exchange(&_state, SPINLOCK_LOCKED, Memory_Order::Acquire);
+	if(ok){
+		if(slot != nullptr){ profile_bump<u64>(&slot->acquires, 1); }
+		_acquired_at = lock_profile_clock();
+		_profile_slot = slot;
+	}
+	else if(slot != nullptr){
+		profile_bump<u64>(&slot->contended, 1);
+	}
+	return ok;
+}
+
+void Spinlock::release(){
+	/* Read the holder's bookkeeping before another thread can overwrite it */
+	auto slot = (Lock_Profile_Slot*)_profile_slot;
+	i64 held = lock_profile_clock() - _acquired_at;
+	_profile_slot = nullptr;
+	atomic::store(&_state, SPINLOCK_UNLOCKED, Memory_Order::Release);
+	if(slot != nullptr){
+		profile_bump<i64>(&slot->hold_ns, held);
+	}
+}
+
+isize lock_profile_collect(Slice<Lock_Profile_Entry> out){
+	isize count = 0;
+	Lock_Profile_Buffer* buf = atomic::load(&lock_profile_buffers, Memory_Order::Acquire);
+	for(; buf != nullptr; buf = buf->next){
+		for(isize i = 0; i < LOCK_PROFILE_SLOTS; i += 1){
+			Lock_Profile_Slot* slot = &buf->slots[i];
+			void const* lock = atomic::load(&slot->lock, Memory_Order::Acquire);
+			if(lock == nullptr){ continue; }
+
+			/* Same lock and call site from different threads merge into one entry */
+			isize n = 0;
+			for(; n < count; n += 1){
+				if(out[n].lock == lock && out[n].location.line == slot->location.line &&
+				   out[n].location.filename == slot->location.filename){
+					break;
+				}
+			}
+			if(n == count){
+				if(count >= out.size()){ continue; }
+				out[n] = Lock_Profile_Entry{ lock, slot->location, 0, 0, 0, 0, 0 };
+				count += 1;
+			}
+			out[n].acquires  += atomic::load(&slot->acquires, Memory_Order::Relaxed);
+			out[n].contended += atomic::load(&slot->contended, Memory_Order::Relaxed);
+			out[n].spins     += atomic::load(&slot->spins, Memory_Order::Relaxed);
+			out[n].wait_ns   += atomic::load(&slot->wait_ns, Memory_Order::Relaxed);
+			out[n].hold_ns   += atomic::load(&slot->hold_ns, Memory_Order::Relaxed);
+		}
+	}
+	qsort(out.raw_data(), count, sizeof(Lock_Profile_Entry), [](void const* a, void const* b) -> int {
+		i64 wa = ((Lock_Profile_Entry const*)a)->wait_ns;
+		i64 wb = ((Lock_Profile_Entry const*)b)->wait_ns;
+		return (wa < wb) - (wa > wb);
+	});
+	return count;
+}
+
+void lock_profile_report(){
+	constexpr isize max_entries = 64;
+	Lock_Profile_Entry entries[max_entries];
+	isize count = lock_profile_collect(Slice<Lock_Profile_Entry>::from_pointer(entries, max_entries));
+
+	u64 dropped = 0;
+	Lock_Profile_Buffer* buf = atomic::load(&lock_profile_buffers, Memory_Order::Acquire);
+	for(; buf != nullptr; buf = buf->next){
+		dropped += atomic::load(&buf->dropped, Memory_Order::Relaxed);
+	}
+
+	printf("Lock profile (%td call sites, %llu dropped records)\n", count, (unsigned long long)dropped);
+	for(isize i = 0; i < count; i += 1){
+		Lock_Profile_Entry const& e = entries[i];
+		printf("  %p %s:%d %s(): acquires=%llu contended=%llu spins=%llu wait=%.3fms hold=%.3fms\n",
+			e.lock, e.location.filename, e.location.line, e.location.caller_name,
+			(unsigned long long)e.acquires, (unsigned long long)e.contended, (unsigned long long)e.spins,
+			double(e.wait_ns) / 1e6, double(e.hold_ns) / 1e6);
+	}
+}
+
+void lock_profile_reset(){
+	Lock_Profile_Buffer* buf = atomic::load(&lock_profile_buffers, Memory_Order::Acquire);
+	for(; buf != nullptr; buf = buf->next){
+		for(isize i = 0; i < LOCK_PROFILE_SLOTS; i += 1){
+			Lock_Profile_Slot* slot = &buf->slots[i];
+			atomic::store<u64>(&slot->acquires, 0, Memory_Order::Relaxed);
+			atomic::store<u64>(&slot->contended, 0, Memory_Order::Relaxed);
+			atomic::store<u64>(&slot->spins, 0, Memory_Order::Relaxed);
+			atomic::store<i64>(&slot->wait_ns, 0, Memory_Order::Relaxed);
+			atomic::store<i64>(&slot->hold_ns, 0, Memory_Order::Relaxed);
+		}
+		atomic::store<u64>(&buf->dropped, 0, Memory_Order::Relaxed);
+	}
+}
+#endif
+
+static inline
+isize current_cpu_slot(){
+#if defined(TARGET_OS_LINUX)
+	int cpu = sched_getcpu();
+#elif defined(TARGET_OS_WINDOWS)
+	int cpu = (int)GetCurrentProcessorNumber();
+#endif
+	if(cpu < 0){
+		/* No CPU info, spread threads by the address of their thread local storage */
+		thread_local byte marker;
+		cpu = (int)(((uintptr)&marker) >> 12);
+	}
+	return (isize)cpu & (SHARDED_COUNTER_SLOTS - 1);
+}
+
+void Sharded_Counter::add(i64 delta){
+	atomic::fetch_add(&_slots[current_cpu_slot()].value, delta, Memory_Order::Relaxed);
+}
+
+i64 Sharded_Counter::sum() const {
+	i64 total = 0;
+	for(isize i = 0; i < SHARDED_COUNTER_SLOTS; i += 1){
+		total += atomic::load(&_slots[i].value, Memory_Order::Relaxed);
+	}
+	return total;
+}
+
+void Sharded_Counter::reset(){
+	for(isize i = 0; i < SHARDED_COUNTER_SLOTS; i += 1){
+		atomic::store(&_slots[i].value, (i64)0, Memory_Order::Relaxed);
+	}
+}
 }
 
 //// Assert ////////////////////////////////////////////////////////////////////
@@ -55,7 +366,7 @@ void bounds_check_assert_ex(bool pred, cstring msg, Source_Location loc){
 }
 
 [[noreturn]]
-void panic(char* const msg){
+void panic(cstring msg){
 	fprintf(stderr, "Panic: %s\n", msg);
 	abort();
 }
@@ -186,198 +497,6181 @@ u8 Stream::capabilities(Stream s){
 }
 } /* Namespace io */
 
-//// UTF-8 /////////////////////////////////////////////////////////////////////
-namespace utf8 {
-constexpr i32 RANGE1 = 0x7f;
-constexpr i32 RANGE2 = 0x7ff;
-constexpr i32 RANGE3 = 0xffff;
-constexpr i32 RANGE4 = 0x10ffff;
-
-constexpr i32 UTF16_SURROGATE1 = 0xd800;
-constexpr i32 UTF16_SURROGATE2 = 0xdfff;
-
-constexpr i32 MASK2 = 0x1f; /* 0001_1111 */
-constexpr i32 MASK3 = 0x0f; /* 0000_1111 */
-constexpr i32 MASK4 = 0x07; /* 0000_0111 */
+//// Epoch Reclamation ///////////////////////////////////////////////////////
+namespace sync {
+using atomic::Memory_Order;
 
-constexpr i32 MASKX = 0x3f; /* 0011_1111 */
+constexpr u64 EPOCH_ACTIVE = 1;
 
-constexpr i32 SIZE2 = 0xc0; /* 110x_xxxx */
-constexpr i32 SIZE3 = 0xe0; /* 1110_xxxx */
-constexpr i32 SIZE4 = 0xf0; /* 1111_0xxx */
+void Epoch_Domain::init(mem::Allocator allocator){
+	atomic::store(&_epoch.value, (u64)1, Memory_Order::Relaxed);
+	_participants = nullptr;
+	_allocator = allocator;
+}
 
-constexpr i32 CONT = 0x80; /* 10xx_xxxx */
+Epoch_Participant* Epoch_Domain::add_participant(){
+	Epoch_Participant* p = make<Epoch_Participant>(_allocator);
+	if(p == nullptr){ return nullptr; }
+	p->_domain = this;
 
-static inline
-bool is_continuation_byte(rune c){
-	static const rune CONTINUATION1 = 0x80;
-	static const rune CONTINUATION2 = 0xbf;
-	return (c >= CONTINUATION1) && (c <= CONTINUATION2);
+	_lock.acquire();
+	p->_next = _participants;
+	_participants = p;
+	_lock.release();
+	return p;
 }
 
-Encode_Result encode(rune c){
-	Encode_Result res = {0};
+void Epoch_Domain::remove_participant(Epoch_Participant* p){
+	p->barrier();
 
-	if(is_continuation_byte(c) ||
-	   (c >= UTF16_SURROGATE1 && c <= UTF16_SURROGATE2) ||
-	   (c > RANGE4))
-	{
-		return ERROR_ENCODED;
+	_lock.acquire();
+	Epoch_Participant** link = &_participants;
+	while(*link != p){
+		link = &(*link)->_next;
 	}
+	*link = p->_next;
+	_lock.release();
 
-	if(c <= RANGE1){
-		res.len = 1;
-		res.bytes[0] = c;
-	}
-	else if(c <= RANGE2){
-		res.len = 2;
-		res.bytes[0] = SIZE2 | ((c >> 6) & MASK2);
-		res.bytes[1] = CONT  | ((c >> 0) & MASKX);
+	for(isize i = 0; i < 3; i += 1){
+		Epoch_Limbo& l = p->_limbo[i];
+		_allocator.free_ex(l.items, l.cap * (isize)sizeof(Epoch_Retired), alignof(Epoch_Retired));
 	}
-	else if(c <= RANGE3){
-		res.len = 3;
-		res.bytes[0] = SIZE3 | ((c >> 12) & MASK3);
-		res.bytes[1] = CONT  | ((c >> 6) & MASKX);
-		res.bytes[2] = CONT  | ((c >> 0) & MASKX);
-	}
-	else if(c <= RANGE4){
-		res.len = 4;
-		res.bytes[0] = SIZE4 | ((c >> 18) & MASK4);
-		res.bytes[1] = CONT  | ((c >> 12) & MASKX);
-		res.bytes[2] = CONT  | ((c >> 6)  & MASKX);
-		res.bytes[3] = CONT  | ((c >> 0)  & MASKX);
+	destroy(p, _allocator);
+}
+
+bool Epoch_Domain::try_advance(){
+	u64 global = atomic::load(&_epoch.value, Memory_Order::Relaxed);
+	bool all_caught_up = true;
+
+	atomic::thread_fence(Memory_Order::Seq_Cst);
+	_lock.acquire();
+	for(Epoch_Participant* it = _participants; it != nullptr; it = it->_next){
+		u64 local = atomic::load(&it->_local_epoch.value, Memory_Order::Relaxed);
+		if((local & EPOCH_ACTIVE) && (local >> 1) != global){
+			all_caught_up = false;
+			break;
+		}
 	}
-	return res;
+	_lock.release();
+
+	if(!all_caught_up){ return false; }
+	atomic::thread_fence(Memory_Order::Acquire);
+	/* Failing means someone else advanced it, which is just as good */
+	atomic::compare_exchange_strong(&_epoch.value, &global, global + 1, Memory_Order::Release, Memory_Order::Relaxed);
+	return true;
 }
 
-constexpr Decode_Result DECODE_ERROR = { .codepoint = ERROR, .len = 0 };
+void Epoch_Participant::enter(){
+	_nesting += 1;
+	if(_nesting > 1){ return; }
 
-Decode_Result decode(Slice<byte> s){
-	Decode_Result res = {0};
-	byte* buf = s.raw_data();
-	isize len = s.size();
+	u64 e = atomic::load(&_domain->_epoch.value, Memory_Order::Relaxed);
+	atomic::store(&_local_epoch.value, (e << 1) | EPOCH_ACTIVE, Memory_Order::Relaxed);
+	/* Announcement must be visible before any shared pointer is loaded */
+	atomic::thread_fence(Memory_Order::Seq_Cst);
+}
 
-	if(s.empty()){ return DECODE_ERROR; }
+void Epoch_Participant::exit(){
+	debug_assert(_nesting > 0, "Unbalanced Epoch_Participant::exit()");
+	_nesting -= 1;
+	if(_nesting > 0){ return; }
 
-	u8 first = buf[0];
+	atomic::store(&_local_epoch.value, (u64)0, Memory_Order::Release);
+}
 
-	if((first & CONT) == 0){
-		res.len = 1;
-		res.codepoint |= first;
+static
+isize limbo_free(Epoch_Limbo& l){
+	isize n = l.len;
+	for(isize i = 0; i < n; i += 1){
+		Epoch_Retired r = l.items[i];
+		r.allocator.free_ex(r.ptr, r.size, r.align);
 	}
-	else if ((first & ~MASK2) == SIZE2 && len >= 2){
-		res.len = 2;
-		res.codepoint |= (buf[0] & MASK2) << 6;
-		res.codepoint |= (buf[1] & MASKX) << 0;
+	l.len = 0;
+	return n;
+}
+
+isize Epoch_Participant::collect(){
+	_domain->try_advance();
+
+	u64 global = atomic::load(&_domain->_epoch.value, Memory_Order::Acquire);
+	isize freed = 0;
+	for(isize i = 0; i < 3; i += 1){
+		Epoch_Limbo& l = _limbo[i];
+		if(l.len > 0 && (l.epoch + 2) <= global){
+			freed += limbo_free(l);
+		}
 	}
-	else if ((first & ~MASK3) == SIZE3 && len >= 3){
-		res.len = 3;
-		res.codepoint |= (buf[0] & MASK3) << 12;
-		res.codepoint |= (buf[1] & MASKX) << 6;
-		res.codepoint |= (buf[2] & MASKX) << 0;
+	_retired_since_collect = 0;
+	return freed;
+}
+
+bool Epoch_Participant::retire(void* ptr, isize size, isize align, mem::Allocator allocator){
+	if(ptr == nullptr){ return true; }
+
+	u64 global = atomic::load(&_domain->_epoch.value, Memory_Order::Acquire);
+	Epoch_Limbo& l = _limbo[global % 3];
+	if(l.epoch != global){
+		/* Bucket holds stuff from at least 3 epochs ago, safe to free */
+		limbo_free(l);
+		l.epoch = global;
 	}
-	else if ((first & ~MASK4) == SIZE4 && len >= 4){
-		res.len = 4;
-		res.codepoint |= (buf[0] & MASK4) << 18;
-		res.codepoint |= (buf[1] & MASKX) << 12;
-		res.codepoint |= (buf[2] & MASKX) << 6;
-		res.codepoint |= (buf[3] & MASKX) << 0;
+
+	if(l.len >= l.cap){
+		mem::Allocator al = _domain->_allocator;
+		isize new_cap = max(EPOCH_BATCH_SIZE, l.cap * 2);
+		isize old_size = l.cap * (isize)sizeof(Epoch_Retired);
+		isize new_size = new_cap * (isize)sizeof(Epoch_Retired);
+		void* items = (l.items == nullptr)
+			? al.alloc(new_size, alignof(Epoch_Retired))
+			: al.realloc(l.items, old_size, new_size, alignof(Epoch_Retired));
+		if(items == nullptr){ return false; }
+		l.items = (Epoch_Retired*)items;
+		l.cap = new_cap;
 	}
-	else {
-		return DECODE_ERROR;
+
+	l.items[l.len] = Epoch_Retired{ ptr, size, align, allocator };
+	l.len += 1;
+
+	_retired_since_collect += 1;
+	if(_retired_since_collect >= EPOCH_BATCH_SIZE){
+		collect();
 	}
+	return true;
+}
 
-	// Validation step
-	if(res.codepoint >= UTF16_SURROGATE1 && res.codepoint <= UTF16_SURROGATE2){
-		return DECODE_ERROR;
+void Epoch_Participant::barrier(){
+	debug_assert(_nesting == 0, "Epoch_Participant::barrier() called inside critical section");
+	for(;;){
+		collect();
+		bool empty = _limbo[0].len == 0 && _limbo[1].len == 0 && _limbo[2].len == 0;
+		if(empty){ break; }
+#if defined(TARGET_OS_LINUX)
+		sched_yield();
+#elif defined(TARGET_OS_WINDOWS)
+		SwitchToThread();
+#endif
 	}
-	if(res.len > 1 && !is_continuation_byte(buf[1])){
-		return DECODE_ERROR;
+}
+} /* Namespace sync */
+
+//// Channels ////////////////////////////////////////////////////////////////
+namespace sync {
+using atomic::Memory_Order;
+
+void Channel_Base::_add_waiter(Channel_Waiter* w, bool sender){
+	Channel_Waiter** list = sender ? &_send_waiters : &_recv_waiters;
+	w->prev = nullptr;
+	w->next = *list;
+	if(*list != nullptr){
+		(*list)->prev = w;
 	}
-	if(res.len > 2 && !is_continuation_byte(buf[2])){
-		return DECODE_ERROR;
+	*list = w;
+	w->linked = true;
+}
+
+void Channel_Base::_remove_waiter(Channel_Waiter* w, bool sender){
+	if(!w->linked){ return; }
+	Channel_Waiter** list = sender ? &_send_waiters : &_recv_waiters;
+	if(w->prev != nullptr){
+		w->prev->next = w->next;
+	} else {
+		*list = w->next;
 	}
-	if(res.len > 3 && !is_continuation_byte(buf[3])){
-		return DECODE_ERROR;
+	if(w->next != nullptr){
+		w->next->prev = w->prev;
 	}
-
-	return res;
+	w->prev = w->next = nullptr;
+	w->linked = false;
 }
 
-// Steps iterator forward and puts rune and Length advanced into pointers,
-// returns false when finished.
-bool Iterator::next(rune* r, i8* len){
-	if(this->current >= this->data.size()){ return 0; }
-
-	Decode_Result res = decode(this->data.sub(current));
-	*r = res.codepoint;
-	*len = res.len;
+void Channel_Base::_unlock(){
+	void volatile * wakes[CHANNEL_PENDING_WAKES];
+	isize n = _pending_len;
+	for(isize i = 0; i < n; i += 1){
+		wakes[i] = _pending_wakes[i];
+	}
+	_pending_len = 0;
+	_lock.release();
 
-	if(res.codepoint == DECODE_ERROR.codepoint){
-		*len = res.len + 1;
+	/* The parker may be gone by now, a futex wake on a stale address is
+	 * harmless as it never touches the memory. */
+	for(isize i = 0; i < n; i += 1){
+		atomic::futex_wake_one(wakes[i]);
 	}
+}
 
-	this->current += res.len;
+static
+bool signal_waiter(Channel_Base* c, Channel_Waiter* w){
+	u32 expected = 0;
+	if(atomic::compare_exchange_strong(&w->parker->_state, &expected, w->index + 1, Memory_Order::Release, Memory_Order::Relaxed)){
+		if(c->_pending_len < CHANNEL_PENDING_WAKES){
+			c->_pending_wakes[c->_pending_len] = &w->parker->_state;
+			c->_pending_len += 1;
+		} else {
+			atomic::notify_one(&w->parker->_state);
+		}
+		return true;
+	}
+	return false;
+}
 
-	return 1;
+void Channel_Base::_wake_one(bool sender){
+	Channel_Waiter** list = sender ? &_send_waiters : &_recv_waiters;
+	while(*list != nullptr){
+		Channel_Waiter* w = *list;
+		_remove_waiter(w, sender);
+		if(signal_waiter(this, w)){ return; }
+	}
 }
 
-// Steps iterator backward and puts rune and its length into pointers,
-// returns false when finished.
-bool Iterator::prev(rune* r, i8* len){
-	if(this->current <= 0){ return false; }
+void Channel_Base::_wake_all(bool sender){
+	Channel_Waiter** list = sender ? &_send_waiters : &_recv_waiters;
+	while(*list != nullptr){
+		Channel_Waiter* w = *list;
+		_remove_waiter(w, sender);
+		signal_waiter(this, w);
+	}
+}
 
-	this->current -= 1;
-	while(is_continuation_byte(this->data[this->current])){
-		this->current -= 1;
+void Channel_Base::_park(Channel_Waiter* w, bool sender){
+	atomic::store(&w->parker->_state, (u32)0, Memory_Order::Relaxed);
+	_add_waiter(w, sender);
+	if(!sender && _unbuffered){
+		_wake_one(true); /* Let a select_send() know there's a receiver now */
 	}
+	_unlock();
 
-	Decode_Result res = decode(this->data.sub(current));
-	*r = res.codepoint;
-	*len = res.len;
-	return true;
+	atomic::wait(&w->parker->_state, (u32)0, Memory_Order::Acquire);
+
+	_lock.acquire();
+	_remove_waiter(w, sender);
 }
-} /* Namespace utf8 */
 
-//// Strings ///////////////////////////////////////////////////////////////////
-isize String::size() const {
-	return _length;
+void Channel_Base::close(){
+	_lock.acquire();
+	_closed = true;
+	_wake_all(true);
+	_wake_all(false);
+	_unlock();
 }
 
-// UTF8_Iterator str_iterator(String s){
-// }
-//
-// UTF8_Iterator str_iterator_reversed(String s){
-// 	return (UTF8_Iterator){
-// 		.current = s.len,
+bool Channel_Base::closed(){
+	_lock.acquire();
+	bool c = _closed;
+	_unlock();
+	return c;
+}
+
+isize Channel_Base::size(){
+	_lock.acquire();
+	isize n = _len;
+	_unlock();
+	return n;
+}
+
+static
+Channel_Result select_try_case(Select_Case& c){
+	c.channel->_lock.acquire();
+	Channel_Result res = c.try_op(c.channel, c.data);
+	c.channel->_unlock();
+	return res;
+}
+
+isize try_select(Slice<Select_Case> cases){
+	for(isize i = 0; i < cases.size(); i += 1){
+		if(select_try_case(cases[i]) == Channel_Result::Ok){
+			return i;
+		}
+	}
+	return -1;
+}
+
+isize select(Slice<Select_Case> cases){
+	panic_assert(cases.size() <= SELECT_MAX_CASES, "Too many select cases");
+	Channel_Parker parker;
+	Channel_Waiter waiters[SELECT_MAX_CASES];
+	isize signaled = -1;
+	isize ready = -1;
+
+	for(;;){
+		isize open = 0;
+		for(isize i = 0; i < cases.size(); i += 1){
+			Channel_Result res = select_try_case(cases[i]);
+			if(res == Channel_Result::Ok){
+				ready = i;
+				break;
+			}
+			open += res != Channel_Result::Closed;
+		}
+		if(ready >= 0 || open == 0){ break; }
+
+		/* Register on every channel, then check again so a wakeup that came
+		 * before registration is not lost */
+		atomic::store(&parker._state, (u32)0, Memory_Order::Relaxed);
+		for(isize i = 0; i < cases.size(); i += 1){
+			Channel_Base* c = cases[i].channel;
+			waiters[i] = Channel_Waiter{};
+			waiters[i].parker = &parker;
+			waiters[i].index = (u32)i;
+			c->_lock.acquire();
+			c->_add_waiter(&waiters[i], cases[i].is_send);
+			if(!cases[i].is_send && c->_unbuffered){
+				c->_wake_one(true);
+			}
+			c->_unlock();
+		}
+
+		for(isize i = 0; i < cases.size(); i += 1){
+			if(select_try_case(cases[i]) == Channel_Result::Ok){
+				ready = i;
+				break;
+			}
+		}
+
+		if(ready < 0){
+			atomic::wait(&parker._state, (u32)0, Memory_Order::Acquire);
+		}
+
+		for(isize i = 0; i < cases.size(); i += 1){
+			Channel_Base* c = cases[i].channel;
+			c->_lock.acquire();
+			c->_remove_waiter(&waiters[i], cases[i].is_send);
+			c->_unlock();
+		}
+
+		u32 state = atomic::load(&parker._state, Memory_Order::Acquire);
+		if(state != 0){
+			signaled = (isize)state - 1;
+		}
+		if(ready >= 0){ break; }
+	}
+
+	/* A wakeup meant for another case got used up by us, pass it along */
+	if(signaled >= 0 && signaled != ready){
+		Channel_Base* c = cases[signaled].channel;
+		c->_lock.acquire();
+		c->_wake_one(cases[signaled].is_send);
+		c->_unlock();
+	}
+	return ready;
+}
+} /* Namespace sync */
+
+//// Time //////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+Time_Point time_now(){
+	struct timespec spec = {};
+	Time_Point p = {0};
+
+	if(clock_gettime(CLOCK_REALTIME, &spec) < 0){
+		return p;
+	}
+
+	p._nsec = ((i64)spec.tv_nsec) + ((i64)spec.tv_sec * time_second);
+	return p;
+}
+
+Time_Point time_monotonic(){
+	struct timespec spec = {};
+	Time_Point p = {0};
+
+	if(clock_gettime(CLOCK_MONOTONIC, &spec) < 0){
+		return p;
+	}
+
+	p._nsec = ((i64)spec.tv_nsec) + ((i64)spec.tv_sec * time_second);
+	return p;
+}
+
+void time_sleep(Time_Duration d){
+	if(d <= 0){ return; }
+	struct timespec spec = {};
+	spec.tv_sec  = d / time_second;
+	spec.tv_nsec = d - (spec.tv_sec * time_second);
+
+	while(nanosleep(&spec, &spec) < 0 && errno == EINTR){}
+}
+
+Time_Duration time_since(Time_Point p){
+	return time_now() - p;
+}
+#endif
+
+//// Async /////////////////////////////////////////////////////////////////////
+#if defined(__cpp_impl_coroutine)
+namespace async {
+static thread_local Executor* current_executor_ = nullptr;
+
+Executor* current_executor(){
+	return current_executor_;
+}
+
+constexpr isize FRAME_HEADER_SIZE = ((sizeof(mem::Allocator) + alignof(max_align_t) - 1) / alignof(max_align_t)) * alignof(max_align_t);
+
+void* _frame_alloc(usize size){
+	Executor* ex = current_executor_;
+	panic_assert(ex != nullptr, "Coroutine frame allocated with no current executor");
+
+	byte* base = (byte*)ex->_allocator.alloc(FRAME_HEADER_SIZE + size, alignof(max_align_t));
+	if(base == nullptr){
+		panic("Failed to allocate coroutine frame");
+	}
+	*((mem::Allocator*)base) = ex->_allocator;
+	return base + FRAME_HEADER_SIZE;
+}
+
+void _frame_free(void* frame, usize size){
+	byte* base = ((byte*)frame) - FRAME_HEADER_SIZE;
+	mem::Allocator allocator = *((mem::Allocator*)base);
+	allocator.free_ex(base, FRAME_HEADER_SIZE + size, alignof(max_align_t));
+}
+
+bool Executor::init(mem::Allocator allocator){
+	_allocator = allocator;
+	_queue_cap = 64;
+	_queue = (std::coroutine_handle<>*)allocator.alloc(sizeof(*_queue) * _queue_cap, alignof(std::coroutine_handle<>));
+	_timers_cap = 16;
+	_timers = (Executor_Timer*)allocator.alloc(sizeof(*_timers) * _timers_cap, alignof(Executor_Timer));
+	if(_queue == nullptr || _timers == nullptr){
+		allocator.free(_queue);
+		allocator.free(_timers);
+		return false;
+	}
+	_previous = current_executor_;
+	current_executor_ = this;
+	return true;
+}
+
+void Executor::destroy(){
+	_allocator.free_ex(_queue, sizeof(*_queue) * _queue_cap, alignof(std::coroutine_handle<>));
+	_allocator.free_ex(_timers, sizeof(*_timers) * _timers_cap, alignof(Executor_Timer));
+	_queue = nullptr;
+	_timers = nullptr;
+	if(current_executor_ == this){
+		current_executor_ = _previous;
+	}
+}
+
+void Executor::schedule(std::coroutine_handle<> h){
+	if(_queue_len >= _queue_cap){
+		isize new_cap = _queue_cap * 2;
+		auto* queue = (std::coroutine_handle<>*)_allocator.alloc(sizeof(*_queue) * new_cap, alignof(std::coroutine_handle<>));
+		panic_assert(queue != nullptr, "Failed to grow executor queue");
+		for(isize i = 0; i < _queue_len; i += 1){
+			queue[i] = _queue[(_queue_head + i) % _queue_cap];
+		}
+		_allocator.free_ex(_queue, sizeof(*_queue) * _queue_cap, alignof(std::coroutine_handle<>));
+		_queue = queue;
+		_queue_cap = new_cap;
+		_queue_head = 0;
+	}
+	_queue[(_queue_head + _queue_len) % _queue_cap] = h;
+	_queue_len += 1;
+}
+
+void Executor::schedule_at(Time_Point deadline, std::coroutine_handle<> h){
+	if(_timers_len >= _timers_cap){
+		isize new_cap = _timers_cap * 2;
+		void* timers = _allocator.realloc(_timers, sizeof(*_timers) * _timers_cap, sizeof(*_timers) * new_cap, alignof(Executor_Timer));
+		panic_assert(timers != nullptr, "Failed to grow executor timers");
+		_timers = (Executor_Timer*)timers;
+		_timers_cap = new_cap;
+	}
+
+	/* Binary min-heap on deadline */
+	isize i = _timers_len;
+	_timers_len += 1;
+	while(i > 0){
+		isize parent = (i - 1) / 2;
+		if(!(deadline < _timers[parent].deadline)){ break; }
+		_timers[i] = _timers[parent];
+		i = parent;
+	}
+	_timers[i] = Executor_Timer{deadline, h};
+}
+
+static
+Executor_Timer timer_pop(Executor* ex){
+	Executor_Timer top = ex->_timers[0];
+	ex->_timers_len -= 1;
+	Executor_Timer last = ex->_timers[ex->_timers_len];
+
+	isize i = 0;
+	isize n = ex->_timers_len;
+	for(;;){
+		isize child = i * 2 + 1;
+		if(child >= n){ break; }
+		if(child + 1 < n && ex->_timers[child + 1].deadline < ex->_timers[child].deadline){
+			child += 1;
+		}
+		if(!(ex->_timers[child].deadline < last.deadline)){ break; }
+		ex->_timers[i] = ex->_timers[child];
+		i = child;
+	}
+	if(n > 0){
+		ex->_timers[i] = last;
+	}
+	return top;
+}
+
+static
+Detached spawn_detached(Task<void> task){
+	co_await task;
+}
+
+void Executor::spawn(Task<void>&& task){
+	Executor* previous = current_executor_;
+	current_executor_ = this;
+	schedule(spawn_detached(static_cast<Task<void>&&>(task))._handle);
+	current_executor_ = previous;
+}
+
+void Executor::run(){
+	Executor* previous = current_executor_;
+	current_executor_ = this;
+
+	for(;;){
+		if(_timers_len > 0){
+			Time_Point now = time_monotonic();
+			while(_timers_len > 0 && !(now < _timers[0].deadline)){
+				schedule(timer_pop(this).handle);
+			}
+		}
+
+		if(_queue_len > 0){
+			std::coroutine_handle<> h = _queue[_queue_head];
+			_queue_head = (_queue_head + 1) % _queue_cap;
+			_queue_len -= 1;
+			h.resume();
+			continue;
+		}
+
+		if(_timers_len == 0){ break; }
+		time_sleep(_timers[0].deadline - time_monotonic());
+	}
+
+	current_executor_ = previous;
+}
+} /* Namespace async */
+#endif
+
+//// SIMD //////////////////////////////////////////////////////////////////////
+/* x86 vector paths are compiled with per-function target attributes and picked
+ * at runtime, so the library itself still builds for a baseline CPU. */
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)) && !defined(DISABLE_SIMD)
+#define SIMD_X86 1
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_TARGET(Isa)
+#else
+#define SIMD_TARGET(Isa) __attribute__((target(Isa)))
+#endif
+
+enum class Simd_Level : int {
+	None = 0,
+	SSE4 = 1,
+	AVX2 = 2,
+};
+
+static inline
+Simd_Level simd_level(){
+#if defined(_MSC_VER) && !defined(__clang__)
+	static volatile int level = -1;
+	if(level < 0){
+		int info[4];
+		int found = int(Simd_Level::None);
+		__cpuid(info, 1);
+		bool sse4 = (info[2] & (1 << 19)) != 0;
+		bool avx_os = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+			(_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		if(sse4){ found = int(Simd_Level::SSE4); }
+		if(avx_os && avx2){ found = int(Simd_Level::AVX2); }
+		level = found;
+	}
+	return Simd_Level(level);
+#else
+	if(__builtin_cpu_supports("avx2")){ return Simd_Level::AVX2; }
+	if(__builtin_cpu_supports("sse4.1")){ return Simd_Level::SSE4; }
+	return Simd_Level::None;
+#endif
+}
+
+/* Index of the lowest set bit, x must not be 0 */
+static inline
+int simd_ctz(u32 x){
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long idx;
+	_BitScanForward(&idx, x);
+	return int(idx);
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+/* Index of the highest set bit, x must not be 0 */
+static inline
+int simd_msb(u32 x){
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long idx;
+	_BitScanReverse(&idx, x);
+	return int(idx);
+#else
+	return 31 - __builtin_clz(x);
+#endif
+}
+#endif
+
+//// UTF-8 /////////////////////////////////////////////////////////////////////
+namespace utf8 {
+constexpr i32 RANGE1 = 0x7f;
+constexpr i32 RANGE2 = 0x7ff;
+constexpr i32 RANGE3 = 0xffff;
+constexpr i32 RANGE4 = 0x10ffff;
+
+constexpr i32 UTF16_SURROGATE1 = 0xd800;
+constexpr i32 UTF16_SURROGATE2 = 0xdfff;
+
+constexpr i32 MASK2 = 0x1f; /* 0001_1111 */
+constexpr i32 MASK3 = 0x0f; /* 0000_1111 */
+constexpr i32 MASK4 = 0x07; /* 0000_0111 */
+
+constexpr i32 MASKX = 0x3f; /* 0011_1111 */
+
+constexpr i32 SIZE2 = 0xc0; /* 110x_xxxx */
+constexpr i32 SIZE3 = 0xe0; /* 1110_xxxx */
+constexpr i32 SIZE4 = 0xf0; /* 1111_0xxx */
+
+constexpr i32 CONT = 0x80; /* 10xx_xxxx */
+
+static inline
+bool is_continuation_byte(rune c){
+	static const rune CONTINUATION1 = 0x80;
+	static const rune CONTINUATION2 = 0xbf;
+	return (c >= CONTINUATION1) && (c <= CONTINUATION2);
+}
+
+Encode_Result encode(rune c){
+	Encode_Result res = {0};
+
+	if(c < 0 ||
+	   (c >= UTF16_SURROGATE1 && c <= UTF16_SURROGATE2) ||
+	   (c > RANGE4))
+	{
+		return ERROR_ENCODED;
+	}
+
+	if(c <= RANGE1){
+		res.len = 1;
+		res.bytes[0] = c;
+	}
+	else if(c <= RANGE2){
+		res.len = 2;
+		res.bytes[0] = SIZE2 | ((c >> 6) & MASK2);
+		res.bytes[1] = CONT  | ((c >> 0) & MASKX);
+	}
+	else if(c <= RANGE3){
+		res.len = 3;
+		res.bytes[0] = SIZE3 | ((c >> 12) & MASK3);
+		res.bytes[1] = CONT  | ((c >> 6) & MASKX);
+		res.bytes[2] = CONT  | ((c >> 0) & MASKX);
+	}
+	else if(c <= RANGE4){
+		res.len = 4;
+		res.bytes[0] = SIZE4 | ((c >> 18) & MASK4);
+		res.bytes[1] = CONT  | ((c >> 12) & MASKX);
+		res.bytes[2] = CONT  | ((c >> 6)  & MASKX);
+		res.bytes[3] = CONT  | ((c >> 0)  & MASKX);
+	}
+	return res;
+}
+
+constexpr Decode_Result DECODE_ERROR = { .codepoint = ERROR, .len = 0 };
+
+Decode_Result decode(Slice<byte> s){
+	Decode_Result res = {0};
+	byte* buf = s.raw_data();
+	isize len = s.size();
+
+	if(s.empty()){ return DECODE_ERROR; }
+
+	u8 first = buf[0];
+
+	if((first & CONT) == 0){
+		res.len = 1;
+		res.codepoint |= first;
+	}
+	else if ((first & ~MASK2) == SIZE2 && len >= 2){
+		res.len = 2;
+		res.codepoint |= (buf[0] & MASK2) << 6;
+		res.codepoint |= (buf[1] & MASKX) << 0;
+	}
+	else if ((first & ~MASK3) == SIZE3 && len >= 3){
+		res.len = 3;
+		res.codepoint |= (buf[0] & MASK3) << 12;
+		res.codepoint |= (buf[1] & MASKX) << 6;
+		res.codepoint |= (buf[2] & MASKX) << 0;
+	}
+	else if ((first & ~MASK4) == SIZE4 && len >= 4){
+		res.len = 4;
+		res.codepoint |= (buf[0] & MASK4) << 18;
+		res.codepoint |= (buf[1] & MASKX) << 12;
+		res.codepoint |= (buf[2] & MASKX) << 6;
+		res.codepoint |= (buf[3] & MASKX) << 0;
+	}
+	else {
+		return DECODE_ERROR;
+	}
+
+	// Validation step
+	if(res.codepoint >= UTF16_SURROGATE1 && res.codepoint <= UTF16_SURROGATE2){
+		return DECODE_ERROR;
+	}
+	if(res.codepoint > RANGE4){
+		return DECODE_ERROR;
+	}
+	/* Overlong encodings: the codepoint fits in a shorter sequence */
+	if((res.len == 2 && res.codepoint <= RANGE1) ||
+	   (res.len == 3 && res.codepoint <= RANGE2) ||
+	   (res.len == 4 && res.codepoint <= RANGE3))
+	{
+		return DECODE_ERROR;
+	}
+	if(res.len > 1 && !is_continuation_byte(buf[1])){
+		return DECODE_ERROR;
+	}
+	if(res.len > 2 && !is_continuation_byte(buf[2])){
+		return DECODE_ERROR;
+	}
+	if(res.len > 3 && !is_continuation_byte(buf[3])){
+		return DECODE_ERROR;
+	}
+
+	return res;
+}
+
+/* Decode a well formed multi-byte sequence, the second byte ranges are the
+ * ones that rule out overlong encodings, surrogates and codepoints past
+ * U+10FFFF. Returns 0 for anything else, decode() sorts that out. */
+static inline
+isize decode_multi(rune* out, byte const* s, isize len){
+	byte b = s[0];
+	if(b < 0xc2 || b > 0xf4 || len < 2){ return 0; }
+
+	byte lo = 0x80, hi = 0xbf;
+	if(b == 0xe0){ lo = 0xa0; }
+	else if(b == 0xed){ hi = 0x9f; }
+	else if(b == 0xf0){ lo = 0x90; }
+	else if(b == 0xf4){ hi = 0x8f; }
+	if(s[1] < lo || s[1] > hi){ return 0; }
+
+	if(b < SIZE3){
+		*out = ((b & MASK2) << 6) | (s[1] & MASKX);
+		return 2;
+	}
+	if(len < 3 || !is_continuation_byte(s[2])){ return 0; }
+	if(b < SIZE4){
+		*out = ((b & MASK3) << 12) | ((s[1] & MASKX) << 6) | (s[2] & MASKX);
+		return 3;
+	}
+	if(len < 4 || !is_continuation_byte(s[3])){ return 0; }
+	*out = ((b & MASK4) << 18) | ((s[1] & MASKX) << 12) | ((s[2] & MASKX) << 6) | (s[3] & MASKX);
+	return 4;
+}
+
+// Steps iterator forward and puts rune and Length advanced into pointers,
+// returns false when finished.
+bool Iterator::next(rune* r, i8* len){
+	if(this->current >= this->data.size()){ return 0; }
+
+	byte first = this->data[this->current];
+	if(first < 0x80){
+		/* ASCII fast path */
+		*r = first;
+		*len = 1;
+		this->current += 1;
+		return 1;
+	}
+
+	isize n = decode_multi(r, &this->data.raw_data()[this->current], this->data.size() - this->current);
+	if(n > 0){
+		*len = i8(n);
+		this->current += n;
+		return 1;
+	}
+
+	Decode_Result res = decode(this->data.sub(current));
+	if(res.len == 0){
+		/* Skip the offending byte */
+		res.len = 1;
+	}
+	*r = res.codepoint;
+	*len = res.len;
+
+	this->current += res.len;
+
+	return 1;
+}
+
+// Steps iterator backward and puts rune and its length into pointers,
+// returns false when finished.
+bool Iterator::prev(rune* r, i8* len){
+	if(this->current <= 0){ return false; }
+
+	isize end = this->current;
+	this->current -= 1;
+	if(this->data[this->current] < 0x80){
+		/* ASCII fast path */
+		*r = this->data[this->current];
+		*len = 1;
+		return true;
+	}
+
+	/* Back up to the lead byte, a rune is at most 4 bytes long */
+	isize start = this->current;
+	while(start > 0 && end - start < 4 && is_continuation_byte(this->data[start])){
+		start -= 1;
+	}
+
+	Decode_Result res = decode(this->data.sub(start, end));
+	if(res.len != end - start){
+		/* Not a whole rune, skip the offending byte */
+		*r = ERROR;
+		*len = 1;
+		return true;
+	}
+	this->current = start;
+	*r = res.codepoint;
+	*len = res.len;
+	return true;
+}
+
+/* Bulk validation follows Keiser & Lemire, "Validating UTF-8 In Less Than One
+ * Instruction Per Byte": each byte is classified with 3 nibble lookups on the
+ * previous/current byte pair, then 3rd/4th byte continuations are checked
+ * separately. Every bit below marks one kind of error. */
+constexpr u8 TOO_SHORT      = 1 << 0; /* 11______ 0_______ or 11______ 11______ */
+constexpr u8 TOO_LONG       = 1 << 1; /* 0_______ 10______ */
+constexpr u8 OVERLONG_3     = 1 << 2; /* 11100000 100_____ */
+constexpr u8 TOO_LARGE      = 1 << 3; /* 11110100 1001____, 11110100 101_____, 11110101+ 1001____... */
+constexpr u8 SURROGATE      = 1 << 4; /* 11101101 101_____ */
+constexpr u8 OVERLONG_2     = 1 << 5; /* 1100000_ 10______ */
+constexpr u8 TOO_LARGE_1000 = 1 << 6; /* 11110101+ 1000____ */
+constexpr u8 OVERLONG_4     = 1 << 6; /* 11110000 1000____ */
+constexpr u8 TWO_CONTS      = 1 << 7; /* 10______ 10______ */
+constexpr u8 CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+alignas(16) constexpr u8 BYTE_1_HIGH[16] = {
+	TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+	TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+	TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+	TOO_SHORT | OVERLONG_2,
+	TOO_SHORT,
+	TOO_SHORT | OVERLONG_3 | SURROGATE,
+	TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+alignas(16) constexpr u8 BYTE_1_LOW[16] = {
+	CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+	CARRY | OVERLONG_2,
+	CARRY,
+	CARRY,
+	CARRY | TOO_LARGE,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+	CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+alignas(16) constexpr u8 BYTE_2_HIGH[16] = {
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+	TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+	TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+
+/* Largest byte allowed at each position of the last 16 bytes of a block
+ * without the sequence it starts running past the block */
+alignas(16) constexpr u8 INCOMPLETE_MAX[16] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xf0 - 1, 0xe0 - 1, 0xc0 - 1,
+};
+
+static
+bool validate_scalar(Slice<byte> buf){
+	isize i = 0;
+	while(i < buf.size()){
+		if(buf[i] < 0x80){
+			i += 1;
+			continue;
+		}
+		Decode_Result res = decode(buf.sub(i));
+		if(res.len == 0){ return false; }
+		i += res.len;
+	}
+	return true;
+}
+
+/* Decode known valid UTF-8, results are the same as decode() */
+static inline
+isize decode_valid_one(rune* out, byte const* s){
+	byte b = s[0];
+	if(b < 0x80){
+		*out = b;
+		return 1;
+	}
+	if(b < SIZE3){
+		*out = ((b & MASK2) << 6) | (s[1] & MASKX);
+		return 2;
+	}
+	if(b < SIZE4){
+		*out = ((b & MASK3) << 12) | ((s[1] & MASKX) << 6) | (s[2] & MASKX);
+		return 3;
+	}
+	*out = ((b & MASK4) << 18) | ((s[1] & MASKX) << 12) | ((s[2] & MASKX) << 6) | (s[3] & MASKX);
+	return 4;
+}
+
+/* Branchless version of decode_valid_one(), mixed length text makes the
+ * branches above mispredict constantly. Needs 4 readable bytes. Every sequence
+ * is assembled as if it was 4 bytes long, then shifted down to its real size,
+ * bytes past the end of a shorter sequence fall off the bottom. */
+static inline
+isize decode_valid_wide(rune* out, byte const* s){
+	static constexpr u8 lengths[16] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 3, 4};
+	static constexpr u8 lead_masks[5] = {0, 0x7f, MASK2, MASK3, MASK4};
+	static constexpr u8 shifts[5] = {0, 18, 12, 6, 0};
+
+	isize len = lengths[s[0] >> 4];
+	u32 v = (u32(s[0] & lead_masks[len]) << 18) |
+		(u32(s[1] & MASKX) << 12) |
+		(u32(s[2] & MASKX) << 6) |
+		(u32(s[3] & MASKX) << 0);
+	*out = rune(v >> shifts[len]);
+	return len;
+}
+
+static
+isize decode_valid_scalar(rune* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	for(; i + 4 <= len; n += 1){
+		i += decode_valid_wide(&out[n], &data[i]);
+	}
+	for(; i < len; n += 1){
+		i += decode_valid_one(&out[n], &data[i]);
+	}
+	return n;
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static inline
+__m128i check_sse4(__m128i input, __m128i prev_input){
+	const __m128i lo4 = _mm_set1_epi8(0x0f);
+	__m128i prev1 = _mm_alignr_epi8(input, prev_input, 16 - 1);
+	__m128i prev2 = _mm_alignr_epi8(input, prev_input, 16 - 2);
+	__m128i prev3 = _mm_alignr_epi8(input, prev_input, 16 - 3);
+
+	__m128i byte_1_high = _mm_shuffle_epi8(_mm_load_si128((__m128i const*)BYTE_1_HIGH),
+		_mm_and_si128(_mm_srli_epi16(prev1, 4), lo4));
+	__m128i byte_1_low = _mm_shuffle_epi8(_mm_load_si128((__m128i const*)BYTE_1_LOW),
+		_mm_and_si128(prev1, lo4));
+	__m128i byte_2_high = _mm_shuffle_epi8(_mm_load_si128((__m128i const*)BYTE_2_HIGH),
+		_mm_and_si128(_mm_srli_epi16(input, 4), lo4));
+	__m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+	/* 111_____ two bytes back or 1111____ three bytes back need a continuation */
+	__m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(char(0xe0 - 0x80)));
+	__m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(char(0xf0 - 0x80)));
+	__m128i must_23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(char(0x80)));
+
+	return _mm_xor_si128(must_23, special);
+}
+
+SIMD_TARGET("sse4.1")
+static
+bool validate_sse4(byte const* data, isize len){
+	const __m128i incomplete_max = _mm_load_si128((__m128i const*)INCOMPLETE_MAX);
+	__m128i error = _mm_setzero_si128();
+	__m128i prev_input = _mm_setzero_si128();
+	__m128i prev_incomplete = _mm_setzero_si128();
+
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i input = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(input) == 0){
+			/* All ASCII, only a sequence left open by the previous block can fail */
+			error = _mm_or_si128(error, prev_incomplete);
+			prev_incomplete = _mm_setzero_si128();
+		}
+		else {
+			error = _mm_or_si128(error, check_sse4(input, prev_input));
+			prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+		}
+		prev_input = input;
+	}
+
+	/* Zero padding is ASCII, so it also catches sequences cut off at the end */
+	alignas(16) byte tail[16] = {0};
+	mem::copy(tail, &data[i], len - i);
+	error = _mm_or_si128(error, check_sse4(_mm_load_si128((__m128i const*)tail), prev_input));
+
+	return _mm_testz_si128(error, error);
+}
+
+SIMD_TARGET("avx2")
+static inline
+__m256i check_avx2(__m256i input, __m256i prev_input){
+	const __m256i lo4 = _mm256_set1_epi8(0x0f);
+	/* Bytes from the high lane of prev_input followed by the low lane of input */
+	__m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+	__m256i prev1 = _mm256_alignr_epi8(input, shifted, 16 - 1);
+	__m256i prev2 = _mm256_alignr_epi8(input, shifted, 16 - 2);
+	__m256i prev3 = _mm256_alignr_epi8(input, shifted, 16 - 3);
+
+	__m256i byte_1_high = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((__m128i const*)BYTE_1_HIGH)),
+		_mm256_and_si256(_mm256_srli_epi16(prev1, 4), lo4));
+	__m256i byte_1_low = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((__m128i const*)BYTE_1_LOW)),
+		_mm256_and_si256(prev1, lo4));
+	__m256i byte_2_high = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((__m128i const*)BYTE_2_HIGH)),
+		_mm256_and_si256(_mm256_srli_epi16(input, 4), lo4));
+	__m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+	__m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xe0 - 0x80)));
+	__m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xf0 - 0x80)));
+	__m256i must_23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+
+	return _mm256_xor_si256(must_23, special);
+}
+
+SIMD_TARGET("avx2")
+static
+bool validate_avx2(byte const* data, isize len){
+	/* Only the high lane matters, it holds the last 16 bytes of the block */
+	const __m256i incomplete_max = _mm256_inserti128_si256(_mm256_set1_epi8(char(0xff)),
+		_mm_load_si128((__m128i const*)INCOMPLETE_MAX), 1);
+	__m256i error = _mm256_setzero_si256();
+	__m256i prev_input = _mm256_setzero_si256();
+	__m256i prev_incomplete = _mm256_setzero_si256();
+
+	isize i = 0;
+	for(; i + 64 <= len; i += 64){
+		__m256i a = _mm256_loadu_si256((__m256i const*)&data[i]);
+		__m256i b = _mm256_loadu_si256((__m256i const*)&data[i + 32]);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0){
+			error = _mm256_or_si256(error, prev_incomplete);
+			prev_incomplete = _mm256_setzero_si256();
+		}
+		else {
+			error = _mm256_or_si256(error, check_avx2(a, prev_input));
+			error = _mm256_or_si256(error, check_avx2(b, a));
+			prev_incomplete = _mm256_subs_epu8(b, incomplete_max);
+		}
+		prev_input = b;
+	}
+	for(; i + 32 <= len; i += 32){
+		__m256i input = _mm256_loadu_si256((__m256i const*)&data[i]);
+		error = _mm256_or_si256(error, check_avx2(input, prev_input));
+		prev_input = input;
+	}
+
+	alignas(32) byte tail[32] = {0};
+	mem::copy(tail, &data[i], len - i);
+	error = _mm256_or_si256(error, check_avx2(_mm256_load_si256((__m256i const*)tail), prev_input));
+
+	return _mm256_testz_si256(error, error);
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize decode_valid_sse4(rune* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	/* Blocks always start on a sequence boundary, the 3 spare bytes keep the
+	 * wide decode of the block's last sequence in bounds. */
+	while(i + 16 + 3 <= len){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) == 0){
+			/* Widen 16 ASCII bytes to runes */
+			_mm_storeu_si128((__m128i*)&out[n + 0],  _mm_cvtepu8_epi32(v));
+			_mm_storeu_si128((__m128i*)&out[n + 4],  _mm_cvtepu8_epi32(_mm_srli_si128(v, 4)));
+			_mm_storeu_si128((__m128i*)&out[n + 8],  _mm_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+			_mm_storeu_si128((__m128i*)&out[n + 12], _mm_cvtepu8_epi32(_mm_srli_si128(v, 12)));
+			i += 16;
+			n += 16;
+			continue;
+		}
+		/* Walk the bitmask of non-continuation bytes, so finding the next
+		 * sequence doesn't wait on decoding the current one */
+		u32 leads = u32(_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(-65))));
+		isize end = i;
+		while(leads != 0){
+			isize p = i + simd_ctz(leads);
+			leads &= leads - 1;
+			end = p + decode_valid_wide(&out[n], &data[p]);
+			n += 1;
+		}
+		i = end;
+	}
+	return n + decode_valid_scalar(&out[n], &data[i], len - i);
+}
+
+SIMD_TARGET("avx2")
+static
+isize decode_valid_avx2(rune* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	while(i + 32 + 3 <= len){
+		__m256i v = _mm256_loadu_si256((__m256i const*)&data[i]);
+		if(_mm256_movemask_epi8(v) == 0){
+			__m128i lo = _mm256_castsi256_si128(v);
+			__m128i hi = _mm256_extracti128_si256(v, 1);
+			_mm256_storeu_si256((__m256i*)&out[n + 0],  _mm256_cvtepu8_epi32(lo));
+			_mm256_storeu_si256((__m256i*)&out[n + 8],  _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+			_mm256_storeu_si256((__m256i*)&out[n + 16], _mm256_cvtepu8_epi32(hi));
+			_mm256_storeu_si256((__m256i*)&out[n + 24], _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+			i += 32;
+			n += 32;
+			continue;
+		}
+		u32 leads = u32(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(-65))));
+		isize end = i;
+		while(leads != 0){
+			isize p = i + simd_ctz(leads);
+			leads &= leads - 1;
+			end = p + decode_valid_wide(&out[n], &data[p]);
+			n += 1;
+		}
+		i = end;
+	}
+	return n + decode_valid_scalar(&out[n], &data[i], len - i);
+}
+#endif
+
+bool validate(Slice<byte> buf){
+	if(buf.empty()){ return true; }
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case Simd_Level::AVX2: return validate_avx2(buf.raw_data(), buf.size());
+		case Simd_Level::SSE4: return validate_sse4(buf.raw_data(), buf.size());
+		default: break;
+	}
+#endif
+	return validate_scalar(buf);
+}
+
+static
+isize decode_valid(rune* out, byte const* data, isize len){
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case Simd_Level::AVX2: return decode_valid_avx2(out, data, len);
+		case Simd_Level::SSE4: return decode_valid_sse4(out, data, len);
+		default: break;
+	}
+#endif
+	return decode_valid_scalar(out, data, len);
+}
+
+/* Input is validated in windows of this size, a window with an error in it is
+ * decoded by the checked scalar decoder instead */
+constexpr isize DECODE_WINDOW = 4096;
+
+/* End of a window of at most `size` bytes starting at `pos`, moved back so it
+ * doesn't split a sequence between windows */
+static inline
+isize window_end(byte const* data, isize len, isize pos, isize size){
+	isize end = min(len, pos + min(DECODE_WINDOW, size));
+	for(isize k = 0; k < 3 && end < len && end > pos && is_continuation_byte(data[end]); k += 1){
+		end -= 1;
+	}
+	return end;
+}
+
+isize decode_runes(Slice<rune> out, Slice<byte> buf, isize* consumed){
+	byte* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	isize pos = 0, n = 0;
+
+	while(pos < len && n < out.size()){
+		isize end = window_end(data, len, pos, out.size() - n);
+
+		if(end > pos && validate(buf.sub(pos, end))){
+			n += decode_valid(&out.raw_data()[n], &data[pos], end - pos);
+			pos = end;
+			continue;
+		}
+
+		/* Same behavior as Iterator::next(), errors skip a single byte */
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end && n < out.size()){
+			Decode_Result res = decode(buf.sub(pos));
+			out[n] = res.codepoint;
+			n += 1;
+			pos += res.len > 0 ? res.len : 1;
+		}
+	}
+
+	if(consumed != nullptr){ *consumed = pos; }
+	return n;
+}
+
+/* High bit of every byte in a word, set only by non-ASCII bytes */
+constexpr u64 ASCII_MASK = 0x8080808080808080ull;
+
+/* Rune count under which rune_offset() steps over ASCII directly */
+constexpr isize ASCII_RUN = 256;
+
+/* Consecutive ASCII runes needed before it reads 8 bytes at a time, single
+ * spaces between non-ASCII runes are not worth a word load */
+constexpr isize ASCII_PROBE = 4;
+
+/* Number of non-continuation bytes in 8 bytes, one per rune in valid UTF-8 */
+static inline
+isize count_word(u64 x){
+	constexpr u64 ones = 0x0101010101010101ull;
+	/* 10xx_xxxx: bit 7 set and bit 6 clear */
+	u64 conts = (x >> 7) & ~(x >> 6) & ones;
+	return 8 - isize((conts * ones) >> 56);
+}
+
+static
+isize count_valid_scalar(byte const* data, isize len){
+	isize i = 0, count = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		mem::copy(&x, &data[i], 8);
+		count += count_word(x);
+	}
+	for(; i < len; i += 1){
+		count += !is_continuation_byte(data[i]);
+	}
+	return count;
+}
+
+#ifdef SIMD_X86
+/* Lead bytes are counted in 8-bit lanes and flushed with a SAD before a lane
+ * can overflow */
+SIMD_TARGET("sse4.1")
+static
+isize count_valid_sse4(byte const* data, isize len){
+	const __m128i threshold = _mm_set1_epi8(-65);
+	isize i = 0, count = 0;
+	while(i + 16 <= len){
+		__m128i acc = _mm_setzero_si128();
+		isize blocks = min<isize>((len - i) / 16, 255);
+		for(isize k = 0; k < blocks; k += 1, i += 16){
+			__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+			acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(v, threshold));
+		}
+		__m128i sums = _mm_sad_epu8(acc, _mm_setzero_si128());
+		count += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+	}
+	return count + count_valid_scalar(&data[i], len - i);
+}
+
+SIMD_TARGET("avx2")
+static
+isize count_valid_avx2(byte const* data, isize len){
+	const __m256i threshold = _mm256_set1_epi8(-65);
+	isize i = 0, count = 0;
+	while(i + 32 <= len){
+		__m256i acc = _mm256_setzero_si256();
+		isize blocks = min<isize>((len - i) / 32, 255);
+		for(isize k = 0; k < blocks; k += 1, i += 32){
+			__m256i v = _mm256_loadu_si256((__m256i const*)&data[i]);
+			acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(v, threshold));
+		}
+		alignas(32) u64 sums[4];
+		_mm256_store_si256((__m256i*)sums, _mm256_sad_epu8(acc, _mm256_setzero_si256()));
+		count += isize(sums[0] + sums[1] + sums[2] + sums[3]);
+	}
+	return count + count_valid_scalar(&data[i], len - i);
+}
+#endif
+
+static
+isize count_valid(byte const* data, isize len){
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case Simd_Level::AVX2: return count_valid_avx2(data, len);
+		case Simd_Level::SSE4: return count_valid_sse4(data, len);
+		default: break;
+	}
+#endif
+	return count_valid_scalar(data, len);
+}
+
+/* Byte offset of rune `n` in valid UTF-8 holding more than `n` runes */
+static
+isize offset_valid(byte const* data, isize len, isize n){
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		mem::copy(&x, &data[i], 8);
+		isize c = count_word(x);
+		if(c > n){ break; }
+		n -= c;
+	}
+	for(; i < len; i += 1){
+		if(is_continuation_byte(data[i])){ continue; }
+		if(n == 0){ break; }
+		n -= 1;
+	}
+	return i;
+}
+
+/* Store the byte offset of every `stride`-th rune into `offsets`, returns the
+ * total number of runes. Same rune boundaries as Iterator::next(). */
+static
+isize rune_checkpoints(Slice<byte> buf, isize stride, isize* offsets, isize* offsets_len){
+	byte* data = buf.raw_data();
+	isize len = buf.size();
+	isize pos = 0, runes = 0, count = 0;
+
+	while(pos < len){
+		isize end = window_end(data, len, pos, len);
+
+		if(end > pos && validate(buf.sub(pos, end))){
+			isize c = count_valid(&data[pos], end - pos);
+			/* Find every checkpoint that lands inside this window */
+			isize at = pos, at_runes = runes;
+			while(count * stride < runes + c){
+				isize target = count * stride;
+				at += offset_valid(&data[at], end - at, target - at_runes);
+				at_runes = target;
+				offsets[count] = at;
+				count += 1;
+			}
+			runes += c;
+			pos = end;
+			continue;
+		}
+
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end){
+			if(runes == count * stride){
+				offsets[count] = pos;
+				count += 1;
+			}
+			Decode_Result res = decode(buf.sub(pos));
+			pos += res.len > 0 ? res.len : 1;
+			runes += 1;
+		}
+	}
+
+	*offsets_len = count;
+	return runes;
+}
+
+isize rune_offset(Slice<byte> buf, isize n, isize* skipped){
+	byte* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	isize pos = 0, done = 0;
+
+	while(pos < len && done < n){
+		isize want = n - done;
+
+		/* Short ASCII runs are cheaper to step over 8 bytes at a time than to
+		 * validate, longer ones go through the vector path below */
+		if(want < ASCII_RUN && data[pos] < 0x80){
+			isize run = 0;
+			for(; pos < len && want > 0 && run < ASCII_PROBE && data[pos] < 0x80; pos += 1, run += 1){
+				want -= 1;
+			}
+			if(run == ASCII_PROBE){
+				for(; pos + 8 <= len && want >= 8; pos += 8, want -= 8){
+					u64 x;
+					mem::copy(&x, &data[pos], 8);
+					if(x & ASCII_MASK){ break; }
+				}
+				for(; pos < len && want > 0 && data[pos] < 0x80; pos += 1){
+					want -= 1;
+				}
+			}
+			done = n - want;
+			continue;
+		}
+
+		/* A rune is at most 4 bytes, no need to look further than that */
+		isize end = window_end(data, len, pos, want > (len / 4) ? len : want * 4);
+
+		if(end > pos && validate(buf.sub(pos, end))){
+			isize c = count_valid(&data[pos], end - pos);
+			if(c <= want){
+				done += c;
+				pos = end;
+			}
+			else {
+				pos += offset_valid(&data[pos], end - pos, want);
+				done = n;
+			}
+			continue;
+		}
+
+		/* Same behavior as Iterator::next(), errors skip a single byte */
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end && done < n){
+			Decode_Result res = decode(buf.sub(pos));
+			pos += res.len > 0 ? res.len : 1;
+			done += 1;
+		}
+	}
+
+	if(skipped != nullptr){ *skipped = done; }
+	return pos;
+}
+
+/* UTF-16 units are in native byte order. Unpaired surrogates and UTF-32 values
+ * that are not scalar values become ERROR, so does invalid UTF-8, the same way
+ * Iterator::next() steps over it. */
+constexpr u16 UTF16_LOW1 = 0xdc00;
+
+static inline
+bool utf16_is_high(u16 u){ return (u & 0xfc00) == UTF16_SURROGATE1; }
+
+static inline
+bool utf16_is_low(u16 u){ return (u & 0xfc00) == UTF16_LOW1; }
+
+/* Decode the codepoint at data[*pos] and step over it */
+static inline
+rune utf16_next(u16 const* data, isize len, isize* pos){
+	u16 u = data[*pos];
+	*pos += 1;
+	if(u < UTF16_SURROGATE1 || u > UTF16_SURROGATE2){ return u; }
+	if(utf16_is_high(u) && *pos < len && utf16_is_low(data[*pos])){
+		rune r = 0x10000 + (rune(u - UTF16_SURROGATE1) << 10) + rune(data[*pos] - UTF16_LOW1);
+		*pos += 1;
+		return r;
+	}
+	return ERROR;
+}
+
+static inline
+rune utf32_scalar(rune r){
+	if(r < 0 || r > RANGE4 || (r >= UTF16_SURROGATE1 && r <= UTF16_SURROGATE2)){
+		return ERROR;
+	}
+	return r;
+}
+
+/* Encoded sizes of a scalar value */
+static inline
+isize utf8_rune_size(rune r){
+	return 1 + (r > RANGE1) + (r > RANGE2) + (r > RANGE3);
+}
+
+static inline
+isize utf16_rune_size(rune r){
+	return 1 + (r > RANGE3);
+}
+
+/* Encode a scalar value, `out` must have utf8_rune_size(r) bytes */
+static inline
+void utf8_put(byte* out, rune r){
+	if(r <= RANGE1){
+		out[0] = byte(r);
+	}
+	else if(r <= RANGE2){
+		out[0] = SIZE2 | ((r >> 6) & MASK2);
+		out[1] = CONT | (r & MASKX);
+	}
+	else if(r <= RANGE3){
+		out[0] = SIZE3 | ((r >> 12) & MASK3);
+		out[1] = CONT | ((r >> 6) & MASKX);
+		out[2] = CONT | (r & MASKX);
+	}
+	else {
+		out[0] = SIZE4 | ((r >> 18) & MASK4);
+		out[1] = CONT | ((r >> 12) & MASKX);
+		out[2] = CONT | ((r >> 6) & MASKX);
+		out[3] = CONT | (r & MASKX);
+	}
+}
+
+/* Encode a scalar value, `out` must have utf16_rune_size(r) units */
+static inline
+void utf16_put(u16* out, rune r){
+	if(r <= RANGE3){
+		out[0] = u16(r);
+	}
+	else {
+		r -= 0x10000;
+		out[0] = u16(UTF16_SURROGATE1 + (r >> 10));
+		out[1] = u16(UTF16_LOW1 + (r & 0x3ff));
+	}
+}
+
+/* Decode valid UTF-8 straight into UTF-16, `out` must have room for `len`
+ * units (no sequence takes more units than bytes) */
+static
+isize to_utf16_valid_scalar(u16* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	rune r;
+	while(i + 4 <= len){
+		i += decode_valid_wide(&r, &data[i]);
+		utf16_put(&out[n], r);
+		n += utf16_rune_size(r);
+	}
+	while(i < len){
+		i += decode_valid_one(&r, &data[i]);
+		utf16_put(&out[n], r);
+		n += utf16_rune_size(r);
+	}
+	return n;
+}
+
+/* Number of 4 byte sequence leads (1111_xxxx) in 8 bytes */
+static inline
+isize count_lead4_word(u64 x){
+	constexpr u64 ones = 0x0101010101010101ull;
+	u64 leads = ((x & (x << 1) & (x << 2) & (x << 3)) >> 7) & ones;
+	return isize((leads * ones) >> 56);
+}
+
+/* Runes that need a surrogate pair in valid UTF-8 */
+static
+isize count_lead4(byte const* data, isize len){
+	isize i = 0, count = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		mem::copy(&x, &data[i], 8);
+		count += count_lead4_word(x);
+	}
+	for(; i < len; i += 1){
+		count += data[i] >= SIZE4;
+	}
+	return count;
+}
+
+/* Extra UTF-8 bytes past the first of every unit, and the number of surrogate
+ * pairs. A pair is 4 bytes but its units would count 3 each. */
+static
+void utf16_measure_scalar(u16 const* data, isize len, isize* extra, isize* pairs){
+	isize e = 0, p = 0;
+	for(isize i = 0; i < len; i += 1){
+		u16 u = data[i];
+		e += (u > RANGE1) + (u > RANGE2);
+		p += utf16_is_high(u) & (i + 1 < len && utf16_is_low(data[i + 1]));
+	}
+	*extra += e;
+	*pairs += p;
+}
+
+#ifdef SIMD_X86
+/* Widen the leading 16 byte blocks of ASCII, returns the bytes done */
+SIMD_TARGET("sse4.1")
+static
+isize ascii_to_utf16_sse4(u16* out, byte const* data, isize len){
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) != 0){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_cvtepu8_epi16(v));
+		_mm_storeu_si128((__m128i*)&out[i + 8], _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+	}
+	return i;
+}
+
+/* Shuffles that move the 16-bit lanes picked by a 4-bit mask to the front */
+static constexpr u8 utf16_compact_shuffle[16][8] = {
+	{0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x02, 0x03, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x80, 0x80, 0x80, 0x80},
+	{0x04, 0x05, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80},
+	{0x02, 0x03, 0x04, 0x05, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x80, 0x80},
+	{0x06, 0x07, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+	{0x02, 0x03, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x06, 0x07, 0x80, 0x80},
+	{0x04, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x80},
+	{0x00, 0x01, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80},
+	{0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x80, 0x80},
+	{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07},
+};
+static constexpr u8 utf16_compact_count[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+/* Store the 8 units of v whose bits are set in mask (low 8 bits) next to each
+ * other, returns how many. Always writes 8 units. */
+SIMD_TARGET("sse4.1")
+static inline
+isize utf16_store_compact_sse4(u16* out, __m128i v, u32 mask){
+	u32 lo = mask & 15, hi = (mask >> 4) & 15;
+	__m128i a = _mm_shuffle_epi8(v, _mm_loadl_epi64((__m128i const*)utf16_compact_shuffle[lo]));
+	__m128i b = _mm_shuffle_epi8(_mm_srli_si128(v, 8), _mm_loadl_epi64((__m128i const*)utf16_compact_shuffle[hi]));
+	_mm_storel_epi64((__m128i*)out, a);
+	_mm_storel_epi64((__m128i*)&out[utf16_compact_count[lo]], b);
+	return utf16_compact_count[lo] + utf16_compact_count[hi];
+}
+
+/* UTF-16 unit for each of 8 positions, from the first three bytes of the
+ * sequence starting there (widened to 16 bits). A 4-byte sequence puts the high
+ * surrogate in its lead's lane and the low one in the next lane, `four` and
+ * `second` mark those lanes. */
+SIMD_TARGET("sse4.1")
+static inline
+__m128i utf16_units_sse4(__m128i b0, __m128i b1, __m128i b2, __m128i four, __m128i second){
+	const __m128i x_mask = _mm_set1_epi16(MASKX);
+	__m128i tail1 = _mm_and_si128(b1, x_mask);
+	__m128i tail2 = _mm_and_si128(b2, x_mask);
+	__m128i two = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b0, _mm_set1_epi16(MASK2)), 6), tail1);
+	__m128i three = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b0, _mm_set1_epi16(MASK3)), 12),
+		_mm_or_si128(_mm_slli_epi16(tail1, 6), tail2));
+	/* (codepoint - 0x10000) >> 10 from the lead, and the low 10 bits from the
+	 * two bytes after the second lane */
+	__m128i high = _mm_add_epi16(_mm_set1_epi16(short(UTF16_SURROGATE1 - 0x40)),
+		_mm_or_si128(_mm_slli_epi16(_mm_and_si128(b0, _mm_set1_epi16(MASK4)), 8),
+		_mm_or_si128(_mm_slli_epi16(tail1, 2), _mm_and_si128(_mm_srli_epi16(b2, 4), _mm_set1_epi16(3)))));
+	__m128i low = _mm_or_si128(_mm_set1_epi16(short(UTF16_LOW1)),
+		_mm_or_si128(_mm_slli_epi16(_mm_and_si128(b1, _mm_set1_epi16(0x0f)), 6), tail2));
+
+	__m128i units = _mm_blendv_epi8(three, two, _mm_cmplt_epi16(b0, _mm_set1_epi16(SIZE3)));
+	units = _mm_blendv_epi8(units, b0, _mm_cmplt_epi16(b0, _mm_set1_epi16(0x80)));
+	units = _mm_blendv_epi8(units, high, four);
+	return _mm_blendv_epi8(units, low, second);
+}
+
+/* Same as to_utf16_valid_scalar(). Every position of a block is decoded as if
+ * a sequence started there, then the lanes of continuation bytes are squeezed
+ * out. */
+SIMD_TARGET("sse4.1")
+static
+isize to_utf16_valid_sse4(u16* out, byte const* data, isize len){
+	isize i = 0, n = 0;
+	/* Blocks always start on a sequence boundary, the 3 spare bytes cover a
+	 * sequence that starts in the block's last byte */
+	while(i + 16 + 3 <= len){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) == 0){
+			_mm_storeu_si128((__m128i*)&out[n], _mm_cvtepu8_epi16(v));
+			_mm_storeu_si128((__m128i*)&out[n + 8], _mm_cvtepu8_epi16(_mm_srli_si128(v, 8)));
+			i += 16;
+			n += 16;
+			continue;
+		}
+
+		__m128i four = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(char(SIZE4))), v);
+		u32 leads = u32(_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(-65))));
+		u32 fours = u32(_mm_movemask_epi8(four));
+		bool split_pair = (fours & 0x8000) != 0;
+		if(split_pair){
+			/* Low surrogate would land past the block, leave that sequence
+			 * to the next one */
+			leads &= 0x7fff;
+			fours &= 0x7fff;
+			four = _mm_insert_epi8(four, 0, 15);
+		}
+		__m128i second = _mm_slli_si128(four, 1);
+		__m128i v1 = _mm_loadu_si128((__m128i const*)&data[i + 1]);
+		__m128i v2 = _mm_loadu_si128((__m128i const*)&data[i + 2]);
+		__m128i lo = utf16_units_sse4(_mm_cvtepu8_epi16(v), _mm_cvtepu8_epi16(v1), _mm_cvtepu8_epi16(v2),
+			_mm_cvtepi8_epi16(four), _mm_cvtepi8_epi16(second));
+		__m128i hi = utf16_units_sse4(_mm_cvtepu8_epi16(_mm_srli_si128(v, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(v1, 8)),
+			_mm_cvtepu8_epi16(_mm_srli_si128(v2, 8)), _mm_cvtepi8_epi16(_mm_srli_si128(four, 8)),
+			_mm_cvtepi8_epi16(_mm_srli_si128(second, 8)));
+		u32 keep = leads | (fours << 1);
+		n += utf16_store_compact_sse4(&out[n], lo, keep);
+		n += utf16_store_compact_sse4(&out[n], hi, keep >> 8);
+
+		if(split_pair){
+			i += 15;
+			continue;
+		}
+		/* The last sequence may run 1 or 2 bytes past the block */
+		isize past = is_continuation_byte(data[i + 16]);
+		i += 16 + past + (past & is_continuation_byte(data[i + 17]));
+	}
+	return n + to_utf16_valid_scalar(&out[n], &data[i], len - i);
+}
+
+/* Narrow the leading 16 unit blocks of ASCII, returns the units done */
+SIMD_TARGET("sse4.1")
+static
+isize utf16_ascii_to_utf8_sse4(byte* out, u16 const* data, isize len){
+	const __m128i non_ascii = _mm_set1_epi16(short(0xff80));
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i a = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&data[i + 8]);
+		if(!_mm_testz_si128(_mm_or_si128(a, b), non_ascii)){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_packus_epi16(a, b));
+	}
+	return i;
+}
+
+/* Widen the leading 8 unit blocks without surrogates, returns the units done */
+SIMD_TARGET("sse4.1")
+static
+isize utf16_bmp_to_utf32_sse4(rune* out, u16 const* data, isize len){
+	const __m128i top = _mm_set1_epi16(short(0xf800));
+	const __m128i surrogate = _mm_set1_epi16(short(UTF16_SURROGATE1));
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i s = _mm_cmpeq_epi16(_mm_and_si128(v, top), surrogate);
+		if(!_mm_testz_si128(s, s)){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_cvtepu16_epi32(v));
+		_mm_storeu_si128((__m128i*)&out[i + 4], _mm_cvtepu16_epi32(_mm_srli_si128(v, 8)));
+	}
+	return i;
+}
+
+/* Narrow the leading 8 rune blocks of BMP scalar values, returns the runes done */
+SIMD_TARGET("sse4.1")
+static
+isize utf32_bmp_to_utf16_sse4(u16* out, rune const* data, isize len){
+	const __m128i high = _mm_set1_epi32(int(0xffff0000));
+	const __m128i top = _mm_set1_epi32(0xf800);
+	const __m128i surrogate = _mm_set1_epi32(UTF16_SURROGATE1);
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		__m128i a = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&data[i + 4]);
+		__m128i s = _mm_or_si128(
+			_mm_cmpeq_epi32(_mm_and_si128(a, top), surrogate),
+			_mm_cmpeq_epi32(_mm_and_si128(b, top), surrogate));
+		if(!_mm_testz_si128(_mm_or_si128(a, b), high) || !_mm_testz_si128(s, s)){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], _mm_packus_epi32(a, b));
+	}
+	return i;
+}
+
+/* Narrow the leading 16 rune blocks of ASCII, returns the runes done */
+SIMD_TARGET("sse4.1")
+static
+isize utf32_ascii_to_utf8_sse4(byte* out, rune const* data, isize len){
+	const __m128i non_ascii = _mm_set1_epi32(~0x7f);
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i a = _mm_loadu_si128((__m128i const*)&data[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&data[i + 4]);
+		__m128i c = _mm_loadu_si128((__m128i const*)&data[i + 8]);
+		__m128i d = _mm_loadu_si128((__m128i const*)&data[i + 12]);
+		if(!_mm_testz_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), non_ascii)){ break; }
+		__m128i lo = _mm_packus_epi32(a, b);
+		__m128i hi = _mm_packus_epi32(c, d);
+		_mm_storeu_si128((__m128i*)&out[i], _mm_packus_epi16(lo, hi));
+	}
+	return i;
+}
+
+/* Same as utf16_measure_scalar(), the counts are kept in 16-bit lanes and
+ * flushed before they can overflow (each lane grows by at most 2 per step) */
+SIMD_TARGET("sse4.1")
+static
+void utf16_measure_sse4(u16 const* data, isize len, isize* extra, isize* pairs){
+	const __m128i ascii_max = _mm_set1_epi16(RANGE1 + 1);
+	const __m128i two_max = _mm_set1_epi16(RANGE2 + 1);
+	const __m128i ten_bits = _mm_set1_epi16(short(0xfc00));
+	const __m128i high = _mm_set1_epi16(short(UTF16_SURROGATE1));
+	const __m128i low = _mm_set1_epi16(short(UTF16_LOW1));
+	const __m128i ones = _mm_set1_epi16(1);
+
+	isize i = 0;
+	/* Reads one unit ahead for the low half of a pair */
+	while(i + 9 <= len){
+		__m128i e = _mm_setzero_si128();
+		__m128i p = _mm_setzero_si128();
+		isize end = min(len - 1, i + 8 * 8192);
+		for(; i + 8 <= end; i += 8){
+			__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+			__m128i next = _mm_loadu_si128((__m128i const*)&data[i + 1]);
+			/* max(v, n) == v is an unsigned v >= n, comparisons are -1 when true */
+			e = _mm_sub_epi16(e, _mm_cmpeq_epi16(_mm_max_epu16(v, ascii_max), v));
+			e = _mm_sub_epi16(e, _mm_cmpeq_epi16(_mm_max_epu16(v, two_max), v));
+			p = _mm_sub_epi16(p, _mm_and_si128(
+				_mm_cmpeq_epi16(_mm_and_si128(v, ten_bits), high),
+				_mm_cmpeq_epi16(_mm_and_si128(next, ten_bits), low)));
+		}
+		__m128i sums = _mm_hadd_epi32(_mm_madd_epi16(e, ones), _mm_madd_epi16(p, ones));
+		sums = _mm_hadd_epi32(sums, sums);
+		*extra += isize(u32(_mm_extract_epi32(sums, 0)));
+		*pairs += isize(u32(_mm_extract_epi32(sums, 1)));
+	}
+	utf16_measure_scalar(&data[i], len - i, extra, pairs);
+}
+#endif
+
+static
+void utf16_measure(u16 const* data, isize len, isize* extra, isize* pairs){
+	*extra = 0;
+	*pairs = 0;
+#ifdef SIMD_X86
+	if(simd_level() >= Simd_Level::SSE4){
+		utf16_measure_sse4(data, len, extra, pairs);
+		return;
+	}
+#endif
+	utf16_measure_scalar(data, len, extra, pairs);
+}
+
+isize to_utf16_size(Slice<byte> buf){
+	byte* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	isize pos = 0, count = 0;
+
+	while(pos < len){
+		isize end = window_end(data, len, pos, len);
+
+		if(end > pos && validate(buf.sub(pos, end))){
+			count += count_valid(&data[pos], end - pos) + count_lead4(&data[pos], end - pos);
+			pos = end;
+			continue;
+		}
+
+		if(end <= pos){ end = pos + 1; }
+		while(pos < end){
+			Decode_Result res = decode(buf.sub(pos));
+			count += res.len == 4 ? 2 : 1;
+			pos += res.len > 0 ? res.len : 1;
+		}
+	}
+	return count;
+}
+
+static
+isize to_utf16_valid(u16* out, byte const* data, isize len){
+#ifdef SIMD_X86
+	if(simd_level() >= Simd_Level::SSE4){
+		return to_utf16_valid_sse4(out, data, len);
+	}
+#endif
+	return to_utf16_valid_scalar(out, data, len);
+}
+
+isize to_utf16(Slice<u16> out, Slice<byte> buf, isize* consumed){
+	byte* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	u16* dst = out.raw_data();
+	isize cap = out.empty() ? 0 : out.size();
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+#endif
+
+	while(pos < len && n < cap){
+#ifdef SIMD_X86
+		if(sse4 && data[pos] < 0x80){
+			/* ASCII needs no validation */
+			isize done = ascii_to_utf16_sse4(&dst[n], &data[pos], min(len - pos, cap - n));
+			pos += done;
+			n += done;
+			if(pos == len || n == cap){ break; }
+		}
+#endif
+		/* Window is capped by the space left, a valid one always fits */
+		isize end = window_end(data, len, pos, cap - n);
+
+		if(end > pos && validate(buf.sub(pos, end))){
+			n += to_utf16_valid(&dst[n], &data[pos], end - pos);
+			pos = end;
+			continue;
+		}
+
+		if(end <= pos){ end = pos + 1; }
+		bool full = false;
+		while(pos < end){
+			Decode_Result res = decode(buf.sub(pos));
+			isize size = utf16_rune_size(res.codepoint);
+			full = n + size > cap;
+			if(full){ break; }
+			utf16_put(&dst[n], res.codepoint);
+			n += size;
+			pos += res.len > 0 ? res.len : 1;
+		}
+		if(full){ break; }
+	}
+
+	if(consumed != nullptr){ *consumed = pos; }
+	return n;
+}
+} /* Namespace utf8 */
+
+namespace utf16 {
+using namespace utf8;
+
+isize to_utf8_size(Slice<u16> buf){
+	isize extra = 0, pairs = 0;
+	if(buf.empty()){ return 0; }
+	utf16_measure(buf.raw_data(), buf.size(), &extra, &pairs);
+	return buf.size() + extra - 2 * pairs;
+}
+
+isize to_utf32_size(Slice<u16> buf){
+	isize extra = 0, pairs = 0;
+	if(buf.empty()){ return 0; }
+	utf16_measure(buf.raw_data(), buf.size(), &extra, &pairs);
+	return buf.size() - pairs;
+}
+
+isize to_utf8(Slice<byte> out, Slice<u16> buf, isize* consumed){
+	u16 const* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	byte* dst = out.raw_data();
+	isize cap = out.empty() ? 0 : out.size();
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+#endif
+
+	while(pos < len){
+#ifdef SIMD_X86
+		if(sse4 && data[pos] <= RANGE1){
+			isize done = utf16_ascii_to_utf8_sse4(&dst[n], &data[pos], min(len - pos, cap - n));
+			pos += done;
+			n += done;
+			if(pos == len){ break; }
+		}
+#endif
+		isize next = pos;
+		rune r = utf16_next(data, len, &next);
+		isize size = utf8_rune_size(r);
+		if(n + size > cap){ break; }
+		utf8_put(&dst[n], r);
+		n += size;
+		pos = next;
+	}
+
+	if(consumed != nullptr){ *consumed = pos; }
+	return n;
+}
+
+isize to_utf32(Slice<rune> out, Slice<u16> buf, isize* consumed){
+	u16 const* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	rune* dst = out.raw_data();
+	isize cap = out.empty() ? 0 : out.size();
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+#endif
+
+	while(pos < len && n < cap){
+#ifdef SIMD_X86
+		if(sse4){
+			isize done = utf16_bmp_to_utf32_sse4(&dst[n], &data[pos], min(len - pos, cap - n));
+			pos += done;
+			n += done;
+			if(pos == len || n == cap){ break; }
+		}
+#endif
+		dst[n] = utf16_next(data, len, &pos);
+		n += 1;
+	}
+
+	if(consumed != nullptr){ *consumed = pos; }
+	return n;
+}
+} /* Namespace utf16 */
+
+namespace utf32 {
+using namespace utf8;
+
+isize to_utf8_size(Slice<rune> buf){
+	isize count = 0;
+	for(isize i = 0; i < buf.size(); i += 1){
+		count += utf8_rune_size(utf32_scalar(buf[i]));
+	}
+	return count;
+}
+
+isize to_utf16_size(Slice<rune> buf){
+	isize count = 0;
+	for(isize i = 0; i < buf.size(); i += 1){
+		count += utf16_rune_size(utf32_scalar(buf[i]));
+	}
+	return count;
+}
+
+isize to_utf8(Slice<byte> out, Slice<rune> buf, isize* consumed){
+	rune const* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	byte* dst = out.raw_data();
+	isize cap = out.empty() ? 0 : out.size();
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+#endif
+
+	while(pos < len){
+#ifdef SIMD_X86
+		if(sse4 && u32(data[pos]) < 0x80){
+			isize done = utf32_ascii_to_utf8_sse4(&dst[n], &data[pos], min(len - pos, cap - n));
+			pos += done;
+			n += done;
+			if(pos == len){ break; }
+		}
+#endif
+		rune r = utf32_scalar(data[pos]);
+		isize size = utf8_rune_size(r);
+		if(n + size > cap){ break; }
+		utf8_put(&dst[n], r);
+		n += size;
+		pos += 1;
+	}
+
+	if(consumed != nullptr){ *consumed = pos; }
+	return n;
+}
+
+isize to_utf16(Slice<u16> out, Slice<rune> buf, isize* consumed){
+	rune const* data = buf.raw_data();
+	isize len = buf.empty() ? 0 : buf.size();
+	u16* dst = out.raw_data();
+	isize cap = out.empty() ? 0 : out.size();
+	isize pos = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+#endif
+
+	while(pos < len){
+#ifdef SIMD_X86
+		if(sse4){
+			isize done = utf32_bmp_to_utf16_sse4(&dst[n], &data[pos], min(len - pos, cap - n));
+			pos += done;
+			n += done;
+			if(pos == len){ break; }
+		}
+#endif
+		rune r = utf32_scalar(data[pos]);
+		isize size = utf16_rune_size(r);
+		if(n + size > cap){ break; }
+		utf16_put(&dst[n], r);
+		n += size;
+		pos += 1;
+	}
+
+	if(consumed != nullptr){ *consumed = pos; }
+	return n;
+}
+} /* Namespace utf32 */
+
+//// Strings ///////////////////////////////////////////////////////////////////
+isize String::size() const {
+	return _length;
+}
+
+// UTF8_Iterator str_iterator(String s){
+// }
+//
+// UTF8_Iterator str_iterator_reversed(String s){
+// 	return (UTF8_Iterator){
+// 		.current = s.len,
 // 		.data_length = s.len,
 // 		.data = s.data,
 // 	};
 // }
 
-utf8::Iterator String::iterator(){
-	return {
-		.data = Slice<byte>::from_pointer((byte*)_data, _length),
-		.current = 0,
-	};
+utf8::Iterator String::iterator(){
+	return {
+		.data = Slice<byte>::from_pointer((byte*)_data, _length),
+		.current = 0,
+	};
+}
+
+utf8::Iterator String::iterator_reversed(){
+	return {
+		.data = Slice<byte>::from_pointer((byte*)_data, _length),
+		.current = _length,
+	};
+}
+
+isize String::rune_count() const {
+	if(_length <= 0 || _data == nullptr){ return 0; }
+	isize count = 0;
+	utf8::rune_offset(Slice<byte>::from_pointer((byte*)_data, _length), _length, &count);
+	return count;
+}
+
+isize String::rune_offset(isize n) const {
+	if(_length <= 0 || _data == nullptr || n <= 0){ return 0; }
+	return utf8::rune_offset(Slice<byte>::from_pointer((byte*)_data, _length), n);
+}
+
+String String::sub(isize start, isize length){
+	if(start < 0 || length < 0 || (start + length) > _length){ return String{}; }
+	return String{ &_data[start], length };
+}
+
+String String::sub_runes(isize start, isize count){
+	if(start < 0 || count < 0){ return String{}; }
+	isize begin = rune_offset(start);
+	isize end = begin + sub(begin, _length - begin).rune_offset(count);
+	return sub(begin, end - begin);
+}
+
+String String::from_cstr(cstring data){
+	return String{ (byte const*)data, cstring_len(data) };
+}
+
+String String::from_cstr(cstring data, isize start, isize length){
+	return String{ (byte const*)&data[start], length };
+}
+
+String String::from_pointer(byte const* data, isize length){
+	return String{ data, length };
+}
+
+//// String Index //////////////////////////////////////////////////////////////
+bool String_Index::init(String s, mem::Allocator allocator){
+	*this = String_Index{};
+	_str = s;
+	_allocator = allocator;
+	/* There's never more runes than bytes */
+	isize cap = s.size() / STRING_INDEX_STRIDE + 1;
+	_offsets = (isize*)allocator.alloc(cap * isize(sizeof(isize)), alignof(isize));
+	if(_offsets == nullptr){ return false; }
+
+	if(s.size() > 0 && s._data != nullptr){
+		auto buf = Slice<byte>::from_pointer((byte*)s._data, s.size());
+		_rune_count = utf8::rune_checkpoints(buf, STRING_INDEX_STRIDE, _offsets, &_len);
+	}
+	return true;
+}
+
+void String_Index::destroy(){
+	_allocator.free(_offsets);
+	*this = String_Index{};
+}
+
+isize String_Index::offset(isize n) const {
+	if(n <= 0){ return 0; }
+	if(n >= _rune_count){ return _str.size(); }
+
+	isize base = _offsets[n / STRING_INDEX_STRIDE];
+	isize rest = n % STRING_INDEX_STRIDE;
+	auto buf = Slice<byte>::from_pointer((byte*)&_str._data[base], _str.size() - base);
+	return base + utf8::rune_offset(buf, rest);
+}
+
+String String_Index::sub(isize start, isize count) const {
+	if(start < 0 || count < 0){ return String{}; }
+	isize begin = offset(start);
+	isize end = offset(start + count);
+	return String{ &_str._data[begin], end - begin };
+}
+
+//// String Search /////////////////////////////////////////////////////////////
+/* Two-Way string matching (Crochemore & Perrin), linear time and constant
+ * space. It backs up the vector filters below once they degenerate, so it
+ * skips the usual bad character table. With `rev` both strings are read back
+ * to front, which finds the last match instead of the first. */
+static inline
+byte two_way_at(byte const* s, isize len, isize i, bool rev){
+	return rev ? s[len - 1 - i] : s[i];
+}
+
+/* Start (minus one) and period of the maximal suffix under either byte order */
+static
+isize two_way_max_suffix(byte const* p, isize m, bool rev, bool flip, isize* period){
+	isize ip = -1, jp = 0, k = 1, per = 1;
+	while(jp + k < m){
+		byte a = two_way_at(p, m, ip + k, rev);
+		byte b = two_way_at(p, m, jp + k, rev);
+		if(a == b){
+			if(k == per){
+				jp += per;
+				k = 1;
+			}
+			else {
+				k += 1;
+			}
+		}
+		else if((a > b) != flip){
+			jp += k;
+			k = 1;
+			per = jp - ip;
+		}
+		else {
+			ip = jp;
+			jp += 1;
+			k = 1;
+			per = 1;
+		}
+	}
+	*period = per;
+	return ip;
+}
+
+/* Offset of the first match (the last one with `rev`), or -1 */
+static
+isize two_way_search(byte const* h, isize n, byte const* p, isize m, bool rev){
+	isize period, flip_period;
+	isize ms = two_way_max_suffix(p, m, rev, false, &period);
+	isize flip_ms = two_way_max_suffix(p, m, rev, true, &flip_period);
+	if(flip_ms > ms){
+		ms = flip_ms;
+		period = flip_period;
+	}
+
+	/* Periodic needles remember how much of their left half already matched */
+	bool periodic = ms + 1 + period <= m;
+	for(isize i = 0; periodic && i <= ms; i += 1){
+		periodic = two_way_at(p, m, i, rev) == two_way_at(p, m, i + period, rev);
+	}
+	isize mem0 = 0;
+	if(periodic){
+		mem0 = m - period;
+	}
+	else {
+		period = max(ms, m - ms - 1) + 1;
+	}
+
+	isize mem = 0;
+	for(isize j = 0; j + m <= n;){
+		isize k = max(ms + 1, mem);
+		while(k < m && two_way_at(p, m, k, rev) == two_way_at(h, n, j + k, rev)){
+			k += 1;
+		}
+		if(k < m){
+			j += k - ms;
+			mem = 0;
+			continue;
+		}
+
+		k = ms + 1;
+		while(k > mem && two_way_at(p, m, k - 1, rev) == two_way_at(h, n, j + k - 1, rev)){
+			k -= 1;
+		}
+		if(k <= mem){
+			return rev ? n - j - m : j;
+		}
+		j += period;
+		mem = mem0;
+	}
+	return -1;
+}
+
+/* The vector filters compare the first and last byte of the pattern against
+ * a whole block of candidate positions at once and only verify the survivors.
+ * Verification work past this budget (plus twice the bytes scanned) means the
+ * input is adversarial for the filter, the rest goes through Two-Way. */
+constexpr isize SEARCH_SLACK = 4096;
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static
+isize str_find_sse4(byte const* h, isize n, byte const* p, isize m){
+	const __m128i first = _mm_set1_epi8(char(p[0]));
+	const __m128i last = _mm_set1_epi8(char(p[m - 1]));
+	isize work = 0;
+	isize i = 0;
+	for(; i + m - 1 + 16 <= n && work <= 2 * i + SEARCH_SLACK; i += 16){
+		__m128i a = _mm_loadu_si128((__m128i const*)&h[i]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&h[i + m - 1]);
+		u32 hits = u32(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+		for(; hits != 0; hits &= hits - 1){
+			isize at = i + simd_ctz(hits);
+			if(m <= 2 || mem::compare(&h[at + 1], &p[1], m - 2) == 0){ return at; }
+			work += m;
+		}
+	}
+	isize r = two_way_search(&h[i], n - i, p, m, false);
+	return r < 0 ? -1 : i + r;
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize str_rfind_sse4(byte const* h, isize n, byte const* p, isize m){
+	const __m128i first = _mm_set1_epi8(char(p[0]));
+	const __m128i last = _mm_set1_epi8(char(p[m - 1]));
+	isize work = 0;
+	/* Candidate positions left are [0, end) */
+	isize end = n - m + 1;
+	for(; end >= 16 && work <= 2 * (n - m + 1 - end) + SEARCH_SLACK; end -= 16){
+		isize base = end - 16;
+		__m128i a = _mm_loadu_si128((__m128i const*)&h[base]);
+		__m128i b = _mm_loadu_si128((__m128i const*)&h[base + m - 1]);
+		u32 hits = u32(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+		while(hits != 0){
+			isize bit = simd_msb(hits);
+			if(m <= 2 || mem::compare(&h[base + bit + 1], &p[1], m - 2) == 0){ return base + bit; }
+			hits &= ~(u32(1) << bit);
+			work += m;
+		}
+	}
+	return two_way_search(h, end + m - 1, p, m, true);
+}
+
+SIMD_TARGET("avx2")
+static
+isize str_find_avx2(byte const* h, isize n, byte const* p, isize m){
+	const __m256i first = _mm256_set1_epi8(char(p[0]));
+	const __m256i last = _mm256_set1_epi8(char(p[m - 1]));
+	isize work = 0;
+	isize i = 0;
+	for(; i + m - 1 + 32 <= n && work <= 2 * i + SEARCH_SLACK; i += 32){
+		__m256i a = _mm256_loadu_si256((__m256i const*)&h[i]);
+		__m256i b = _mm256_loadu_si256((__m256i const*)&h[i + m - 1]);
+		u32 hits = u32(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+		for(; hits != 0; hits &= hits - 1){
+			isize at = i + simd_ctz(hits);
+			if(m <= 2 || mem::compare(&h[at + 1], &p[1], m - 2) == 0){ return at; }
+			work += m;
+		}
+	}
+	isize r = two_way_search(&h[i], n - i, p, m, false);
+	return r < 0 ? -1 : i + r;
+}
+
+SIMD_TARGET("avx2")
+static
+isize str_rfind_avx2(byte const* h, isize n, byte const* p, isize m){
+	const __m256i first = _mm256_set1_epi8(char(p[0]));
+	const __m256i last = _mm256_set1_epi8(char(p[m - 1]));
+	isize work = 0;
+	isize end = n - m + 1;
+	for(; end >= 32 && work <= 2 * (n - m + 1 - end) + SEARCH_SLACK; end -= 32){
+		isize base = end - 32;
+		__m256i a = _mm256_loadu_si256((__m256i const*)&h[base]);
+		__m256i b = _mm256_loadu_si256((__m256i const*)&h[base + m - 1]);
+		u32 hits = u32(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+		while(hits != 0){
+			isize bit = simd_msb(hits);
+			if(m <= 2 || mem::compare(&h[base + bit + 1], &p[1], m - 2) == 0){ return base + bit; }
+			hits &= ~(u32(1) << bit);
+			work += m;
+		}
+	}
+	return two_way_search(h, end + m - 1, p, m, true);
+}
+#endif
+
+isize String::find(String pattern) const {
+	if(pattern._length == 0){ return 0; }
+	if(pattern._length > _length){ return -1; }
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case Simd_Level::AVX2: return str_find_avx2(_data, _length, pattern._data, pattern._length);
+		case Simd_Level::SSE4: return str_find_sse4(_data, _length, pattern._data, pattern._length);
+		default: break;
+	}
+#endif
+	return two_way_search(_data, _length, pattern._data, pattern._length, false);
+}
+
+isize String::rfind(String pattern) const {
+	if(pattern._length == 0){ return _length; }
+	if(pattern._length > _length){ return -1; }
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case Simd_Level::AVX2: return str_rfind_avx2(_data, _length, pattern._data, pattern._length);
+		case Simd_Level::SSE4: return str_rfind_sse4(_data, _length, pattern._data, pattern._length);
+		default: break;
+	}
+#endif
+	return two_way_search(_data, _length, pattern._data, pattern._length, true);
+}
+
+isize String::count(String pattern) const {
+	if(pattern._length == 0){ return 0; }
+
+	isize n = 0;
+	if(pattern._length == 1){
+		byte c = pattern._data[0];
+		for(isize i = 0; i < _length; i += 1){
+			n += _data[i] == c;
+		}
+		return n;
+	}
+
+	for(isize pos = 0;;){
+		isize at = String{ &_data[pos], _length - pos }.find(pattern);
+		if(at < 0){ break; }
+		n += 1;
+		pos += at + pattern._length;
+	}
+	return n;
+}
+
+//// Pattern Set ///////////////////////////////////////////////////////////////
+/* Aho-Corasick turned into a DFA over byte classes. Transitions hold the row
+ * offset of their target (state * class_count) so stepping doesn't multiply,
+ * and are complemented when the target ends at least one pattern. */
+bool Pattern_Set::init(Slice<String> patterns, mem::Allocator allocator){
+	*this = Pattern_Set{};
+	_allocator = allocator;
+	_pattern_count = patterns.size();
+
+	/* Bytes that never show up in a pattern all share class 0 */
+	bool used[256] = {};
+	isize used_count = 0, total = 0;
+	for(isize i = 0; i < patterns.size(); i += 1){
+		String p = patterns[i];
+		total += p._length;
+		for(isize k = 0; k < p._length; k += 1){
+			used_count += !used[p._data[k]];
+			used[p._data[k]] = true;
+		}
+	}
+	isize next_class = used_count < 256 ? 1 : 0;
+	for(isize b = 0; b < 256; b += 1){
+		_classes[b] = used[b] ? byte(next_class++) : 0;
+	}
+	_class_count = next_class;
+
+	isize cap = total + 1;
+	isize C = _class_count;
+	if(cap * C > INT32_MAX){ return false; }
+
+	auto alloc_i32 = [&](isize n){ return (i32*)allocator.alloc(n * isize(sizeof(i32)), alignof(i32)); };
+	_delta = alloc_i32(cap * C);
+	_output = alloc_i32(cap);
+	_dict = alloc_i32(cap);
+	_pattern = alloc_i32(cap);
+	_lengths = (isize*)allocator.alloc(max<isize>(_pattern_count, 1) * isize(sizeof(isize)), alignof(isize));
+	i32* fail = alloc_i32(cap);
+	i32* queue = alloc_i32(cap);
+	bool ok = _delta != nullptr && _output != nullptr && _dict != nullptr &&
+		_pattern != nullptr && _lengths != nullptr && fail != nullptr && queue != nullptr;
+
+	/* Plain trie first, missing transitions are -1 */
+	if(ok){
+		for(isize i = 0; i < cap * C; i += 1){
+			_delta[i] = -1;
+		}
+		_pattern[0] = -1;
+		_state_count = 1;
+
+		for(isize i = 0; i < patterns.size(); i += 1){
+			String p = patterns[i];
+			_lengths[i] = p._length;
+			if(p._length == 0){ continue; } /* Never matches */
+
+			i32 s = 0;
+			for(isize k = 0; k < p._length; k += 1){
+				isize slot = s * C + _classes[p._data[k]];
+				if(_delta[slot] < 0){
+					_delta[slot] = i32(_state_count);
+					_pattern[_state_count] = -1;
+					_state_count += 1;
+				}
+				s = _delta[slot];
+			}
+			/* Duplicates report the first one */
+			if(_pattern[s] < 0){
+				_pattern[s] = i32(i);
+			}
+		}
+	}
+
+	/* Failure links and the missing transitions, breadth first so the failure
+	 * state of every state already has its row filled in */
+	if(ok){
+		isize head = 0, tail = 0;
+		_dict[0] = -1;
+		_output[0] = -1;
+		for(isize c = 0; c < C; c += 1){
+			i32 t = _delta[c];
+			if(t < 0){
+				_delta[c] = 0;
+			}
+			else {
+				fail[t] = 0;
+				queue[tail++] = t;
+			}
+		}
+
+		while(head < tail){
+			i32 s = queue[head++];
+			i32 f = fail[s];
+			_dict[s] = _pattern[f] >= 0 ? f : _dict[f];
+			_output[s] = _pattern[s] >= 0 ? s : _dict[s];
+			for(isize c = 0; c < C; c += 1){
+				i32 t = _delta[s * C + c];
+				if(t < 0){
+					_delta[s * C + c] = _delta[f * C + c];
+				}
+				else {
+					fail[t] = _delta[f * C + c];
+					queue[tail++] = t;
+				}
+			}
+		}
+	}
+
+	for(isize i = 0; ok && i < _state_count * C; i += 1){
+		i32 t = _delta[i];
+		_delta[i] = _output[t] >= 0 ? ~i32(t * C) : i32(t * C);
+	}
+
+	if(fail != nullptr){ allocator.free(fail); }
+	if(queue != nullptr){ allocator.free(queue); }
+	if(!ok){ destroy(); }
+	return ok;
+}
+
+void Pattern_Set::destroy(){
+	if(_delta != nullptr){ _allocator.free(_delta); }
+	if(_output != nullptr){ _allocator.free(_output); }
+	if(_dict != nullptr){ _allocator.free(_dict); }
+	if(_pattern != nullptr){ _allocator.free(_pattern); }
+	if(_lengths != nullptr){ _allocator.free(_lengths); }
+	*this = Pattern_Set{};
+}
+
+bool Pattern_Set::run(i32* row, isize base, String chunk, Pattern_Match_Func func, void* ctx) const {
+	i32 r = *row;
+	for(isize i = 0; i < chunk._length; i += 1){
+		r = _delta[r + _classes[chunk._data[i]]];
+		if(r >= 0){ continue; }
+
+		r = ~r;
+		for(i32 o = _output[r / _class_count]; o >= 0; o = _dict[o]){
+			i32 id = _pattern[o];
+			isize len = _lengths[id];
+			Pattern_Match m = { .pattern = id, .offset = base + i + 1 - len, .len = len };
+			if(!func(ctx, m)){
+				*row = r;
+				return false;
+			}
+		}
+	}
+	*row = r;
+	return true;
+}
+
+bool Pattern_Set::find(String s, Pattern_Match* match) const {
+	i32 row = 0;
+	auto first = [](void* ctx, Pattern_Match m) -> bool {
+		*(Pattern_Match*)ctx = m;
+		return false;
+	};
+	return !run(&row, 0, s, first, match);
+}
+
+isize Pattern_Set::find_all(String s, Slice<Pattern_Match> out) const {
+	struct Match_List {
+		Slice<Pattern_Match> out;
+		isize count;
+	};
+	Match_List list = { out, 0 };
+	auto append = [](void* ctx, Pattern_Match m) -> bool {
+		Match_List* list = (Match_List*)ctx;
+		if(list->count < list->out.size()){
+			list->out[list->count] = m;
+		}
+		list->count += 1;
+		return true;
+	};
+	i32 row = 0;
+	run(&row, 0, s, append, &list);
+	return list.count;
+}
+
+i64 Pattern_Set::match_stream(io::Stream s, Slice<byte> buf, Pattern_Match_Func func, void* ctx) const {
+	Pattern_Scanner sc;
+	sc.init(this);
+	for(;;){
+		i64 n = s.read(buf);
+		if(n == i64(io::Stream_Error::End_Of_Stream) || n == 0){ break; }
+		if(n < 0){ return n; }
+		if(!sc.feed(String{ buf.raw_data(), isize(n) }, func, ctx)){ break; }
+	}
+	return sc._offset;
+}
+
+void Pattern_Scanner::init(Pattern_Set const* set){
+	*this = Pattern_Scanner{};
+	_set = set;
+}
+
+bool Pattern_Scanner::feed(String chunk, Pattern_Match_Func func, void* ctx){
+	bool ok = _set->run(&_row, _offset, chunk, func, ctx);
+	_offset += chunk.size();
+	return ok;
+}
+
+//// Cutset ////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+
+/* The bitmap is laid out as two 16 byte tables indexed by the low nibble, one
+ * for bytes under 0x80 and one for the rest, with bit `(b >> 4) & 7` set for
+ * each member byte `b`. That lets the vector paths look bytes up with shuffles. */
+static inline
+bool cutset_has_byte(Cutset const& set, byte b){
+	return (set._bitmap[(b >> 7) * 16 + (b & 15)] >> ((b >> 4) & 7)) & 1;
+}
+
+static inline
+void cutset_add_byte(Cutset& set, byte b){
+	set._bitmap[(b >> 7) * 16 + (b & 15)] |= byte(1 << ((b >> 4) & 7));
+}
+
+bool Cutset::init(String runes, mem::Allocator allocator){
+	*this = Cutset{};
+	_allocator = allocator;
+
+	/* Every non-ASCII rune has at least one byte over 0x7f */
+	isize wide = 0;
+	for(isize i = 0; i < runes.size(); i += 1){
+		wide += runes._data[i] >= 0x80;
+	}
+	if(wide > 0){
+		_runes = (rune*)allocator.alloc(wide * isize(sizeof(rune)), alignof(rune));
+		if(_runes == nullptr){ return false; }
+	}
+
+	rune c; i8 n;
+	utf8::Iterator iter = runes.iterator();
+	while(iter.next(&c, &n)){
+		if(c < 0x80){
+			cutset_add_byte(*this, byte(c));
+			continue;
+		}
+
+		_runes[_runes_len] = c;
+		_runes_len += 1;
+		if(c == utf8::ERROR){
+			/* Invalid bytes also decode to the error rune, so any non-ASCII byte can match */
+			for(isize b = 0x80; b <= 0xff; b += 1){
+				cutset_add_byte(*this, byte(b));
+			}
+		}
+		else {
+			cutset_add_byte(*this, utf8::encode(c).bytes[0]);
+		}
+	}
+
+	if(_runes_len > 1){
+		qsort(_runes, _runes_len, sizeof(rune), [](void const* a, void const* b) -> int {
+			rune x = *(rune const*)a;
+			rune y = *(rune const*)b;
+			return (x > y) - (x < y);
+		});
+		isize unique = 1;
+		for(isize i = 1; i < _runes_len; i += 1){
+			if(_runes[i] != _runes[unique - 1]){
+				_runes[unique] = _runes[i];
+				unique += 1;
+			}
+		}
+		_runes_len = unique;
+	}
+	return true;
+}
+
+void Cutset::destroy(){
+	if(_runes != nullptr){
+		_allocator.free(_runes);
+	}
+	*this = Cutset{};
+}
+
+bool Cutset::contains(rune r) const {
+	if(r < 0x80){
+		return r >= 0 && cutset_has_byte(*this, byte(r));
+	}
+
+	isize lo = 0, hi = _runes_len;
+	while(lo < hi){
+		isize mid = lo + (hi - lo) / 2;
+		if(_runes[mid] < r){
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	return lo < _runes_len && _runes[lo] == r;
+}
+
+/* Scanning stops at member bytes, or with `span` at anything but an ASCII
+ * member byte. Non-ASCII stops still have to be decoded and looked up. */
+static inline
+bool cutset_stops_at(Cutset const& set, byte b, bool span){
+	if(span){
+		return b >= 0x80 || !cutset_has_byte(set, b);
+	}
+	return cutset_has_byte(set, b);
+}
+
+static
+isize cutset_find_scalar(Cutset const& set, byte const* data, isize len, bool span){
+	isize i = 0;
+	for(; i < len; i += 1){
+		if(cutset_stops_at(set, data[i], span)){ break; }
+	}
+	return i;
+}
+
+static
+isize cutset_rfind_scalar(Cutset const& set, byte const* data, isize len, bool span){
+	isize i = len - 1;
+	for(; i >= 0; i -= 1){
+		if(cutset_stops_at(set, data[i], span)){ break; }
+	}
+	return i;
+}
+
+#ifdef SIMD_X86
+/* Bitmask of the stops in a block, see cutset_stops_at() */
+SIMD_TARGET("sse4.1")
+static inline
+u32 cutset_stops_sse4(__m128i low, __m128i high, __m128i v, bool span){
+	const __m128i nibble = _mm_set1_epi8(0x0f);
+	const __m128i rows = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	__m128i lo = _mm_and_si128(v, nibble);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+	/* blendv picks the high table for bytes with their top bit set */
+	__m128i cols = _mm_blendv_epi8(_mm_shuffle_epi8(low, lo), _mm_shuffle_epi8(high, lo), v);
+	__m128i hits = _mm_and_si128(cols, _mm_shuffle_epi8(rows, hi));
+	u32 misses = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(hits, _mm_setzero_si128())));
+	if(span){
+		return misses | u32(_mm_movemask_epi8(v));
+	}
+	return ~misses & 0xffff;
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize cutset_find_sse4(Cutset const& set, byte const* data, isize len, bool span){
+	__m128i low = _mm_loadu_si128((__m128i const*)&set._bitmap[0]);
+	__m128i high = _mm_loadu_si128((__m128i const*)&set._bitmap[16]);
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		u32 stops = cutset_stops_sse4(low, high, _mm_loadu_si128((__m128i const*)&data[i]), span);
+		if(stops != 0){ return i + simd_ctz(stops); }
+	}
+	return i + cutset_find_scalar(set, &data[i], len - i, span);
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize cutset_rfind_sse4(Cutset const& set, byte const* data, isize len, bool span){
+	__m128i low = _mm_loadu_si128((__m128i const*)&set._bitmap[0]);
+	__m128i high = _mm_loadu_si128((__m128i const*)&set._bitmap[16]);
+	isize i = len;
+	for(; i >= 16; i -= 16){
+		u32 stops = cutset_stops_sse4(low, high, _mm_loadu_si128((__m128i const*)&data[i - 16]), span);
+		if(stops != 0){ return i - 16 + simd_msb(stops); }
+	}
+	return cutset_rfind_scalar(set, data, i, span);
+}
+
+SIMD_TARGET("avx2")
+static inline
+u32 cutset_stops_avx2(__m256i low, __m256i high, __m256i v, bool span){
+	const __m256i nibble = _mm256_set1_epi8(0x0f);
+	const __m256i rows = _mm256_setr_epi8(
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+		1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	__m256i lo = _mm256_and_si256(v, nibble);
+	__m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+	__m256i cols = _mm256_blendv_epi8(_mm256_shuffle_epi8(low, lo), _mm256_shuffle_epi8(high, lo), v);
+	__m256i hits = _mm256_and_si256(cols, _mm256_shuffle_epi8(rows, hi));
+	u32 misses = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hits, _mm256_setzero_si256())));
+	if(span){
+		return misses | u32(_mm256_movemask_epi8(v));
+	}
+	return ~misses;
+}
+
+SIMD_TARGET("avx2")
+static
+isize cutset_find_avx2(Cutset const& set, byte const* data, isize len, bool span){
+	__m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set._bitmap[0]));
+	__m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set._bitmap[16]));
+	isize i = 0;
+	for(; i + 32 <= len; i += 32){
+		u32 stops = cutset_stops_avx2(low, high, _mm256_loadu_si256((__m256i const*)&data[i]), span);
+		if(stops != 0){ return i + simd_ctz(stops); }
+	}
+	return i + cutset_find_scalar(set, &data[i], len - i, span);
+}
+
+SIMD_TARGET("avx2")
+static
+isize cutset_rfind_avx2(Cutset const& set, byte const* data, isize len, bool span){
+	__m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set._bitmap[0]));
+	__m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const*)&set._bitmap[16]));
+	isize i = len;
+	for(; i >= 32; i -= 32){
+		u32 stops = cutset_stops_avx2(low, high, _mm256_loadu_si256((__m256i const*)&data[i - 32]), span);
+		if(stops != 0){ return i - 32 + simd_msb(stops); }
+	}
+	return cutset_rfind_scalar(set, data, i, span);
+}
+#endif
+
+/* Index of the first stop byte, or `len` */
+static
+isize cutset_find(Cutset const& set, byte const* data, isize len, bool span){
+	/* Trimmed runs are usually short, try a few bytes before going wide */
+	isize head = len < 8 ? len : 8;
+	isize i = cutset_find_scalar(set, data, head, span);
+	if(i < head || i == len){ return i; }
+#ifdef SIMD_X86
+	if(len - i >= 16){
+		switch(simd_level()){
+			case Simd_Level::AVX2: return i + cutset_find_avx2(set, &data[i], len - i, span);
+			case Simd_Level::SSE4: return i + cutset_find_sse4(set, &data[i], len - i, span);
+			default: break;
+		}
+	}
+#endif
+	return i + cutset_find_scalar(set, &data[i], len - i, span);
+}
+
+/* Index of the last stop byte, or -1 */
+static
+isize cutset_rfind(Cutset const& set, byte const* data, isize len, bool span){
+	isize head = len < 8 ? len : 8;
+	isize i = len - head + cutset_rfind_scalar(set, &data[len - head], head, span);
+	if(i >= len - head || len == head){ return i; }
+	len -= head;
+#ifdef SIMD_X86
+	if(len >= 16){
+		switch(simd_level()){
+			case Simd_Level::AVX2: return cutset_rfind_avx2(set, data, len, span);
+			case Simd_Level::SSE4: return cutset_rfind_sse4(set, data, len, span);
+			default: break;
+		}
+	}
+#endif
+	return cutset_rfind_scalar(set, data, len, span);
+}
+
+/* Decode the rune at `pos` like utf8::Iterator::next() and store its length in
+ * `n`, returns whether it's a member */
+static inline
+bool cutset_match(Cutset const& set, String s, isize pos, isize* n){
+	byte b = s._data[pos];
+	if(b < 0x80){
+		*n = 1;
+		return cutset_has_byte(set, b);
+	}
+	utf8::Decode_Result res = utf8::decode(Slice<byte>::from_pointer((byte*)&s._data[pos], s.size() - pos));
+	*n = res.len > 0 ? res.len : 1;
+	return cutset_has_byte(set, b) && set.contains(res.codepoint);
+}
+
+/* Byte offset and length of the first member rune at or after `pos` */
+static
+isize cutset_find_rune(Cutset const& set, String s, isize pos, isize* n){
+	while(pos < s.size()){
+		pos += cutset_find(set, &s._data[pos], s.size() - pos, false);
+		if(pos >= s.size()){ break; }
+		if(cutset_match(set, s, pos, n)){ return pos; }
+		pos += *n;
+	}
+	*n = 0;
+	return -1;
+}
+
+String String::trim_leading(Cutset const& set){
+	isize cut_after = 0;
+	while(cut_after < _length){
+		cut_after += cutset_find(set, &_data[cut_after], _length - cut_after, true);
+		if(cut_after >= _length){ break; }
+
+		isize n;
+		if(!cutset_match(set, *this, cut_after, &n)){ break; }
+		cut_after += n;
+	}
+	return sub(cut_after, _length - cut_after);
+}
+
+String String::trim_trailing(Cutset const& set){
+	isize cut_until = _length;
+	while(cut_until > 0){
+		cut_until = cutset_rfind(set, _data, cut_until, true) + 1;
+		if(cut_until <= 0 || _data[cut_until - 1] < 0x80){ break; }
+
+		/* Same rune boundaries as utf8::Iterator::prev() */
+		utf8::Iterator iter = iterator();
+		iter.current = cut_until;
+		rune c; i8 n;
+		iter.prev(&c, &n);
+		if(!set.contains(c)){ break; }
+		cut_until = iter.current;
+	}
+	return sub(0, cut_until);
+}
+
+String String::trim(Cutset const& set){
+	return trim_trailing(set).trim_leading(set);
+}
+
+isize String::find_any(Cutset const& set) const {
+	isize n;
+	return cutset_find_rune(set, *this, 0, &n);
+}
+
+isize String::rfind_any(Cutset const& set) const {
+	isize n;
+	if(cutset_has_byte(set, 0x80)){
+		/* Continuation bytes are members, so a match could start anywhere
+		 * before it: walk forward instead */
+		isize last = -1;
+		for(isize pos = cutset_find_rune(set, *this, 0, &n); pos >= 0; pos = cutset_find_rune(set, *this, pos + n, &n)){
+			last = pos;
+		}
+		return last;
+	}
+
+	/* Member bytes are ASCII or lead bytes, which always start a rune */
+	isize end = _length;
+	while(end > 0){
+		isize pos = cutset_rfind(set, _data, end, false);
+		if(pos < 0){ break; }
+		if(cutset_match(set, *this, pos, &n)){ return pos; }
+		end = pos;
+	}
+	return -1;
+}
+
+bool String::cut_any(Cutset const& set, String* before, String* after) const {
+	isize n;
+	isize pos = cutset_find_rune(set, *this, 0, &n);
+	if(pos < 0){
+		*before = *this;
+		*after = String{};
+		return false;
+	}
+	*before = String{ _data, pos };
+	*after = String{ &_data[pos + n], _length - (pos + n) };
+	return true;
+}
+
+//// Byte Search ///////////////////////////////////////////////////////////////
+/* The vector loops look at 64 bytes per iteration and only extract masks once
+ * something matched, then finish with one block overlapping the bytes already
+ * scanned instead of a scalar tail. Buffers under a block go byte by byte. */
+
+constexpr isize CSTR_MAX_LENGTH = isize((~u32(0)) >> 1);
+
+/* cstring_len() reads whole aligned blocks, which can go past the terminator
+ * but never into another page, so they can't fault. Address sanitizer would
+ * still report them. */
+#if defined(__GNUC__) || defined(__clang__)
+#define MEM_ALIGNED_OVERREAD __attribute__((no_sanitize_address))
+#elif defined(_MSC_VER)
+#define MEM_ALIGNED_OVERREAD __declspec(no_sanitize_address)
+#else
+#define MEM_ALIGNED_OVERREAD
+#endif
+
+/* Word with the top bit set in exactly the bytes of `x` that are 0 */
+static inline
+u64 mem_zero_bytes(u64 x){
+	const u64 low7 = 0x7f7f7f7f7f7f7f7full;
+	return ~(((x & low7) + low7) | x | low7);
+}
+
+static
+isize mem_find_byte_scalar(byte const* data, byte val, isize len){
+	const u64 pattern = 0x0101010101010101ull * val;
+	isize i = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		mem::copy_no_overlap(&x, &data[i], 8);
+		if(mem_zero_bytes(x ^ pattern) != 0){ break; }
+	}
+	for(; i < len; i += 1){
+		if(data[i] == val){ return i; }
+	}
+	return -1;
+}
+
+static
+isize mem_rfind_byte_scalar(byte const* data, byte val, isize len){
+	const u64 pattern = 0x0101010101010101ull * val;
+	isize i = len;
+	for(; i >= 8; i -= 8){
+		u64 x;
+		mem::copy_no_overlap(&x, &data[i - 8], 8);
+		if(mem_zero_bytes(x ^ pattern) != 0){ break; }
+	}
+	for(isize j = i - 1; j >= 0 && j >= i - 8; j -= 1){
+		if(data[j] == val){ return j; }
+	}
+	return -1;
+}
+
+/* Byte by byte so the load can't go through an intercepted memcpy, compilers
+ * turn it into a single read */
+MEM_ALIGNED_OVERREAD
+static inline
+u64 mem_load_word(byte const* p){
+	return u64(p[0]) | u64(p[1]) << 8 | u64(p[2]) << 16 | u64(p[3]) << 24 |
+		u64(p[4]) << 32 | u64(p[5]) << 40 | u64(p[6]) << 48 | u64(p[7]) << 56;
+}
+
+MEM_ALIGNED_OVERREAD
+static
+isize cstring_len_scalar(byte const* s){
+	isize i = 0;
+	for(; (uintptr(&s[i]) & 7) != 0; i += 1){
+		if(s[i] == 0){ return i; }
+	}
+	for(; i < CSTR_MAX_LENGTH; i += 8){
+		if(mem_zero_bytes(mem_load_word(&s[i])) != 0){ break; }
+	}
+	while(i < CSTR_MAX_LENGTH && s[i] != 0){
+		i += 1;
+	}
+	return i;
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static
+isize mem_find_byte_sse4(byte const* data, byte val, isize len){
+	const __m128i v = _mm_set1_epi8(char(val));
+	isize i = 0;
+	for(; i + 64 <= len; i += 64){
+		__m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i]), v);
+		__m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i + 16]), v);
+		__m128i c = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i + 32]), v);
+		__m128i d = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i + 48]), v);
+		if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0){ break; }
+	}
+	for(; i + 16 <= len; i += 16){
+		u32 hits = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i]), v)));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	if(i < len){
+		i = len - 16;
+		u32 hits = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i]), v)));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	return -1;
+}
+
+SIMD_TARGET("sse4.1")
+static
+isize mem_rfind_byte_sse4(byte const* data, byte val, isize len){
+	const __m128i v = _mm_set1_epi8(char(val));
+	isize i = len;
+	for(; i >= 64; i -= 64){
+		__m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 64]), v);
+		__m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 48]), v);
+		__m128i c = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 32]), v);
+		__m128i d = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 16]), v);
+		if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0){ break; }
+	}
+	for(; i >= 16; i -= 16){
+		u32 hits = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[i - 16]), v)));
+		if(hits != 0){ return i - 16 + simd_msb(hits); }
+	}
+	if(i > 0){
+		u32 hits = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i const*)&data[0]), v)));
+		if(hits != 0){ return simd_msb(hits); }
+	}
+	return -1;
+}
+
+MEM_ALIGNED_OVERREAD
+SIMD_TARGET("sse4.1")
+static
+isize cstring_len_sse4(byte const* s){
+	const __m128i zero = _mm_setzero_si128();
+	isize skew = isize(uintptr(s) & 15);
+	u32 hits = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((__m128i const*)(s - skew)), zero))) >> skew;
+	if(hits != 0){ return simd_ctz(hits); }
+	isize i = 16 - skew;
+	for(; i < CSTR_MAX_LENGTH; i += 16){
+		hits = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((__m128i const*)&s[i]), zero)));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	return i;
+}
+
+SIMD_TARGET("avx2")
+static
+isize mem_find_byte_avx2(byte const* data, byte val, isize len){
+	const __m256i v = _mm256_set1_epi8(char(val));
+	isize i = 0;
+	for(; i + 64 <= len; i += 64){
+		__m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i]), v);
+		__m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i + 32]), v);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0){ break; }
+	}
+	for(; i + 32 <= len; i += 32){
+		u32 hits = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i]), v)));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	if(i < len){
+		i = len - 32;
+		u32 hits = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i]), v)));
+		if(hits != 0){ return i + simd_ctz(hits); }
+	}
+	return -1;
+}
+
+SIMD_TARGET("avx2")
+static
+isize mem_rfind_byte_avx2(byte const* data, byte val, isize len){
+	const __m256i v = _mm256_set1_epi8(char(val));
+	isize i = len;
+	for(; i >= 64; i -= 64){
+		__m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i - 64]), v);
+		__m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i - 32]), v);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0){ break; }
+	}
+	for(; i >= 32; i -= 32){
+		u32 hits = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[i - 32]), v)));
+		if(hits != 0){ return i - 32 + simd_msb(hits); }
+	}
+	if(i > 0){
+		u32 hits = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const*)&data[0]), v)));
+		if(hits != 0){ return simd_msb(hits); }
+	}
+	return -1;
+}
+
+MEM_ALIGNED_OVERREAD
+SIMD_TARGET("avx2")
+static
+isize cstring_len_avx2(byte const* s){
+	const __m256i zero = _mm256_setzero_si256();
+	isize skew = isize(uintptr(s) & 31);
+	u32 hits = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)(s - skew)), zero))) >> skew;
+	if(hits != 0){ return simd_ctz(hits); }
+	isize i = 32 - skew;
+	/* Pairs of blocks are only page safe from a 64 byte boundary */
+	if((uintptr(&s[i]) & 32) != 0){
+		hits = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)&s[i]), zero)));
+		if(hits != 0){ return i + simd_ctz(hits); }
+		i += 32;
+	}
+	for(; i < CSTR_MAX_LENGTH; i += 64){
+		__m256i a = _mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)&s[i]), zero);
+		__m256i b = _mm256_cmpeq_epi8(_mm256_load_si256((__m256i const*)&s[i + 32]), zero);
+		if(_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0){
+			hits = u32(_mm256_movemask_epi8(a));
+			if(hits != 0){ return i + simd_ctz(hits); }
+			return i + 32 + simd_ctz(u32(_mm256_movemask_epi8(b)));
+		}
+	}
+	return i;
+}
+#endif
+
+namespace mem {
+isize find_byte(void const* p, byte val, isize nbytes){
+	byte const* data = (byte const*)p;
+#ifdef SIMD_X86
+	if(nbytes >= 16){
+		Simd_Level level = simd_level();
+		if(level == Simd_Level::AVX2 && nbytes >= 32){ return mem_find_byte_avx2(data, val, nbytes); }
+		if(level >= Simd_Level::SSE4){ return mem_find_byte_sse4(data, val, nbytes); }
+	}
+#endif
+	return mem_find_byte_scalar(data, val, nbytes);
+}
+
+isize rfind_byte(void const* p, byte val, isize nbytes){
+	byte const* data = (byte const*)p;
+#ifdef SIMD_X86
+	if(nbytes >= 16){
+		Simd_Level level = simd_level();
+		if(level == Simd_Level::AVX2 && nbytes >= 32){ return mem_rfind_byte_avx2(data, val, nbytes); }
+		if(level >= Simd_Level::SSE4){ return mem_rfind_byte_sse4(data, val, nbytes); }
+	}
+#endif
+	return mem_rfind_byte_scalar(data, val, nbytes);
+}
+
+isize find_any_of(void const* p, byte const* set, isize set_len, isize nbytes){
+	if(set_len == 1){ return find_byte(p, set[0], nbytes); }
+	/* Same lookup as a Cutset without runes, any byte in the bitmap stops */
+	Cutset bytes{};
+	for(isize i = 0; i < set_len; i += 1){
+		cutset_add_byte(bytes, set[i]);
+	}
+	isize i = cutset_find(bytes, (byte const*)p, nbytes, false);
+	return i < nbytes ? i : -1;
+}
+
+} /* Namespace mem */
+
+isize cstring_len(cstring cstr){
+	byte const* s = (byte const*)cstr;
+	isize len;
+#ifdef SIMD_X86
+	switch(simd_level()){
+		case Simd_Level::AVX2: len = cstring_len_avx2(s); break;
+		case Simd_Level::SSE4: len = cstring_len_sse4(s); break;
+		default: len = cstring_len_scalar(s); break;
+	}
+#else
+	len = cstring_len_scalar(s);
+#endif
+	return min(len, CSTR_MAX_LENGTH);
+}
+
+#undef MEM_ALIGNED_OVERREAD
+
+//// String Compare ////////////////////////////////////////////////////////////
+/* Everything goes through str_mismatch(), which compares a word or a vector
+ * block at a time and only looks at single bytes inside the block that
+ * differs. Short strings are compared with a couple of overlapping loads. */
+
+static inline
+u64 str_load_u64(byte const* p){
+	u64 x;
+	mem::copy_no_overlap(&x, p, 8);
+	return x;
+}
+
+static inline
+u32 str_load_u32(byte const* p){
+	u32 x;
+	mem::copy_no_overlap(&x, p, 4);
+	return x;
+}
+
+/* Equality of up to 16 bytes */
+static inline
+bool str_eq_short(byte const* a, byte const* b, isize n){
+	if(n >= 8){
+		return ((str_load_u64(a) ^ str_load_u64(b)) | (str_load_u64(&a[n - 8]) ^ str_load_u64(&b[n - 8]))) == 0;
+	}
+	if(n >= 4){
+		return ((str_load_u32(a) ^ str_load_u32(b)) | (str_load_u32(&a[n - 4]) ^ str_load_u32(&b[n - 4]))) == 0;
+	}
+	if(n > 0){
+		return a[0] == b[0] && a[n / 2] == b[n / 2] && a[n - 1] == b[n - 1];
+	}
+	return true;
+}
+
+static
+isize str_mismatch_scalar(byte const* a, byte const* b, isize n){
+	isize i = 0;
+	for(; i + 8 <= n; i += 8){
+		if(str_load_u64(&a[i]) != str_load_u64(&b[i])){ break; }
+	}
+	for(; i < n; i += 1){
+		if(a[i] != b[i]){ break; }
+	}
+	return i;
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static
+isize str_mismatch_sse4(byte const* a, byte const* b, isize n){
+	isize i = 0;
+	for(; i + 16 <= n; i += 16){
+		__m128i x = _mm_loadu_si128((__m128i const*)&a[i]);
+		__m128i y = _mm_loadu_si128((__m128i const*)&b[i]);
+		u32 same = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+		if(same != 0xffff){ return i + simd_ctz(~same); }
+	}
+	if(i < n){
+		/* Last block overlaps bytes already known to be equal */
+		i = n - 16;
+		__m128i x = _mm_loadu_si128((__m128i const*)&a[i]);
+		__m128i y = _mm_loadu_si128((__m128i const*)&b[i]);
+		u32 same = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+		if(same != 0xffff){ return i + simd_ctz(~same); }
+	}
+	return n;
+}
+
+SIMD_TARGET("avx2")
+static
+isize str_mismatch_avx2(byte const* a, byte const* b, isize n){
+	isize i = 0;
+	for(; i + 32 <= n; i += 32){
+		__m256i x = _mm256_loadu_si256((__m256i const*)&a[i]);
+		__m256i y = _mm256_loadu_si256((__m256i const*)&b[i]);
+		u32 same = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+		if(same != 0xffffffffu){ return i + simd_ctz(~same); }
+	}
+	if(i < n){
+		i = n - 32;
+		__m256i x = _mm256_loadu_si256((__m256i const*)&a[i]);
+		__m256i y = _mm256_loadu_si256((__m256i const*)&b[i]);
+		u32 same = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+		if(same != 0xffffffffu){ return i + simd_ctz(~same); }
+	}
+	return n;
+}
+#endif
+
+/* Is the byte at `i` a continuation byte? The end of the string is not */
+static inline
+bool str_continues(String s, isize i){
+	return i < s._length && (s._data[i] & 0xc0) == 0x80;
+}
+
+/* Offset of the first byte that differs in the first `n` bytes, or `n` */
+static inline
+isize str_mismatch(byte const* a, byte const* b, isize n){
+	if(a == b){ return n; }
+#ifdef SIMD_X86
+	if(n >= 16){
+		Simd_Level level = simd_level();
+		if(level == Simd_Level::AVX2 && n >= 32){ return str_mismatch_avx2(a, b, n); }
+		if(level >= Simd_Level::SSE4){ return str_mismatch_sse4(a, b, n); }
+	}
+#endif
+	return str_mismatch_scalar(a, b, n);
+}
+
+bool String::eq(String other) const {
+	if(_length != other._length){ return false; }
+	if(_length <= 16){ return str_eq_short(_data, other._data, _length); }
+	return str_mismatch(_data, other._data, _length) == _length;
+}
+
+isize String::common_prefix_len(String other) const {
+	return str_mismatch(_data, other._data, min(_length, other._length));
+}
+
+i32 String::compare(String other) const {
+	isize n = min(_length, other._length);
+	isize i = str_mismatch(_data, other._data, n);
+	if(i < n){
+		return _data[i] < other._data[i] ? -1 : 1;
+	}
+	return (_length > other._length) - (_length < other._length);
+}
+
+i32 String::compare_runes(String other) const {
+	isize n = min(_length, other._length);
+	isize i = str_mismatch(_data, other._data, n);
+	if(i == n && _length == other._length){ return 0; }
+	/* Invalid bytes are skipped one at a time, so any byte that isn't a
+	 * continuation byte starts a rune. Decoding resumes from the closest such
+	 * byte (in both strings) before the difference. Without one in the 3
+	 * bytes before it, no rune can span the difference and it starts one.
+	 * Even a byte prefix needs this, its last rune may be cut short. */
+	isize start = i;
+	while(start > 0 && start > i - 3 && (str_continues(*this, start) || str_continues(other, start))){
+		start -= 1;
+	}
+	if(start > 0 && (str_continues(*this, start) || str_continues(other, start))){
+		start = i;
+	}
+	utf8::Iterator ia = String::from_pointer(&_data[start], _length - start).iterator();
+	utf8::Iterator ib = String::from_pointer(&other._data[start], other._length - start).iterator();
+	for(;;){
+		rune ra, rb;
+		i8 la, lb;
+		bool more_a = ia.next(&ra, &la);
+		bool more_b = ib.next(&rb, &lb);
+		if(!more_a || !more_b){ return i32(more_a) - i32(more_b); }
+		if(ra != rb){ return ra < rb ? -1 : 1; }
+	}
+}
+
+//// String Split //////////////////////////////////////////////////////////////
+/* Space, \t, \n, \v, \f and \r in the Cutset bitmap layout */
+static constexpr Cutset ascii_whitespace = {
+	{ 1 << 2, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1 },
+	nullptr,
+	0,
+	mem::Allocator{},
+};
+
+String_Splitter String::split(byte delim) const {
+	String_Splitter it = {};
+	it._rest = *this;
+	it._kind = Split_Kind::Byte;
+	it._byte_delim = delim;
+	return it;
+}
+
+String_Splitter String::split(String delim) const {
+	String_Splitter it = {};
+	it._rest = *this;
+	it._kind = Split_Kind::String;
+	it._delim = delim;
+	return it;
+}
+
+String_Splitter String::split_any(Cutset const& set) const {
+	String_Splitter it = {};
+	it._rest = *this;
+	it._kind = Split_Kind::Cutset;
+	it._cutset = &set;
+	return it;
+}
+
+String_Splitter String::fields() const {
+	String_Splitter it = {};
+	it._rest = *this;
+	it._kind = Split_Kind::Fields;
+	return it;
+}
+
+bool String_Splitter::next(String* token){
+	if(_done){ return false; }
+	String rest = _rest;
+
+	if(_kind == Split_Kind::Fields){
+		isize start = cutset_find(ascii_whitespace, rest._data, rest._length, true);
+		if(start >= rest._length){
+			_done = true;
+			return false;
+		}
+		isize end = start + cutset_find(ascii_whitespace, &rest._data[start], rest._length - start, false);
+		*token = String{ &rest._data[start], end - start };
+		_rest = String{ &rest._data[end], rest._length - end };
+		return true;
+	}
+
+	/* Position and length of the next delimiter */
+	isize at = -1, n = 0;
+	switch(_kind){
+		case Split_Kind::Byte:
+			at = rest.find(String{ &_byte_delim, 1 });
+			n = 1;
+		break;
+		case Split_Kind::String:
+			if(_delim._length > 0){
+				at = rest.find(_delim);
+				n = _delim._length;
+			}
+		break;
+		case Split_Kind::Cutset:
+			at = cutset_find_rune(*_cutset, rest, 0, &n);
+		break;
+		default: break;
+	}
+
+	if(at < 0){
+		*token = rest;
+		_rest = String{};
+		_done = true;
+		return true;
+	}
+	*token = String{ rest._data, at };
+	_rest = String{ &rest._data[at + n], rest._length - (at + n) };
+	return true;
+}
+
+//// Case Folding //////////////////////////////////////////////////////////////
+/* Case mappings are stored as deltas in a two-level table: the upper bits of a
+ * rune pick a block of 64 entries, each entry indexes into a small table of
+ * (fold, lowercase) delta pairs. Most blocks have no mappings and share the
+ * all-zero block. */
+namespace utf8 {
+/* Generated by case-tables.py (Unicode 14.0.0), do not edit */
+constexpr rune CASE_LIMIT = 0x1e922;
+constexpr int CASE_BLOCK_SHIFT = 6;
+
+constexpr u8 case_stage1[1957] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0, 0, 10, 11, 12, 13, 14, 15, 16, 17, 18, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 19, 20, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 21, 22, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23, 0, 0, 0, 0, 0, 24, 24, 25, 24, 26, 27, 28, 29,
+	0, 0, 0, 0, 30, 31, 32, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 33, 34, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 35, 36, 24, 37, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 38, 39, 0, 40, 41, 42, 43,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 44, 45, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 46, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 47, 0, 48, 49, 0, 50, 51, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 52, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 53, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 54, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 55,
+};
+
+constexpr u8 case_stage2[3584] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 100, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 72, 72, 72, 72, 72, 72, 72, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 61, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0, 65, 0, 65, 0, 65,
+	0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 40, 65, 0, 65, 0, 65, 0, 34,
+	0, 93, 65, 0, 65, 0, 90, 65, 0, 89, 89, 65, 0, 0, 83, 87, 88, 65, 0, 89, 91, 0, 94, 92, 65, 0, 0, 0, 94, 95, 0, 96,
+	65, 0, 65, 0, 65, 0, 98, 65, 0, 98, 0, 0, 65, 0, 98, 65, 0, 97, 97, 65, 0, 65, 0, 99, 65, 0, 0, 0, 65, 0, 0, 0,
+	0, 0, 0, 0, 66, 65, 0, 66, 65, 0, 66, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 66, 65, 0, 65, 0, 43, 49, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	37, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 104, 65, 0, 36, 103, 0,
+	0, 65, 0, 35, 81, 82, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 85, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 86,
+	0, 0, 0, 0, 0, 0, 75, 0, 74, 74, 74, 0, 80, 0, 79, 79, 0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	72, 72, 0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 64, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 67, 53, 54, 0, 0, 0, 56, 55, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 50, 52, 0, 0, 47, 46, 0, 65, 0, 60, 65, 0, 0, 37, 37, 37,
+	84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 84, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	68, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78,
+	78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102, 102,
+	102, 102, 102, 102, 102, 102, 0, 102, 0, 0, 0, 0, 0, 102, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 62, 62, 62, 62, 62, 62, 0, 0, 59, 59, 59, 59, 59, 59, 0, 0,
+	25, 26, 27, 29, 29, 28, 30, 31, 105, 0, 0, 0, 0, 0, 0, 0, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33,
+	33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 0, 0, 33, 33, 33,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 48, 0, 0, 22, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 58, 0, 58, 0, 58, 0, 58,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 58, 58, 58, 58, 58, 58, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 45, 45, 57, 0, 24, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 44, 44, 44, 44, 57, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 42, 42, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 58, 58, 41, 41, 60, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 38, 38, 39, 39, 57, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 23, 0, 0, 0, 20, 21, 0, 0, 0, 0, 0, 0, 71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 69, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70,
+	70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 70, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78,
+	78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 78, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 18, 32, 19, 0, 0, 65, 0, 65, 0, 65, 0, 16, 17, 14, 15, 0, 65, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 13, 13,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 65, 0, 12, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 0, 0, 0, 65, 0, 7, 0, 0, 65, 0, 65, 0, 0, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 3, 1, 2, 5, 3, 0, 9, 6, 8, 101, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0, 65, 0,
+	65, 0, 65, 0, 51, 4, 11, 65, 0, 65, 0, 0, 0, 0, 0, 0, 65, 0, 0, 0, 0, 0, 65, 0, 65, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+	10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+	10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 0, 0, 0, 0, 0,
+	77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+	77, 77, 77, 77, 77, 77, 77, 77, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77,
+	77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 77, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 0, 76, 76, 76, 76,
+	76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 76, 0, 76, 76, 76, 76, 76, 76, 76, 0, 76, 76, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80,
+	80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73, 73,
+	73, 73, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+/* Fold and lowercase deltas */
+constexpr i32 case_deltas[106][2] = {
+	{0, 0}, {-42319, -42319}, {-42315, -42315}, {-42308, -42308}, {-42307, -42307}, {-42305, -42305},
+	{-42282, -42282}, {-42280, -42280}, {-42261, -42261}, {-42258, -42258}, {-38864, 0}, {-35384, -35384},
+	{-35332, -35332}, {-10815, -10815}, {-10783, -10783}, {-10782, -10782}, {-10780, -10780}, {-10749, -10749},
+	{-10743, -10743}, {-10727, -10727}, {-8383, -8383}, {-8262, -8262}, {-7615, -7615}, {-7517, -7517},
+	{-7173, 0}, {-6222, 0}, {-6221, 0}, {-6212, 0}, {-6211, 0}, {-6210, 0},
+	{-6204, 0}, {-6180, 0}, {-3814, -3814}, {-3008, -3008}, {-268, 0}, {-195, -195},
+	{-163, -163}, {-130, -130}, {-128, -128}, {-126, -126}, {-121, -121}, {-112, -112},
+	{-100, -100}, {-97, -97}, {-86, -86}, {-74, -74}, {-64, 0}, {-60, -60},
+	{-58, 0}, {-56, -56}, {-54, 0}, {-48, -48}, {-48, 0}, {-30, 0},
+	{-25, 0}, {-22, 0}, {-15, 0}, {-9, -9}, {-8, -8}, {-8, 0},
+	{-7, -7}, {0, -199}, {0, 8}, {0, 38864}, {1, 0}, {1, 1},
+	{2, 2}, {8, 8}, {15, 15}, {16, 16}, {26, 26}, {28, 28},
+	{32, 32}, {34, 34}, {37, 37}, {38, 38}, {39, 39}, {40, 40},
+	{48, 48}, {63, 63}, {64, 64}, {69, 69}, {71, 71}, {79, 79},
+	{80, 80}, {116, 0}, {116, 116}, {202, 202}, {203, 203}, {205, 205},
+	{206, 206}, {207, 207}, {209, 209}, {210, 210}, {211, 211}, {213, 213},
+	{214, 214}, {217, 217}, {218, 218}, {219, 219}, {775, 0}, {928, 928},
+	{7264, 7264}, {10792, 10792}, {10795, 10795}, {35267, 0},
+};
+
+constexpr rune CASE_BLOCK_MASK = (1 << CASE_BLOCK_SHIFT) - 1;
+
+static inline
+u8 case_index(rune r){
+	if(u32(r) >= u32(CASE_LIMIT)){ return 0; }
+	return case_stage2[(case_stage1[r >> CASE_BLOCK_SHIFT] << CASE_BLOCK_SHIFT) | (r & CASE_BLOCK_MASK)];
+}
+
+rune fold(rune r){
+	return r + case_deltas[case_index(r)][0];
+}
+
+rune to_lower(rune r){
+	return r + case_deltas[case_index(r)][1];
+}
+
+/* ASCII letters fold (and lowercase) to ASCII, the only other runes that fold
+ * into ASCII are U+017F and U+212A, which are multibyte */
+static inline
+byte ascii_lower(byte b){
+	return b | (u8(b - 'A') < 26 ? 0x20 : 0);
+}
+
+#ifdef SIMD_X86
+SIMD_TARGET("sse4.1")
+static inline
+__m128i ascii_lower_sse4(__m128i v){
+	__m128i upper = _mm_and_si128(
+		_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+		_mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+	return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+/* Lowercase the leading 16 byte blocks of ASCII into `out`, returns the bytes
+ * done */
+SIMD_TARGET("sse4.1")
+static
+isize ascii_lower_blocks_sse4(byte* out, byte const* data, isize len){
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i v = _mm_loadu_si128((__m128i const*)&data[i]);
+		if(_mm_movemask_epi8(v) != 0){ break; }
+		_mm_storeu_si128((__m128i*)&out[i], ascii_lower_sse4(v));
+	}
+	return i;
+}
+
+/* Compare the leading 16 byte blocks where both sides are ASCII, returns the
+ * bytes that matched. A mismatch in such a block sets `differ`. */
+SIMD_TARGET("sse4.1")
+static
+isize ascii_eq_fold_sse4(byte const* a, byte const* b, isize len, bool* differ){
+	isize i = 0;
+	for(; i + 16 <= len; i += 16){
+		__m128i x = _mm_loadu_si128((__m128i const*)&a[i]);
+		__m128i y = _mm_loadu_si128((__m128i const*)&b[i]);
+		if(_mm_movemask_epi8(_mm_or_si128(x, y)) != 0){ break; }
+		__m128i eq = _mm_cmpeq_epi8(ascii_lower_sse4(x), ascii_lower_sse4(y));
+		if(_mm_movemask_epi8(eq) != 0xffff){
+			*differ = true;
+			break;
+		}
+	}
+	return i;
+}
+#endif
+
+/* Hashes the folded UTF-8 in 32 byte stripes over 4 lanes (the same rounds as
+ * xxHash64), the input is folded through a small buffer first */
+constexpr u64 FOLD_HASH_P1 = 0x9e3779b185ebca87ull;
+constexpr u64 FOLD_HASH_P2 = 0xc2b2ae3d27d4eb4full;
+constexpr u64 FOLD_HASH_P3 = 0x165667b19e3779f9ull;
+constexpr isize FOLD_HASH_BUF = 256;
+
+static inline
+u64 fold_hash_rotl(u64 x, int r){
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline
+u64 fold_hash_round(u64 acc, u64 w){
+	return fold_hash_rotl(acc + w * FOLD_HASH_P2, 31) * FOLD_HASH_P1;
+}
+
+struct Fold_Hasher {
+	u64 lanes[4] = {FOLD_HASH_P1 + FOLD_HASH_P2, FOLD_HASH_P2, 0, u64(0) - FOLD_HASH_P1};
+	u64 total = 0;
+	byte buf[FOLD_HASH_BUF + 16];
+	isize fill = 0;
+
+	/* Hash every whole stripe in the buffer, keeping the rest */
+	void flush(){
+		isize i = 0;
+		for(; i + 32 <= fill; i += 32){
+			for(int k = 0; k < 4; k += 1){
+				u64 w;
+				mem::copy(&w, &buf[i + k * 8], 8);
+				lanes[k] = fold_hash_round(lanes[k], w);
+			}
+		}
+		total += i;
+		mem::copy(buf, &buf[i], fill - i);
+		fill -= i;
+	}
+
+	u64 finish(){
+		u64 x = fold_hash_rotl(lanes[0], 1) + fold_hash_rotl(lanes[1], 7) +
+			fold_hash_rotl(lanes[2], 12) + fold_hash_rotl(lanes[3], 18);
+		x += total + fill;
+		/* Leftover bytes, zero padded, go through a single lane */
+		mem::set(&buf[fill], 0, 8);
+		for(isize i = 0; i < fill; i += 8){
+			u64 w;
+			mem::copy(&w, &buf[i], 8);
+			x = fold_hash_rotl(x ^ fold_hash_round(0, w), 27) * FOLD_HASH_P1 + FOLD_HASH_P3;
+		}
+		x ^= x >> 33;
+		x *= FOLD_HASH_P2;
+		x ^= x >> 29;
+		x *= FOLD_HASH_P3;
+		x ^= x >> 32;
+		return x;
+	}
+};
+} /* Namespace utf8 */
+
+bool String::eq_fold(String other) const {
+	using namespace utf8;
+	byte const* a = _data;
+	byte const* b = other._data;
+	isize a_len = _length, b_len = other._length;
+	isize i = 0, j = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+	isize retry = 0;
+#endif
+
+	while(i < a_len && j < b_len){
+		byte x = a[i], y = b[j];
+		if((x | y) < 0x80){
+#ifdef SIMD_X86
+			/* A block that wasn't all ASCII is not tried again */
+			if(sse4 && i >= retry){
+				bool differ = false;
+				isize done = ascii_eq_fold_sse4(&a[i], &b[j], min(a_len - i, b_len - j), &differ);
+				if(differ){ return false; }
+				i += done;
+				j += done;
+				retry = i + 16;
+				continue;
+			}
+#endif
+			if(ascii_lower(x) != ascii_lower(y)){ return false; }
+			i += 1;
+			j += 1;
+			continue;
+		}
+
+		Decode_Result ra = decode(Slice<byte>::from_pointer((byte*)&a[i], a_len - i));
+		Decode_Result rb = decode(Slice<byte>::from_pointer((byte*)&b[j], b_len - j));
+		/* Invalid bytes only match themselves */
+		if(ra.len == 0 || rb.len == 0){
+			if(ra.len != rb.len || x != y){ return false; }
+			i += 1;
+			j += 1;
+			continue;
+		}
+		if(fold(ra.codepoint) != fold(rb.codepoint)){ return false; }
+		i += ra.len;
+		j += rb.len;
+	}
+
+	return i == a_len && j == b_len;
+}
+
+u64 String::hash_fold() const {
+	using namespace utf8;
+	Fold_Hasher h;
+	isize i = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+	isize retry = 0;
+#endif
+
+	while(i < _length){
+		byte b = _data[i];
+		if(b < 0x80){
+#ifdef SIMD_X86
+			if(sse4 && i >= retry){
+				isize room = FOLD_HASH_BUF - h.fill;
+				isize done = ascii_lower_blocks_sse4(&h.buf[h.fill], &_data[i], min(_length - i, room));
+				i += done;
+				h.fill += done;
+				retry = i + 16;
+			}
+#endif
+			if(i < _length && _data[i] < 0x80){
+				h.buf[h.fill++] = ascii_lower(_data[i]);
+				i += 1;
+			}
+		}
+		else {
+			Decode_Result res = decode(Slice<byte>::from_pointer((byte*)&_data[i], _length - i));
+			if(res.len == 0){
+				h.buf[h.fill++] = b;
+				i += 1;
+			}
+			else {
+				rune r = fold(res.codepoint);
+				utf8_put(&h.buf[h.fill], r);
+				h.fill += utf8_rune_size(r);
+				i += res.len;
+			}
+		}
+		if(h.fill > FOLD_HASH_BUF - 16){
+			h.flush();
+		}
+	}
+
+	h.flush();
+	return h.finish();
+}
+
+isize String::to_lower_size() const {
+	using namespace utf8;
+	isize size = 0;
+	for(isize i = 0; i < _length;){
+		if(_data[i] < 0x80){
+			size += 1;
+			i += 1;
+			continue;
+		}
+		Decode_Result res = decode(Slice<byte>::from_pointer((byte*)&_data[i], _length - i));
+		size += res.len == 0 ? 1 : utf8_rune_size(utf8::to_lower(res.codepoint));
+		i += res.len == 0 ? 1 : res.len;
+	}
+	return size;
+}
+
+isize String::to_lower(Slice<byte> out) const {
+	using namespace utf8;
+	byte* dst = out.raw_data();
+	isize cap = out.empty() ? 0 : out.size();
+	isize i = 0, n = 0;
+#ifdef SIMD_X86
+	bool sse4 = simd_level() >= Simd_Level::SSE4;
+	isize retry = 0;
+#endif
+
+	while(i < _length){
+		byte b = _data[i];
+		if(b < 0x80){
+#ifdef SIMD_X86
+			if(sse4 && i >= retry){
+				isize done = ascii_lower_blocks_sse4(&dst[n], &_data[i], min(_length - i, cap - n));
+				i += done;
+				n += done;
+				retry = i + 16;
+				continue;
+			}
+#endif
+			if(n >= cap){ break; }
+			dst[n++] = ascii_lower(b);
+			i += 1;
+			continue;
+		}
+
+		/* Invalid bytes are kept as they are */
+		Decode_Result res = decode(Slice<byte>::from_pointer((byte*)&_data[i], _length - i));
+		if(res.len == 0){
+			if(n >= cap){ break; }
+			dst[n++] = b;
+			i += 1;
+			continue;
+		}
+		rune r = utf8::to_lower(res.codepoint);
+		isize size = utf8_rune_size(r);
+		if(n + size > cap){ break; }
+		utf8_put(&dst[n], r);
+		n += size;
+		i += res.len;
+	}
+
+	return n;
+}
+
+//// Numbers ///////////////////////////////////////////////////////////////////
+namespace fmt {
+/* Generated by pow10-table.py, do not edit. Significands of 10^k for k in
+ * [POW10_MIN, POW10_MAX], rounded down to 128 bits as {high, low} */
+constexpr int POW10_MIN = -342;
+constexpr int POW10_MAX = 324;
+constexpr u64 pow10_table[667][2] = {
+	{0xeef453d6923bd65a, 0x113faa2906a13b3f}, {0x9558b4661b6565f8, 0x4ac7ca59a424c507},
+	{0xbaaee17fa23ebf76, 0x5d79bcf00d2df649}, {0xe95a99df8ace6f53, 0xf4d82c2c107973dc},
+	{0x91d8a02bb6c10594, 0x79071b9b8a4be869}, {0xb64ec836a47146f9, 0x9748e2826cdee284},
+	{0xe3e27a444d8d98b7, 0xfd1b1b2308169b25}, {0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7},
+	{0xb208ef855c969f4f, 0xbdbd2d335e51a935}, {0xde8b2b66b3bc4723, 0xad2c788035e61382},
+	{0x8b16fb203055ac76, 0x4c3bcb5021afcc31}, {0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d},
+	{0xd953e8624b85dd78, 0xd71d6dad34a2af0d}, {0x87d4713d6f33aa6b, 0x8672648c40e5ad68},
+	{0xa9c98d8ccb009506, 0x680efdaf511f18c2}, {0xd43bf0effdc0ba48, 0x0212bd1b2566def2},
+	{0x84a57695fe98746d, 0x014bb630f7604b57}, {0xa5ced43b7e3e9188, 0x419ea3bd35385e2d},
+	{0xcf42894a5dce35ea, 0x52064cac828675b9}, {0x818995ce7aa0e1b2, 0x7343efebd1940993},
+	{0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8}, {0xca66fa129f9b60a6, 0xd41a26e077774ef6},
+	{0xfd00b897478238d0, 0x8920b098955522b4}, {0x9e20735e8cb16382, 0x55b46e5f5d5535b0},
+	{0xc5a890362fddbc62, 0xeb2189f734aa831d}, {0xf712b443bbd52b7b, 0xa5e9ec7501d523e4},
+	{0x9a6bb0aa55653b2d, 0x47b233c92125366e}, {0xc1069cd4eabe89f8, 0x999ec0bb696e840a},
+	{0xf148440a256e2c76, 0xc00670ea43ca250d}, {0x96cd2a865764dbca, 0x380406926a5e5728},
+	{0xbc807527ed3e12bc, 0xc605083704f5ecf2}, {0xeba09271e88d976b, 0xf7864a44c633682e},
+	{0x93445b8731587ea3, 0x7ab3ee6afbe0211d}, {0xb8157268fdae9e4c, 0x5960ea05bad82964},
+	{0xe61acf033d1a45df, 0x6fb92487298e33bd}, {0x8fd0c16206306bab, 0xa5d3b6d479f8e056},
+	{0xb3c4f1ba87bc8696, 0x8f48a4899877186c}, {0xe0b62e2929aba83c, 0x331acdabfe94de87},
+	{0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14}, {0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9},
+	{0xdb71e91432b1a24a, 0xc9e82cd9f69d6150}, {0x892731ac9faf056e, 0xbe311c083a225cd2},
+	{0xab70fe17c79ac6ca, 0x6dbd630a48aaf406}, {0xd64d3d9db981787d, 0x092cbbccdad5b108},
+	{0x85f0468293f0eb4e, 0x25bbf56008c58ea5}, {0xa76c582338ed2621, 0xaf2af2b80af6f24e},
+	{0xd1476e2c07286faa, 0x1af5af660db4aee1}, {0x82cca4db847945ca, 0x50d98d9fc890ed4d},
+	{0xa37fce126597973c, 0xe50ff107bab528a0}, {0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8},
+	{0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a}, {0x9faacf3df73609b1, 0x77b191618c54e9ac},
+	{0xc795830d75038c1d, 0xd59df5b9ef6a2417}, {0xf97ae3d0d2446f25, 0x4b0573286b44ad1d},
+	{0x9becce62836ac577, 0x4ee367f9430aec32}, {0xc2e801fb244576d5, 0x229c41f793cda73f},
+	{0xf3a20279ed56d48a, 0x6b43527578c1110f}, {0x9845418c345644d6, 0x830a13896b78aaa9},
+	{0xbe5691ef416bd60c, 0x23cc986bc656d553}, {0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8},
+	{0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9}, {0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53},
+	{0xe858ad248f5c22c9, 0xd1b3400f8f9cff68}, {0x91376c36d99995be, 0x23100809b9c21fa1},
+	{0xb58547448ffffb2d, 0xabd40a0c2832a78a}, {0xe2e69915b3fff9f9, 0x16c90c8f323f516c},
+	{0x8dd01fad907ffc3b, 0xae3da7d97f6792e3}, {0xb1442798f49ffb4a, 0x99cd11cfdf41779c},
+	{0xdd95317f31c7fa1d, 0x40405643d711d583}, {0x8a7d3eef7f1cfc52, 0x482835ea666b2572},
+	{0xad1c8eab5ee43b66, 0xda3243650005eecf}, {0xd863b256369d4a40, 0x90bed43e40076a82},
+	{0x873e4f75e2224e68, 0x5a7744a6e804a291}, {0xa90de3535aaae202, 0x711515d0a205cb36},
+	{0xd3515c2831559a83, 0x0d5a5b44ca873e03}, {0x8412d9991ed58091, 0xe858790afe9486c2},
+	{0xa5178fff668ae0b6, 0x626e974dbe39a872}, {0xce5d73ff402d98e3, 0xfb0a3d212dc8128f},
+	{0x80fa687f881c7f8e, 0x7ce66634bc9d0b99}, {0xa139029f6a239f72, 0x1c1fffc1ebc44e80},
+	{0xc987434744ac874e, 0xa327ffb266b56220}, {0xfbe9141915d7a922, 0x4bf1ff9f0062baa8},
+	{0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9}, {0xc4ce17b399107c22, 0xcb550fb4384d21d3},
+	{0xf6019da07f549b2b, 0x7e2a53a146606a48}, {0x99c102844f94e0fb, 0x2eda7444cbfc426d},
+	{0xc0314325637a1939, 0xfa911155fefb5308}, {0xf03d93eebc589f88, 0x793555ab7eba27ca},
+	{0x96267c7535b763b5, 0x4bc1558b2f3458de}, {0xbbb01b9283253ca2, 0x9eb1aaedfb016f16},
+	{0xea9c227723ee8bcb, 0x465e15a979c1cadc}, {0x92a1958a7675175f, 0x0bfacd89ec191ec9},
+	{0xb749faed14125d36, 0xcef980ec671f667b}, {0xe51c79a85916f484, 0x82b7e12780e7401a},
+	{0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810}, {0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15},
+	{0xdfbdcece67006ac9, 0x67a791e093e1d49a}, {0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0},
+	{0xaecc49914078536d, 0x58fae9f773886e18}, {0xda7f5bf590966848, 0xaf39a475506a899e},
+	{0x888f99797a5e012d, 0x6d8406c952429603}, {0xaab37fd7d8f58178, 0xc8e5087ba6d33b83},
+	{0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64}, {0x855c3be0a17fcd26, 0x5cf2eea09a55067f},
+	{0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e}, {0xd0601d8efc57b08b, 0xf13b94daf124da26},
+	{0x823c12795db6ce57, 0x76c53d08d6b70858}, {0xa2cb1717b52481ed, 0x54768c4b0c64ca6e},
+	{0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09}, {0xfe5d54150b090b02, 0xd3f93b35435d7c4c},
+	{0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf}, {0xc6b8e9b0709f109a, 0x359ab6419ca1091b},
+	{0xf867241c8cc6d4c0, 0xc30163d203c94b62}, {0x9b407691d7fc44f8, 0x79e0de63425dcf1d},
+	{0xc21094364dfb5636, 0x985915fc12f542e4}, {0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d},
+	{0x979cf3ca6cec5b5a, 0xa705992ceecf9c42}, {0xbd8430bd08277231, 0x50c6ff782a838353},
+	{0xece53cec4a314ebd, 0xa4f8bf5635246428}, {0x940f4613ae5ed136, 0x871b7795e136be99},
+	{0xb913179899f68584, 0x28e2557b59846e3f}, {0xe757dd7ec07426e5, 0x331aeada2fe589cf},
+	{0x9096ea6f3848984f, 0x3ff0d2c85def7621}, {0xb4bca50b065abe63, 0x0fed077a756b53a9},
+	{0xe1ebce4dc7f16dfb, 0xd3e8495912c62894}, {0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c},
+	{0xb080392cc4349dec, 0xbd8d794d96aacfb3}, {0xdca04777f541c567, 0xecf0d7a0fc5583a0},
+	{0x89e42caaf9491b60, 0xf41686c49db57244}, {0xac5d37d5b79b6239, 0x311c2875c522ced5},
+	{0xd77485cb25823ac7, 0x7d633293366b828b}, {0x86a8d39ef77164bc, 0xae5dff9c02033197},
+	{0xa8530886b54dbdeb, 0xd9f57f830283fdfc}, {0xd267caa862a12d66, 0xd072df63c324fd7b},
+	{0x8380dea93da4bc60, 0x4247cb9e59f71e6d}, {0xa46116538d0deb78, 0x52d9be85f074e608},
+	{0xcd795be870516656, 0x67902e276c921f8b}, {0x806bd9714632dff6, 0x00ba1cd8a3db53b6},
+	{0xa086cfcd97bf97f3, 0x80e8a40eccd228a4}, {0xc8a883c0fdaf7df0, 0x6122cd128006b2cd},
+	{0xfad2a4b13d1b5d6c, 0x796b805720085f81}, {0x9cc3a6eec6311a63, 0xcbe3303674053bb0},
+	{0xc3f490aa77bd60fc, 0xbedbfc4411068a9c}, {0xf4f1b4d515acb93b, 0xee92fb5515482d44},
+	{0x991711052d8bf3c5, 0x751bdd152d4d1c4a}, {0xbf5cd54678eef0b6, 0xd262d45a78a0635d},
+	{0xef340a98172aace4, 0x86fb897116c87c34}, {0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0},
+	{0xbae0a846d2195712, 0x8974836059cca109}, {0xe998d258869facd7, 0x2bd1a438703fc94b},
+	{0x91ff83775423cc06, 0x7b6306a34627ddcf}, {0xb67f6455292cbf08, 0x1a3bc84c17b1d542},
+	{0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93}, {0x8e938662882af53e, 0x547eb47b7282ee9c},
+	{0xb23867fb2a35b28d, 0xe99e619a4f23aa43}, {0xdec681f9f4c31f31, 0x6405fa00e2ec94d4},
+	{0x8b3c113c38f9f37e, 0xde83bc408dd3dd04}, {0xae0b158b4738705e, 0x9624ab50b148d445},
+	{0xd98ddaee19068c76, 0x3badd624dd9b0957}, {0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6},
+	{0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c}, {0xd47487cc8470652b, 0x7647c3200069671f},
+	{0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073}, {0xa5fb0a17c777cf09, 0xf468107100525890},
+	{0xcf79cc9db955c2cc, 0x7182148d4066eeb4}, {0x81ac1fe293d599bf, 0xc6f14cd848405530},
+	{0xa21727db38cb002f, 0xb8ada00e5a506a7c}, {0xca9cf1d206fdc03b, 0xa6d90811f0e4851c},
+	{0xfd442e4688bd304a, 0x908f4a166d1da663}, {0x9e4a9cec15763e2e, 0x9a598e4e043287fe},
+	{0xc5dd44271ad3cdba, 0x40eff1e1853f29fd}, {0xf7549530e188c128, 0xd12bee59e68ef47c},
+	{0x9a94dd3e8cf578b9, 0x82bb74f8301958ce}, {0xc13a148e3032d6e7, 0xe36a52363c1faf01},
+	{0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1}, {0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9},
+	{0xbcb2b812db11a5de, 0x7415d448f6b6f0e7}, {0xebdf661791d60f56, 0x111b495b3464ad21},
+	{0x936b9fcebb25c995, 0xcab10dd900beec34}, {0xb84687c269ef3bfb, 0x3d5d514f40eea742},
+	{0xe65829b3046b0afa, 0x0cb4a5a3112a5112}, {0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab},
+	{0xb3f4e093db73a093, 0x59ed216765690f56}, {0xe0f218b8d25088b8, 0x306869c13ec3532c},
+	{0x8c974f7383725573, 0x1e414218c73a13fb}, {0xafbd2350644eeacf, 0xe5d1929ef90898fa},
+	{0xdbac6c247d62a583, 0xdf45f746b74abf39}, {0x894bc396ce5da772, 0x6b8bba8c328eb783},
+	{0xab9eb47c81f5114f, 0x066ea92f3f326564}, {0xd686619ba27255a2, 0xc80a537b0efefebd},
+	{0x8613fd0145877585, 0xbd06742ce95f5f36}, {0xa798fc4196e952e7, 0x2c48113823b73704},
+	{0xd17f3b51fca3a7a0, 0xf75a15862ca504c5}, {0x82ef85133de648c4, 0x9a984d73dbe722fb},
+	{0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba}, {0xcc963fee10b7d1b3, 0x318df905079926a8},
+	{0xffbbcfe994e5c61f, 0xfdf17746497f7052}, {0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633},
+	{0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0}, {0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0},
+	{0x9c1661a651213e2d, 0x06bea10ca65c084e}, {0xc31bfa0fe5698db8, 0x486e494fcff30a62},
+	{0xf3e2f893dec3f126, 0x5a89dba3c3efccfa}, {0x986ddb5c6b3a76b7, 0xf89629465a75e01c},
+	{0xbe89523386091465, 0xf6bbb397f1135823}, {0xee2ba6c0678b597f, 0x746aa07ded582e2c},
+	{0x94db483840b717ef, 0xa8c2a44eb4571cdc}, {0xba121a4650e4ddeb, 0x92f34d62616ce413},
+	{0xe896a0d7e51e1566, 0x77b020baf9c81d17}, {0x915e2486ef32cd60, 0x0ace1474dc1d122e},
+	{0xb5b5ada8aaff80b8, 0x0d819992132456ba}, {0xe3231912d5bf60e6, 0x10e1fff697ed6c69},
+	{0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1}, {0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2},
+	{0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde}, {0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b},
+	{0xad4ab7112eb3929d, 0x86c16c98d2c953c6}, {0xd89d64d57a607744, 0xe871c7bf077ba8b7},
+	{0x87625f056c7c4a8b, 0x11471cd764ad4972}, {0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf},
+	{0xd389b47879823479, 0x4aff1d108d4ec2c3}, {0x843610cb4bf160cb, 0xcedf722a585139ba},
+	{0xa54394fe1eedb8fe, 0xc2974eb4ee658828}, {0xce947a3da6a9273e, 0x733d226229feea32},
+	{0x811ccc668829b887, 0x0806357d5a3f525f}, {0xa163ff802a3426a8, 0xca07c2dcb0cf26f7},
+	{0xc9bcff6034c13052, 0xfc89b393dd02f0b5}, {0xfc2c3f3841f17c67, 0xbbac2078d443ace2},
+	{0x9d9ba7832936edc0, 0xd54b944b84aa4c0d}, {0xc5029163f384a931, 0x0a9e795e65d4df11},
+	{0xf64335bcf065d37d, 0x4d4617b5ff4a16d5}, {0x99ea0196163fa42e, 0x504bced1bf8e4e45},
+	{0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6}, {0xf07da27a82c37088, 0x5d767327bb4e5a4c},
+	{0x964e858c91ba2655, 0x3a6a07f8d510f86f}, {0xbbe226efb628afea, 0x890489f70a55368b},
+	{0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e}, {0x92c8ae6b464fc96f, 0x3b0b8bc90012929d},
+	{0xb77ada0617e3bbcb, 0x09ce6ebb40173744}, {0xe55990879ddcaabd, 0xcc420a6a101d0515},
+	{0x8f57fa54c2a9eab6, 0x9fa946824a12232d}, {0xb32df8e9f3546564, 0x47939822dc96abf9},
+	{0xdff9772470297ebd, 0x59787e2b93bc56f7}, {0x8bfbea76c619ef36, 0x57eb4edb3c55b65a},
+	{0xaefae51477a06b03, 0xede622920b6b23f1}, {0xdab99e59958885c4, 0xe95fab368e45eced},
+	{0x88b402f7fd75539b, 0x11dbcb0218ebb414}, {0xaae103b5fcd2a881, 0xd652bdc29f26a119},
+	{0xd59944a37c0752a2, 0x4be76d3346f0495f}, {0x857fcae62d8493a5, 0x6f70a4400c562ddb},
+	{0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952}, {0xd097ad07a71f26b2, 0x7e2000a41346a7a7},
+	{0x825ecc24c873782f, 0x8ed400668c0c28c8}, {0xa2f67f2dfa90563b, 0x728900802f0f32fa},
+	{0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9}, {0xfea126b7d78186bc, 0xe2f610c84987bfa8},
+	{0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9}, {0xc6ede63fa05d3143, 0x91503d1c79720dbb},
+	{0xf8a95fcf88747d94, 0x75a44c6397ce912a}, {0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba},
+	{0xc24452da229b021b, 0xfbe85badce996168}, {0xf2d56790ab41c2a2, 0xfae27299423fb9c3},
+	{0x97c560ba6b0919a5, 0xdccd879fc967d41a}, {0xbdb6b8e905cb600f, 0x5400e987bbc1c920},
+	{0xed246723473e3813, 0x290123e9aab23b68}, {0x9436c0760c86e30b, 0xf9a0b6720aaf6521},
+	{0xb94470938fa89bce, 0xf808e40e8d5b3e69}, {0xe7958cb87392c2c2, 0xb60b1d1230b20e04},
+	{0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2}, {0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3},
+	{0xe2280b6c20dd5232, 0x25c6da63c38de1b0}, {0x8d590723948a535f, 0x579c487e5a38ad0e},
+	{0xb0af48ec79ace837, 0x2d835a9df0c6d851}, {0xdcdb1b2798182244, 0xf8e431456cf88e65},
+	{0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff}, {0xac8b2d36eed2dac5, 0xe272467e3d222f3f},
+	{0xd7adf884aa879177, 0x5b0ed81dcc6abb0f}, {0x86ccbb52ea94baea, 0x98e947129fc2b4e9},
+	{0xa87fea27a539e9a5, 0x3f2398d747b36224}, {0xd29fe4b18e88640e, 0x8eec7f0d19a03aad},
+	{0x83a3eeeef9153e89, 0x1953cf68300424ac}, {0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7},
+	{0xcdb02555653131b6, 0x3792f412cb06794d}, {0x808e17555f3ebf11, 0xe2bbd88bbee40bd0},
+	{0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4}, {0xc8de047564d20a8b, 0xf245825a5a445275},
+	{0xfb158592be068d2e, 0xeed6e2f0f0d56712}, {0x9ced737bb6c4183d, 0x55464dd69685606b},
+	{0xc428d05aa4751e4c, 0xaa97e14c3c26b886}, {0xf53304714d9265df, 0xd53dd99f4b3066a8},
+	{0x993fe2c6d07b7fab, 0xe546a8038efe4029}, {0xbf8fdb78849a5f96, 0xde98520472bdd033},
+	{0xef73d256a5c0f77c, 0x963e66858f6d4440}, {0x95a8637627989aad, 0xdde7001379a44aa8},
+	{0xbb127c53b17ec159, 0x5560c018580d5d52}, {0xe9d71b689dde71af, 0xaab8f01e6e10b4a6},
+	{0x9226712162ab070d, 0xcab3961304ca70e8}, {0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22},
+	{0xe45c10c42a2b3b05, 0x8cb89a7db77c506a}, {0x8eb98a7a9a5b04e3, 0x77f3608e92adb242},
+	{0xb267ed1940f1c61c, 0x55f038b237591ed3}, {0xdf01e85f912e37a3, 0x6b6c46dec52f6688},
+	{0x8b61313bbabce2c6, 0x2323ac4b3b3da015}, {0xae397d8aa96c1b77, 0xabec975e0a0d081a},
+	{0xd9c7dced53c72255, 0x96e7bd358c904a21}, {0x881cea14545c7575, 0x7e50d64177da2e54},
+	{0xaa242499697392d2, 0xdde50bd1d5d0b9e9}, {0xd4ad2dbfc3d07787, 0x955e4ec64b44e864},
+	{0x84ec3c97da624ab4, 0xbd5af13bef0b113e}, {0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e},
+	{0xcfb11ead453994ba, 0x67de18eda5814af2}, {0x81ceb32c4b43fcf4, 0x80eacf948770ced7},
+	{0xa2425ff75e14fc31, 0xa1258379a94d028d}, {0xcad2f7f5359a3b3e, 0x096ee45813a04330},
+	{0xfd87b5f28300ca0d, 0x8bca9d6e188853fc}, {0x9e74d1b791e07e48, 0x775ea264cf55347d},
+	{0xc612062576589dda, 0x95364afe032a819d}, {0xf79687aed3eec551, 0x3a83ddbd83f52204},
+	{0x9abe14cd44753b52, 0xc4926a9672793542}, {0xc16d9a0095928a27, 0x75b7053c0f178293},
+	{0xf1c90080baf72cb1, 0x5324c68b12dd6338}, {0x971da05074da7bee, 0xd3f6fc16ebca5e03},
+	{0xbce5086492111aea, 0x88f4bb1ca6bcf584}, {0xec1e4a7db69561a5, 0x2b31e9e3d06c32e5},
+	{0x9392ee8e921d5d07, 0x3aff322e62439fcf}, {0xb877aa3236a4b449, 0x09befeb9fad487c2},
+	{0xe69594bec44de15b, 0x4c2ebe687989a9b3}, {0x901d7cf73ab0acd9, 0x0f9d37014bf60a10},
+	{0xb424dc35095cd80f, 0x538484c19ef38c94}, {0xe12e13424bb40e13, 0x2865a5f206b06fb9},
+	{0x8cbccc096f5088cb, 0xf93f87b7442e45d3}, {0xafebff0bcb24aafe, 0xf78f69a51539d748},
+	{0xdbe6fecebdedd5be, 0xb573440e5a884d1b}, {0x89705f4136b4a597, 0x31680a88f8953030},
+	{0xabcc77118461cefc, 0xfdc20d2b36ba7c3d}, {0xd6bf94d5e57a42bc, 0x3d32907604691b4c},
+	{0x8637bd05af6c69b5, 0xa63f9a49c2c1b10f}, {0xa7c5ac471b478423, 0x0fcf80dc33721d53},
+	{0xd1b71758e219652b, 0xd3c36113404ea4a8}, {0x83126e978d4fdf3b, 0x645a1cac083126e9},
+	{0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a3}, {0xcccccccccccccccc, 0xcccccccccccccccc},
+	{0x8000000000000000, 0x0000000000000000}, {0xa000000000000000, 0x0000000000000000},
+	{0xc800000000000000, 0x0000000000000000}, {0xfa00000000000000, 0x0000000000000000},
+	{0x9c40000000000000, 0x0000000000000000}, {0xc350000000000000, 0x0000000000000000},
+	{0xf424000000000000, 0x0000000000000000}, {0x9896800000000000, 0x0000000000000000},
+	{0xbebc200000000000, 0x0000000000000000}, {0xee6b280000000000, 0x0000000000000000},
+	{0x9502f90000000000, 0x0000000000000000}, {0xba43b74000000000, 0x0000000000000000},
+	{0xe8d4a51000000000, 0x0000000000000000}, {0x9184e72a00000000, 0x0000000000000000},
+	{0xb5e620f480000000, 0x0000000000000000}, {0xe35fa931a0000000, 0x0000000000000000},
+	{0x8e1bc9bf04000000, 0x0000000000000000}, {0xb1a2bc2ec5000000, 0x0000000000000000},
+	{0xde0b6b3a76400000, 0x0000000000000000}, {0x8ac7230489e80000, 0x0000000000000000},
+	{0xad78ebc5ac620000, 0x0000000000000000}, {0xd8d726b7177a8000, 0x0000000000000000},
+	{0x878678326eac9000, 0x0000000000000000}, {0xa968163f0a57b400, 0x0000000000000000},
+	{0xd3c21bcecceda100, 0x0000000000000000}, {0x84595161401484a0, 0x0000000000000000},
+	{0xa56fa5b99019a5c8, 0x0000000000000000}, {0xcecb8f27f4200f3a, 0x0000000000000000},
+	{0x813f3978f8940984, 0x4000000000000000}, {0xa18f07d736b90be5, 0x5000000000000000},
+	{0xc9f2c9cd04674ede, 0xa400000000000000}, {0xfc6f7c4045812296, 0x4d00000000000000},
+	{0x9dc5ada82b70b59d, 0xf020000000000000}, {0xc5371912364ce305, 0x6c28000000000000},
+	{0xf684df56c3e01bc6, 0xc732000000000000}, {0x9a130b963a6c115c, 0x3c7f400000000000},
+	{0xc097ce7bc90715b3, 0x4b9f100000000000}, {0xf0bdc21abb48db20, 0x1e86d40000000000},
+	{0x96769950b50d88f4, 0x1314448000000000}, {0xbc143fa4e250eb31, 0x17d955a000000000},
+	{0xeb194f8e1ae525fd, 0x5dcfab0800000000}, {0x92efd1b8d0cf37be, 0x5aa1cae500000000},
+	{0xb7abc627050305ad, 0xf14a3d9e40000000}, {0xe596b7b0c643c719, 0x6d9ccd05d0000000},
+	{0x8f7e32ce7bea5c6f, 0xe4820023a2000000}, {0xb35dbf821ae4f38b, 0xdda2802c8a800000},
+	{0xe0352f62a19e306e, 0xd50b2037ad200000}, {0x8c213d9da502de45, 0x4526f422cc340000},
+	{0xaf298d050e4395d6, 0x9670b12b7f410000}, {0xdaf3f04651d47b4c, 0x3c0cdd765f114000},
+	{0x88d8762bf324cd0f, 0xa5880a69fb6ac800}, {0xab0e93b6efee0053, 0x8eea0d047a457a00},
+	{0xd5d238a4abe98068, 0x72a4904598d6d880}, {0x85a36366eb71f041, 0x47a6da2b7f864750},
+	{0xa70c3c40a64e6c51, 0x999090b65f67d924}, {0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d},
+	{0x82818f1281ed449f, 0xbff8f10e7a8921a4}, {0xa321f2d7226895c7, 0xaff72d52192b6a0d},
+	{0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490}, {0xfee50b7025c36a08, 0x02f236d04753d5b4},
+	{0x9f4f2726179a2245, 0x01d762422c946590}, {0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5},
+	{0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2}, {0x9b934c3b330c8577, 0x63cc55f49f88eb2f},
+	{0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb}, {0xf316271c7fc3908a, 0x8bef464e3945ef7a},
+	{0x97edd871cfda3a56, 0x97758bf0e3cbb5ac}, {0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317},
+	{0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd}, {0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a},
+	{0xb975d6b6ee39e436, 0xb3e2fd538e122b44}, {0xe7d34c64a9c85d44, 0x60dbbca87196b616},
+	{0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd}, {0xb51d13aea4a488dd, 0x6babab6398bdbe41},
+	{0xe264589a4dcdab14, 0xc696963c7eed2dd1}, {0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2},
+	{0xb0de65388cc8ada8, 0x3b25a55f43294bcb}, {0xdd15fe86affad912, 0x49ef0eb713f39ebe},
+	{0x8a2dbf142dfcc7ab, 0x6e3569326c784337}, {0xacb92ed9397bf996, 0x49c2c37f07965404},
+	{0xd7e77a8f87daf7fb, 0xdc33745ec97be906}, {0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3},
+	{0xa8acd7c0222311bc, 0xc40832ea0d68ce0c}, {0xd2d80db02aabd62b, 0xf50a3fa490c30190},
+	{0x83c7088e1aab65db, 0x792667c6da79e0fa}, {0xa4b8cab1a1563f52, 0x577001b891185938},
+	{0xcde6fd5e09abcf26, 0xed4c0226b55e6f86}, {0x80b05e5ac60b6178, 0x544f8158315b05b4},
+	{0xa0dc75f1778e39d6, 0x696361ae3db1c721}, {0xc913936dd571c84c, 0x03bc3a19cd1e38e9},
+	{0xfb5878494ace3a5f, 0x04ab48a04065c723}, {0x9d174b2dcec0e47b, 0x62eb0d64283f9c76},
+	{0xc45d1df942711d9a, 0x3ba5d0bd324f8394}, {0xf5746577930d6500, 0xca8f44ec7ee36479},
+	{0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb}, {0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e},
+	{0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e}, {0x95d04aee3b80ece5, 0xbba1f1d158724a12},
+	{0xbb445da9ca61281f, 0x2a8a6e45ae8edc97}, {0xea1575143cf97226, 0xf52d09d71a3293bd},
+	{0x924d692ca61be758, 0x593c2626705f9c56}, {0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c},
+	{0xe498f455c38b997a, 0x0b6dfb9c0f956447}, {0x8edf98b59a373fec, 0x4724bd4189bd5eac},
+	{0xb2977ee300c50fe7, 0x58edec91ec2cb657}, {0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed},
+	{0x8b865b215899f46c, 0xbd79e0d20082ee74}, {0xae67f1e9aec07187, 0xecd8590680a3aa11},
+	{0xda01ee641a708de9, 0xe80e6f4820cc9495}, {0x884134fe908658b2, 0x3109058d147fdcdd},
+	{0xaa51823e34a7eede, 0xbd4b46f0599fd415}, {0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a},
+	{0x850fadc09923329e, 0x03e2cf6bc604ddb0}, {0xa6539930bf6bff45, 0x84db8346b786151c},
+	{0xcfe87f7cef46ff16, 0xe612641865679a63}, {0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e},
+	{0xa26da3999aef7749, 0xe3be5e330f38f09d}, {0xcb090c8001ab551c, 0x5cadf5bfd3072cc5},
+	{0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6}, {0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa},
+	{0xc646d63501a1511d, 0xb281e1fd541501b8}, {0xf7d88bc24209a565, 0x1f225a7ca91a4226},
+	{0x9ae757596946075f, 0x3375788de9b06958}, {0xc1a12d2fc3978937, 0x0052d6b1641c83ae},
+	{0xf209787bb47d6b84, 0xc0678c5dbd23a49a}, {0x9745eb4d50ce6332, 0xf840b7ba963646e0},
+	{0xbd176620a501fbff, 0xb650e5a93bc3d898}, {0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe},
+	{0x93ba47c980e98cdf, 0xc66f336c36b10137}, {0xb8a8d9bbe123f017, 0xb80b0047445d4184},
+	{0xe6d3102ad96cec1d, 0xa60dc059157491e5}, {0x9043ea1ac7e41392, 0x87c89837ad68db2f},
+	{0xb454e4a179dd1877, 0x29babe4598c311fb}, {0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a},
+	{0x8ce2529e2734bb1d, 0x1899e4a65f58660c}, {0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f},
+	{0xdc21a1171d42645d, 0x76707543f4fa1f73}, {0x899504ae72497eba, 0x6a06494a791c53a8},
+	{0xabfa45da0edbde69, 0x0487db9d17636892}, {0xd6f8d7509292d603, 0x45a9d2845d3c42b6},
+	{0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2}, {0xa7f26836f282b732, 0x8e6cac7768d7141e},
+	{0xd1ef0244af2364ff, 0x3207d795430cd926}, {0x8335616aed761f1f, 0x7f44e6bd49e807b8},
+	{0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6}, {0xcd036837130890a1, 0x36dba887c37a8c0f},
+	{0x802221226be55a64, 0xc2494954da2c9789}, {0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c},
+	{0xc83553c5c8965d3d, 0x6f92829494e5acc7}, {0xfa42a8b73abbf48c, 0xcb772339ba1f17f9},
+	{0x9c69a97284b578d7, 0xff2a760414536efb}, {0xc38413cf25e2d70d, 0xfef5138519684aba},
+	{0xf46518c2ef5b8cd1, 0x7eb258665fc25d69}, {0x98bf2f79d5993802, 0xef2f773ffbd97a61},
+	{0xbeeefb584aff8603, 0xaafb550ffacfd8fa}, {0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38},
+	{0x952ab45cfa97a0b2, 0xdd945a747bf26183}, {0xba756174393d88df, 0x94f971119aeef9e4},
+	{0xe912b9d1478ceb17, 0x7a37cd5601aab85d}, {0x91abb422ccb812ee, 0xac62e055c10ab33a},
+	{0xb616a12b7fe617aa, 0x577b986b314d6009}, {0xe39c49765fdf9d94, 0xed5a7e85fda0b80b},
+	{0x8e41ade9fbebc27d, 0x14588f13be847307}, {0xb1d219647ae6b31c, 0x596eb2d8ae258fc8},
+	{0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb}, {0x8aec23d680043bee, 0x25de7bb9480d5854},
+	{0xada72ccc20054ae9, 0xaf561aa79a10ae6a}, {0xd910f7ff28069da4, 0x1b2ba1518094da04},
+	{0x87aa9aff79042286, 0x90fb44d2f05d0842}, {0xa99541bf57452b28, 0x353a1607ac744a53},
+	{0xd3fa922f2d1675f2, 0x42889b8997915ce8}, {0x847c9b5d7c2e09b7, 0x69956135febada11},
+	{0xa59bc234db398c25, 0x43fab9837e699095}, {0xcf02b2c21207ef2e, 0x94f967e45e03f4bb},
+	{0x8161afb94b44f57d, 0x1d1be0eebac278f5}, {0xa1ba1ba79e1632dc, 0x6462d92a69731732},
+	{0xca28a291859bbf93, 0x7d7b8f7503cfdcfe}, {0xfcb2cb35e702af78, 0x5cda735244c3d43e},
+	{0x9defbf01b061adab, 0x3a0888136afa64a7}, {0xc56baec21c7a1916, 0x088aaa1845b8fdd0},
+	{0xf6c69a72a3989f5b, 0x8aad549e57273d45}, {0x9a3c2087a63f6399, 0x36ac54e2f678864b},
+	{0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd}, {0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5},
+	{0x969eb7c47859e743, 0x9f644ae5a4b1b325}, {0xbc4665b596706114, 0x873d5d9f0dde1fee},
+	{0xeb57ff22fc0c7959, 0xa90cb506d155a7ea}, {0x9316ff75dd87cbd8, 0x09a7f12442d588f2},
+	{0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f}, {0xe5d3ef282a242e81, 0x8f1668c8a86da5fa},
+	{0x8fa475791a569d10, 0xf96e017d694487bc}, {0xb38d92d760ec4455, 0x37c981dcc395a9ac},
+	{0xe070f78d3927556a, 0x85bbe253f47b1417}, {0x8c469ab843b89562, 0x93956d7478ccec8e},
+	{0xaf58416654a6babb, 0x387ac8d1970027b2}, {0xdb2e51bfe9d0696a, 0x06997b05fcc0319e},
+	{0x88fcf317f22241e2, 0x441fece3bdf81f03}, {0xab3c2fddeeaad25a, 0xd527e81cad7626c3},
+	{0xd60b3bd56a5586f1, 0x8a71e223d8d3b074}, {0x85c7056562757456, 0xf6872d5667844e49},
+	{0xa738c6bebb12d16c, 0xb428f8ac016561db}, {0xd106f86e69d785c7, 0xe13336d701beba52},
+	{0x82a45b450226b39c, 0xecc0024661173473}, {0xa34d721642b06084, 0x27f002d7f95d0190},
+	{0xcc20ce9bd35c78a5, 0x31ec038df7b441f4}, {0xff290242c83396ce, 0x7e67047175a15271},
+	{0x9f79a169bd203e41, 0x0f0062c6e984d386}, {0xc75809c42c684dd1, 0x52c07b78a3e60868},
+	{0xf92e0c3537826145, 0xa7709a56ccdf8a82}, {0x9bbcc7a142b17ccb, 0x88a66076400bb691},
+	{0xc2abf989935ddbfe, 0x6acff893d00ea435}, {0xf356f7ebf83552fe, 0x0583f6b8c4124d43},
+	{0x98165af37b2153de, 0xc3727a337a8b704a}, {0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c},
+	{0xeda2ee1c7064130c, 0x1162def06f79df73}, {0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8},
+	{0xb9a74a0637ce2ee1, 0x6d953e2bd7173692}, {0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437},
+	{0x910ab1d4db9914a0, 0x1d9c9892400a22a2}, {0xb54d5e4a127f59c8, 0x2503beb6d00cab4b},
+	{0xe2a0b5dc971f303a, 0x2e44ae64840fd61d}, {0x8da471a9de737e24, 0x5ceaecfed289e5d2},
+	{0xb10d8e1456105dad, 0x7425a83e872c5f47}, {0xdd50f1996b947518, 0xd12f124e28f77719},
+	{0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f}, {0xace73cbfdc0bfb7b, 0x636cc64d1001550b},
+	{0xd8210befd30efa5a, 0x3c47f7e05401aa4e}, {0x8714a775e3e95c78, 0x65acfaec34810a71},
+	{0xa8d9d1535ce3b396, 0x7f1839a741a14d0d}, {0xd31045a8341ca07c, 0x1ede48111209a050},
+	{0x83ea2b892091e44d, 0x934aed0aab460432}, {0xa4e4b66b68b65d60, 0xf81da84d5617853f},
+	{0xce1de40642e3f4b9, 0x36251260ab9d668e}, {0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019},
+	{0xa1075a24e4421730, 0xb24cf65b8612f81f}, {0xc94930ae1d529cfc, 0xdee033f26797b627},
+	{0xfb9b7cd9a4a7443c, 0x169840ef017da3b1}, {0x9d412e0806e88aa5, 0x8e1f289560ee864e},
+	{0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2}, {0xf5b5d7ec8acb58a2, 0xae10af696774b1db},
+	{0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29}, {0xbff610b0cc6edd3f, 0x17fd090a58d32af3},
+	{0xeff394dcff8a948e, 0xddfc4b4cef07f5b0}, {0x95f83d0a1fb69cd9, 0x4abdaf101564f98e},
+	{0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1}, {0xea53df5fd18d5513, 0x84c86189216dc5ed},
+	{0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4}, {0xb7118682dbb66a77, 0x3fbc8c33221dc2a1},
+	{0xe4d5e82392a40515, 0x0fabaf3feaa5334a}, {0x8f05b1163ba6832d, 0x29cb4d87f2a7400e},
+	{0xb2c71d5bca9023f8, 0x743e20e9ef511012}, {0xdf78e4b2bd342cf6, 0x914da9246b255416},
+	{0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e}, {0xae9672aba3d0c320, 0xa184ac2473b529b1},
+	{0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e}, {0x8865899617fb1871, 0x7e2fa67c7a658892},
+	{0xaa7eebfb9df9de8d, 0xddbb901b98feeab7}, {0xd51ea6fa85785631, 0x552a74227f3ea565},
+	{0x8533285c936b35de, 0xd53a88958f87275f}, {0xa67ff273b8460356, 0x8a892abaf368f137},
+	{0xd01fef10a657842c, 0x2d2b7569b0432d85}, {0x8213f56a67f6b29b, 0x9c3b29620e29fc73},
+	{0xa298f2c501f45f42, 0x8349f3ba91b47b8f}, {0xcb3f2f7642717713, 0x241c70a936219a73},
+	{0xfe0efb53d30dd4d7, 0xed238cd383aa0110}, {0x9ec95d1463e8a506, 0xf4363804324a40aa},
+	{0xc67bb4597ce2ce48, 0xb143c6053edcd0d5}, {0xf81aa16fdc1b81da, 0xdd94b7868e94050a},
+	{0x9b10a4e5e9913128, 0xca7cf2b4191c8326}, {0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0},
+	{0xf24a01a73cf2dccf, 0xbc633b39673c8cec}, {0x976e41088617ca01, 0xd5be0503e085d813},
+	{0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18}, {0xec9c459d51852ba2, 0xddf8e7d60ed1219e},
+	{0x93e1ab8252f33b45, 0xcabb90e5c942b503}, {0xb8da1662e7b00a17, 0x3d6a751f3b936243},
+	{0xe7109bfba19c0c9d, 0x0cc512670a783ad4}, {0x906a617d450187e2, 0x27fb2b80668b24c5},
+	{0xb484f9dc9641e9da, 0xb1f9f660802dedf6}, {0xe1a63853bbd26451, 0x5e7873f8a0396973},
+	{0x8d07e33455637eb2, 0xdb0b487b6423e1e8}, {0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62},
+	{0xdc5c5301c56b75f7, 0x7641a140cc7810fb}, {0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d},
+	{0xac2820d9623bf429, 0x546345fa9fbdcd44}, {0xd732290fbacaf133, 0xa97c177947ad4095},
+	{0x867f59a9d4bed6c0, 0x49ed8eabcccc485d}, {0xa81f301449ee8c70, 0x5c68f256bfff5a74},
+	{0xd226fc195c6a2f8c, 0x73832eec6fff3111}, {0x83585d8fd9c25db7, 0xc831fd53c5ff7eab},
+	{0xa42e74f3d032f525, 0xba3e7ca8b77f5e55}, {0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb},
+	{0x80444b5e7aa7cf85, 0x7980d163cf5b81b3}, {0xa0555e361951c366, 0xd7e105bcc332621f},
+	{0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7}, {0xfa856334878fc150, 0xb14f98f6f0feb951},
+	{0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3}, {0xc3b8358109e84f07, 0x0a862f80ec4700c8},
+	{0xf4a642e14c6262c8, 0xcd27bb612758c0fa}, {0x98e7e9cccfbd7dbd, 0x8038d51cb897789c},
+	{0xbf21e44003acdd2c, 0xe0470a63e6bd56c3}, {0xeeea5d5004981478, 0x1858ccfce06cac74},
+	{0x95527a5202df0ccb, 0x0f37801e0c43ebc8}, {0xbaa718e68396cffd, 0xd30560258f54e6ba},
+	{0xe950df20247c83fd, 0x47c6b82ef32a2069}, {0x91d28b7416cdd27e, 0x4cdc331d57fa5441},
+	{0xb6472e511c81471d, 0xe0133fe4adf8e952}, {0xe3d8f9e563a198e5, 0x58180fddd97723a6},
+	{0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648}, {0xb201833b35d63f73, 0x2cd2cc6551e513da},
+	{0xde81e40a034bcf4f, 0xf8077f7ea65e58d1}, {0x8b112e86420f6191, 0xfb04afaf27faf782},
+	{0xadd57a27d29339f6, 0x79c5db9af1f9b563}, {0xd94ad8b1c7380874, 0x18375281ae7822bc},
+	{0x87cec76f1c830548, 0x8f2293910d0b15b5}, {0xa9c2794ae3a3c69a, 0xb2eb3875504ddb22},
+	{0xd433179d9c8cb841, 0x5fa60692a46151eb}, {0x849feec281d7f328, 0xdbc7c41ba6bcd333},
+	{0xa5c7ea73224deff3, 0x12b9b522906c0800}, {0xcf39e50feae16bef, 0xd768226b34870a00},
+	{0x81842f29f2cce375, 0xe6a1158300d46640}, {0xa1e53af46f801c53, 0x60495ae3c1097fd0},
+	{0xca5e89b18b602368, 0x385bb19cb14bdfc4}, {0xfcf62c1dee382c42, 0x46729e03dd9ed7b5},
+	{0x9e19db92b4e31ba9, 0x6c07a2c26a8346d1},
+};
+
+constexpr char digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/* Exact powers of ten for the fast path of String::parse_f64() */
+constexpr f64 f64_pow10[23] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+constexpr i32 F64_MANTISSA_BITS = 52;
+constexpr u64 F64_MANTISSA_MASK = (1ull << F64_MANTISSA_BITS) - 1;
+constexpr i32 F64_EXPONENT_BIAS = 1023;
+constexpr u64 F64_SIGN_BIT = 1ull << 63;
+constexpr u64 U64_MASK63 = (1ull << 63) - 1;
+
+/* Full 64x64 bit product, returns the high half */
+static inline
+u64 mul_u64(u64 a, u64 b, u64* lo){
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 r = (unsigned __int128)(a) * b;
+	*lo = u64(r);
+	return u64(r >> 64);
+#else
+	u64 a_lo = u32(a), a_hi = a >> 32;
+	u64 b_lo = u32(b), b_hi = b >> 32;
+	u64 p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+	u64 mid = (p0 >> 32) + u32(p1) + u32(p2);
+	*lo = (mid << 32) | u32(p0);
+	return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
+
+static inline
+int u64_clz(u64 x){
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long idx;
+	_BitScanReverse64(&idx, x);
+	return 63 - int(idx);
+#else
+	return __builtin_clzll(x);
+#endif
+}
+
+static
+isize format_u64(byte* out, u64 v){
+	byte buf[INT_SIZE];
+	isize i = INT_SIZE;
+	while(v >= 100){
+		u64 q = v / 100;
+		isize r = isize(v - q * 100);
+		i -= 2;
+		mem::copy(&buf[i], &digit_pairs[r * 2], 2);
+		v = q;
+	}
+	if(v >= 10){
+		i -= 2;
+		mem::copy(&buf[i], &digit_pairs[v * 2], 2);
+	}
+	else {
+		i -= 1;
+		buf[i] = byte('0' + v);
+	}
+	mem::copy(out, &buf[i], INT_SIZE - i);
+	return INT_SIZE - i;
+}
+
+static
+isize format_i64(byte* out, i64 v){
+	if(v < 0){
+		out[0] = '-';
+		return 1 + format_u64(&out[1], u64(0) - u64(v));
+	}
+	return format_u64(out, u64(v));
+}
+
+/* Shortest decimal that rounds back to the same double, using Schubfach
+ * (Raffaello Giulietti, "The Schubfach way to render doubles", 2020) */
+constexpr u64 SCHUBFACH_C_MIN = 1ull << F64_MANTISSA_BITS;
+constexpr i32 SCHUBFACH_Q_MIN = -1074;
+
+static inline
+i32 flog10_pow2(i32 q){
+	return i32((i64(q) * 661971961083ll) >> 41);
+}
+
+static inline
+i32 flog10_three_quarters_pow2(i32 q){
+	return i32((i64(q) * 661971961083ll - 274743187321ll) >> 41);
+}
+
+static inline
+i32 flog2_pow10(i32 e){
+	return i32((i64(e) * 1741647) >> 19);
+}
+
+/* Round to odd of g * cp, with g = g1 * 2^63 + g0 */
+static inline
+u64 schubfach_round(u64 g1, u64 g0, u64 cp){
+	u64 x0, y0;
+	u64 x1 = mul_u64(g0, cp, &x0);
+	u64 y1 = mul_u64(g1, cp, &y0);
+	u64 z = (y0 >> 1) + x1;
+	u64 vbp = y1 + (z >> 63);
+	return vbp | (((z & U64_MASK63) + U64_MASK63) >> 63);
+}
+
+/* Decimal f * 10^e closest to c * 2^q among the shortest ones in its rounding
+ * interval. `dk` corrects the exponent when c was scaled by 10. */
+static
+void schubfach(i32 q, u64 c, i32 dk, u64* f, i32* e){
+	u64 out = c & 1;
+	u64 cb = c << 2;
+	u64 cbr = cb + 2;
+	u64 cbl;
+	i32 k;
+	if(c != SCHUBFACH_C_MIN || q == SCHUBFACH_Q_MIN){
+		cbl = cb - 2;
+		k = flog10_pow2(q);
+	}
+	else {
+		cbl = cb - 1;
+		k = flog10_three_quarters_pow2(q);
+	}
+	i32 h = q + flog2_pow10(-k) + 2;
+
+	/* g = floor(10^-k * 2^(125 - flog2(10^-k))) + 1, from the 128-bit table */
+	u64 const* p = pow10_table[-k - POW10_MIN];
+	u64 g_hi = p[0] >> 2;
+	u64 g_lo = ((p[0] << 62) | (p[1] >> 2)) + 1;
+	g_hi += g_lo == 0;
+	u64 g1 = (g_hi << 1) | (g_lo >> 63);
+	u64 g0 = g_lo & U64_MASK63;
+
+	u64 vb = schubfach_round(g1, g0, cb << h);
+	u64 vbl = schubfach_round(g1, g0, cbl << h);
+	u64 vbr = schubfach_round(g1, g0, cbr << h);
+
+	u64 s = vb >> 2;
+	if(s >= 10){
+		u64 sp10 = 10 * (s / 10);
+		u64 tp10 = sp10 + 10;
+		bool upin = vbl + out <= sp10 << 2;
+		bool wpin = (tp10 << 2) + out <= vbr;
+		if(upin != wpin){
+			*f = upin ? sp10 : tp10;
+			*e = k;
+			return;
+		}
+	}
+	u64 t = s + 1;
+	bool uin = vbl + out <= s << 2;
+	bool win = (t << 2) + out <= vbr;
+	if(uin != win){
+		*f = uin ? s : t;
+		*e = k + dk;
+		return;
+	}
+	i64 cmp = i64(vb - ((s + t) << 1));
+	*f = (cmp < 0 || (cmp == 0 && (s & 1) == 0)) ? s : t;
+	*e = k + dk;
+}
+
+/* Finite, non-zero doubles only */
+static
+void f64_to_decimal(u64 bits, u64* f, i32* e){
+	u64 t = bits & F64_MANTISSA_MASK;
+	i32 bq = i32(bits >> F64_MANTISSA_BITS) & 0x7ff;
+	if(bq == 0){
+		schubfach(SCHUBFACH_Q_MIN, t, 0, f, e);
+		return;
+	}
+
+	i32 mq = -SCHUBFACH_Q_MIN + 1 - bq;
+	u64 c = SCHUBFACH_C_MIN | t;
+	/* Integers are printed as they are */
+	if(mq > 0 && mq <= F64_MANTISSA_BITS){
+		u64 fi = c >> mq;
+		if((fi << mq) == c){
+			*f = fi;
+			*e = 0;
+			return;
+		}
+	}
+	schubfach(-mq, c, 0, f, e);
+}
+
+static
+isize format_f64(byte* out, f64 v){
+	u64 bits;
+	mem::copy(&bits, &v, 8);
+	isize n = 0;
+	bool neg = (bits & F64_SIGN_BIT) != 0;
+	u64 abs_bits = bits & ~F64_SIGN_BIT;
+
+	if(abs_bits >= (0x7ffull << F64_MANTISSA_BITS)){
+		if(abs_bits != (0x7ffull << F64_MANTISSA_BITS)){
+			mem::copy(out, "nan", 3);
+			return 3;
+		}
+		if(neg){ out[n++] = '-'; }
+		mem::copy(&out[n], "inf", 3);
+		return n + 3;
+	}
+	if(neg){ out[n++] = '-'; }
+	if(abs_bits == 0){
+		out[n++] = '0';
+		return n;
+	}
+
+	u64 f;
+	i32 e;
+	f64_to_decimal(abs_bits, &f, &e);
+	while(f % 10 == 0){
+		f /= 10;
+		e += 1;
+	}
+
+	byte digits[INT_SIZE];
+	i32 k = i32(format_u64(digits, f));
+	/* Same layout as JavaScript: the value is 0.digits * 10^point */
+	i32 point = e + k;
+
+	if(k <= point && point <= 21){
+		mem::copy(&out[n], digits, k);
+		n += k;
+		mem::set(&out[n], '0', point - k);
+		n += point - k;
+	}
+	else if(0 < point && point <= 21){
+		mem::copy(&out[n], digits, point);
+		n += point;
+		out[n++] = '.';
+		mem::copy(&out[n], &digits[point], k - point);
+		n += k - point;
+	}
+	else if(-6 < point && point <= 0){
+		out[n++] = '0';
+		out[n++] = '.';
+		mem::set(&out[n], '0', -point);
+		n += -point;
+		mem::copy(&out[n], digits, k);
+		n += k;
+	}
+	else {
+		out[n++] = digits[0];
+		if(k > 1){
+			out[n++] = '.';
+			mem::copy(&out[n], &digits[1], k - 1);
+			n += k - 1;
+		}
+		out[n++] = 'e';
+		out[n++] = point - 1 < 0 ? '-' : '+';
+		n += format_u64(&out[n], u64(point - 1 < 0 ? 1 - point : point - 1));
+	}
+	return n;
+}
+
+isize write_u64(Slice<byte> out, u64 v){
+	bounds_check_assert(out.size() >= INT_SIZE, "Output is too small for an integer");
+	return format_u64(out.raw_data(), v);
+}
+
+isize write_i64(Slice<byte> out, i64 v){
+	bounds_check_assert(out.size() >= INT_SIZE, "Output is too small for an integer");
+	return format_i64(out.raw_data(), v);
+}
+
+isize write_f64(Slice<byte> out, f64 v){
+	bounds_check_assert(out.size() >= F64_SIZE, "Output is too small for a float");
+	return format_f64(out.raw_data(), v);
+}
+
+static inline
+bool is_digit(byte c){
+	return u8(c - '0') < 10;
+}
+
+/* Check if the 8 bytes are all ASCII digits */
+static inline
+bool swar_is_8_digits(u64 x){
+	return ((x & 0xf0f0f0f0f0f0f0f0ull) | (((x + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) ==
+		0x3333333333333333ull;
+}
+
+/* Value of 8 ASCII digits loaded as a little endian word */
+static inline
+u64 swar_parse_8_digits(u64 x){
+	x -= 0x3030303030303030ull;
+	x = (x * 10 + (x >> 8)) & 0x00ff00ff00ff00ffull;
+	x = (x * 100 + (x >> 16)) & 0x0000ffff0000ffffull;
+	return (x * 10000 + (x >> 32)) & 0xffffffffull;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool SWAR_DIGITS = false;
+#else
+constexpr bool SWAR_DIGITS = true;
+#endif
+
+/* Parse the digits in data[*pos..len], stops at anything that's not a digit.
+ * Returns false on overflow. */
+static
+bool parse_u64_digits(byte const* data, isize len, isize* pos, u64* out){
+	isize i = *pos;
+	u64 v = 0;
+	while(i < len && data[i] == '0'){ i += 1; }
+
+	/* 19 digits always fit */
+	isize end = min(len, i + 19);
+	while(SWAR_DIGITS && i + 8 <= end){
+		u64 x;
+		mem::copy(&x, &data[i], 8);
+		if(!swar_is_8_digits(x)){ break; }
+		v = v * 100000000 + swar_parse_8_digits(x);
+		i += 8;
+	}
+	while(i < end && is_digit(data[i])){
+		v = v * 10 + (data[i] - '0');
+		i += 1;
+	}
+	if(i < len && is_digit(data[i])){
+		u64 d = data[i] - '0';
+		if(v > (~u64(0) - d) / 10){ return false; }
+		v = v * 10 + d;
+		i += 1;
+		if(i < len && is_digit(data[i])){ return false; }
+	}
+
+	*pos = i;
+	*out = v;
+	return true;
+}
+
+static
+bool parse_u64(String s, u64* out){
+	isize i = 0;
+	if(s._length > 0 && s._data[0] == '+'){ i += 1; }
+	if(i == s._length){ return false; }
+	u64 v;
+	if(!parse_u64_digits(s._data, s._length, &i, &v) || i != s._length){ return false; }
+	*out = v;
+	return true;
+}
+
+static
+bool parse_i64(String s, i64* out){
+	isize i = 0;
+	bool neg = false;
+	if(s._length > 0 && (s._data[0] == '+' || s._data[0] == '-')){
+		neg = s._data[0] == '-';
+		i += 1;
+	}
+	if(i == s._length){ return false; }
+	u64 v;
+	if(!parse_u64_digits(s._data, s._length, &i, &v) || i != s._length){ return false; }
+	if(v > u64(INT64_MAX) + neg){ return false; }
+	*out = neg ? i64(u64(0) - v) : i64(v);
+	return true;
+}
+
+/* Eisel-Lemire: rounds man * 10^exp10 using a 128-bit approximation of the
+ * power, gives up (returns false) when that's not enough to decide. Follows
+ * Nigel Tao's simplified version, which works with a rounded down table. */
+static
+bool eisel_lemire(u64 man, i32 exp10, f64* out){
+	if(exp10 < POW10_MIN || exp10 > POW10_MAX){ return false; }
+	int clz = u64_clz(man);
+	man <<= clz;
+	u64 ret_exp2 = u64(((i64(217706) * exp10) >> 16) + 64 + F64_EXPONENT_BIAS) - u64(clz);
+
+	u64 const* p = pow10_table[exp10 - POW10_MIN];
+	u64 x_lo;
+	u64 x_hi = mul_u64(man, p[0], &x_lo);
+	/* The low half of the power only matters when the high product is close to
+	 * a rounding boundary */
+	if((x_hi & 0x1ff) == 0x1ff && x_lo + man < man){
+		u64 y_lo;
+		u64 y_hi = mul_u64(man, p[1], &y_lo);
+		u64 merged_hi = x_hi, merged_lo = x_lo + y_hi;
+		if(merged_lo < x_lo){ merged_hi += 1; }
+		if((merged_hi & 0x1ff) == 0x1ff && merged_lo + 1 == 0 && y_lo + man < man){ return false; }
+		x_hi = merged_hi;
+		x_lo = merged_lo;
+	}
+
+	u64 msb = x_hi >> 63;
+	u64 ret_mantissa = x_hi >> (msb + 9);
+	ret_exp2 -= 1 ^ msb;
+	/* Exactly halfway between two doubles */
+	if(x_lo == 0 && (x_hi & 0x1ff) == 0 && (ret_mantissa & 3) == 1){ return false; }
+
+	ret_mantissa += ret_mantissa & 1;
+	ret_mantissa >>= 1;
+	if((ret_mantissa >> 53) > 0){
+		ret_mantissa >>= 1;
+		ret_exp2 += 1;
+	}
+	/* Subnormals, infinities and overflow go to the slow path */
+	if(ret_exp2 - 1 >= 0x7ff - 1){ return false; }
+
+	u64 bits = (ret_exp2 << F64_MANTISSA_BITS) | (ret_mantissa & F64_MANTISSA_MASK);
+	mem::copy(out, &bits, 8);
+	return true;
+}
+
+/* Slow path for the rare inputs Eisel-Lemire can't decide: exact decimal
+ * arithmetic on up to DECIMAL_DIGITS digits, scaled by powers of two until
+ * the mantissa can be read off (the algorithm from Go's strconv). */
+constexpr i32 DECIMAL_DIGITS = 800;
+constexpr i32 DECIMAL_MAX_SHIFT = 60;
+
+struct Decimal {
+	u8 d[DECIMAL_DIGITS]; /* Digit values, not characters */
+	i32 nd;               /* Number of digits used */
+	i32 dp;               /* Decimal point */
+	bool trunc;           /* Nonzero digits were dropped */
+};
+
+static
+void decimal_trim(Decimal* a){
+	while(a->nd > 0 && a->d[a->nd - 1] == 0){ a->nd -= 1; }
+	if(a->nd == 0){ a->dp = 0; }
+}
+
+/* Digits of a string already checked by String::parse_f64() */
+static
+void decimal_from_string(Decimal* a, String s){
+	isize i = 0;
+	bool seen_dot = false;
+	a->nd = 0;
+	a->dp = 0;
+	a->trunc = false;
+	if(s._data[0] == '+' || s._data[0] == '-'){ i += 1; }
+
+	for(; i < s._length; i += 1){
+		byte c = s._data[i];
+		if(c == '.'){
+			seen_dot = true;
+			continue;
+		}
+		if(!is_digit(c)){ break; }
+		if(a->nd == 0 && c == '0'){
+			a->dp -= seen_dot;
+			continue;
+		}
+		a->dp += !seen_dot;
+		if(a->nd < DECIMAL_DIGITS){
+			a->d[a->nd++] = c - '0';
+		}
+		else if(c != '0'){
+			a->trunc = true;
+		}
+	}
+
+	if(i < s._length){
+		i += 1;
+		bool neg = false;
+		if(s._data[i] == '+' || s._data[i] == '-'){
+			neg = s._data[i] == '-';
+			i += 1;
+		}
+		i32 e = 0;
+		for(; i < s._length; i += 1){
+			if(e < 100000){ e = e * 10 + (s._data[i] - '0'); }
+		}
+		a->dp += neg ? -e : e;
+	}
+	decimal_trim(a);
+}
+
+static
+void decimal_right_shift(Decimal* a, u32 k){
+	i32 r = 0, w = 0;
+	u64 n = 0;
+	for(; (n >> k) == 0; r += 1){
+		if(r >= a->nd){
+			if(n == 0){
+				a->nd = 0;
+				return;
+			}
+			while((n >> k) == 0){
+				n *= 10;
+				r += 1;
+			}
+			break;
+		}
+		n = n * 10 + a->d[r];
+	}
+	a->dp -= r - 1;
+
+	u64 mask = (u64(1) << k) - 1;
+	for(; r < a->nd; r += 1){
+		u64 c = a->d[r];
+		a->d[w++] = u8(n >> k);
+		n = (n & mask) * 10 + c;
+	}
+	while(n > 0){
+		u64 dig = n >> k;
+		n &= mask;
+		if(w < DECIMAL_DIGITS){
+			a->d[w++] = u8(dig);
+		}
+		else if(dig > 0){
+			a->trunc = true;
+		}
+		n *= 10;
+	}
+	a->nd = w;
+	decimal_trim(a);
+}
+
+static
+void decimal_left_shift(Decimal* a, u32 k){
+	u8 tmp[DECIMAL_DIGITS + 24];
+	i32 t = DECIMAL_DIGITS + 24;
+	u64 n = 0;
+	for(i32 r = a->nd - 1; r >= 0; r -= 1){
+		n += u64(a->d[r]) << k;
+		u64 q = n / 10;
+		tmp[--t] = u8(n - q * 10);
+		n = q;
+	}
+	while(n > 0){
+		u64 q = n / 10;
+		tmp[--t] = u8(n - q * 10);
+		n = q;
+	}
+
+	i32 count = DECIMAL_DIGITS + 24 - t;
+	a->dp += count - a->nd;
+	if(count > DECIMAL_DIGITS){
+		for(i32 i = DECIMAL_DIGITS; i < count; i += 1){
+			if(tmp[t + i] != 0){ a->trunc = true; }
+		}
+		count = DECIMAL_DIGITS;
+	}
+	mem::copy(a->d, &tmp[t], count);
+	a->nd = count;
+	decimal_trim(a);
+}
+
+static
+void decimal_shift(Decimal* a, i32 k){
+	if(a->nd == 0){ return; }
+	while(k > DECIMAL_MAX_SHIFT){
+		decimal_left_shift(a, DECIMAL_MAX_SHIFT);
+		k -= DECIMAL_MAX_SHIFT;
+	}
+	while(k < -DECIMAL_MAX_SHIFT){
+		decimal_right_shift(a, DECIMAL_MAX_SHIFT);
+		k += DECIMAL_MAX_SHIFT;
+	}
+	if(k > 0){ decimal_left_shift(a, k); }
+	if(k < 0){ decimal_right_shift(a, -k); }
+}
+
+/* Integer part, rounded half to even */
+static
+u64 decimal_rounded_integer(Decimal* a){
+	if(a->dp > 20){ return ~u64(0); }
+	i32 i = 0;
+	u64 n = 0;
+	for(; i < a->dp && i < a->nd; i += 1){
+		n = n * 10 + a->d[i];
+	}
+	for(; i < a->dp; i += 1){
+		n *= 10;
+	}
+
+	bool round_up = false;
+	if(a->dp >= 0 && a->dp < a->nd){
+		if(a->d[a->dp] == 5 && a->dp + 1 == a->nd){
+			round_up = a->trunc || (a->dp > 0 && (a->d[a->dp - 1] & 1));
+		}
+		else {
+			round_up = a->d[a->dp] >= 5;
+		}
+	}
+	return n + round_up;
+}
+
+static
+u64 decimal_to_f64_bits(Decimal* a){
+	constexpr u8 powtab[9] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+	constexpr u64 inf = 0x7ffull << F64_MANTISSA_BITS;
+
+	if(a->nd == 0 || a->dp < -330){ return 0; }
+	if(a->dp > 310){ return inf; }
+
+	/* Scale by powers of two until the value is in [0.5, 1) */
+	i32 exp = 0;
+	while(a->dp > 0){
+		i32 n = a->dp >= 9 ? 27 : powtab[a->dp];
+		decimal_shift(a, -n);
+		exp += n;
+	}
+	while(a->dp < 0 || (a->dp == 0 && a->d[0] < 5)){
+		i32 n = -a->dp >= 9 ? 27 : powtab[-a->dp];
+		decimal_shift(a, n);
+		exp -= n;
+	}
+	/* Doubles are in [1, 2) */
+	exp -= 1;
+
+	if(exp < 1 - F64_EXPONENT_BIAS){
+		i32 n = 1 - F64_EXPONENT_BIAS - exp;
+		decimal_shift(a, -n);
+		exp += n;
+	}
+	if(exp + F64_EXPONENT_BIAS >= 0x7ff){ return inf; }
+
+	decimal_shift(a, 1 + F64_MANTISSA_BITS);
+	u64 mant = decimal_rounded_integer(a);
+	if(mant == (2ull << F64_MANTISSA_BITS)){
+		mant >>= 1;
+		exp += 1;
+		if(exp + F64_EXPONENT_BIAS >= 0x7ff){ return inf; }
+	}
+	/* Subnormal */
+	if((mant & (1ull << F64_MANTISSA_BITS)) == 0){
+		exp = -F64_EXPONENT_BIAS;
+	}
+	return (mant & F64_MANTISSA_MASK) | (u64(exp + F64_EXPONENT_BIAS) << F64_MANTISSA_BITS);
+}
+
+static
+bool eq_ascii_fold(byte const* data, isize len, cstring lower){
+	isize i = 0;
+	for(; i < len && lower[i] != 0; i += 1){
+		if((data[i] | 0x20) != lower[i]){ return false; }
+	}
+	return i == len && lower[i] == 0;
+}
+
+static
+bool parse_f64(String s, f64* out){
+	isize i = 0;
+	bool neg = false;
+	if(s._length > 0 && (s._data[0] == '+' || s._data[0] == '-')){
+		neg = s._data[0] == '-';
+		i += 1;
+	}
+
+	u64 bits;
+	byte const* rest = &s._data[i];
+	if(eq_ascii_fold(rest, s._length - i, "inf") || eq_ascii_fold(rest, s._length - i, "infinity")){
+		bits = (0x7ffull << F64_MANTISSA_BITS) | (neg ? F64_SIGN_BIT : 0);
+		mem::copy(out, &bits, 8);
+		return true;
+	}
+	if(eq_ascii_fold(rest, s._length - i, "nan")){
+		bits = 0x7ff8000000000000ull;
+		mem::copy(out, &bits, 8);
+		return true;
+	}
+
+	/* Up to 19 significant digits go in `w`, the rest only move the exponent */
+	u64 w = 0;
+	i32 digits = 0;
+	i64 exp10 = 0;
+	bool any = false, truncated = false;
+	for(; i < s._length && is_digit(s._data[i]); i += 1){
+		u64 d = s._data[i] - '0';
+		any = true;
+		if(digits == 0 && d == 0){ continue; }
+		if(digits < 19){
+			w = w * 10 + d;
+			digits += 1;
+		}
+		else {
+			exp10 += 1;
+			truncated |= d != 0;
+		}
+	}
+	if(i < s._length && s._data[i] == '.'){
+		for(i += 1; i < s._length && is_digit(s._data[i]); i += 1){
+			u64 d = s._data[i] - '0';
+			any = true;
+			if(digits == 0 && d == 0){
+				exp10 -= 1;
+			}
+			else if(digits < 19){
+				w = w * 10 + d;
+				digits += 1;
+				exp10 -= 1;
+			}
+			else {
+				truncated |= d != 0;
+			}
+		}
+	}
+	if(!any){ return false; }
+
+	if(i < s._length && (s._data[i] | 0x20) == 'e'){
+		i += 1;
+		bool exp_neg = false;
+		if(i < s._length && (s._data[i] == '+' || s._data[i] == '-')){
+			exp_neg = s._data[i] == '-';
+			i += 1;
+		}
+		if(i == s._length){ return false; }
+		i64 e = 0;
+		for(; i < s._length && is_digit(s._data[i]); i += 1){
+			if(e < 100000){ e = e * 10 + (s._data[i] - '0'); }
+		}
+		exp10 += exp_neg ? -e : e;
+	}
+	if(i != s._length){ return false; }
+
+	f64 v;
+	if(w == 0 || exp10 < POW10_MIN){
+		v = 0.0;
+	}
+	else if(exp10 > 308){
+		bits = 0x7ffull << F64_MANTISSA_BITS;
+		mem::copy(&v, &bits, 8);
+	}
+	else if(!truncated && w <= (1ull << 53) && exp10 >= -22 && exp10 <= 22){
+		/* Both are exact, so is the rounded result (Clinger's fast path) */
+		v = f64(w);
+		v = exp10 < 0 ? v / f64_pow10[-exp10] : v * f64_pow10[exp10];
+	}
+	else {
+		f64 upper;
+		bool ok = eisel_lemire(w, i32(exp10), &v);
+		/* Dropped digits are between w and w + 1, both have to agree */
+		if(ok && truncated){
+			ok = eisel_lemire(w + 1, i32(exp10), &upper) && upper == v;
+		}
+		if(!ok){
+			Decimal dec;
+			decimal_from_string(&dec, s);
+			bits = decimal_to_f64_bits(&dec);
+			mem::copy(&v, &bits, 8);
+		}
+	}
+
+	*out = neg ? -v : v;
+	return true;
+}
+} /* Namespace fmt */
+
+bool String::parse_u64(u64* out) const {
+	return fmt::parse_u64(*this, out);
+}
+
+bool String::parse_i64(i64* out) const {
+	return fmt::parse_i64(*this, out);
+}
+
+bool String::parse_f64(f64* out) const {
+	return fmt::parse_f64(*this, out);
+}
+
+//// Owned Strings /////////////////////////////////////////////////////////////
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Str_Buf keeps its tag in the top byte of the heap capacity, which needs a little endian target"
+#endif
+
+void Str_Buf::_set_length(isize length){
+	if(is_small()){
+		_small[length] = 0;
+		_small[SMALL_CAPACITY] = byte(SMALL_CAPACITY - length);
+	}
+	else {
+		_heap._data[length] = 0;
+		_heap._length = length;
+	}
+}
+
+void Str_Buf::_reset(){
+	mem::set(_small, 0, isize(sizeof(_small)));
+	_small[SMALL_CAPACITY] = byte(SMALL_CAPACITY);
+}
+
+void Str_Buf::_free(){
+	if(!is_small()){
+		_allocator.free_ex(_heap._data, capacity() + 1, alignof(byte));
+	}
+	_reset();
+}
+
+bool Str_Buf::reserve(isize nbytes){
+	isize cap = capacity();
+	if(nbytes <= cap){ return true; }
+	if(_allocator._func == nullptr){ return false; }
+	isize new_cap = max<isize>(nbytes, (cap * 7) / 4, 2 * SMALL_CAPACITY);
+	isize len = size();
+	byte* data;
+	if(is_small()){
+		data = (byte*)_allocator.alloc(new_cap + 1, alignof(byte));
+		if(data == nullptr){ return false; }
+		mem::copy_no_overlap(data, _small, len + 1);
+	}
+	else {
+		data = (byte*)_allocator.realloc(_heap._data, cap + 1, new_cap + 1, alignof(byte));
+		if(data == nullptr){ return false; }
+	}
+	_heap._data = data;
+	_heap._length = len;
+	_heap._capacity = new_cap | HEAP_FLAG;
+	return true;
+}
+
+bool Str_Buf::assign(String s){
+	truncate(0);
+	return append(s);
+}
+
+bool Str_Buf::append(String s){
+	isize len = size();
+	byte const* src = s._data;
+	/* Growing moves the contents, so a view of them has to be rebased */
+	uintptr base = uintptr(raw_data());
+	bool self = uintptr(src) >= base && uintptr(src) <= base + uintptr(len);
+	isize self_offset = isize(uintptr(src) - base);
+	if(!reserve(len + s._length)){ return false; }
+	if(self){ src = raw_data() + self_offset; }
+	mem::copy(&raw_data()[len], src, s._length);
+	_set_length(len + s._length);
+	return true;
+}
+
+bool Str_Buf::append_rune(rune r){
+	utf8::Encode_Result enc = utf8::encode(r);
+	return append(String::from_pointer(enc.bytes, enc.len));
+}
+
+void Str_Buf::truncate(isize length){
+	if(length >= 0 && length < size()){
+		_set_length(length);
+	}
+}
+
+//// String Builder ////////////////////////////////////////////////////////////
+bool String_Builder::init(mem::Allocator allocator, isize initial_cap){
+	_allocator = allocator;
+	_length = 0;
+	_data = (byte*)allocator.alloc(initial_cap, alignof(byte));
+	_capacity = initial_cap;
+	return _data != nullptr;
+}
+
+void String_Builder::destroy(){
+	_allocator.free_ex(_data, _capacity, alignof(byte));
+	_data = nullptr;
+	_length = 0;
+	_capacity = 0;
+}
+
+bool String_Builder::reserve(isize nbytes){
+	if((_length + nbytes) <= _capacity){ return true; }
+	isize new_cap = max<isize>(16, (_capacity * 7) / 4, _length + nbytes);
+	byte* new_data = (byte*)_allocator.realloc(_data, _capacity, new_cap, alignof(byte));
+	if(new_data == nullptr){ return false; }
+	_data = new_data;
+	_capacity = new_cap;
+	return true;
+}
+
+isize String_Builder::append_bytes(byte const* buf, isize nbytes){
+	if(!reserve(nbytes)){ return -1; }
+	mem::copy(&_data[_length], buf, nbytes);
+	_length += nbytes;
+	return nbytes;
+}
+
+isize String_Builder::append(String s){
+	return append_bytes(s._data, s._length);
+}
+
+isize String_Builder::append_rune(rune r){
+	utf8::Encode_Result enc = utf8::encode(r);
+	return append_bytes(enc.bytes, enc.len);
+}
+
+String String_Builder::as_string() const {
+	return String::from_pointer(_data, _length);
+}
+
+String String_Builder::build(){
+	_allocator.resize(_data, _length);
+	String s = String::from_pointer(_data, _length);
+	_data = nullptr;
+	_length = 0;
+	_capacity = 0;
+	return s;
+}
+
+void String_Builder::clear(){
+	_length = 0;
+}
+
+//// Chunk Builder /////////////////////////////////////////////////////////////
+Builder_Chunk* Chunk_Builder::_new_chunk(){
+	Builder_Chunk* c = (Builder_Chunk*)_allocator.alloc(isize(sizeof(Builder_Chunk)) + _chunk_size, alignof(Builder_Chunk));
+	if(c == nullptr){ return nullptr; }
+	c->_next = nullptr;
+	c->_length = 0;
+	c->_capacity = _chunk_size;
+	return c;
+}
+
+bool Chunk_Builder::init(mem::Allocator allocator, isize chunk_size){
+	debug_assert(chunk_size > 0, "Chunk size must be positive");
+	*this = Chunk_Builder{};
+	_allocator = allocator;
+	/* Whole chunk allocations stay a multiple of their alignment */
+	_chunk_size = isize(mem::align_forward_size(chunk_size, alignof(Builder_Chunk)));
+	_head = _new_chunk();
+	_tail = _head;
+	return _head != nullptr;
+}
+
+bool Chunk_Builder::init(mem::Allocator allocator, isize chunk_size, io::Stream s){
+	bool ok = init(allocator, chunk_size);
+	_stream = s;
+	return ok;
+}
+
+void Chunk_Builder::destroy(){
+	Builder_Chunk* c = _head;
+	while(c != nullptr){
+		Builder_Chunk* next = c->_next;
+		_allocator.free_ex(c, isize(sizeof(Builder_Chunk)) + c->_capacity, alignof(Builder_Chunk));
+		c = next;
+	}
+	_head = nullptr;
+	_tail = nullptr;
+	_length = 0;
+}
+
+void Chunk_Builder::_write(byte const* data, isize len){
+	while(len > 0 && _error == 0){
+		i64 n = _stream.write(Slice<byte>::from_pointer((byte*)data, len));
+		if(n <= 0){
+			_error = n < 0 ? n : i64(io::Stream_Error::Broken_Handle);
+			return;
+		}
+		_written += n;
+		data += n;
+		len -= n;
+	}
+}
+
+/* Write the chunks up to the tail and empty them */
+void Chunk_Builder::_spill(){
+	for(Builder_Chunk* c = _head; c != nullptr && c->_length > 0; c = c->_next){
+		_write(c->data(), c->_length);
+		c->_length = 0;
+		if(c == _tail){ break; }
+	}
+	_tail = _head;
+	_length = 0;
 }
 
-utf8::Iterator String::iterator_reversed(){
-	return {
-		.data = Slice<byte>::from_pointer((byte*)_data, _length),
-		.current = _length,
+/* Move on to the next chunk after the tail filled up */
+bool Chunk_Builder::_next_chunk(){
+	if(_stream._func != nullptr){
+		_spill();
+		return _error == 0;
+	}
+	if(_tail->_next == nullptr){
+		_tail->_next = _new_chunk();
+		if(_tail->_next == nullptr){ return false; }
+	}
+	_tail = _tail->_next;
+	return true;
+}
+
+isize Chunk_Builder::append_bytes(byte const* buf, isize nbytes){
+	if(_error != 0 || _tail == nullptr){ return -1; }
+	if(_stream._func != nullptr && nbytes >= _chunk_size){
+		/* Would only go through the chunk to be written right away */
+		_spill();
+		_write(buf, nbytes);
+		return _error == 0 ? nbytes : -1;
+	}
+	isize done = 0;
+	while(done < nbytes){
+		Builder_Chunk* c = _tail;
+		if(c->_length == c->_capacity){
+			if(!_next_chunk()){ return -1; }
+			c = _tail;
+		}
+		isize n = min(nbytes - done, c->_capacity - c->_length);
+		mem::copy(&c->data()[c->_length], &buf[done], n);
+		c->_length += n;
+		_length += n;
+		done += n;
+	}
+	return nbytes;
+}
+
+isize Chunk_Builder::append(String s){
+	return append_bytes(s._data, s._length);
+}
+
+isize Chunk_Builder::append_rune(rune r){
+	utf8::Encode_Result enc = utf8::encode(r);
+	return append_bytes(enc.bytes, enc.len);
+}
+
+i64 Chunk_Builder::flush(){
+	if(_stream._func == nullptr){ return i64(io::Stream_Error::Unsupported); }
+	if(_error == 0){ _spill(); }
+	return _error != 0 ? _error : _written;
+}
+
+String Chunk_Builder::build(){
+	byte* data = (byte*)_allocator.alloc(_length, alignof(byte));
+	if(data == nullptr){ return String{}; }
+	isize n = 0;
+	for(Builder_Chunk* c = _head; c != nullptr; c = c->_next){
+		mem::copy(&data[n], c->data(), c->_length);
+		n += c->_length;
+		if(c == _tail){ break; }
+	}
+	clear();
+	return String::from_pointer(data, n);
+}
+
+void Chunk_Builder::clear(){
+	for(Builder_Chunk* c = _head; c != nullptr; c = c->_next){
+		c->_length = 0;
+	}
+	_tail = _head;
+	_length = 0;
+}
+
+//// Rope //////////////////////////////////////////////////////////////////////
+/* Concatenation is AVL join: descend the spine of the taller tree until the
+ * heights are within one, link there and rotate on the way back up. Every
+ * operation copies the nodes on the paths it touches and shares the rest. */
+/* Runes started in a piece of UTF-8, counting non-continuation bytes */
+static
+isize rope_count_starts(byte const* data, isize len){
+	isize count = 0, i = 0;
+	for(; i + 8 <= len; i += 8){
+		u64 x;
+		mem::copy_no_overlap(&x, &data[i], 8);
+		/* Continuation bytes are the ones with the top bits 10 */
+		u64 cont = (x & ~(x << 1) & 0x8080808080808080ull) >> 7;
+		count += 8 - isize((cont * 0x0101010101010101ull) >> 56);
+	}
+	for(; i < len; i += 1){
+		count += (data[i] & 0xc0) != 0x80;
+	}
+	return count;
+}
+
+static inline
+i32 rope_height(Rope_Node const* n){
+	return n == nullptr ? -1 : n->_height;
+}
+
+static
+Rope_Node const* rope_leaf(mem::Allocator allocator, String s, isize runes){
+	Rope_Node* n = make<Rope_Node>(allocator);
+	if(n == nullptr){ return nullptr; }
+	n->_leaf = s;
+	n->_length = s._length;
+	n->_runes = runes;
+	return n;
+}
+
+static
+Rope_Node const* rope_node(mem::Allocator allocator, Rope_Node const* left, Rope_Node const* right){
+	if(left == nullptr || right == nullptr){ return nullptr; }
+	Rope_Node* n = make<Rope_Node>(allocator);
+	if(n == nullptr){ return nullptr; }
+	n->_left = left;
+	n->_right = right;
+	n->_length = left->_length + right->_length;
+	n->_runes = left->_runes + right->_runes;
+	n->_height = max(left->_height, right->_height) + 1;
+	return n;
+}
+
+/* Node over 2 subtrees whose heights differ by at most 2 */
+static
+Rope_Node const* rope_balance(mem::Allocator allocator, Rope_Node const* a, Rope_Node const* b){
+	if(a == nullptr || b == nullptr){ return nullptr; }
+	if(a->_height > b->_height + 1){
+		if(rope_height(a->_left) >= rope_height(a->_right)){
+			return rope_node(allocator, a->_left, rope_node(allocator, a->_right, b));
+		}
+		Rope_Node const* m = a->_right;
+		return rope_node(allocator,
+			rope_node(allocator, a->_left, m->_left),
+			rope_node(allocator, m->_right, b));
+	}
+	if(b->_height > a->_height + 1){
+		if(rope_height(b->_right) >= rope_height(b->_left)){
+			return rope_node(allocator, rope_node(allocator, a, b->_left), b->_right);
+		}
+		Rope_Node const* m = b->_left;
+		return rope_node(allocator,
+			rope_node(allocator, a, m->_left),
+			rope_node(allocator, m->_right, b->_right));
+	}
+	return rope_node(allocator, a, b);
+}
+
+/* Join 2 trees, `ok` is cleared if an allocation fails */
+static
+Rope_Node const* rope_join(mem::Allocator allocator, Rope_Node const* a, Rope_Node const* b, bool* ok){
+	if(a == nullptr){ return b; }
+	if(b == nullptr){ return a; }
+
+	if(a->_height == 0 && b->_height == 0 && a->_length + b->_length <= ROPE_LEAF_MERGE){
+		byte* data = (byte*)allocator.alloc(a->_length + b->_length, alignof(byte));
+		if(data == nullptr){
+			*ok = false;
+			return nullptr;
+		}
+		mem::copy(data, a->_leaf._data, a->_length);
+		mem::copy(&data[a->_length], b->_leaf._data, b->_length);
+		Rope_Node const* n = rope_leaf(allocator, String::from_pointer(data, a->_length + b->_length), a->_runes + b->_runes);
+		*ok = *ok && n != nullptr;
+		return n;
+	}
+
+	Rope_Node const* n;
+	if(a->_height > b->_height + 1){
+		Rope_Node const* right = rope_join(allocator, a->_right, b, ok);
+		n = *ok ? rope_balance(allocator, a->_left, right) : nullptr;
+	}
+	else if(b->_height > a->_height + 1){
+		Rope_Node const* left = rope_join(allocator, a, b->_left, ok);
+		n = *ok ? rope_balance(allocator, left, b->_right) : nullptr;
+	}
+	else {
+		n = rope_node(allocator, a, b);
+	}
+	*ok = *ok && n != nullptr;
+	return n;
+}
+
+/* Bytes [start, end) of a tree, which has to overlap the range */
+static
+Rope_Node const* rope_slice(mem::Allocator allocator, Rope_Node const* n, isize start, isize end, bool* ok){
+	if(!*ok){ return nullptr; }
+	if(start <= 0 && end >= n->_length){ return n; }
+	if(n->_height == 0){
+		isize from = max<isize>(start, 0);
+		String s = String::from_pointer(&n->_leaf._data[from], min(end, n->_length) - from);
+		Rope_Node const* leaf = rope_leaf(allocator, s, rope_count_starts(s._data, s._length));
+		*ok = leaf != nullptr;
+		return leaf;
+	}
+	isize split = n->_left->_length;
+	if(end <= split){ return rope_slice(allocator, n->_left, start, end, ok); }
+	if(start >= split){ return rope_slice(allocator, n->_right, start - split, end - split, ok); }
+	Rope_Node const* left = rope_slice(allocator, n->_left, start, split, ok);
+	Rope_Node const* right = rope_slice(allocator, n->_right, 0, end - split, ok);
+	return *ok ? rope_join(allocator, left, right, ok) : nullptr;
+}
+
+bool Rope::init(mem::Allocator allocator, String s){
+	_allocator = allocator;
+	_root = nullptr;
+	if(s._length == 0){ return true; }
+	_root = rope_leaf(allocator, s, rope_count_starts(s._data, s._length));
+	return _root != nullptr;
+}
+
+bool Rope::concat(Rope* out, Rope other) const {
+	bool ok = true;
+	Rope_Node const* root = rope_join(_allocator, _root, other._root, &ok);
+	if(!ok){ return false; }
+	out->_root = root;
+	out->_allocator = _allocator;
+	return true;
+}
+
+bool Rope::sub(Rope* out, isize start, isize length) const {
+	isize len = size();
+	start = clamp<isize>(0, start, len);
+	isize end = start + clamp<isize>(0, length, len - start);
+	if(start == end){
+		out->_root = nullptr;
+		out->_allocator = _allocator;
+		return true;
+	}
+	bool ok = true;
+	Rope_Node const* root = rope_slice(_allocator, _root, start, end, &ok);
+	if(!ok){ return false; }
+	out->_root = root;
+	out->_allocator = _allocator;
+	return true;
+}
+
+bool Rope::sub_runes(Rope* out, isize start, isize count) const {
+	if(start < 0 || count < 0){
+		return sub(out, 0, 0);
+	}
+	isize begin = rune_offset(start);
+	isize end = rune_offset(start + count);
+	return sub(out, begin, end - begin);
+}
+
+isize Rope::size() const {
+	return _root == nullptr ? 0 : _root->_length;
+}
+
+isize Rope::rune_count() const {
+	return _root == nullptr ? 0 : _root->_runes;
+}
+
+byte Rope::byte_at(isize offset) const {
+	bounds_check_assert(offset >= 0 && offset < size(), "Rope offset out of bounds");
+	Rope_Node const* n = _root;
+	while(n->_height > 0){
+		if(offset < n->_left->_length){
+			n = n->_left;
+		}
+		else {
+			offset -= n->_left->_length;
+			n = n->_right;
+		}
+	}
+	return n->_leaf._data[offset];
+}
+
+isize Rope::rune_offset(isize n) const {
+	if(n < 0){ return 0; }
+	if(n >= rune_count()){ return size(); }
+	Rope_Node const* node = _root;
+	isize base = 0;
+	while(node->_height > 0){
+		if(n < node->_left->_runes){
+			node = node->_left;
+		}
+		else {
+			n -= node->_left->_runes;
+			base += node->_left->_length;
+			node = node->_right;
+		}
+	}
+	/* Skip to the n-th rune start in the leaf, past any continuation bytes
+	 * left over from the previous leaf */
+	byte const* data = node->_leaf._data;
+	isize i = 0;
+	for(;; i += 1){
+		if((data[i] & 0xc0) != 0x80){
+			if(n == 0){ break; }
+			n -= 1;
+		}
+	}
+	return base + i;
+}
+
+rune Rope::rune_at(isize n) const {
+	if(n < 0 || n >= rune_count()){ return utf8::ERROR; }
+	isize offset = rune_offset(n);
+	isize len = size();
+	byte buf[4];
+	isize count = 0;
+	for(; count < 4 && offset + count < len; count += 1){
+		buf[count] = byte_at(offset + count);
+		if(count > 0 && (buf[count] & 0xc0) != 0x80){ break; }
+	}
+	utf8::Decode_Result res = utf8::decode(Slice<byte>::from_pointer(buf, count));
+	return res.len > 0 ? res.codepoint : utf8::ERROR;
+}
+
+isize Rope::flatten(String_Builder* sb) const {
+	isize len = size();
+	if(!sb->reserve(len)){ return -1; }
+	Rope_Iterator it = leaves();
+	for(String leaf; it.next(&leaf);){
+		mem::copy(&sb->_data[sb->_length], leaf._data, leaf._length);
+		sb->_length += leaf._length;
+	}
+	return len;
+}
+
+Rope_Iterator Rope::leaves() const {
+	Rope_Iterator it;
+	it._depth = 0;
+	if(_root != nullptr){
+		it._stack[it._depth++] = _root;
+	}
+	return it;
+}
+
+bool Rope_Iterator::next(String* leaf){
+	while(_depth > 0){
+		Rope_Node const* n = _stack[--_depth];
+		if(n->_height == 0){
+			*leaf = n->_leaf;
+			return true;
+		}
+		_stack[_depth++] = n->_right;
+		_stack[_depth++] = n->_left;
+	}
+	return false;
+}
+
+//// Buffered IO ///////////////////////////////////////////////////////////////
+bool Buffered_Reader::init(mem::Allocator allocator, isize size, io::Stream source){
+	debug_assert(size > 0, "Buffer size must be positive");
+	byte* buf = (byte*)allocator.alloc(size, alignof(byte));
+	init(Slice<byte>::from_pointer(buf, buf == nullptr ? 0 : size), source);
+	_allocator = allocator;
+	return buf != nullptr;
+}
+
+void Buffered_Reader::init(Slice<byte> buffer, io::Stream source){
+	*this = Buffered_Reader{};
+	_source = source;
+	_buf = buffer.raw_data();
+	_capacity = buffer.size();
+	if(_buf == nullptr){ _error = i64(io::Stream_Error::Memory_Error); }
+}
+
+void Buffered_Reader::destroy(){
+	if(_allocator._func != nullptr && _buf != nullptr){
+		_allocator.free_ex(_buf, _capacity, alignof(byte));
+	}
+	_buf = nullptr;
+	_capacity = 0;
+	_start = 0;
+	_end = 0;
+}
+
+/* Move the unread bytes to the front and do one read from the source into the
+ * free space after them */
+void Buffered_Reader::_fill(){
+	if(_start > 0){
+		mem::copy(_buf, &_buf[_start], _end - _start);
+		_end -= _start;
+		_start = 0;
+	}
+	if(_error != 0 || _end == _capacity){ return; }
+	i64 n = _source.read(Slice<byte>::from_pointer(&_buf[_end], _capacity - _end));
+	if(n <= 0){
+		_error = n < 0 ? n : i64(io::Stream_Error::End_Of_Stream);
+		return;
+	}
+	_end += n;
+}
+
+i64 Buffered_Reader::read(Slice<byte> buf){
+	if(buf.size() <= 0){ return 0; }
+	if(_start == _end){
+		if(_error != 0){ return _error; }
+		if(buf.size() >= _capacity){
+			/* Would only go through the buffer to be copied out right away */
+			i64 n = _source.read(buf);
+			if(n <= 0){
+				_error = n < 0 ? n : i64(io::Stream_Error::End_Of_Stream);
+				return _error;
+			}
+			return n;
+		}
+		_fill();
+		if(_start == _end){ return _error; }
+	}
+	isize n = min(buf.size(), _end - _start);
+	mem::copy(buf.raw_data(), &_buf[_start], n);
+	_start += n;
+	return n;
+}
+
+String Buffered_Reader::peek(isize n){
+	n = min(max(n, isize(0)), _capacity);
+	while(_end - _start < n && _error == 0){
+		_fill();
+	}
+	return String::from_pointer(&_buf[_start], min(n, _end - _start));
+}
+
+i64 Buffered_Reader::read_until(byte delim, String* out){
+	/* Bytes after _start that are known not to hold the delimiter */
+	isize scanned = 0;
+	for(;;){
+		isize pos = mem::find_byte(&_buf[_start + scanned], delim, _end - _start - scanned);
+		if(pos >= 0){
+			isize len = scanned + pos + 1;
+			*out = String::from_pointer(&_buf[_start], len);
+			_start += len;
+			return len;
+		}
+		scanned = _end - _start;
+		if(scanned == _capacity || _error != 0){ break; }
+		_fill();
+	}
+	*out = String::from_pointer(&_buf[_start], scanned);
+	_start = _end;
+	return scanned > 0 ? scanned : _error;
+}
+
+i64 Buffered_Reader::read_until(byte delim, String_Builder* sb){
+	i64 total = 0;
+	for(;;){
+		String part;
+		i64 n = read_until(delim, &part);
+		if(n < 0){
+			/* Report what was read, the error comes back on the next call */
+			return total > 0 ? total : n;
+		}
+		if(sb->append_bytes(part._data, part._length) < 0){ return i64(io::Stream_Error::Memory_Error); }
+		total += n;
+		if(part._data[part._length - 1] == delim){ return total; }
+	}
+}
+
+static
+i64 buffered_reader_stream_func(void* impl, io::Stream_Op op, Slice<byte> buf){
+	switch(op){
+	case io::Stream_Op::Query: return i64(io::Stream_Capability::Read);
+	case io::Stream_Op::Read: return ((Buffered_Reader*)impl)->read(buf);
+	default: return i64(io::Stream_Error::Unsupported);
+	}
+}
+
+io::Stream Buffered_Reader::stream(){
+	io::Stream s;
+	s._data = this;
+	s._func = buffered_reader_stream_func;
+	return s;
+}
+
+bool Buffered_Writer::init(mem::Allocator allocator, isize size, io::Stream sink){
+	debug_assert(size > 0, "Buffer size must be positive");
+	byte* buf = (byte*)allocator.alloc(size, alignof(byte));
+	init(Slice<byte>::from_pointer(buf, buf == nullptr ? 0 : size), sink);
+	_allocator = allocator;
+	return buf != nullptr;
+}
+
+void Buffered_Writer::init(Slice<byte> buffer, io::Stream sink){
+	*this = Buffered_Writer{};
+	_sink = sink;
+	_buf = buffer.raw_data();
+	_capacity = buffer.size();
+	if(_buf == nullptr){ _error = i64(io::Stream_Error::Memory_Error); }
+}
+
+void Buffered_Writer::destroy(){
+	if(_allocator._func != nullptr && _buf != nullptr){
+		_allocator.free_ex(_buf, _capacity, alignof(byte));
+	}
+	_buf = nullptr;
+	_capacity = 0;
+	_length = 0;
+}
+
+void Buffered_Writer::_send(byte const* data, isize len){
+	while(len > 0 && _error == 0){
+		i64 n = _sink.write(Slice<byte>::from_pointer((byte*)data, len));
+		if(n <= 0){
+			_error = n < 0 ? n : i64(io::Stream_Error::Broken_Handle);
+			return;
+		}
+		_written += n;
+		data += n;
+		len -= n;
+	}
+}
+
+i64 Buffered_Writer::write(Slice<byte> buf){
+	byte const* data = buf.raw_data();
+	isize len = buf.size();
+	isize done = 0;
+	while(len - done > _capacity - _length && _error == 0){
+		if(_length == 0){
+			/* Would only go through the buffer to be written right away */
+			_send(&data[done], len - done);
+			done = len;
+			break;
+		}
+		isize n = _capacity - _length;
+		mem::copy(&_buf[_length], &data[done], n);
+		_send(_buf, _capacity);
+		_length = 0;
+		done += n;
+	}
+	if(_error != 0){ return _error; }
+	mem::copy(&_buf[_length], &data[done], len - done);
+	_length += len - done;
+	return len;
+}
+
+i64 Buffered_Writer::flush(){
+	if(_error == 0){
+		_send(_buf, _length);
+		_length = 0;
+	}
+	return _error != 0 ? _error : _written;
+}
+
+static
+i64 buffered_writer_stream_func(void* impl, io::Stream_Op op, Slice<byte> buf){
+	switch(op){
+	case io::Stream_Op::Query: return i64(io::Stream_Capability::Write);
+	case io::Stream_Op::Write: return ((Buffered_Writer*)impl)->write(buf);
+	default: return i64(io::Stream_Error::Unsupported);
+	}
+}
+
+io::Stream Buffered_Writer::stream(){
+	io::Stream s;
+	s._data = this;
+	s._func = buffered_writer_stream_func;
+	return s;
+}
+
+//// Format ////////////////////////////////////////////////////////////////////
+/* Builder writers borrow the builder's buffer as their window and only touch
+ * the builder itself when it has to grow and on flush. Stream writers send
+ * the window to the stream whenever it fills up. */
+namespace fmt {
+Writer Writer::from_builder(String_Builder* sb){
+	Writer w = {};
+	w._builder = sb;
+	w._buf = sb->_data;
+	w._length = sb->_length;
+	w._capacity = sb->_capacity;
+	return w;
+}
+
+Writer Writer::from_stream(io::Stream s, Slice<byte> buf){
+	debug_assert(buf.size() >= F64_SIZE, "Format buffer is too small");
+	Writer w = {};
+	w._stream = s;
+	w._buf = buf.raw_data();
+	w._capacity = buf.size();
+	return w;
+}
+
+static
+void stream_out(Writer* w, byte const* data, isize len){
+	while(len > 0 && w->_error == 0){
+		i64 n = w->_stream.write(Slice<byte>::from_pointer((byte*)data, len));
+		if(n <= 0){
+			w->_error = n < 0 ? n : i64(io::Stream_Error::Broken_Handle);
+			return;
+		}
+		w->_written += n;
+		data += n;
+		len -= n;
+	}
+}
+
+i64 Writer::flush(){
+	if(_builder != nullptr){
+		_written += _length - _builder->_length;
+		_builder->_length = _length;
+	}
+	else {
+		stream_out(this, _buf, _length);
+		_length = 0;
+	}
+	return _error != 0 ? _error : _written;
+}
+
+bool Writer::_make_room(isize len){
+	if(_error != 0){ return false; }
+	flush();
+	if(_builder != nullptr){
+		if(!_builder->reserve(len)){
+			_error = i64(io::Stream_Error::Memory_Error);
+			return false;
+		}
+		_buf = _builder->_data;
+		_capacity = _builder->_capacity;
+		return true;
+	}
+	return _error == 0 && len <= _capacity;
+}
+
+void Writer::_write_slow(byte const* data, isize len){
+	if(_builder == nullptr && _error == 0){
+		/* Too big for the buffer, goes straight to the stream */
+		flush();
+		if(len >= _capacity){
+			stream_out(this, data, len);
+			return;
+		}
+	}
+	if(!_make_room(len)){ return; }
+	mem::copy(&_buf[_length], data, len);
+	_length += len;
+}
+
+void format_value(Writer& w, String s){
+	w.write(s);
+}
+
+void format_value(Writer& w, cstring s){
+	if(s != nullptr){ w.write((byte const*)s, cstring_len(s)); }
+}
+
+void format_value(Writer& w, bool v){
+	if(v){ w.write((byte const*)"true", 4); }
+	else { w.write((byte const*)"false", 5); }
+}
+} /* Namespace fmt */
+
+//// Files /////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+// <unistd.h> collides with namespace sync (see Atomic), declare what is used here
+extern "C" ssize_t read(int fd, void* buf, size_t count);
+extern "C" ssize_t write(int fd, void const* buf, size_t count);
+extern "C" ssize_t pread(int fd, void* buf, size_t count, off_t offset);
+extern "C" ssize_t pwrite(int fd, void const* buf, size_t count, off_t offset);
+extern "C" int close(int fd);
+
+static_assert(sizeof(Slice<byte>) == sizeof(struct iovec) &&
+	offsetof(Slice<byte>, _data) == offsetof(struct iovec, iov_base) &&
+	offsetof(Slice<byte>, _length) == offsetof(struct iovec, iov_len), "Byte slices must match struct iovec");
+
+namespace io {
+static
+i64 file_error(int err){
+	switch(err){
+	case ENOMEM: return i64(Stream_Error::Memory_Error);
+	case EINVAL: case ESPIPE: return i64(Stream_Error::Unsupported);
+	default: return i64(Stream_Error::Broken_Handle);
+	}
+}
+
+/* Result of a read(2)-like call, 0 bytes for a non-empty read is the end */
+static
+i64 file_read_result(ssize_t n, isize buflen){
+	if(n < 0){ return file_error(errno); }
+	if(n == 0 && buflen > 0){ return i64(Stream_Error::End_Of_Stream); }
+	return n;
+}
+
+static
+i64 file_write_result(ssize_t n){
+	return n < 0 ? file_error(errno) : n;
+}
+
+static
+bool has_mode(u32 mode, File_Mode flag){
+	return (mode & u32(flag)) != 0;
+}
+
+bool File::open(String path, u32 mode){
+	_fd = -1;
+	_mode = mode;
+	char cpath[FILE_PATH_MAX];
+	if(path._length >= FILE_PATH_MAX){ return false; }
+	mem::copy_no_overlap(cpath, path._data, path._length);
+	cpath[path._length] = 0;
+
+	int flags = O_CLOEXEC;
+	if(has_mode(mode, File_Mode::Read) && has_mode(mode, File_Mode::Write)){ flags |= O_RDWR; }
+	else if(has_mode(mode, File_Mode::Write)){ flags |= O_WRONLY; }
+	else { flags |= O_RDONLY; }
+	if(has_mode(mode, File_Mode::Create)){ flags |= O_CREAT; }
+	if(has_mode(mode, File_Mode::Truncate)){ flags |= O_TRUNC; }
+	if(has_mode(mode, File_Mode::Append)){ flags |= O_APPEND; }
+	if(has_mode(mode, File_Mode::Exclusive)){ flags |= O_EXCL; }
+
+	int fd;
+	do { fd = ::open(cpath, flags, 0666); } while(fd < 0 && errno == EINTR);
+	_fd = fd;
+	return fd >= 0;
+}
+
+File File::from_fd(i32 fd, u32 mode){
+	File f;
+	f._fd = fd;
+	f._mode = mode;
+	return f;
+}
+
+bool File::close(){
+	if(_fd < 0){ return false; }
+	/* The descriptor is released even if close() is interrupted */
+	bool ok = ::close(_fd) == 0 || errno == EINTR;
+	_fd = -1;
+	return ok;
+}
+
+i64 File::read(Slice<byte> buf){
+	ssize_t n;
+	do { n = ::read(_fd, buf.raw_data(), buf.size()); } while(n < 0 && errno == EINTR);
+	return file_read_result(n, buf.size());
+}
+
+i64 File::write(Slice<byte> buf){
+	ssize_t n;
+	do { n = ::write(_fd, buf.raw_data(), buf.size()); } while(n < 0 && errno == EINTR);
+	return file_write_result(n);
+}
+
+i64 File::read_at(Slice<byte> buf, i64 offset){
+	ssize_t n;
+	do { n = ::pread(_fd, buf.raw_data(), buf.size(), offset); } while(n < 0 && errno == EINTR);
+	return file_read_result(n, buf.size());
+}
+
+i64 File::write_at(Slice<byte> buf, i64 offset){
+	ssize_t n;
+	do { n = ::pwrite(_fd, buf.raw_data(), buf.size(), offset); } while(n < 0 && errno == EINTR);
+	return file_write_result(n);
+}
+
+i64 File::readv(Slice<Slice<byte>> bufs){
+	isize count = min(bufs.size(), FILE_IO_BUFFERS_MAX);
+	isize total = 0;
+	for(isize i = 0; i < count; i++){ total += bufs[i].size(); }
+	ssize_t n;
+	do { n = ::readv(_fd, (struct iovec const*)bufs.raw_data(), int(count)); } while(n < 0 && errno == EINTR);
+	return file_read_result(n, total);
+}
+
+i64 File::writev(Slice<Slice<byte>> bufs){
+	isize count = min(bufs.size(), FILE_IO_BUFFERS_MAX);
+	ssize_t n;
+	do { n = ::writev(_fd, (struct iovec const*)bufs.raw_data(), int(count)); } while(n < 0 && errno == EINTR);
+	return file_write_result(n);
+}
+
+i64 File::size(){
+	struct stat st;
+	if(fstat(_fd, &st) < 0){ return file_error(errno); }
+	return st.st_size;
+}
+
+bool File::advise(i64 offset, i64 len, File_Advice advice){
+	static int const advice_flags[] = {
+		POSIX_FADV_NORMAL,
+		POSIX_FADV_SEQUENTIAL,
+		POSIX_FADV_RANDOM,
+		POSIX_FADV_WILLNEED,
+		POSIX_FADV_DONTNEED,
 	};
+	if(advice > File_Advice::Dont_Need){ return false; }
+	return posix_fadvise(_fd, offset, len, advice_flags[u8(advice)]) == 0;
 }
 
-utf8::Iterator str_iterator_reversed(String s);
+static
+i64 file_stream_func(void* impl, Stream_Op op, Slice<byte> buf){
+	File* f = (File*)impl;
+	switch(op){
+	case Stream_Op::Query:
+		return (has_mode(f->_mode, File_Mode::Read) ? i64(Stream_Capability::Read) : 0) |
+			(has_mode(f->_mode, File_Mode::Write) ? i64(Stream_Capability::Write) : 0);
+	case Stream_Op::Read: return f->read(buf);
+	case Stream_Op::Write: return f->write(buf);
+	default: return i64(Stream_Error::Unsupported);
+	}
+}
 
-isize String::rune_count() const {
+Stream File::stream(){
+	Stream s;
+	s._data = this;
+	s._func = file_stream_func;
+	return s;
+}
+} /* Namespace io */
+#endif
+
+//// Mapped Files //////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+#include <sys/mman.h>
+#include <sys/auxv.h>
+
+namespace io {
+static
+isize mmap_page_size(){
+	return isize(getauxval(AT_PAGESZ));
+}
+
+/* Reserve address space with room for `len` bytes after a huge page boundary,
+ * returns the whole reservation */
+static
+byte* mmap_reserve(isize len, isize* reserved){
+	*reserved = len + MMAP_HUGE_PAGE_SIZE;
+	void* p = mmap(nullptr, *reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return p == MAP_FAILED ? nullptr : (byte*)p;
+}
+
+static
+bool has_mode(u32 mode, Map_Mode flag){
+	return (mode & u32(flag)) != 0;
 }
 
-String String::sub(isize start, isize length);
+bool Mapped_File::map(String path, u32 mode){
+	_data = nullptr;
+	_length = 0;
+	bool shared_write = has_mode(mode, Map_Mode::Write) && !has_mode(mode, Map_Mode::Private);
+	File f;
+	u32 file_mode = u32(File_Mode::Read) | (shared_write ? u32(File_Mode::Write) : 0);
+	if(!f.open(path, file_mode)){ return false; }
+	i64 size = f.size();
+	if(size <= 0){
+		f.close();
+		return size == 0;
+	}
+
+	bool writable = has_mode(mode, Map_Mode::Write) || has_mode(mode, Map_Mode::Private);
+	int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+	int flags = has_mode(mode, Map_Mode::Private) ? MAP_PRIVATE : MAP_SHARED;
+	if(has_mode(mode, Map_Mode::Populate)){ flags |= MAP_POPULATE; }
+
+	/* The kernel only uses huge pages for a range that is aligned to them, so
+	 * the file is mapped over an aligned spot in a bigger reservation and the
+	 * rest of it is given back */
+	byte* reservation = nullptr;
+	isize reserved = 0;
+	byte* at = nullptr;
+	if(has_mode(mode, Map_Mode::Huge_Pages) && size >= MMAP_HUGE_PAGE_SIZE){
+		reservation = mmap_reserve(size, &reserved);
+		if(reservation != nullptr){
+			at = (byte*)mem::align_forward_ptr(uintptr(reservation), MMAP_HUGE_PAGE_SIZE);
+			flags |= MAP_FIXED;
+		}
+	}
+
+	void* p = mmap(at, size, prot, flags, f._fd, 0);
+	f.close();
+	if(p == MAP_FAILED){
+		if(reservation != nullptr){ munmap(reservation, reserved); }
+		return false;
+	}
+
+	if(reservation != nullptr){
+		byte* end = at + mem::align_forward_size(size, mmap_page_size());
+		if(at > reservation){ munmap(reservation, at - reservation); }
+		if(end < reservation + reserved){ munmap(end, reservation + reserved - end); }
+		/* Only a hint, file systems that can't do it leave regular pages */
+		madvise(at, size, MADV_HUGEPAGE);
+	}
 
-String String::from_cstr(cstring data){}
+	_data = (byte*)p;
+	_length = size;
+	return true;
+}
 
-String String::from_cstr(cstring data, isize start, isize length);
+bool Mapped_File::advise(isize offset, isize len, File_Advice advice){
+	static int const advice_flags[] = {
+		MADV_NORMAL,
+		MADV_SEQUENTIAL,
+		MADV_RANDOM,
+		MADV_WILLNEED,
+		MADV_DONTNEED,
+	};
+	if(advice > File_Advice::Dont_Need || offset < 0 || offset > _length){ return false; }
+	if(_data == nullptr){ return true; }
+	isize end = len > 0 ? min(offset + len, _length) : _length;
+	/* The mapping starts on a page, so rounding down stays inside it */
+	isize start = offset & ~(mmap_page_size() - 1);
+	return madvise(&_data[start], end - start, advice_flags[u8(advice)]) == 0;
+}
 
-String String::from_pointer(byte const* data, isize length);
+bool Mapped_File::unmap(){
+	bool ok = _data == nullptr || munmap(_data, _length) == 0;
+	_data = nullptr;
+	_length = 0;
+	return ok;
+}
+} /* Namespace io */
+#endif
@@ -1,10 +1,12 @@
 #pragma once
-// TODO: futex
 
 //// Platform //////////////////////////////////////////////////////////////////
 #if defined(TARGET_OS_LINUX)
 	#define TARGET_OS_NAME "Linux"
 	#define _XOPEN_SOURCE 800
+	#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE
+	#endif
 #elif defined(TARGET_OS_WINDOWS)
 	#define TARGET_OS_NAME "Windows"
 	#define WIN32_LEAN_AND_MEAN
@@ -25,6 +27,8 @@
 
 #include <atomic>
 #include <new>
+#include <type_traits>
+#include <utility>
 
 //// Essentials ////////////////////////////////////////////////////////////////
 #define null NULL
@@ -98,6 +102,25 @@ T clamp(T lo, T x, T hi){
 	return min(max(lo, x), hi);
 }
 
+// Assumed size of a cache line, things that are written by different threads
+// should be at least this far apart to avoid false sharing
+constexpr isize CACHE_LINE_SIZE = 64;
+
+// Wrapper that puts a value in its own cache line(s)
+template<typename T>
+struct alignas(CACHE_LINE_SIZE) Cache_Padded {
+	T value{};
+
+	T& operator*() { return value; }
+	T const& operator*() const { return value; }
+
+	T* operator->() { return &value; }
+	T const* operator->() const { return &value; }
+};
+
+static_assert(sizeof(Cache_Padded<i64>) == CACHE_LINE_SIZE && alignof(Cache_Padded<i64>) == CACHE_LINE_SIZE,
+	"Cache_Padded must occupy exactly one cache line");
+
 static_assert(sizeof(f32) == 4 && sizeof(f64) == 8, "Bad float size");
 static_assert(sizeof(isize) == sizeof(usize), "Mismatched (i/u)size");
 static_assert(sizeof(void(*)(void)) == sizeof(void*), "Function pointers and data pointers must be of the same width");
@@ -111,6 +134,11 @@ struct Source_Location {
     cstring filename;
     cstring caller_name;
     i32 line;
+
+    // Location of the caller when used as a default argument
+    static constexpr Source_Location current(cstring filename = __builtin_FILE(), cstring caller_name = __builtin_FUNCTION(), i32 line = __builtin_LINE()){
+        return Source_Location{filename, caller_name, line};
+    }
 };
 
 #define this_location() this_location_()
@@ -271,14 +299,51 @@ T exchange(volatile Atomic<T> * ptr, T desired, Memory_Order order = Memory_Orde
 }
 
 template <typename T>
-bool compare_exchange_strong(Atomic<T> *ptr, std::atomic<T> *expected, T desired, Memory_Order order = Memory_Order::Seq_Cst, Memory_Order failure_order = Memory_Order::Seq_Cst) {
+bool compare_exchange_strong(Atomic<T> *ptr, T *expected, T desired, Memory_Order order = Memory_Order::Seq_Cst, Memory_Order failure_order = Memory_Order::Seq_Cst) {
   return std::atomic_compare_exchange_strong_explicit(ptr, expected, desired, (std::memory_order)order, (std::memory_order)failure_order);
 }
 template<typename T>
-bool compare_exchange_strong(volatile Atomic<T> * ptr, std::atomic<T> * expected, T desired, Memory_Order order = Memory_Order::Seq_Cst, Memory_Order failure_order = Memory_Order::Seq_Cst){
+bool compare_exchange_strong(volatile Atomic<T> * ptr, T * expected, T desired, Memory_Order order = Memory_Order::Seq_Cst, Memory_Order failure_order = Memory_Order::Seq_Cst){
 	return std::atomic_compare_exchange_strong_explicit(ptr, expected, desired, (std::memory_order)order, (std::memory_order)failure_order);
 }
 
+// Like compare_exchange_strong but may fail spuriously, prefer this one inside retry loops
+template<typename T>
+bool compare_exchange_weak(Atomic<T> * ptr, T * expected, T desired, Memory_Order order = Memory_Order::Seq_Cst, Memory_Order failure_order = Memory_Order::Seq_Cst){
+	return std::atomic_compare_exchange_weak_explicit(ptr, expected, desired, (std::memory_order)order, (std::memory_order)failure_order);
+}
+template<typename T>
+bool compare_exchange_weak(volatile Atomic<T> * ptr, T * expected, T desired, Memory_Order order = Memory_Order::Seq_Cst, Memory_Order failure_order = Memory_Order::Seq_Cst){
+	return std::atomic_compare_exchange_weak_explicit(ptr, expected, desired, (std::memory_order)order, (std::memory_order)failure_order);
+}
+
+// Fetch operations, all of them return the value *before* the operation
+
+template<typename T>
+T fetch_add(volatile Atomic<T> * ptr, T delta, Memory_Order order = Memory_Order::Seq_Cst){
+	return std::atomic_fetch_add_explicit<T>(ptr, delta, (std::memory_order)order);
+}
+
+template<typename T>
+T fetch_sub(volatile Atomic<T> * ptr, T delta, Memory_Order order = Memory_Order::Seq_Cst){
+	return std::atomic_fetch_sub_explicit<T>(ptr, delta, (std::memory_order)order);
+}
+
+template<typename T>
+T fetch_and(volatile Atomic<T> * ptr, T mask, Memory_Order order = Memory_Order::Seq_Cst){
+	return std::atomic_fetch_and_explicit<T>(ptr, mask, (std::memory_order)order);
+}
+
+template<typename T>
+T fetch_or(volatile Atomic<T> * ptr, T mask, Memory_Order order = Memory_Order::Seq_Cst){
+	return std::atomic_fetch_or_explicit<T>(ptr, mask, (std::memory_order)order);
+}
+
+template<typename T>
+T fetch_xor(volatile Atomic<T> * ptr, T mask, Memory_Order order = Memory_Order::Seq_Cst){
+	return std::atomic_fetch_xor_explicit<T>(ptr, mask, (std::memory_order)order);
+}
+
 template<typename T>
 void store(Atomic<T> * ptr, T desired, Memory_Order order = Memory_Order::Seq_Cst){
 	return std::atomic_store_explicit<T>(ptr, desired, (std::memory_order)order);
@@ -296,6 +361,56 @@ template<typename T>
 T load(volatile Atomic<T> const * ptr, Memory_Order order = Memory_Order::Seq_Cst){
 	return std::atomic_load_explicit<T>(ptr, (std::memory_order)order);
 }
+
+// Memory fence between threads
+static inline
+void thread_fence(Memory_Order order){
+	std::atomic_thread_fence((std::memory_order)order);
+}
+
+// Compiler-only fence, between a thread and a signal handler running on it
+static inline
+void signal_fence(Memory_Order order){
+	std::atomic_signal_fence((std::memory_order)order);
+}
+
+// Put thread to sleep while the 32-bit word at addr still holds `expected`,
+// wakeups may be spurious. Only valid within the same process.
+void futex_wait(void const volatile * addr, u32 expected);
+
+// Same as futex_wait, but gives up after `timeout_ns` nanoseconds. Returns
+// false if it timed out.
+bool futex_wait_timeout(void const volatile * addr, u32 expected, i64 timeout_ns);
+
+// Wake up one thread sleeping on addr
+void futex_wake_one(void volatile * addr);
+
+// Wake up all threads sleeping on addr
+void futex_wake_all(void volatile * addr);
+
+// Block until the value of atomic is different from `old`. Only works for
+// 32-bit integers and enums, as that's what the OS can wait on.
+template<typename T>
+void wait(volatile Atomic<T> const * ptr, T old, Memory_Order order = Memory_Order::Seq_Cst){
+	static_assert(sizeof(T) == sizeof(u32) && (std::is_integral<T>::value || std::is_enum<T>::value), "Can only wait on 32-bit integers");
+	while(load(ptr, order) == old){
+		futex_wait(ptr, (u32)old);
+	}
+}
+
+// Wake one thread blocked on wait()
+template<typename T>
+void notify_one(volatile Atomic<T> * ptr){
+	static_assert(sizeof(T) == sizeof(u32), "Can only wait on 32-bit integers");
+	futex_wake_one(ptr);
+}
+
+// Wake all threads blocked on wait()
+template<typename T>
+void notify_all(volatile Atomic<T> * ptr){
+	static_assert(sizeof(T) == sizeof(u32), "Can only wait on 32-bit integers");
+	futex_wake_all(ptr);
+}
 }
 
 //// Sync //////////////////////////////////////////////////////////////////////
@@ -308,16 +423,82 @@ constexpr int SPINLOCK_LOCKED = 1;
 // a thread_local struct.
 struct Spinlock {
 	atomic::Atomic<int> _state{0};
+#ifdef ENABLE_LOCK_PROFILING
+	i64 _acquired_at{0};
+	void* _profile_slot{nullptr};
+
+	// Enter a busy wait loop until spinlock is acquired(locked)
+	void acquire(Source_Location loc = Source_Location::current());
 
+	// Try to lock spinlock, if failed, just move on. Returns if lock was locked.
+	bool try_acquire(Source_Location loc = Source_Location::current());
+#else
 	// Enter a busy wait loop until spinlock is acquired(locked)
 	void acquire();
 
 	// Try to lock spinlock, if failed, just move on. Returns if lock was locked.
 	bool try_acquire();
+#endif
 
 	// Release(unlock) the spinlock
 	void release();
 };
+
+// Opt-in contention profiler for spinlocks, enabled by defining
+// ENABLE_LOCK_PROFILING. Every acquisition is recorded into a buffer owned by
+// the calling thread, keyed by (lock, call site), so the uncontended path only
+// pays for a clock read and a few relaxed stores. When disabled the Spinlock
+// is not instrumented at all and the functions below compile to nothing.
+struct Lock_Profile_Entry {
+	void const* lock;
+	Source_Location location;
+	u64 acquires;  // Successful acquisitions
+	u64 contended; // Acquisitions that had to wait, or failed try_acquire calls
+	u64 spins;     // Busy wait iterations spent waiting for the lock
+	i64 wait_ns;   // Total time spent waiting to acquire
+	i64 hold_ns;   // Total time the lock was held after acquisition
+};
+
+#ifdef ENABLE_LOCK_PROFILING
+// Maximum number of distinct (lock, call site) pairs tracked per thread, extra
+// pairs are counted as dropped.
+constexpr isize LOCK_PROFILE_SLOTS = 256;
+
+// Merge the records of every thread (including finished ones) into `out`,
+// sorted by total wait time, most contended first. Returns the number of
+// entries written. Numbers are approximate while other threads are still
+// taking locks.
+isize lock_profile_collect(Slice<Lock_Profile_Entry> out);
+
+// Print the merged records to stdout
+void lock_profile_report();
+
+// Zero the records of every thread
+void lock_profile_reset();
+#else
+static inline isize lock_profile_collect(Slice<Lock_Profile_Entry>){ return 0; }
+static inline void lock_profile_report(){}
+static inline void lock_profile_reset(){}
+#endif
+
+constexpr isize SHARDED_COUNTER_SLOTS = 64;
+
+// Counter split into per-CPU slots, increments only touch the slot of the CPU
+// the caller is running on so they don't bounce cache lines between cores.
+// Reading has to sum every slot, so it's meant for counters that are written
+// far more often than they are read.
+struct Sharded_Counter {
+	Cache_Padded<atomic::Atomic<i64>> _slots[SHARDED_COUNTER_SLOTS];
+
+	// Add delta to the current CPU's slot
+	void add(i64 delta);
+
+	// Sum of all slots, not a snapshot if there are concurrent writers
+	i64 sum() const;
+
+	// Set all slots back to 0
+	void reset();
+};
 }
 
 //// Memory ////////////////////////////////////////////////////////////////////
@@ -391,6 +572,17 @@ i32 compare(void const * a, void const * b, isize nbytes);
 // to be faster then mem_copy
 void copy_no_overlap(void* dest, void const * src, isize nbytes);
 
+// Offset of the first byte equal to `val`, -1 if there is none. Uses SSE4/AVX2
+// when the CPU has them, like the other byte searches below.
+isize find_byte(void const* p, byte val, isize nbytes);
+
+// Offset of the last byte equal to `val`, -1 if there is none
+isize rfind_byte(void const* p, byte val, isize nbytes);
+
+// Offset of the first byte that is any of the `set_len` bytes in `set`, -1 if
+// there is none
+isize find_any_of(void const* p, byte const* set, isize set_len, isize nbytes);
+
 // Align p to alignment a, this only works if a is a non-zero power of 2
 uintptr align_forward_ptr(uintptr p, uintptr a);
 
@@ -404,9 +596,9 @@ uintptr align_forward_size(isize p, isize a);
 // Allocate one of object of a type using allocator
 template<typename T>
 T* make(mem::Allocator al){
-	T* p = al.alloc(sizeof(T), alignof(T));
+	T* p = (T*)al.alloc(sizeof(T), alignof(T));
 	if(p != nullptr){
-		new (&p) T();
+		new (p) T();
 	}
 	return p;
 }
@@ -414,7 +606,7 @@ T* make(mem::Allocator al){
 // Allocate slice of a type using allocator
 template<typename T>
 Slice<T> make(isize count, mem::Allocator al){
-	T* p = al.alloc(sizeof(T) * count, alignof(T) * count);
+	T* p = (T*)al.alloc(sizeof(T) * count, alignof(T));
 	if(p != nullptr){
 		for(isize i = 0; i < count; i ++){
 			new (&p[i]) T();
@@ -436,11 +628,634 @@ void destroy(Slice<T> s, mem::Allocator al){
 	isize n = s.size();
 	T* ptr = s.raw_data();
 	for(isize i = 0; i < n; i ++){
-		ptr[i]->~T();
+		ptr[i].~T();
 	}
 	al.free(ptr);
 }
 
+//// Epoch Reclamation ///////////////////////////////////////////////////////
+namespace sync {
+// How many retired pointers a participant accumulates before it tries to
+// advance the epoch and free what is safe
+constexpr isize EPOCH_BATCH_SIZE = 64;
+
+struct Epoch_Domain;
+
+// Memory that was unlinked from a shared structure but may still be read
+struct Epoch_Retired {
+	void* ptr;
+	isize size;
+	isize align;
+	mem::Allocator allocator;
+};
+
+// Pointers retired during a particular epoch
+struct Epoch_Limbo {
+	Epoch_Retired* items{nullptr};
+	isize len{0};
+	isize cap{0};
+	u64 epoch{0};
+};
+
+// One per thread (per domain), readers only touch their own participant.
+struct Epoch_Participant {
+	Cache_Padded<atomic::Atomic<u64>> _local_epoch;
+	Epoch_Domain* _domain{nullptr};
+	Epoch_Participant* _next{nullptr};
+	Epoch_Limbo _limbo[3];
+	isize _nesting{0};
+	isize _retired_since_collect{0};
+
+	// Enter a read side critical section, pointers loaded from shared structures
+	// stay valid until exit(). Can be nested.
+	void enter();
+
+	// Leave read side critical section
+	void exit();
+
+	// Hand memory (already unlinked from any shared structure) over to be freed
+	// into `allocator` once no reader can still see it. Returns success status,
+	// it can only fail if the limbo list could not grow.
+	bool retire(void* ptr, isize size, isize align, mem::Allocator allocator);
+
+	// Typed version of retire(), no destructor is run when memory is freed
+	template<typename T>
+	bool retire(T* ptr, mem::Allocator allocator){
+		static_assert(std::is_trivially_destructible<T>::value, "Retired objects must be trivially destructible");
+		return retire((void*)ptr, sizeof(T), alignof(T), allocator);
+	}
+
+	// Try to advance the epoch and free what is safe. Returns number of pointers freed.
+	isize collect();
+
+	// Block until all memory retired by this participant is freed. Must not be
+	// called inside a critical section.
+	void barrier();
+};
+
+// Epoch based memory reclamation: memory retired while some thread may still
+// be reading it is kept in the retiring thread's limbo lists and released in
+// batches once every active thread has moved 2 epochs past it.
+struct Epoch_Domain {
+	Cache_Padded<atomic::Atomic<u64>> _epoch;
+	Spinlock _lock;
+	Epoch_Participant* _participants{nullptr};
+	mem::Allocator _allocator;
+
+	// Initialize domain, allocator is used for participants and their limbo lists
+	void init(mem::Allocator allocator);
+
+	// Register a participant for the calling thread, returns null on failure
+	Epoch_Participant* add_participant();
+
+	// Unregister participant, blocks until all its retired memory can be freed
+	void remove_participant(Epoch_Participant* p);
+
+	// Try to move global epoch forward, fails if some reader is still behind
+	bool try_advance();
+};
+} /* Namespace sync */
+
+//// Channels ////////////////////////////////////////////////////////////////
+namespace sync {
+enum class Channel_Result : u8 {
+	Ok          = 0,
+	Would_Block = 1,
+	Closed      = 2,
+};
+
+// Futex word a blocked thread sleeps on, 0 means not signaled, otherwise it
+// holds (index + 1) of the waiter that got signaled.
+struct Channel_Parker {
+	atomic::Atomic<u32> _state{0};
+};
+
+// Node in a channel's wait list, lives on the blocked thread's stack
+struct Channel_Waiter {
+	Channel_Parker* parker{nullptr};
+	Channel_Waiter* prev{nullptr};
+	Channel_Waiter* next{nullptr};
+	u32 index{0};
+	bool linked{false};
+};
+
+constexpr isize CHANNEL_PENDING_WAKES = 8;
+
+// Part of the channel that does not depend on the element type. All `_`
+// prefixed methods must be called with the lock held.
+struct Channel_Base {
+	Spinlock _lock;
+	Channel_Waiter* _recv_waiters{nullptr};
+	Channel_Waiter* _send_waiters{nullptr};
+	void volatile * _pending_wakes[CHANNEL_PENDING_WAKES];
+	isize _pending_len{0};
+	mem::Allocator _allocator;
+	isize _cap{0};
+	isize _head{0};
+	isize _len{0};
+	u64 _sent{0};
+	u64 _taken{0};
+	bool _unbuffered{false};
+	bool _closed{false};
+
+	// Release lock, then wake the threads signaled while it was held, so they
+	// don't wake up just to spin on it
+	void _unlock();
+
+	void _add_waiter(Channel_Waiter* w, bool sender);
+
+	void _remove_waiter(Channel_Waiter* w, bool sender);
+
+	// Wake the first waiter on one side that was not already signaled by
+	// another channel
+	void _wake_one(bool sender);
+
+	void _wake_all(bool sender);
+
+	// Put current thread to sleep until it's woken up by the other side, the
+	// lock is released while sleeping
+	void _park(Channel_Waiter* w, bool sender);
+
+	// Close channel, blocked senders and receivers wake up. Items already in the
+	// channel can still be received.
+	void close();
+
+	// Is channel closed?
+	bool closed();
+
+	// Number of items currently buffered
+	isize size();
+};
+
+// Go style channel. A capacity of 0 makes it unbuffered: send() only returns
+// once a receiver took the item (or the channel got closed) and try_send()
+// only succeeds if a receiver is already waiting.
+template<typename T>
+struct Channel : Channel_Base {
+	T* _buf{nullptr};
+
+	// Initialize channel with ring storage from allocator. Returns success status.
+	bool init(mem::Allocator allocator, isize capacity){
+		_allocator = allocator;
+		_unbuffered = capacity == 0;
+		_cap = max<isize>(capacity, 1);
+		_buf = (T*)allocator.alloc(sizeof(T) * _cap, alignof(T));
+		return _buf != nullptr;
+	}
+
+	// Destroy channel and the items still inside it, no thread may be using it
+	void destroy(){
+		for(isize i = 0; i < _len; i += 1){
+			_buf[(_head + i) % _cap].~T();
+		}
+		_allocator.free_ex(_buf, sizeof(T) * _cap, alignof(T));
+		_buf = nullptr;
+		_len = 0;
+	}
+
+	void _push(T const& v){
+		new (&_buf[(_head + _len) % _cap]) T(v);
+		_len += 1;
+		_sent += 1;
+		_wake_one(false);
+	}
+
+	void _pop(T* out){
+		T* item = &_buf[_head];
+		*out = static_cast<T&&>(*item);
+		item->~T();
+		_head = (_head + 1) % _cap;
+		_len -= 1;
+		_taken += 1;
+		if(_unbuffered){
+			_wake_all(true);
+		} else {
+			_wake_one(true);
+		}
+	}
+
+	Channel_Result _try_send(T const& v){
+		if(_closed){ return Channel_Result::Closed; }
+		if(_len >= _cap){ return Channel_Result::Would_Block; }
+		if(_unbuffered && _recv_waiters == nullptr){ return Channel_Result::Would_Block; }
+		_push(v);
+		return Channel_Result::Ok;
+	}
+
+	Channel_Result _try_recv(T* out){
+		if(_len == 0){
+			return _closed ? Channel_Result::Closed : Channel_Result::Would_Block;
+		}
+		_pop(out);
+		return Channel_Result::Ok;
+	}
+
+	// Send value, blocking while channel is full. Returns false if channel is closed.
+	bool send(T const& v){
+		Channel_Parker parker;
+		Channel_Waiter w;
+		w.parker = &parker;
+
+		_lock.acquire();
+		for(;;){
+			if(_closed){
+				_unlock();
+				return false;
+			}
+			if(_len < _cap){ break; }
+			_park(&w, true);
+		}
+		_push(v);
+
+		if(_unbuffered){
+			u64 ticket = _sent;
+			while(_taken < ticket && !_closed){
+				_park(&w, true);
+			}
+		}
+		_unlock();
+		return true;
+	}
+
+	// Receive value, blocking while channel is empty. Returns false if channel
+	// is closed and has nothing left.
+	bool recv(T* out){
+		Channel_Parker parker;
+		Channel_Waiter w;
+		w.parker = &parker;
+
+		_lock.acquire();
+		for(;;){
+			if(_len > 0){
+				_pop(out);
+				_unlock();
+				return true;
+			}
+			if(_closed){
+				_unlock();
+				return false;
+			}
+			_park(&w, false);
+		}
+	}
+
+	// Send without blocking
+	Channel_Result try_send(T const& v){
+		_lock.acquire();
+		Channel_Result res = _try_send(v);
+		_unlock();
+		return res;
+	}
+
+	// Receive without blocking
+	Channel_Result try_recv(T* out){
+		_lock.acquire();
+		Channel_Result res = _try_recv(out);
+		_unlock();
+		return res;
+	}
+
+	static Channel_Result _try_send_erased(Channel_Base* c, void* data){
+		return static_cast<Channel<T>*>(c)->_try_send(*(T const*)data);
+	}
+
+	static Channel_Result _try_recv_erased(Channel_Base* c, void* data){
+		return static_cast<Channel<T>*>(c)->_try_recv((T*)data);
+	}
+};
+
+constexpr isize SELECT_MAX_CASES = 32;
+
+// One operation inside a select(), built with select_send() or select_recv()
+struct Select_Case {
+	Channel_Base* channel;
+	void* data;
+	Channel_Result (*try_op)(Channel_Base* c, void* data);
+	bool is_send;
+};
+
+template<typename T>
+Select_Case select_send(Channel<T>* c, T const* value){
+	return Select_Case{ c, (void*)value, Channel<T>::_try_send_erased, true };
+}
+
+template<typename T>
+Select_Case select_recv(Channel<T>* c, T* out){
+	return Select_Case{ c, (void*)out, Channel<T>::_try_recv_erased, false };
+}
+
+// Block until one of the cases goes through, returns its index. Closed
+// channels are skipped, returns -1 if all of them are closed.
+isize select(Slice<Select_Case> cases);
+
+// Same as select() but does not block, returns -1 if no case is ready
+isize try_select(Slice<Select_Case> cases);
+
+template<typename ...Cases>
+isize select(Select_Case first, Cases... rest){
+	Select_Case cases[] = {first, rest...};
+	return select(Slice<Select_Case>::from_pointer(cases, 1 + sizeof...(Cases)));
+}
+} /* Namespace sync */
+
+//// Time //////////////////////////////////////////////////////////////////////
+// Difference between 2 time points (in nanoseconds)
+// Note that a 64bit signed integer can handle around +-292 years.
+using Time_Duration = i64;
+
+// UNIX Epoch scaled to nanosecond precision
+struct Time_Point {
+	i64 _nsec;
+
+	Time_Duration operator-(Time_Point other) const { return _nsec - other._nsec; }
+
+	Time_Point operator+(Time_Duration d) const { return Time_Point{_nsec + d}; }
+
+	bool operator<(Time_Point other) const { return _nsec < other._nsec; }
+};
+
+// Time constants, as a multiple of durations
+constexpr Time_Duration time_nanosecond  = 1ll;
+constexpr Time_Duration time_microsecond = 1000ll;
+constexpr Time_Duration time_millisecond = 1000000ll;
+constexpr Time_Duration time_second      = 1000000000ll;
+constexpr Time_Duration time_minute      = 60ll * 1000000000ll;
+constexpr Time_Duration time_hour        = 3600ll * 1000000000ll;
+
+// Get current system Time_Point
+Time_Point time_now();
+
+// Get current Time_Point of a clock that never jumps, only comparable with
+// other monotonic points. Use it for deadlines and timeouts.
+Time_Point time_monotonic();
+
+// Sleep current thread for a duration
+void time_sleep(Time_Duration d);
+
+// Time since timepoint
+Time_Duration time_since(Time_Point p);
+
+//// Async /////////////////////////////////////////////////////////////////////
+// Coroutine tasks, only available when the compiler has coroutines enabled
+// (-fcoroutines on GCC)
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+
+namespace async {
+struct Executor;
+
+// Executor of the calling thread, null if there is none
+Executor* current_executor();
+
+// Coroutine frames are allocated from the current executor's allocator, the
+// allocator is kept in a small header so the frame is freed into the same one.
+void* _frame_alloc(usize size);
+
+void _frame_free(void* frame, usize size);
+
+struct Promise_Base {
+	std::coroutine_handle<> _continuation{};
+
+	static void* operator new(usize size){ return _frame_alloc(size); }
+
+	static void operator delete(void* frame, usize size){ _frame_free(frame, size); }
+
+	std::suspend_always initial_suspend() noexcept { return {}; }
+
+	struct Final_Awaiter {
+		bool await_ready() noexcept { return false; }
+
+		template<typename P>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+			std::coroutine_handle<> next = h.promise()._continuation;
+			return next ? next : std::noop_coroutine();
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	Final_Awaiter final_suspend() noexcept { return {}; }
+
+	void unhandled_exception(){ panic("Unhandled exception inside task"); }
+};
+
+template<typename T>
+struct Task_Promise : Promise_Base {
+	T _value{};
+
+	void return_value(T v){ _value = static_cast<T&&>(v); }
+
+	T& _result(){ return _value; }
+};
+
+template<>
+struct Task_Promise<void> : Promise_Base {
+	void return_void(){}
+
+	void _result(){}
+};
+
+// Lazy coroutine, it only starts running when awaited (or spawned on an
+// executor), the awaiting coroutine is resumed right after it finishes.
+template<typename T>
+struct Task {
+	struct promise_type : Task_Promise<T> {
+		Task get_return_object(){
+			return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+	};
+
+	std::coroutine_handle<promise_type> _handle{};
+
+	Task() = default;
+
+	explicit Task(std::coroutine_handle<promise_type> h) : _handle{h} {}
+
+	Task(Task const&) = delete;
+
+	Task(Task&& other) : _handle{other._handle} { other._handle = nullptr; }
+
+	Task& operator=(Task&& other){
+		if(this != &other){
+			if(_handle){ _handle.destroy(); }
+			_handle = other._handle;
+			other._handle = nullptr;
+		}
+		return *this;
+	}
+
+	~Task(){
+		if(_handle){ _handle.destroy(); }
+	}
+
+	// Has the task finished running?
+	bool done() const { return !_handle || _handle.done(); }
+
+	// Get the result of a finished task
+	decltype(auto) result(){
+		debug_assert(_handle && _handle.done(), "Task has not finished");
+		return _handle.promise()._result();
+	}
+
+	bool await_ready() const { return done(); }
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting){
+		_handle.promise()._continuation = awaiting;
+		return _handle;
+	}
+
+	decltype(auto) await_resume(){
+		if constexpr (std::is_void<T>::value){
+			return;
+		} else {
+			return static_cast<T&&>(_handle.promise()._value);
+		}
+	}
+};
+
+// Coroutine that owns itself, its frame is released when it finishes
+struct Detached {
+	struct promise_type : Promise_Base {
+		Detached get_return_object(){
+			return Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+
+		std::suspend_never final_suspend() noexcept { return {}; }
+
+		void return_void(){}
+	};
+
+	std::coroutine_handle<promise_type> _handle;
+};
+
+struct Executor_Timer {
+	Time_Point deadline;
+	std::coroutine_handle<> handle;
+};
+
+// Single threaded executor, runs ready coroutines in FIFO order and wakes up
+// sleeping ones when their deadline passes.
+struct Executor {
+	mem::Allocator _allocator;
+	std::coroutine_handle<>* _queue{nullptr};
+	isize _queue_cap{0};
+	isize _queue_head{0};
+	isize _queue_len{0};
+	Executor_Timer* _timers{nullptr};
+	isize _timers_cap{0};
+	isize _timers_len{0};
+	Executor* _previous{nullptr};
+
+	// Initialize executor and make it current for the calling thread, frames,
+	// run queue and timers are allocated from allocator. Returns success status.
+	bool init(mem::Allocator allocator);
+
+	// Destroy executor, restoring the previously current one
+	void destroy();
+
+	// Queue coroutine to be resumed
+	void schedule(std::coroutine_handle<> h);
+
+	// Resume coroutine once deadline (a time_monotonic() point) has passed
+	void schedule_at(Time_Point deadline, std::coroutine_handle<> h);
+
+	// Run task detached, the executor owns it from now on
+	void spawn(Task<void>&& task);
+
+	// Run until there are no ready or sleeping coroutines left
+	void run();
+};
+
+struct Sleep_Awaiter {
+	Time_Duration duration;
+
+	bool await_ready() const { return duration <= 0; }
+
+	void await_suspend(std::coroutine_handle<> h){
+		current_executor()->schedule_at(time_monotonic() + duration, h);
+	}
+
+	void await_resume(){}
+};
+
+// Suspend current coroutine for (at least) duration
+static inline
+Sleep_Awaiter sleep(Time_Duration duration){
+	return Sleep_Awaiter{duration};
+}
+
+struct Yield_Awaiter {
+	bool await_ready() const { return false; }
+
+	void await_suspend(std::coroutine_handle<> h){
+		current_executor()->schedule(h);
+	}
+
+	void await_resume(){}
+};
+
+// Go to the back of the executor's queue
+static inline
+Yield_Awaiter yield(){
+	return Yield_Awaiter{};
+}
+
+struct When_All_State {
+	isize remaining;
+	std::coroutine_handle<> parent;
+};
+
+// Waits for a task without taking its result
+template<typename T>
+struct Task_Join {
+	Task<T>* task;
+
+	bool await_ready() const { return task->done(); }
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> h){ return task->await_suspend(h); }
+
+	void await_resume(){}
+};
+
+template<typename T>
+Detached _when_all_child(Task<T>* task, When_All_State* state){
+	co_await Task_Join<T>{task};
+	state->remaining -= 1;
+	if(state->remaining == 0){
+		current_executor()->schedule(state->parent);
+	}
+}
+
+struct When_All_Awaiter {
+	When_All_State* state;
+	Slice<std::coroutine_handle<>> children;
+
+	bool await_ready() const { return false; }
+
+	void await_suspend(std::coroutine_handle<> h){
+		state->parent = h;
+		for(isize i = 0; i < children.size(); i += 1){
+			current_executor()->schedule(children[i]);
+		}
+	}
+
+	void await_resume(){}
+};
+
+// Run all tasks concurrently and wait for all of them, results are left
+// inside each task and can be read with result()
+template<typename T, typename ...Ts>
+Task<void> when_all(Task<T>& first, Task<Ts>&... rest){
+	When_All_State state{ 1 + (isize)sizeof...(Ts), {} };
+	std::coroutine_handle<> children[] = {
+		_when_all_child(&first, &state)._handle,
+		_when_all_child(&rest, &state)._handle...,
+	};
+	co_await When_All_Awaiter{ &state, Slice<std::coroutine_handle<>>::from_pointer(children, 1 + sizeof...(Ts)) };
+}
+} /* Namespace async */
+#endif
+
 //// UTF-8 /////////////////////////////////////////////////////////////////////
 namespace utf8 {
 
@@ -469,7 +1284,7 @@ constexpr Encode_Result ERROR_ENCODED = {
 Encode_Result encode(rune c);
 
 // Decode a codepoint from a UTF8 buffer of bytes
-Decode_Result utf8_decode(Slice<byte> buf);
+Decode_Result decode(Slice<byte> buf);
 
 // Allows to iterate a stream of bytes as a sequence of runes
 struct Iterator {
@@ -485,9 +1300,68 @@ struct Iterator {
 	bool prev(rune* r, i8* len);
 };
 
+// Check that a buffer is entirely valid UTF-8: no truncated sequences,
+// overlong encodings, surrogates or codepoints past U+10FFFF. Uses SSE4/AVX2
+// when the CPU has them (define DISABLE_SIMD to always use the scalar path).
+bool validate(Slice<byte> buf);
+
+// Decode a buffer into runes, stopping when either the input is consumed or
+// `out` is full. Results are the same as stepping with Iterator::next():
+// invalid bytes become ERROR and are skipped one at a time. Returns the number
+// of runes written, the number of bytes used is stored in `consumed` (may be
+// null). An `out` with as many runes as input bytes always fits.
+isize decode_runes(Slice<rune> out, Slice<byte> buf, isize* consumed = nullptr);
+
+// Get the byte offset after stepping `n` runes (as Iterator::next() would) into
+// the buffer, or its size if it has fewer runes. The number of runes actually
+// stepped over is stored in `skipped` (may be null).
+isize rune_offset(Slice<byte> buf, isize n, isize* skipped = nullptr);
+
+// Transcoding between UTF-8, UTF-16 (native byte order) and UTF-32. Unpaired
+// surrogates and UTF-32 values outside the scalar range become ERROR, as does
+// invalid UTF-8 (one per skipped byte, like Iterator::next()). UTF-8 to UTF-32
+// is decode_runes(), counted by String::rune_count().
+//
+// The to_*_size() functions return the exact output size in units, converting
+// stops when the input is consumed or the next codepoint does not fit in
+// `out`. They return the number of units written and store the number of input
+// units used in `consumed` (may be null). ASCII runs (and surrogate free text
+// between UTF-16 and UTF-32) are done with SSE4 when the CPU has it, so is
+// UTF-8 to UTF-16 for text of any width that validates.
+isize to_utf16_size(Slice<byte> buf);
+isize to_utf16(Slice<u16> out, Slice<byte> buf, isize* consumed = nullptr);
+
+// Simple (one to one) Unicode case folding, runes without a folding are
+// returned as they are. Tables are generated by case-tables.py.
+rune fold(rune r);
+
+// Simple Unicode lowercase mapping
+rune to_lower(rune r);
+
 } /* Namespace utf8 */
 
+namespace utf16 {
+// See utf8::to_utf16()
+isize to_utf8_size(Slice<u16> buf);
+isize to_utf8(Slice<byte> out, Slice<u16> buf, isize* consumed = nullptr);
+
+isize to_utf32_size(Slice<u16> buf);
+isize to_utf32(Slice<rune> out, Slice<u16> buf, isize* consumed = nullptr);
+} /* Namespace utf16 */
+
+namespace utf32 {
+// See utf8::to_utf16()
+isize to_utf8_size(Slice<rune> buf);
+isize to_utf8(Slice<byte> out, Slice<rune> buf, isize* consumed = nullptr);
+
+isize to_utf16_size(Slice<rune> buf);
+isize to_utf16(Slice<u16> out, Slice<rune> buf, isize* consumed = nullptr);
+} /* Namespace utf32 */
+
 //// Strings ///////////////////////////////////////////////////////////////////
+struct Cutset;
+struct String_Splitter;
+
 struct String {
 	byte const * _data;
 	isize _length;
@@ -498,9 +1372,15 @@ struct String {
 	// Size (in codepoints)
 	isize rune_count() const;
 
-	// Create a substring
+	// Byte offset of the n-th codepoint
+	isize rune_offset(isize n) const;
+
+	// Create a substring, `start` and `length` are in bytes
 	String sub(isize start, isize length);
 
+	// Create a substring of `count` codepoints starting at the `start`-th codepoint
+	String sub_runes(isize start, isize count);
+
 	// Create string from C-style string
 	static String from_cstr(cstring data);
 
@@ -516,22 +1396,267 @@ struct String {
 	// Get an utf8 iterator from string, already at the end, to be used for reverse iteration
 	utf8::Iterator iterator_reversed();
 
+	// Trim leading codepoints that belong to the cutset
+	String trim_leading(Cutset const& set);
+
+	// Trim trailing codepoints that belong to the cutset
+	String trim_trailing(Cutset const& set);
+
+	// Trim leading and trailing codepoints that belong to the cutset
+	String trim(Cutset const& set);
+
+	// Byte offset of the first codepoint that belongs to the cutset, -1 if none does
+	isize find_any(Cutset const& set) const;
+
+	// Byte offset of the last codepoint that belongs to the cutset, -1 if none does
+	isize rfind_any(Cutset const& set) const;
+
+	// Split around the first codepoint that belongs to the cutset, which is left
+	// out of both halves. Returns false (and all of the string in `before`) if
+	// none does.
+	bool cut_any(Cutset const& set, String* before, String* after) const;
+
+	// Byte offset of the first occurrence of `pattern`, -1 if there is none. An
+	// empty pattern is found at 0. Linear time even on adversarial input, uses
+	// SSE4/AVX2 when available.
+	isize find(String pattern) const;
+
+	// Byte offset of the last occurrence of `pattern`, -1 if there is none. An
+	// empty pattern is found at the end of the string.
+	isize rfind(String pattern) const;
+
+	// Number of non-overlapping occurrences of `pattern`, 0 for an empty pattern
+	isize count(String pattern) const;
+
+	// Split around every occurrence of a byte, n delimiters give n + 1 tokens
+	// (which may be empty)
+	String_Splitter split(byte delim) const;
+
+	// Split around every occurrence of a string, an empty delimiter gives back
+	// the whole string
+	String_Splitter split(String delim) const;
+
+	// Split around every codepoint that belongs to the cutset, which must
+	// outlive the splitter
+	String_Splitter split_any(Cutset const& set) const;
+
+	// Split into the non-empty runs between ASCII whitespace
+	String_Splitter fields() const;
+
+	// Check if 2 strings are equal ignoring case (simple case folding). Invalid
+	// UTF-8 bytes only match the same byte. ASCII runs are compared with SSE4
+	// when available.
+	bool eq_fold(String other) const;
+
+	// Hash of the case folded string, strings that are equal under eq_fold()
+	// have the same hash. Not suited for untrusted keys, there is no seed.
+	u64 hash_fold() const;
+
+	// Exact size (in bytes) of the lowercase string
+	isize to_lower_size() const;
+
+	// Write the lowercase string to `out`, stopping before a codepoint that does
+	// not fit. Invalid UTF-8 bytes are copied as they are. Returns the number
+	// of bytes written.
+	isize to_lower(Slice<byte> out) const;
+
+	// Parse the whole string as an unsigned decimal integer with an optional
+	// '+'. Returns false on invalid input or overflow, `out` is left untouched.
+	bool parse_u64(u64* out) const;
+
+	// Parse the whole string as a signed decimal integer
+	bool parse_i64(i64* out) const;
+
+	// Parse the whole string as a float: [+-]digits[.digits][(e|E)[+-]digits],
+	// "inf", "infinity" or "nan" (any case). The result is correctly rounded,
+	// no locale is involved and nothing is allocated.
+	bool parse_f64(f64* out) const;
+
+	// Check if 2 strings are equal, comparing a word or vector block at a time
+	bool eq(String other) const;
+
+	// Three-way lexicographic comparison of the bytes (as unsigned), a string
+	// sorts after its prefixes. Returns -1, 0 or 1.
+	i32 compare(String other) const;
+
+	// Three-way comparison by codepoint, decoding like utf8::Iterator::next().
+	// Same order as compare() for valid UTF-8, invalid bytes compare as
+	// utf8::ERROR.
+	i32 compare_runes(String other) const;
+
+	// Length (in bytes) of the longest common prefix, which may end in the
+	// middle of a codepoint
+	isize common_prefix_len(String other) const;
+
 	// Check if 2 strings are equal
-	bool operator==(String lhs) const {
-		if(lhs._length != _length){ return false; }
-		return mem::compare(_data, lhs._data, _length) == 0;
-	}
+	bool operator==(String lhs) const { return eq(lhs); }
+
+	// Byte order, see compare()
+	bool operator<(String lhs) const { return compare(lhs) < 0; }
 };
 
-static inline
-isize cstring_len(cstring cstr){
-	constexpr isize CSTR_MAX_LENGTH = (~(u32)0) >> 1;
-	isize size = 0;
-	for(isize i = 0; i < CSTR_MAX_LENGTH && cstr[i] != 0; i += 1){
-		size += 1;
+// Runes between two entries of a String_Index
+constexpr isize STRING_INDEX_STRIDE = 64;
+
+// Sparse codepoint -> byte offset index of a string, makes codepoint offsets
+// and codepoint based substrings O(1) instead of a walk over the whole string.
+// It keeps one offset per STRING_INDEX_STRIDE codepoints, the string must
+// outlive the index and not change.
+struct String_Index {
+	String _str;
+	isize* _offsets;
+	isize _len;
+	isize _rune_count;
+	mem::Allocator _allocator;
+
+	// Build the index of a string, returns false if allocation fails
+	bool init(String s, mem::Allocator allocator);
+
+	// Free the index
+	void destroy();
+
+	// Number of codepoints in the string
+	isize rune_count() const { return _rune_count; }
+
+	// Byte offset of the n-th codepoint
+	isize offset(isize n) const;
+
+	// Substring of `count` codepoints starting at the `start`-th codepoint
+	String sub(isize start, isize count) const;
+};
+
+// Precompiled set of codepoints for trimming, splitting and searching, meant to
+// be built once and reused. Bytes are first tested against a 256-bit bitmap
+// (ASCII members and lead bytes of the others) with SSE4/AVX2 when available,
+// non-ASCII codepoints are then looked up in a sorted array.
+struct Cutset {
+	byte _bitmap[32];
+	rune* _runes;
+	isize _runes_len;
+	mem::Allocator _allocator;
+
+	// Build a cutset out of every codepoint in `runes`, returns false if
+	// allocation fails. Only non-ASCII codepoints take memory.
+	bool init(String runes, mem::Allocator allocator);
+
+	// Free the cutset
+	void destroy();
+
+	// Check if a codepoint belongs to the cutset
+	bool contains(rune r) const;
+};
+
+enum class Split_Kind : u8 {
+	Byte   = 0,
+	String = 1,
+	Cutset = 2,
+	Fields = 3,
+};
+
+// Lazy splitter, tokens are views into the original string and nothing is
+// allocated. Delimiters are searched with the vector paths of String::find()
+// and the Cutset functions. Works with range-for:
+//   for(String tok : line.split(String::from_cstr(", "))){ ... }
+struct String_Splitter {
+	String _rest;
+	String _delim;
+	Cutset const* _cutset;
+	byte _byte_delim;
+	Split_Kind _kind;
+	bool _done;
+
+	// Get the next token, returns false when there are no more
+	bool next(String* token);
+
+	struct Iterator {
+		String_Splitter* _splitter;
+		String _token;
+		bool _valid;
+
+		String operator*() const { return _token; }
+
+		Iterator& operator++(){
+			_valid = _splitter->next(&_token);
+			return *this;
+		}
+
+		bool operator!=(Iterator const& other) const { return _valid != other._valid; }
+	};
+
+	Iterator begin(){
+		Iterator it = { this, String{}, false };
+		it._valid = next(&it._token);
+		return it;
 	}
-	return size;
-}
+
+	Iterator end(){ return Iterator{ this, String{}, false }; }
+};
+
+struct Pattern_Match {
+	isize pattern; // Index of the pattern that matched
+	isize offset;  // Byte offset of the match from the start of the input
+	isize len;
+};
+
+// Called for every match, return false to stop matching
+using Pattern_Match_Func = bool (*)(void* ctx, Pattern_Match match);
+
+// Set of patterns compiled once (Aho-Corasick) and then matched against any
+// input in a single pass, no matter how many patterns there are. Memory is
+// about 4 bytes per distinct pattern byte for every prefix of every pattern.
+struct Pattern_Set {
+	i32* _delta;
+	i32* _output;
+	i32* _dict;
+	i32* _pattern;
+	isize* _lengths;
+	isize _pattern_count;
+	isize _state_count;
+	isize _class_count;
+	byte _classes[256];
+	mem::Allocator _allocator;
+
+	// Compile a set of patterns, returns false if allocation fails or the
+	// patterns are too big. Empty patterns never match, duplicates report the
+	// first index.
+	bool init(Slice<String> patterns, mem::Allocator allocator);
+
+	// Free the set
+	void destroy();
+
+	// Find the match that ends first (the longest one if several end together),
+	// returns false if nothing matches.
+	bool find(String s, Pattern_Match* match) const;
+
+	// Find every match, including overlapping ones, in order of where they
+	// end. Stores as many as fit in `out` and returns how many there are in total.
+	isize find_all(String s, Slice<Pattern_Match> out) const;
+
+	// Match everything read from a stream, using `buf` as the read buffer.
+	// Returns the number of bytes read or (if negative) an IO error code.
+	i64 match_stream(io::Stream s, Slice<byte> buf, Pattern_Match_Func func, void* ctx) const;
+
+	// Run the automaton from `row` over a chunk that starts `base` bytes into
+	// the input, returns false if `func` stopped matching
+	bool run(i32* row, isize base, String chunk, Pattern_Match_Func func, void* ctx) const;
+};
+
+// Incremental matcher, for input that comes in chunks. Matches can span
+// chunks.
+struct Pattern_Scanner {
+	Pattern_Set const* _set;
+	i32 _row;
+	isize _offset;
+
+	// Start matching a new input
+	void init(Pattern_Set const* set);
+
+	// Match the next chunk of the input, returns false if `func` stopped matching
+	bool feed(String chunk, Pattern_Match_Func func, void* ctx);
+};
+
+// Length of a C string (in bytes), counting stops at 2^31 - 1
+isize cstring_len(cstring cstr);
 
 // // Get the byte offset of the n-th codepoint
 // isize str_codepoint_offset(String s, isize n);
@@ -545,15 +1670,6 @@ isize cstring_len(cstring cstr){
 // // Concatenate 2 strings
 // String str_concat(String a, String b, mem::Allocator allocator);
 //
-// // Trim leading codepoints that belong to the cutset
-// String str_trim_leading(String s, String cutset);
-//
-// // Trim trailing codepoints that belong to the cutset
-// String str_trim_trailing(String s, String cutset);
-//
-// // Trim leading and trailing codepoints
-// String str_trim(String s, String cutset);
-//
 // // Check if string starts with a prefix
 // bool str_starts_with(String s, String prefix);
 //
@@ -561,3 +1677,728 @@ isize cstring_len(cstring cstr){
 // bool str_ends_with(String s, String suffix);
 //
 
+//// Numbers ///////////////////////////////////////////////////////////////////
+// Locale independent number formatting, see also String::parse_u64() and
+// friends for the other direction.
+namespace fmt {
+// Room needed in the output of write_u64() and write_i64()
+constexpr isize INT_SIZE = 20;
+
+// Room needed in the output of write_f64()
+constexpr isize F64_SIZE = 25;
+
+// Write decimal integer to `out`, which must have room for INT_SIZE bytes.
+// Returns the number of bytes written.
+isize write_u64(Slice<byte> out, u64 v);
+
+isize write_i64(Slice<byte> out, i64 v);
+
+// Write the shortest decimal that parses back to the same value (Schubfach
+// algorithm), `out` must have room for F64_SIZE bytes. Uses plain notation for
+// exponents in [-6, 21) and scientific ("1.5e+300") otherwise, like
+// JavaScript. Non finite values are written as "nan", "inf" and "-inf".
+// Returns the number of bytes written.
+isize write_f64(Slice<byte> out, f64 v);
+} /* Namespace fmt */
+
+//// Owned Strings /////////////////////////////////////////////////////////////
+// Owning, growable string. Up to SMALL_CAPACITY bytes (23 on 64-bit targets)
+// are kept inline and never allocate, longer contents live in a buffer from
+// the allocator. Contents are always followed by a 0 byte, so they can be
+// passed to C APIs as they are. Moving transfers the buffer, copies have to be
+// made explicitly with assign().
+//
+// The last inline byte doubles as the tag: SMALL_CAPACITY minus the length for
+// inline strings (0 when full, which is also the terminator), and the top bit
+// of the heap capacity otherwise. This relies on a little endian target.
+struct Str_Buf {
+	struct _Heap {
+		byte* _data;
+		isize _length;
+		isize _capacity; // Includes HEAP_FLAG
+	};
+
+	static constexpr isize SMALL_CAPACITY = isize(sizeof(_Heap)) - 1;
+	static constexpr isize HEAP_FLAG = isize(usize(1) << (sizeof(isize) * 8 - 1));
+
+	union {
+		_Heap _heap;
+		byte _small[sizeof(_Heap)];
+	};
+	mem::Allocator _allocator;
+
+	// Empty string without an allocator, it can only hold short contents
+	Str_Buf() : _small{}, _allocator{} { _small[SMALL_CAPACITY] = byte(SMALL_CAPACITY); }
+
+	// Empty string that grows using an allocator
+	explicit Str_Buf(mem::Allocator allocator) : _small{}, _allocator{allocator} { _small[SMALL_CAPACITY] = byte(SMALL_CAPACITY); }
+
+	Str_Buf(Str_Buf const&) = delete;
+
+	Str_Buf(Str_Buf&& other) : _heap{other._heap}, _allocator{other._allocator} { other._reset(); }
+
+	Str_Buf& operator=(Str_Buf&& other){
+		if(this != &other){
+			_free();
+			_heap = other._heap;
+			_allocator = other._allocator;
+			other._reset();
+		}
+		return *this;
+	}
+
+	~Str_Buf(){ _free(); }
+
+	// Are the contents stored inline?
+	bool is_small() const { return (_small[SMALL_CAPACITY] & 0x80) == 0; }
+
+	// Size (in bytes)
+	isize size() const { return is_small() ? SMALL_CAPACITY - _small[SMALL_CAPACITY] : _heap._length; }
+
+	// Bytes that fit without growing, not counting the terminator
+	isize capacity() const { return is_small() ? SMALL_CAPACITY : _heap._capacity & ~HEAP_FLAG; }
+
+	// Pointer to the (0 terminated) contents, invalidated when the string grows
+	byte* raw_data(){ return is_small() ? _small : _heap._data; }
+	byte const* raw_data() const { return is_small() ? _small : _heap._data; }
+
+	// View of the contents, invalidated when the string changes
+	String as_string() const { return String::from_pointer(raw_data(), size()); }
+
+	operator String() const { return as_string(); }
+
+	// Make room for a total of at least `nbytes` bytes, returns false on failure
+	bool reserve(isize nbytes);
+
+	// Replace the contents with a copy of a string, returns false on failure
+	bool assign(String s);
+
+	// Append a string (which may be a view of this one), returns false on failure
+	bool append(String s);
+
+	// Append encoded rune, returns false on failure
+	bool append_rune(rune r);
+
+	// Cut the contents down to `length` bytes, does nothing if they are shorter
+	void truncate(isize length);
+
+	// Empty the string, keeping its buffer
+	void clear(){ truncate(0); }
+
+	void _set_length(isize length);
+	void _reset();
+	void _free();
+};
+
+//// String Builder ////////////////////////////////////////////////////////////
+struct String_Builder {
+	byte* _data;
+	isize _length;
+	isize _capacity;
+	mem::Allocator _allocator;
+
+	// Initialize a string builder, returns false on failure
+	bool init(mem::Allocator allocator, isize initial_cap);
+
+	// Free builder's buffer
+	void destroy();
+
+	// Make room for at least `nbytes` more bytes, returns false on failure
+	bool reserve(isize nbytes);
+
+	// Append buffer of bytes. Returns < 0 if an error occours and number of
+	// bytes added otherwise
+	isize append_bytes(byte const* buf, isize nbytes);
+
+	// Append string
+	isize append(String s);
+
+	// Append encoded rune
+	isize append_rune(rune r);
+
+	// View of the current contents, invalidated by the next append
+	String as_string() const;
+
+	// Build owned string, resetting the builder
+	String build();
+
+	// Reset length, does not free memory
+	void clear();
+};
+
+//// Chunk Builder /////////////////////////////////////////////////////////////
+// Chunk header, followed by `_capacity` bytes of data
+struct Builder_Chunk {
+	Builder_Chunk* _next;
+	isize _length;
+	isize _capacity;
+
+	byte* data(){ return (byte*)(this + 1); }
+};
+
+// String builder made of a list of fixed size chunks, nothing is copied when
+// it grows. When a stream is attached every chunk is written out as soon as it
+// fills up and then reused, so memory stays at a single chunk no matter how
+// much is appended. Chunks are linked from `_head`, the ones after `_tail` are
+// empty and kept for reuse.
+struct Chunk_Builder {
+	Builder_Chunk* _head;
+	Builder_Chunk* _tail;
+	isize _chunk_size;
+	isize _length;
+	i64 _written;
+	i64 _error;
+	io::Stream _stream;
+	mem::Allocator _allocator;
+
+	// Initialize a chunk builder, returns false on failure. `chunk_size` is
+	// rounded up to a multiple of the chunk header alignment.
+	bool init(mem::Allocator allocator, isize chunk_size);
+
+	// Initialize a chunk builder that writes full chunks to a stream, returns
+	// false on failure
+	bool init(mem::Allocator allocator, isize chunk_size, io::Stream s);
+
+	// Free all chunks, does not flush
+	void destroy();
+
+	// Append buffer of bytes. Returns < 0 if an error occours and number of
+	// bytes added otherwise
+	isize append_bytes(byte const* buf, isize nbytes);
+
+	// Append string
+	isize append(String s);
+
+	// Append encoded rune
+	isize append_rune(rune r);
+
+	// Write everything held to the stream. Returns total number of bytes
+	// written or (if negative) an error code.
+	i64 flush();
+
+	// Copy the contents into a single owned string (from the builder's
+	// allocator) and reset the builder. Returns an empty string on failure.
+	String build();
+
+	// Reset contents, keeping the chunks for reuse
+	void clear();
+
+	Builder_Chunk* _new_chunk();
+	void _write(byte const* data, isize len);
+	void _spill();
+	bool _next_chunk();
+};
+
+//// Rope //////////////////////////////////////////////////////////////////////
+// Maximum height of a rope, enough for any rope that fits in memory
+constexpr i32 ROPE_MAX_HEIGHT = 96;
+
+// Leaves this short (in bytes) are copied together on concatenation instead of
+// getting a node of their own
+constexpr isize ROPE_LEAF_MERGE = 128;
+
+// Immutable tree node, leaves have no children
+struct Rope_Node {
+	Rope_Node const* _left;
+	Rope_Node const* _right;
+	String _leaf;
+	isize _length; // Bytes
+	isize _runes;  // Codepoints
+	i32 _height;   // 0 for leaves
+};
+
+// Walks the leaves of a rope in order
+struct Rope_Iterator {
+	Rope_Node const* _stack[ROPE_MAX_HEIGHT + 1];
+	isize _depth;
+
+	// Get the next leaf, returns false at the end
+	bool next(String* leaf);
+};
+
+// Text as a balanced (AVL) tree of string views, concatenation and substrings
+// are O(log n) and share all untouched nodes with their inputs. Ropes are
+// immutable values: nodes are never changed or freed on their own, so they
+// should come from an arena that is freed as a whole once the ropes are done.
+// The strings a rope is made from must outlive it.
+//
+// Concatenation is cheap in time, not in memory: each one copies the O(log n)
+// nodes along the join path, and joining 2 short leaves copies both into a
+// merged leaf of up to ROPE_LEAF_MERGE bytes. None of it is released before
+// the arena, so growing a rope by many small appends costs several hundred
+// bytes of arena per append. Collect such text in a builder and add it once.
+//
+// Rune counts and offsets assume valid UTF-8, every byte that is not a
+// continuation byte starts a rune. This keeps them exact when a byte range
+// cuts through a codepoint.
+struct Rope {
+	Rope_Node const* _root;
+	mem::Allocator _allocator;
+
+	// Initialize a rope of a single string (which is not copied), returns false
+	// on failure
+	bool init(mem::Allocator allocator, String s);
+
+	// Concatenation with another rope, with nodes from this rope's allocator.
+	// Returns false on failure.
+	bool concat(Rope* out, Rope other) const;
+
+	// Rope of `length` bytes starting at `start`, the range is clamped to the
+	// rope. Returns false on failure.
+	bool sub(Rope* out, isize start, isize length) const;
+
+	// Rope of `count` codepoints starting at the `start`-th codepoint
+	bool sub_runes(Rope* out, isize start, isize count) const;
+
+	// Size (in bytes)
+	isize size() const;
+
+	// Size (in codepoints)
+	isize rune_count() const;
+
+	// Byte at an offset, which must be in range
+	byte byte_at(isize offset) const;
+
+	// Byte offset of the n-th codepoint, the rope's size if it's past the end
+	isize rune_offset(isize n) const;
+
+	// Decode the n-th codepoint, which may span leaves. utf8::ERROR if it's out
+	// of range or invalid.
+	rune rune_at(isize n) const;
+
+	// Append all the rope's text to a builder. Returns < 0 if an error occours
+	// and number of bytes added otherwise
+	isize flatten(String_Builder* sb) const;
+
+	// Iterator over the leaves
+	Rope_Iterator leaves() const;
+};
+
+//// Buffered IO ///////////////////////////////////////////////////////////////
+// Reads from a stream in buffer sized pieces. Reads that are at least as big as
+// the buffer skip it when it's empty. A source that returns 0 is at its end.
+struct Buffered_Reader {
+	io::Stream _source;
+	byte* _buf;
+	isize _capacity;
+	isize _start; // Unread bytes are [_start, _end)
+	isize _end;
+	i64 _error;   // First source error (or End_Of_Stream), returned once the buffer is empty
+	mem::Allocator _allocator; // Only used if the buffer was allocated
+
+	// Initialize a reader with a buffer from the allocator, returns false on
+	// failure
+	bool init(mem::Allocator allocator, isize size, io::Stream source);
+
+	// Initialize a reader over a caller owned buffer
+	void init(Slice<byte> buffer, io::Stream source);
+
+	// Free the buffer if it was allocated
+	void destroy();
+
+	// Read up to `buf.size()` bytes. Returns number of bytes read or (if
+	// negative) an error code, End_Of_Stream once everything was read.
+	i64 read(Slice<byte> buf);
+
+	// View of the next `n` bytes without consuming them, shorter if the stream
+	// ends first or `n` is bigger than the buffer. Valid until the next read.
+	String peek(isize n);
+
+	// Read up to and including the next `delim`, the result is a view into the
+	// buffer valid until the next read. When the delimiter isn't found before
+	// the buffer fills up or the stream ends, the view holds everything buffered
+	// and doesn't end with `delim`; call again for the rest. Returns the length
+	// of the view or (if negative) an error code.
+	i64 read_until(byte delim, String* out);
+
+	// Append everything up to and including the next `delim` to a builder, of
+	// any length. Returns the number of bytes appended or (if negative) an error
+	// code.
+	i64 read_until(byte delim, String_Builder* sb);
+
+	// Stream interface that reads through the buffer
+	io::Stream stream();
+
+	void _fill();
+};
+
+// Writes to a stream in buffer sized pieces. Writes that are at least as big as
+// the buffer skip it.
+struct Buffered_Writer {
+	io::Stream _sink;
+	byte* _buf;
+	isize _capacity;
+	isize _length;
+	i64 _written; // Bytes written to the sink so far
+	i64 _error;   // First sink error, later writes fail
+	mem::Allocator _allocator; // Only used if the buffer was allocated
+
+	// Initialize a writer with a buffer from the allocator, returns false on
+	// failure
+	bool init(mem::Allocator allocator, isize size, io::Stream sink);
+
+	// Initialize a writer over a caller owned buffer
+	void init(Slice<byte> buffer, io::Stream sink);
+
+	// Free the buffer if it was allocated, does not flush
+	void destroy();
+
+	// Write buffer of bytes. Returns number of bytes taken or (if negative) an
+	// error code.
+	i64 write(Slice<byte> buf);
+
+	// Write everything buffered to the sink. Returns total number of bytes
+	// written or (if negative) an error code.
+	i64 flush();
+
+	// Stream interface that writes through the buffer
+	io::Stream stream();
+
+	void _send(byte const* data, isize len);
+};
+
+//// Format ////////////////////////////////////////////////////////////////////
+// Type safe formatting, every `{}` in the format string is replaced by the next
+// argument and `{{`, `}}` stand for literal braces. The format string is parsed
+// when the program is compiled, a bad one (or the wrong number of arguments)
+// is a compile error, and the whole call becomes a fixed sequence of writes:
+//   fmt::format_to(sb, fmt_lit("{} of {} done"), done, total);
+// Integers, floats, bool, char, enums, String, C strings and Slice<T> (of any
+// formattable T) are supported. Other types need an overload found by
+// argument dependent lookup:
+//   void format_value(fmt::Writer& w, Point const& p);
+namespace fmt {
+// Formatted output goes either straight into a string builder or into a
+// caller supplied buffer that is flushed to a stream whenever it fills up.
+struct Writer {
+	byte* _buf;
+	isize _length;
+	isize _capacity;
+	String_Builder* _builder;
+	io::Stream _stream;
+	i64 _written;
+	i64 _error;
+
+	// Writer that appends to a builder, call flush() when done
+	static Writer from_builder(String_Builder* sb);
+
+	// Writer that buffers into `buf` (at least F64_SIZE bytes) and writes to a
+	// stream, call flush() when done
+	static Writer from_stream(io::Stream s, Slice<byte> buf);
+
+	// Push pending output to the builder or stream. Returns total number of
+	// bytes written by the writer or (if negative) the first error it ran into.
+	i64 flush();
+
+	// Write raw bytes
+	void write(byte const* data, isize len){
+		if(len <= _capacity - _length){
+			mem::copy(&_buf[_length], data, len);
+			_length += len;
+		}
+		else {
+			_write_slow(data, len);
+		}
+	}
+
+	void write(String s){ write(s._data, s._length); }
+
+	// Room for `len` more bytes (no more than F64_SIZE), to be followed by
+	// commit(). Returns null on error.
+	byte* reserve(isize len){
+		if(len > _capacity - _length && !_make_room(len)){ return nullptr; }
+		return &_buf[_length];
+	}
+
+	void commit(isize len){ _length += len; }
+
+	void _write_slow(byte const* data, isize len);
+	bool _make_room(isize len);
+};
+
+void format_value(Writer& w, String s);
+void format_value(Writer& w, cstring s);
+void format_value(Writer& w, bool v);
+
+template<typename T>
+void format_arg(Writer& w, T const& v);
+
+template<typename T>
+void format_value(Writer& w, Slice<T> const& s){
+	w.write((byte const*)"[", 1);
+	for(isize i = 0; i < s.size(); i += 1){
+		if(i > 0){ w.write((byte const*)", ", 2); }
+		format_arg(w, s.raw_data()[i]);
+	}
+	w.write((byte const*)"]", 1);
+}
+
+template<typename T, typename = void>
+struct Has_Format_Value : std::false_type {};
+
+template<typename T>
+struct Has_Format_Value<T, std::void_t<decltype(format_value(std::declval<Writer&>(), std::declval<T const&>()))>>
+	: std::true_type {};
+
+template<typename T>
+void format_arg(Writer& w, T const& v){
+	if constexpr(std::is_same_v<T, bool>){
+		format_value(w, v);
+	}
+	else if constexpr(std::is_same_v<T, char>){
+		w.write((byte const*)&v, 1);
+	}
+	else if constexpr(std::is_enum_v<T>){
+		format_arg(w, std::underlying_type_t<T>(v));
+	}
+	else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>){
+		byte* out = w.reserve(INT_SIZE);
+		if(out != nullptr){ w.commit(write_i64(Slice<byte>::from_pointer(out, INT_SIZE), i64(v))); }
+	}
+	else if constexpr(std::is_integral_v<T>){
+		byte* out = w.reserve(INT_SIZE);
+		if(out != nullptr){ w.commit(write_u64(Slice<byte>::from_pointer(out, INT_SIZE), u64(v))); }
+	}
+	else if constexpr(std::is_floating_point_v<T>){
+		byte* out = w.reserve(F64_SIZE);
+		if(out != nullptr){ w.commit(write_f64(Slice<byte>::from_pointer(out, F64_SIZE), f64(v))); }
+	}
+	else if constexpr(std::is_array_v<T> || std::is_pointer_v<T>){
+		static_assert(std::is_same_v<std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>>, char>,
+			"Only char pointers and arrays can be formatted");
+		format_value(w, cstring(v));
+	}
+	else {
+		static_assert(Has_Format_Value<T>::value, "No format_value() overload for this type");
+		format_value(w, v);
+	}
+}
+
+// Format string parsed at compile time: literal text with the escapes
+// resolved, cut where each argument goes
+template<isize N, isize ARGS>
+struct Format_Plan {
+	char text[N + 1];
+	isize cuts[ARGS + 1];
+	isize arg_count;
+	bool valid;
+};
+
+constexpr isize literal_length(cstring s){
+	isize n = 0;
+	while(s[n] != 0){ n += 1; }
+	return n;
+}
+
+template<isize N, isize ARGS>
+constexpr Format_Plan<N, ARGS> compile_format(cstring s){
+	Format_Plan<N, ARGS> plan{};
+	isize len = 0;
+	plan.valid = true;
+	for(isize i = 0; i < N; i += 1){
+		char c = s[i];
+		if(c == '{' && i + 1 < N && s[i + 1] == '}'){
+			if(plan.arg_count < ARGS){ plan.cuts[plan.arg_count] = len; }
+			plan.arg_count += 1;
+			i += 1;
+			continue;
+		}
+		if(c == '{' || c == '}'){
+			if(i + 1 >= N || s[i + 1] != c){ plan.valid = false; }
+			i += 1;
+		}
+		plan.text[len] = c;
+		len += 1;
+	}
+	plan.cuts[ARGS] = len;
+	return plan;
+}
+
+template<typename Lit, typename... Args>
+struct Compiled_Format {
+	static constexpr isize size = literal_length(Lit::value());
+	static constexpr isize arg_count = sizeof...(Args);
+	static constexpr Format_Plan<size, arg_count> plan = compile_format<size, arg_count>(Lit::value());
+	static_assert(plan.valid, "Unmatched '{' or '}' in format string");
+	static_assert(plan.arg_count == arg_count, "Number of '{}' in format string does not match the arguments");
+};
+
+// Text before argument I (or after the last one, for I == number of arguments)
+template<typename Compiled, isize I>
+void format_text(Writer& w){
+	constexpr isize start = I == 0 ? 0 : Compiled::plan.cuts[I - 1];
+	constexpr isize len = Compiled::plan.cuts[I] - start;
+	if constexpr(len > 0){
+		w.write((byte const*)&Compiled::plan.text[start], len);
+	}
+}
+
+template<typename Compiled, typename... Args, isize... I>
+void format_expand(Writer& w, std::integer_sequence<isize, I...>, Args const&... args){
+	((format_text<Compiled, I>(w), format_arg(w, args)), ...);
+	format_text<Compiled, sizeof...(Args)>(w);
+}
+
+// Write formatted text to a writer, `lit` comes from fmt_lit()
+template<typename Lit, typename... Args>
+void format_to(Writer& w, Lit lit, Args const&... args){
+	(void)lit;
+	using Compiled = Compiled_Format<Lit, Args...>;
+	format_expand<Compiled>(w, std::make_integer_sequence<isize, sizeof...(Args)>{}, args...);
+}
+
+// Append formatted text to builder. Returns < 0 if an error occours and number
+// of bytes added otherwise
+template<typename Lit, typename... Args>
+isize format_to(String_Builder& sb, Lit lit, Args const&... args){
+	isize start = sb._length;
+	Writer w = Writer::from_builder(&sb);
+	format_to(w, lit, args...);
+	i64 n = w.flush();
+	if(n < 0){
+		sb._length = start;
+		return -1;
+	}
+	return isize(n);
+}
+
+// Write formatted text to a stream, using `buf` to batch the writes. Returns
+// number of bytes written or (if negative) an error code.
+template<typename Lit, typename... Args>
+i64 format_to(io::Stream s, Slice<byte> buf, Lit lit, Args const&... args){
+	Writer w = Writer::from_stream(s, buf);
+	format_to(w, lit, args...);
+	return w.flush();
+}
+} /* Namespace fmt */
+
+// Format string literal for fmt::format_to(), carried in its type so it can be
+// checked at compile time
+#define fmt_lit(Lit) [](){ \
+	struct Format_Literal { static constexpr cstring value(){ return Lit; } }; \
+	return Format_Literal{}; \
+}()
+
+//// Files /////////////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+namespace io {
+enum class File_Mode : u32 {
+	Read      = 1 << 0,
+	Write     = 1 << 1,
+	Create    = 1 << 2, // Create the file if it doesn't exist
+	Truncate  = 1 << 3,
+	Append    = 1 << 4, // Every write goes to the end of the file
+	Exclusive = 1 << 5, // Fail if the file exists (with Create)
+};
+
+// Access pattern hints, see posix_fadvise()
+enum class File_Advice : u8 {
+	Normal     = 0,
+	Sequential = 1,
+	Random     = 2,
+	Will_Need  = 3,
+	Dont_Need  = 4,
+};
+
+// Longest path File::open() accepts (in bytes)
+constexpr isize FILE_PATH_MAX = 4096;
+
+// Most buffers a single vectored read or write takes
+constexpr isize FILE_IO_BUFFERS_MAX = 1024;
+
+// File descriptor and the mode it was opened with. Vectored IO takes lists of
+// byte slices, which have the same layout as `struct iovec` and are handed to
+// the kernel as is.
+struct File {
+	i32 _fd{-1};
+	u32 _mode{0};
+
+	// Open a file, `mode` is a combination of File_Mode flags. Created files get
+	// permissions 0666 minus the process umask. Returns success status.
+	bool open(String path, u32 mode);
+
+	// Wrap an already open descriptor (e.g. 0, 1, 2 for the standard streams)
+	static File from_fd(i32 fd, u32 mode);
+
+	// Close the file. Returns success status.
+	bool close();
+
+	// Read at the current position. Returns number of bytes read or (if
+	// negative) an error code, End_Of_Stream at the end of the file.
+	i64 read(Slice<byte> buf);
+
+	// Write at the current position. Returns number of bytes written or (if
+	// negative) an error code.
+	i64 write(Slice<byte> buf);
+
+	// Read at an offset without moving the current position, safe to use from
+	// several threads at once. Returns like read().
+	i64 read_at(Slice<byte> buf, i64 offset);
+
+	// Write at an offset without moving the current position. Returns like
+	// write().
+	i64 write_at(Slice<byte> buf, i64 offset);
+
+	// Read into several buffers with one call, filling them in order. At most
+	// FILE_IO_BUFFERS_MAX buffers are used. Returns like read().
+	i64 readv(Slice<Slice<byte>> bufs);
+
+	// Write several buffers with one call, in order. At most
+	// FILE_IO_BUFFERS_MAX buffers are used. Returns like write().
+	i64 writev(Slice<Slice<byte>> bufs);
+
+	// Size of the file (in bytes) or (if negative) an error code
+	i64 size();
+
+	// Tell the kernel how a range will be accessed (`len` 0 is up to the end),
+	// Sequential makes it read ahead further. Returns success status.
+	bool advise(i64 offset, i64 len, File_Advice advice);
+
+	// Stream interface reading and writing at the current position
+	Stream stream();
+};
+} /* Namespace io */
+#endif
+
+//// Mapped Files //////////////////////////////////////////////////////////////
+#if defined(TARGET_OS_LINUX)
+namespace io {
+enum class Map_Mode : u32 {
+	Read       = 1 << 0,
+	Write      = 1 << 1, // Writes go back to the file
+	Private    = 1 << 2, // Writable, but writes stay private to the mapping
+	Populate   = 1 << 3, // Read the whole file in up front, no page faults later
+	Huge_Pages = 1 << 4, // Align to huge pages and ask for them, if the kernel can back the file with them
+};
+
+// Huge page size used to align mappings, files smaller than this are mapped
+// with regular pages
+constexpr isize MMAP_HUGE_PAGE_SIZE = 2ll * 1024ll * 1024ll;
+
+// File contents mapped into memory, usable as a byte slice or a String as long
+// as the mapping lives
+struct Mapped_File {
+	byte* _data{nullptr};
+	isize _length{0};
+
+	// Map a whole file, `mode` is a combination of Map_Mode flags. The file
+	// does not need to stay open. Empty files succeed with no data. Returns
+	// success status.
+	bool map(String path, u32 mode);
+
+	// Tell the kernel how a range (`len` 0 is up to the end) will be accessed,
+	// takes the same hints as File::advise(). Dont_Need drops private changes.
+	// Returns success status.
+	bool advise(isize offset, isize len, File_Advice advice);
+
+	// Unmap the file, its data must not be used anymore. Returns success status.
+	bool unmap();
+
+	// Mapped bytes
+	Slice<byte> bytes() const { return Slice<byte>::from_pointer(_data, _length); }
+
+	// Mapped bytes as text
+	String as_string() const { return String::from_pointer(_data, _length); }
+};
+} /* Namespace io */
+#endif
@@ -1,6 +1,114 @@
 #include "prelude.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+static
+void* test_allocator_func(void*, mem::Allocator_Op op, void* old_ptr, isize size, isize, u32*){
+	switch(op){
+	case mem::Allocator_Op::Alloc: return calloc(1, size);
+	case mem::Allocator_Op::Free: free(old_ptr); return nullptr;
+	default: return nullptr;
+	}
+}
+
+#if defined(__cpp_impl_coroutine)
+static
+async::Task<int> doubled_later(int v, Time_Duration delay){
+	co_await async::sleep(delay);
+	co_return v * 2;
+}
+
+static
+async::Task<void> sum_doubled(int* out){
+	async::Task<int> slow = doubled_later(1, 2 * time_millisecond);
+	async::Task<int> fast = doubled_later(20, time_millisecond);
+	co_await async::when_all(slow, fast);
+	*out = slow.result() + fast.result();
+}
+#endif
 
 int main(){
-	Atomic<int> a = 0;
-	Atomic<int> b = 4;
+	atomic::Atomic<int> a{0};
+	atomic::Atomic<int> b{4};
+
+	int expected = 4;
+	bool ok = atomic::compare_exchange_strong(&b, &expected, 8) && expected == 4 && atomic::load(&b) == 8;
+	ok = ok && !atomic::compare_exchange_strong(&b, &expected, 16) && expected == 8 && atomic::load(&b) == 8;
+	ok = ok && atomic::fetch_add(&a, 2, atomic::Memory_Order::Relaxed) == 0 && atomic::load(&a) == 2;
+	atomic::thread_fence(atomic::Memory_Order::Acq_Rel);
+	std::thread waiter([&a](){ atomic::wait(&a, 2); });
+	atomic::store(&a, 3);
+	atomic::notify_all(&a);
+	waiter.join();
+	ok = ok && atomic::load(&a) == 3;
+	printf("%d\n", ok);
+
+	mem::Allocator allocator;
+	allocator._func = test_allocator_func;
+
+	for(isize cap : {isize(4), isize(0)}){
+		sync::Channel<int> ch;
+		ch.init(allocator, cap);
+		std::thread producer([&ch](){
+			for(int i = 1; i <= 1000; i += 1){ ch.send(i); }
+			ch.close();
+		});
+		int v = 0, last = 0;
+		ok = true;
+		while(ch.recv(&v)){
+			ok = ok && v == last + 1;
+			last = v;
+		}
+		producer.join();
+		ok = ok && last == 1000 && ch.try_recv(&v) == sync::Channel_Result::Closed;
+		printf("%d\n", ok);
+		ch.destroy();
+	}
+	sync::Channel<int> left, right;
+	left.init(allocator, 1);
+	right.init(allocator, 1);
+	left.close();
+	right.close();
+	int got = 0;
+	ok = sync::select(sync::select_recv(&left, &got), sync::select_recv(&right, &got)) == -1 &&
+		!left.send(1) && left.try_send(1) == sync::Channel_Result::Closed;
+	printf("%d\n", ok);
+	left.destroy();
+	right.destroy();
+
+#if defined(__cpp_impl_coroutine)
+	async::Executor executor;
+	executor.init(allocator);
+	int total = 0;
+	Time_Point start = time_monotonic();
+	executor.spawn(sum_doubled(&total));
+	executor.run();
+	ok = total == 42 && time_monotonic() - start >= 2 * time_millisecond;
+	printf("%d\n", ok);
+	executor.destroy();
+#endif
+
+	Str_Buf small(allocator);
+	small.assign(String::from_cstr("12345678901234567890123"));
+	ok = small.is_small() && small.size() == 23 && small.raw_data()[23] == 0;
+	small.append_rune('4');
+	ok = ok && !small.is_small() && small.size() == 24 && small.raw_data()[24] == 0 &&
+		small.as_string() == String::from_cstr("123456789012345678901234");
+	printf("%d\n", ok);
+
+	Str_Buf twice(allocator);
+	twice.assign(String::from_cstr("0123456789abcdef0123"));
+	ok = twice.is_small() && twice.append(twice.as_string()) && !twice.is_small() &&
+		twice.as_string() == String::from_cstr("0123456789abcdef01230123456789abcdef0123") &&
+		twice.append(twice.as_string().sub(0, 40)) && twice.size() == 80 && twice.raw_data()[80] == 0 &&
+		twice.as_string().sub(40, 40) == twice.as_string().sub(0, 40);
+	Str_Buf moved(static_cast<Str_Buf&&>(twice));
+	ok = ok && moved.size() == 80 && twice.size() == 0 && twice.is_small() && twice.raw_data()[0] == 0;
+	printf("%d\n", ok);
+
+	Str_Buf fixed;
+	ok = fixed.assign(String::from_cstr("12345678901234567890123")) && !fixed.append(String::from_cstr("4")) &&
+		fixed.is_small() && fixed.size() == 23 && !fixed.reserve(24);
+	printf("%d\n", ok);
 }
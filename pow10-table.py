@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+# Generates the table of 128-bit powers of ten shared by fmt_f64() (Schubfach)
+# and str_parse_f64() (Eisel-Lemire), paste the output over the table in
+# c/prelude.c and cpp/prelude.cpp.
+#
+#   python3 pow10-table.py > table.txt
+#   python3 pow10-table.py --cpp > table.txt
+import sys
+
+POW10_MIN = -342
+POW10_MAX = 324
+
+def significand(k):
+	# floor(10^k * 2^s), with s picked so the result is in [2^127, 2^128)
+	if k >= 0:
+		v = 10 ** k
+		n = v.bit_length()
+		return v << (128 - n) if n <= 128 else v >> (n - 128)
+	p = 10 ** -k
+	s = p.bit_length() + 127
+	v = (1 << s) // p
+	if v >= 1 << 128:
+		v = (1 << (s - 1)) // p
+	assert (1 << 127) <= v < (1 << 128)
+	return v
+
+def main():
+	cpp = '--cpp' in sys.argv[1:]
+	print('/* Generated by pow10-table.py, do not edit. Significands of 10^k for k in')
+	print(' * [POW10_MIN, POW10_MAX], rounded down to 128 bits as {high, low} */')
+	if cpp:
+		print('constexpr int POW10_MIN = %d;' % POW10_MIN)
+		print('constexpr int POW10_MAX = %d;' % POW10_MAX)
+		print('constexpr u64 pow10_table[%d][2] = {' % (POW10_MAX - POW10_MIN + 1))
+	else:
+		print('#define POW10_MIN (%d)' % POW10_MIN)
+		print('#define POW10_MAX %d' % POW10_MAX)
+		print('static const u64 pow10_table[%d][2] = {' % (POW10_MAX - POW10_MIN + 1))
+	entries = []
+	for k in range(POW10_MIN, POW10_MAX + 1):
+		v = significand(k)
+		entries.append('{0x%016x, 0x%016x},' % (v >> 64, v & ((1 << 64) - 1)))
+	for i in range(0, len(entries), 2):
+		print('\t' + ' '.join(entries[i:i + 2]))
+	print('};')
+
+main()